@@ -7,6 +7,16 @@
 
 typedef int8_t (*Activation_i8_t)(int8_t x);
 
+/* per-layer activation selector used by layer descriptors */
+typedef enum {
+    TT_ACT_RELU = 0,
+    TT_ACT_LEAKY,       /* slope 1/4, as leaky_relu_i8 */
+    TT_ACT_LINEAR,
+    TT_ACT_SIGMOID,     /* 256-entry tables, see tt_act_lut.h */
+    TT_ACT_TANH,
+    TT_ACT_COUNT,
+} tt_act_t;
+
 typedef float (*Activation_flt_t)(float x);
 /*
  * Activation functions for both integer and floating-point use.
@@ -0,0 +1,210 @@
+/**
+ * @file tt_act_lut.c
+ * @brief integer-only sigmoid, tanh and softmax for int8 tensors
+ * @license MIT
+ */
+#include "tt_act_lut.h"
+#include "tt_math.h"
+#include "tt_utils.h"
+#include <string.h>
+
+#define S_ONE        (1 << 16)          /* 1.0 in Q16 */
+#define S_X_MAX      (32 << 16)         /* |x| beyond which the functions are flat */
+#define S_LOG2E_Q16  (94548)            /* log2(e) in Q16 */
+
+/* 2^x on [0, 1] as 1 + x (c1 + x (c2 + x c3)), coefficients in Q16 */
+#define S_C1 (45559)
+#define S_C2 (14821)
+#define S_C3 (5179)
+
+/* lsb of header s: m / 2^30 * 2^e, m in [2^29, 2^30) */
+static tt_mult_t s_lsb(const scale_t *s) {
+#ifdef TENSOR_USE_NESTED
+    int S = s->g.S + s->l.S, U = s->g.U + s->l.U, D = s->g.D + s->l.D;
+#else
+    int S = s->S, U = s->U, D = s->D;
+#endif
+    uint64_t m = (uint64_t)1 << 29;
+    int e = 1;
+    /* every upscale left a factor 16/21 in the value of one step, every downscale 4/3 */
+    for (; U > 0; --U) { m = (m * 16 + 10) / 21;  if (m < ((uint64_t)1 << 29)) { m <<= 1; --e; } }
+    for (; U < 0; ++U) { m = (m * 21 + 8) / 16;   if (m >= ((uint64_t)1 << 30)) { m = (m + 1) >> 1; ++e; } }
+    for (; D > 0; --D) { m = (m * 4 + 1) / 3;     if (m >= ((uint64_t)1 << 30)) { m = (m + 1) >> 1; ++e; } }
+    for (; D < 0; ++D) { m = (m * 3 + 2) / 4;     if (m < ((uint64_t)1 << 29)) { m <<= 1; --e; } }
+    tt_mult_t r;
+    r.m = (int32_t)m;
+    r.e = (int16_t)(e - S);
+    return r;
+}
+
+/* k steps of lsb in Q16, saturated to +-S_X_MAX */
+static int32_t s_to_q16(int k, tt_mult_t lsb) {
+    uint64_t p = (uint64_t)(k < 0 ? -k : k) * (uint64_t)lsb.m;
+    int sh = lsb.e - 14;
+    if (sh >= 0) {
+        p = sh > 20 ? (uint64_t)S_X_MAX : p << sh;
+    } else {
+        p = -sh >= 63 ? 0 : (p + ((uint64_t)1 << (-sh - 1))) >> -sh;
+    }
+    int32_t a = p > (uint64_t)S_X_MAX ? S_X_MAX : (int32_t)p;
+    return k < 0 ? -a : a;
+}
+
+/* 2^-t of t >= 0 in Q16 */
+static uint32_t s_exp2_neg_q16(uint64_t t) {
+    uint64_t n = t >> 16;
+    if (n > 16) return 0;
+    /* 2^-f = 2^(1-f) / 2 */
+    uint64_t g = S_ONE - (t & 0xFFFF);
+    uint64_t p = S_C3;
+    p = S_C2 + ((p * g) >> 16);
+    p = S_C1 + ((p * g) >> 16);
+    p = S_ONE + ((p * g) >> 16);
+    p >>= 1;
+    if (p > S_ONE) p = S_ONE;
+    return (uint32_t)((p + (((uint64_t)1 << n) >> 1)) >> n);
+}
+
+/**
+ * @brief exp(-x) in fixed point
+ * @param x argument in Q16, x >= 0
+ * @return uint32_t exp(-x) in Q16
+ */
+uint32_t tt_exp_neg_q16(uint32_t x) {
+    return s_exp2_neg_q16(((uint64_t)x * S_LOG2E_Q16 + (1u << 15)) >> 16);
+}
+
+static int32_t s_sigmoid_q16(int32_t x) {
+    uint32_t e = tt_exp_neg_q16((uint32_t)(x < 0 ? -x : x));
+    int32_t  s = (int32_t)((((uint64_t)1 << 32) + ((S_ONE + e) >> 1)) / (S_ONE + e));
+    return x < 0 ? S_ONE - s : s;
+}
+
+static int32_t s_tanh_q16(int32_t x) {
+    uint32_t e = tt_exp_neg_q16(2u * (uint32_t)(x < 0 ? -x : x));
+    int32_t  t = (int32_t)((((uint64_t)(S_ONE - e) << 16) + ((S_ONE + e) >> 1)) / (S_ONE + e));
+    return x < 0 ? -t : t;
+}
+
+/* Q16 value to int8 steps of 2^-TT_LUT_OUT_S, half away from zero */
+static int8_t s_q16_to_i8(int32_t y) {
+    const int sh = 16 - TT_LUT_OUT_S;
+    int32_t a = y < 0 ? -y : y;
+    a = (a + (1 << (sh - 1))) >> sh;
+    return clip_int8(y < 0 ? -a : a);
+}
+
+static void s_out_header(scale_t *s) {
+    memset(s, 0, sizeof(*s));
+#ifdef TENSOR_USE_NESTED
+    s->l.S = TT_LUT_OUT_S;
+#else
+    s->S = TT_LUT_OUT_S;
+#endif
+}
+
+/*----------------------------------------------------------------------*
+ * Sigmoid / tanh
+ *----------------------------------------------------------------------*/
+void tt_act_lut_init(tt_act_lut_t *lut, tt_lut_kind_t kind) {
+    if (!lut) return;
+    memset(lut, 0, sizeof(*lut));
+    lut->kind = (uint8_t)kind;
+}
+
+/**
+ * @brief builds the map of a LUT activation for one input header
+ * @param lut pointer of the table, kind set by tt_act_lut_init
+ * @param in input header
+ */
+void tt_act_lut_build(tt_act_lut_t *lut, const scale_t *in) {
+    if (!lut || !in) return;
+    const tt_mult_t lsb = s_lsb(in);
+    for (int q = INT8_MIN; q <= INT8_MAX; ++q) {
+        int32_t x = s_to_q16(q, lsb);
+        int32_t y = lut->kind == TT_LUT_TANH ? s_tanh_q16(x) : s_sigmoid_q16(x);
+        lut->map[(uint8_t)q] = s_q16_to_i8(y);
+    }
+    lut->in    = *in;
+    lut->valid = 1;
+}
+
+/**
+ * @brief applies a LUT activation
+ * @param lut pointer of the table
+ * @param x pointer of the input tensor
+ * @param y pointer of the output tensor, at least x->len elements, may be x
+ */
+void tt_act_lut_apply(tt_act_lut_t *lut, const tensor_t *x, tensor_t *y) {
+    if (!lut || !x || !y || !x->data || !y->data) return;
+    if (!lut->valid || memcmp(&lut->in, &x->s, sizeof(scale_t)) != 0) tt_act_lut_build(lut, &x->s);
+    const int8_t *map = lut->map;
+    for (size_t i = 0; i < x->len; ++i) y->data[i] = map[(uint8_t)x->data[i]];
+    s_out_header(&y->s);
+}
+
+/*----------------------------------------------------------------------*
+ * Per-thread table cache for the layer epilogues: headers change from
+ * call to call, but a layer cycles through a few of them.
+ *----------------------------------------------------------------------*/
+static __thread tt_act_lut_t s_cache[TT_LUT_CACHE];
+static __thread unsigned     s_cache_next;
+
+const tt_act_lut_t *tt_act_lut_get(tt_lut_kind_t kind, const scale_t *in) {
+    if (!in) return NULL;
+    for (unsigned i = 0; i < TT_LUT_CACHE; ++i) {
+        const tt_act_lut_t *c = &s_cache[i];
+        if (c->valid && c->kind == kind && memcmp(&c->in, in, sizeof(scale_t)) == 0) return c;
+    }
+    tt_act_lut_t *c = &s_cache[s_cache_next++ % TT_LUT_CACHE];
+    tt_act_lut_init(c, kind);
+    tt_act_lut_build(c, in);
+    return c;
+}
+
+void tt_act_lut_tensor(tt_act_t act, tensor_t *y) {
+    if (!y || !y->data) return;
+    if (act != TT_ACT_SIGMOID && act != TT_ACT_TANH) return;
+    const tt_act_lut_t *lut = tt_act_lut_get(act == TT_ACT_TANH ? TT_LUT_TANH : TT_LUT_SIGMOID, &y->s);
+    for (size_t i = 0; i < y->len; ++i) y->data[i] = lut->map[(uint8_t)y->data[i]];
+    s_out_header(&y->s);
+}
+
+/*----------------------------------------------------------------------*
+ * Softmax
+ *----------------------------------------------------------------------*/
+void tt_softmax_lut_init(tt_softmax_lut_t *lut) {
+    if (!lut) return;
+    memset(lut, 0, sizeof(*lut));
+}
+
+static void s_softmax_build(tt_softmax_lut_t *lut, const scale_t *in) {
+    const tt_mult_t lsb = s_lsb(in);
+    for (int k = 0; k < 256; ++k)
+        lut->e[k] = (uint16_t)((tt_exp_neg_q16((uint32_t)s_to_q16(k, lsb)) + 1) >> 1);
+    lut->in    = *in;
+    lut->valid = 1;
+}
+
+/**
+ * @brief softmax of int8 logits
+ * @param lut pointer of the exp table
+ * @param x pointer of the logits
+ * @param y pointer of the probabilities, at least x->len elements, may be x
+ */
+void tt_softmax_i8(tt_softmax_lut_t *lut, const tensor_t *x, tensor_t *y) {
+    if (!lut || !x || !y || !x->data || !y->data || !x->len) return;
+    if (!lut->valid || memcmp(&lut->in, &x->s, sizeof(scale_t)) != 0) s_softmax_build(lut, &x->s);
+
+    int mx = INT8_MIN;
+    for (size_t i = 0; i < x->len; ++i) mx = x->data[i] > mx ? x->data[i] : mx;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < x->len; ++i) sum += lut->e[mx - x->data[i]];
+
+    const int32_t one = 1 << TT_LUT_OUT_S;
+    for (size_t i = 0; i < x->len; ++i) {
+        uint64_t p = ((uint64_t)lut->e[mx - x->data[i]] * one + sum / 2) / sum;
+        y->data[i] = clip_int8((int32_t)p);
+    }
+    s_out_header(&y->s);
+}
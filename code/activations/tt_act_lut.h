@@ -0,0 +1,68 @@
+/**
+ * @file tt_act_lut.h
+ * @brief integer-only sigmoid, tanh and softmax for int8 tensors
+ * @details an int8 input only takes 256 values, so sigmoid and tanh are one
+ * table lookup per element. The table belongs to the input header: it is
+ * rebuilt from (S, U, D) whenever a tensor with another header comes in,
+ * in fixed point (the lsb of the header as a Q30 mantissa and exponent,
+ * exp through a cubic 2^x), so no floating point is ever touched.
+ *
+ * Softmax works on differences to the max logit, which for int8 are
+ * 0..255 steps of the input lsb: their exp (Q15) is tabled the same way,
+ * the probabilities are e / sum.
+ *
+ * Outputs carry the fixed header S = TT_LUT_OUT_S (lsb 1/128): sigmoid and
+ * softmax in [0, 127], tanh in [-127, 127].
+ * @license MIT
+ */
+#ifndef TT_ACT_LUT_H
+#define TT_ACT_LUT_H
+
+#include "tt_types.h"
+#include "activations.h"
+#include <stdint.h>
+
+#define TT_LUT_OUT_S   (7)
+
+typedef enum {
+    TT_LUT_SIGMOID = 0,
+    TT_LUT_TANH,
+} tt_lut_kind_t;
+
+typedef struct {
+    int8_t  map[256];   /* output of input (uint8_t)x */
+    scale_t in;         /* input header the map was built for */
+    uint8_t kind;       /* tt_lut_kind_t */
+    uint8_t valid;
+} tt_act_lut_t;
+
+typedef struct {
+    uint16_t e[256];    /* exp(-k * lsb) in Q15 */
+    scale_t  in;
+    uint8_t  valid;
+} tt_softmax_lut_t;
+
+/* exp(-x) of x >= 0 in Q16, result in Q16 */
+uint32_t tt_exp_neg_q16(uint32_t x);
+
+/* empty table of kind, built on first use */
+void tt_act_lut_init(tt_act_lut_t *lut, tt_lut_kind_t kind);
+/* (re)build the map for input header in */
+void tt_act_lut_build(tt_act_lut_t *lut, const scale_t *in);
+/* y = f(x) over x->len elements (y may be x), rebuilds on a new header */
+void tt_act_lut_apply(tt_act_lut_t *lut, const tensor_t *x, tensor_t *y);
+
+/*
+ * table of kind for input header in from a small per-thread cache, built
+ * on a miss; valid until the thread builds TT_LUT_CACHE other tables
+ */
+#define TT_LUT_CACHE   (8)
+const tt_act_lut_t *tt_act_lut_get(tt_lut_kind_t kind, const scale_t *in);
+/* in place y = act(y) through the cached table for TT_ACT_SIGMOID / TT_ACT_TANH, no-op otherwise */
+void tt_act_lut_tensor(tt_act_t act, tensor_t *y);
+
+void tt_softmax_lut_init(tt_softmax_lut_t *lut);
+/* y = softmax(x) over x->len elements (y may be x), rebuilds on a new header */
+void tt_softmax_i8(tt_softmax_lut_t *lut, const tensor_t *x, tensor_t *y);
+
+#endif // TT_ACT_LUT_H
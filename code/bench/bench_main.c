@@ -0,0 +1,468 @@
+/**
+ * @file bench_main.c
+ * @brief micro-benchmarks of the kernels, dense layers and models
+ * @details usage: tt_bench [csv path]. The default path is
+ * results/csv/bench_<build>.csv, <build> being "tt" or "nested"
+ * (TENSOR_USE_NESTED). The nested build runs every layer benchmark on both
+ * tt_backend and nested_backend so the two can be compared on the same
+ * binary. tt_i4_backend (packed int4 weights) and tt_tiled_backend (16 x 4
+ * weight tiles) run in both builds, and tt_sparse_backend at 0, 50 and
+ * 75 % pruned blocks. Sizes sweep square IN = OUT layers.
+ * @license MIT
+ */
+#include "tt_bench.h"
+#include "matrix.h"
+#include "matrix_i4.h"
+#include "matrix_sparse.h"
+#include "tt_dense_sparse.h"
+#include "tt_math.h"
+#include "tt_update.h"
+#include "tt_cpu.h"
+#include "tt_tensor_backend.h"
+#include "tt_seq_model.h"
+#include "motor_ae_model.h"
+#include "prng.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TENSOR_USE_NESTED
+#define BENCH_BUILD "nested"
+#else
+#define BENCH_BUILD "tt"
+#endif
+
+static const size_t s_sizes[] = { 16, 32, 64, 128, 256, 512 };
+#define N_SIZES (sizeof(s_sizes) / sizeof(s_sizes[0]))
+
+typedef struct {
+    const char            *name;
+    const TensorBackend_t *ops;
+} bench_backend_t;
+
+static const bench_backend_t s_backends[] = {
+    { "tt", &tt_backend },
+    { "tt_i4", &tt_i4_backend },
+    { "tt_tiled", &tt_tiled_backend },
+#ifdef TENSOR_USE_NESTED
+    { "nested", &nested_backend },
+    { "nested_tiled", &nested_tiled_backend },
+#endif
+};
+#define N_BACKENDS (sizeof(s_backends) / sizeof(s_backends[0]))
+
+/* keeps scalar results alive */
+static volatile int32_t s_sink;
+
+/*----------------------------------------------------------------------*
+ * one dense layer worth of buffers
+ *----------------------------------------------------------------------*/
+typedef struct {
+    const TensorBackend_t *ops;
+    tensor_t  W, x, y, e_next, e_prev, G;
+    int32_t  *acc;
+    tt_i4_ext_t i4;         /* W->ext once s_layer_pack_i4 ran */
+    matrix_sp_t sp;         /* W->ext once s_layer_sparse ran */
+    matrix_acc_t acc16;     /* int16 accumulation plan of the int8 W */
+    matrix_tile_t tile;     /* W->ext once s_layer_tiled ran */
+    size_t    n;            /* element count for the scalar helpers */
+    uint8_t  *mem;
+    uint8_t  *mem4;
+    uint8_t  *mem_sp;
+    uint8_t  *mem_t;
+} bench_layer_t;
+
+static void *s_take(uint8_t **cur, size_t bytes) {
+    void *p = *cur;
+    *cur += TT_SEQ_PAD(bytes);
+    return p;
+}
+
+static int s_layer_init(bench_layer_t *b, size_t in, size_t out, uint32_t seed) {
+    size_t bytes = 2 * TT_SEQ_PAD(in * out) + 2 * TT_SEQ_PAD(in) + 2 * TT_SEQ_PAD(out) +
+                   TT_SEQ_PAD(in * out * sizeof(int32_t)) + TT_SEQ_ALIGN;
+    memset(b, 0, sizeof(*b));
+    b->mem = malloc(bytes);
+    if (!b->mem) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)b->mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    tt_tensor_init(&b->W,      s_take(&cur, in * out), in * out);
+    tt_tensor_init(&b->G,      s_take(&cur, in * out), in * out);
+    tt_tensor_init(&b->x,      s_take(&cur, in), in);
+    tt_tensor_init(&b->e_prev, s_take(&cur, in), in);
+    tt_tensor_init(&b->y,      s_take(&cur, out), out);
+    tt_tensor_init(&b->e_next, s_take(&cur, out), out);
+    /* in x out int32 so the scalar helpers get a layer-sized array */
+    b->n   = in * out;
+    b->acc = s_take(&cur, b->n * sizeof(int32_t));
+
+    uint32_t rng;
+    prng_init(&rng, seed);
+    for (size_t i = 0; i < in * out; ++i) b->W.data[i] = prng_rand_range(&rng, -63, 63);
+    for (size_t i = 0; i < in; ++i)       b->x.data[i] = prng_rand_range(&rng, 0, 127);
+    for (size_t i = 0; i < out; ++i)      b->e_next.data[i] = prng_rand_range(&rng, -31, 31);
+    for (size_t i = 0; i < b->n; ++i)     b->acc[i] = (int32_t)prng_next(&rng) >> 8;
+    return 0;
+}
+
+/* switch W to packed int4 storage, the int8 weights become the shadow */
+static int s_layer_pack_i4(bench_layer_t *b, size_t in, size_t out) {
+    b->mem4 = malloc(TT_SEQ_PAD(TT_I4_BYTES(out, in)) + TT_SEQ_ALIGN);
+    if (!b->mem4) return -1;
+    uint8_t *packed = (uint8_t *)(((uintptr_t)b->mem4 + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    return tt_i4_weights_init(&b->W, &b->i4, packed, b->W.data, out, in);
+}
+
+/* index W as block-sparse and prune pct % of its blocks */
+static int s_layer_sparse(bench_layer_t *b, size_t in, size_t out, uint8_t pct) {
+    b->mem_sp = malloc(MATRIX_SP_BYTES(out, in) + TT_SEQ_ALIGN);
+    if (!b->mem_sp) return -1;
+    uint8_t *mem = (uint8_t *)(((uintptr_t)b->mem_sp + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    if (tt_sparse_weights_init(&b->W, &b->sp, mem, out, in) != 0) return -1;
+    tensor_t *W = &b->W;
+    tt_sparse_prune(&W, 1, pct);
+    return 0;
+}
+
+/* repack W into tiles, with a G of the tiled length */
+static int s_layer_tiled(bench_layer_t *b, size_t in, size_t out) {
+    size_t len = MATRIX_TILE_LEN(out, in);
+    b->mem_t = malloc(2 * TT_SEQ_PAD(len) + TT_SEQ_ALIGN);
+    if (!b->mem_t) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)b->mem_t + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    const int8_t *w = b->W.data;
+    if (tt_tiled_weights_init(&b->W, &b->tile, s_take(&cur, len), out, in) != 0) return -1;
+    matrix_tile_pack(&b->tile, w, b->W.data);
+    tt_tensor_init(&b->G, s_take(&cur, len), len);
+    return 0;
+}
+
+static void s_layer_free(bench_layer_t *b) {
+    free(b->mem_t);
+    b->mem_t = NULL;
+    free(b->mem4);
+    b->mem4 = NULL;
+    free(b->mem_sp);
+    b->mem_sp = NULL;
+    free(b->mem);
+    b->mem = NULL;
+}
+
+/*----------------------------------------------------------------------*
+ * bodies
+ *----------------------------------------------------------------------*/
+static void s_matrix_mul(void *ctx) {
+    bench_layer_t *b = ctx;
+    matrix_mul(&b->W, &b->x, b->acc);
+}
+
+static void s_matrix_mul_acc16(void *ctx) {
+    bench_layer_t *b = ctx;
+    matrix_mul_acc(&b->W, &b->x, &b->acc16, b->acc);
+}
+
+static void s_matrix_mul_i4(void *ctx) {
+    bench_layer_t *b = ctx;
+    matrix_mul_i4((const uint8_t *)b->W.data, b->y.len, &b->x, b->acc);
+}
+
+static void s_dense_forward(void *ctx) {
+    bench_layer_t *b = ctx;
+    b->ops->dense_forward(&b->W, &b->x, &b->y, b->acc, b->y.len, TT_ACT_RELU);
+}
+
+static void s_dense_train(void *ctx) {
+    bench_layer_t *b = ctx;
+    b->ops->dense_train(&b->W, &b->x, &b->e_next, &b->e_prev, &b->G);
+}
+
+static void s_shift_round(void *ctx) {
+    bench_layer_t *b = ctx;
+    int32_t s = 0;
+    for (size_t i = 0; i < b->n; ++i) s += shift_and_round32(b->acc[i], 7);
+    s_sink = s;
+}
+
+static void s_eff_bitwidth(void *ctx) {
+    bench_layer_t *b = ctx;
+    s_sink = eff_bitwidth_array(b->acc, b->n);
+}
+
+/* samples of one tt_seq_model_train_batch call */
+#define BENCH_BATCH (16)
+
+typedef struct {
+    tt_seq_model_t  m;
+    tt_layer_t      layers[3];
+    void           *arena;
+    int8_t         *in;
+    int8_t         *batch;      /* BENCH_BATCH copies of in */
+    void           *gsum;       /* tt_seq_model_batch_bytes */
+    size_t          gsum_bytes;
+} bench_seq_t;
+
+static void s_seq_forward(void *ctx) {
+    bench_seq_t *b = ctx;
+    tt_seq_model_forward(&b->m, b->in);
+}
+
+static void s_seq_train(void *ctx) {
+    bench_seq_t *b = ctx;
+    s_sink = (int32_t)tt_seq_model_train_step(&b->m, b->in, b->in);
+}
+
+static void s_seq_train_batch(void *ctx) {
+    bench_seq_t *b = ctx;
+    s_sink = (int32_t)tt_seq_model_train_batch(&b->m, b->batch, b->batch, BENCH_BATCH, b->gsum, b->gsum_bytes);
+}
+
+typedef struct {
+    tt_motor_ae_model_t *m;
+    int8_t               in[MOTOR_IN];
+} bench_motor_t;
+
+static void s_motor_forward(void *ctx) {
+    bench_motor_t *b = ctx;
+    s_sink = (int32_t)tt_motor_ae_forward(b->m, b->in);
+}
+
+static void s_motor_fwd_bwd(void *ctx) {
+    bench_motor_t *b = ctx;
+    s_sink = (int32_t)tt_motor_ae_forward(b->m, b->in);
+    tt_motor_ae_backward(b->m);
+}
+
+/* BENCH_GROUP motors of one shape, one input each */
+#define BENCH_GROUP (256)
+
+typedef struct {
+    tt_motor_ae_model_t *m;         /* [BENCH_GROUP] */
+    tt_seq_model_t      *seq[BENCH_GROUP];
+    const int8_t        *in[BENCH_GROUP];
+    uint32_t             sse[BENCH_GROUP];
+    tt_seq_group_t       g;
+} bench_motor_group_t;
+
+static void s_motor_forward_each(void *ctx) {
+    bench_motor_group_t *b = ctx;
+    for (size_t k = 0; k < BENCH_GROUP; ++k) b->sse[k] = tt_motor_ae_forward(&b->m[k], b->in[k]);
+    s_sink = (int32_t)b->sse[0];
+}
+
+static void s_motor_forward_group(void *ctx) {
+    bench_motor_group_t *b = ctx;
+    tt_motor_ae_forward_group(&b->g, b->in, b->sse);
+    s_sink = (int32_t)b->sse[0];
+}
+
+/*----------------------------------------------------------------------*
+ * suites
+ *----------------------------------------------------------------------*/
+static void s_emit(FILE *f, tt_bench_result_t r, const char *backend, size_t in, size_t out) {
+    r.backend = backend;
+    r.isa     = tt_cpu_isa_name(matrix_isa());
+    r.in      = in;
+    r.out     = out;
+    tt_bench_csv_row(f, &r);
+}
+
+/* matrix_mul on every kernel level the cpu runs */
+static void s_bench_matrix(FILE *f) {
+    for (size_t k = 0; k < N_SIZES; ++k) {
+        size_t n = s_sizes[k];
+        bench_layer_t b;
+        if (s_layer_init(&b, n, n, 1) != 0) continue;
+        double ops   = 2.0 * n * n;
+        double bytes = (double)n * n + n + 4.0 * n;
+        for (int isa = TT_ISA_SCALAR; isa <= TT_ISA_NEON_DOT; ++isa) {
+            if (!tt_cpu_supports((tt_isa_t)isa)) continue;
+            if (matrix_set_isa((tt_isa_t)isa) != (tt_isa_t)isa) continue;
+            s_emit(f, tt_bench_run("matrix_mul", s_matrix_mul, &b, ops, bytes), "-", n, n);
+            /* int16 lanes where the weight bound allows them (|w| <= 63 here) */
+            matrix_acc_plan(&b.acc16, n, eff_bitwidth32(tt_max_abs_i8(b.W.data, b.W.len)));
+            if (b.acc16.spill && (isa == TT_ISA_SSE41 || isa == TT_ISA_AVX2 || isa == TT_ISA_NEON))
+                s_emit(f, tt_bench_run("matrix_mul_acc16", s_matrix_mul_acc16, &b, ops, bytes), "-", n, n);
+        }
+        matrix_set_isa(tt_cpu_isa());
+        /* int4 weights: half the weight bytes, kernel picked from tt_cpu_isa() */
+        if (s_layer_pack_i4(&b, n, n) == 0)
+            s_emit(f, tt_bench_run("matrix_mul_i4", s_matrix_mul_i4, &b, ops,
+                                   (double)n * n / 2 + n + 4.0 * n), "-", n, n);
+        s_layer_free(&b);
+    }
+}
+
+static void s_bench_dense(FILE *f) {
+    for (size_t k = 0; k < N_SIZES; ++k) {
+        size_t n = s_sizes[k];
+        for (size_t be = 0; be < N_BACKENDS; ++be) {
+            bench_layer_t b;
+            if (s_layer_init(&b, n, n, 2) != 0) continue;
+            b.ops = s_backends[be].ops;
+            if ((b.ops->w_bits == 4 && s_layer_pack_i4(&b, n, n) != 0) ||
+                (b.ops->w_tiled && s_layer_tiled(&b, n, n) != 0)) {
+                s_layer_free(&b);
+                continue;
+            }
+            /* forward: GEMV + epilogue over OUT accumulators */
+            s_emit(f, tt_bench_run("dense_forward", s_dense_forward, &b,
+                                   2.0 * n * n, (double)n * n + 2.0 * n),
+                   s_backends[be].name, n, n);
+            /* train: outer product, SGD update and Wt·e (2 ops per MAC) */
+            s_emit(f, tt_bench_run("dense_train", s_dense_train, &b,
+                                   4.0 * n * n, 4.0 * n * n + 2.0 * n),
+                   s_backends[be].name, n, n);
+            s_layer_free(&b);
+        }
+    }
+}
+
+/* block-sparse forward at rising sparsity, against the dense tt row */
+static void s_bench_sparse(FILE *f) {
+    static const struct { const char *name; uint8_t pct; } levels[] = {
+        { "tt_sparse0", 0 }, { "tt_sparse50", 50 }, { "tt_sparse75", 75 },
+    };
+    for (size_t k = 0; k < N_SIZES; ++k) {
+        size_t n = s_sizes[k];
+        for (size_t v = 0; v < sizeof(levels) / sizeof(levels[0]); ++v) {
+            bench_layer_t b;
+            if (s_layer_init(&b, n, n, 2) != 0) continue;
+            b.ops = &tt_sparse_backend;
+            if (s_layer_sparse(&b, n, n, levels[v].pct) != 0) {
+                s_layer_free(&b);
+                continue;
+            }
+            /* ops and bytes of the dense layer, so the rates compare */
+            s_emit(f, tt_bench_run("dense_forward", s_dense_forward, &b,
+                                   2.0 * n * n, (double)n * n + 2.0 * n),
+                   levels[v].name, n, n);
+            s_layer_free(&b);
+        }
+    }
+}
+
+static void s_bench_scalar(FILE *f) {
+    for (size_t k = 0; k < N_SIZES; ++k) {
+        size_t n = s_sizes[k];
+        bench_layer_t b;
+        if (s_layer_init(&b, n, n, 3) != 0) continue;
+        s_emit(f, tt_bench_run("shift_and_round32", s_shift_round, &b,
+                               (double)b.n, 4.0 * b.n), "-", n, n);
+        s_emit(f, tt_bench_run("eff_bitwidth_array", s_eff_bitwidth, &b,
+                               (double)b.n, 4.0 * b.n), "-", n, n);
+        s_layer_free(&b);
+    }
+}
+
+/* IN -> 3/4 IN -> 3/4 IN -> IN auto-encoder on the sequential runtime */
+static void s_bench_seq(FILE *f) {
+    for (size_t k = 0; k < N_SIZES; ++k) {
+        uint16_t n = (uint16_t)s_sizes[k];
+        uint16_t h = (uint16_t)(n * 3 / 4);
+        for (size_t be = 0; be < N_BACKENDS; ++be) {
+            const tt_layer_desc_t descs[3] = {
+                { .type = TT_LAYER_DENSE, .in = n, .out = h, .act = TT_ACT_RELU, .ops = s_backends[be].ops },
+                { .type = TT_LAYER_DENSE, .in = h, .out = h, .act = TT_ACT_RELU, .ops = s_backends[be].ops },
+                { .type = TT_LAYER_DENSE, .in = h, .out = n, .act = TT_ACT_RELU, .ops = s_backends[be].ops },
+            };
+            bench_seq_t b;
+            size_t arena = tt_seq_model_arena_size(descs, 3);
+            b.arena = malloc(arena);
+            b.in    = malloc(n);
+            if (!b.arena || !b.in ||
+                tt_seq_model_init(&b.m, b.layers, descs, 3, b.arena, arena) != 0) {
+                free(b.arena);
+                free(b.in);
+                continue;
+            }
+            tt_seq_model_randomize(&b.m, 4, -63, 63);
+            for (size_t i = 0; i < n; ++i) b.in[i] = (int8_t)(40 + (i * 3) % 50);
+
+            double macs = (double)n * h * 2 + (double)h * h;
+            s_emit(f, tt_bench_run("seq_ae_forward", s_seq_forward, &b, 2.0 * macs, macs),
+                   s_backends[be].name, n, n);
+            s_emit(f, tt_bench_run("seq_ae_train_step", s_seq_train, &b, 6.0 * macs, 5.0 * macs),
+                   s_backends[be].name, n, n);
+
+            /* same samples, one update per BENCH_BATCH */
+            b.gsum_bytes = tt_seq_model_batch_bytes(&b.m);
+            b.gsum  = b.gsum_bytes ? malloc(b.gsum_bytes) : NULL;
+            b.batch = malloc((size_t)n * BENCH_BATCH);
+            if (b.gsum && b.batch) {
+                for (size_t s = 0; s < BENCH_BATCH; ++s) memcpy(b.batch + s * n, b.in, n);
+                s_emit(f, tt_bench_run("seq_ae_train_batch16", s_seq_train_batch, &b,
+                                       6.0 * macs * BENCH_BATCH, 5.0 * macs * BENCH_BATCH),
+                       s_backends[be].name, n, n);
+            }
+            free(b.gsum);
+            free(b.batch);
+            free(b.arena);
+            free(b.in);
+        }
+    }
+}
+
+static void s_bench_motor(FILE *f) {
+    for (size_t be = 0; be < N_BACKENDS; ++be) {
+        bench_motor_t b;
+        b.m = malloc(sizeof(*b.m));
+        if (!b.m) continue;
+        if (motor_ae_model_init(b.m, s_backends[be].ops, 5) != 0) { free(b.m); continue; }
+        for (size_t i = 0; i < MOTOR_IN; ++i) b.in[i] = (int8_t)(40 + (i * 3) % 50);
+
+        double macs = (double)MOTOR_IN * MOTOR_H1 + (double)MOTOR_H1 * MOTOR_H2 +
+                      (double)MOTOR_H2 * MOTOR_OUT;
+        s_emit(f, tt_bench_run("motor_ae_forward", s_motor_forward, &b, 2.0 * macs, macs),
+               s_backends[be].name, MOTOR_IN, MOTOR_OUT);
+        s_emit(f, tt_bench_run("motor_ae_fwd_bwd", s_motor_fwd_bwd, &b, 6.0 * macs, 5.0 * macs),
+               s_backends[be].name, MOTOR_IN, MOTOR_OUT);
+        free(b.m);
+    }
+}
+
+/* BENCH_GROUP motors one by one vs one grouped pass, on the backends with a split epilogue */
+static void s_bench_motor_group(FILE *f) {
+    static int8_t in[BENCH_GROUP][MOTOR_IN];
+    double macs = BENCH_GROUP * ((double)MOTOR_IN * MOTOR_H1 + (double)MOTOR_H1 * MOTOR_H2 +
+                                 (double)MOTOR_H2 * MOTOR_OUT);
+    for (size_t be = 0; be < N_BACKENDS; ++be) {
+        if (!s_backends[be].ops->dense_epilogue) continue;
+        bench_motor_group_t *b = malloc(sizeof(*b));
+        if (!b) continue;
+        b->m = malloc(BENCH_GROUP * sizeof(*b->m));
+        if (!b->m) { free(b); continue; }
+        size_t k = 0;
+        for (; k < BENCH_GROUP; ++k) {
+            if (motor_ae_model_init(&b->m[k], s_backends[be].ops, (uint32_t)(5 + k)) != 0) break;
+            for (size_t i = 0; i < MOTOR_IN; ++i) in[k][i] = (int8_t)(40 + (i * 3 + k) % 50);
+            b->seq[k] = &b->m[k].seq;
+            b->in[k]  = in[k];
+        }
+        if (k == BENCH_GROUP && tt_seq_group_init(&b->g, b->seq, BENCH_GROUP) == 0) {
+            s_emit(f, tt_bench_run("motor_ae_forward_x256", s_motor_forward_each, b, 2.0 * macs, macs),
+                   s_backends[be].name, MOTOR_IN, MOTOR_OUT);
+            s_emit(f, tt_bench_run("motor_ae_forward_group256", s_motor_forward_group, b, 2.0 * macs, macs),
+                   s_backends[be].name, MOTOR_IN, MOTOR_OUT);
+            tt_seq_group_free(&b->g);
+        }
+        free(b->m);
+        free(b);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "results/csv/bench_" BENCH_BUILD ".csv";
+    FILE *f = tt_bench_csv_open(path);
+    if (!f) fprintf(stderr, "tt_bench: cannot write %s, stdout only\n", path);
+
+    matrix_init();
+    s_bench_matrix(f);
+    s_bench_dense(f);
+    s_bench_sparse(f);
+    s_bench_scalar(f);
+    s_bench_seq(f);
+    s_bench_motor(f);
+    s_bench_motor_group(f);
+
+    tt_bench_csv_close(f);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file tt_bench.c
+ * @brief self-contained micro-benchmark timing loop and CSV report
+ * @license MIT
+ */
+#define _POSIX_C_SOURCE 199309L
+#include "tt_bench.h"
+#include <time.h>
+
+static uint64_t s_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t s_time_iters(tt_bench_fn_t fn, void *ctx, uint64_t iters) {
+    uint64_t t0 = s_now_ns();
+    for (uint64_t i = 0; i < iters; ++i) fn(ctx);
+    return s_now_ns() - t0;
+}
+
+/**
+ * @brief calibrates and times a benchmark body
+ * @param name kernel name
+ * @param fn body
+ * @param ctx body context
+ * @param ops integer ops of one call
+ * @param bytes bytes touched by one call
+ * @return tt_bench_result_t timings, backend / isa / sizes left to the caller
+ */
+tt_bench_result_t tt_bench_run(const char *name, tt_bench_fn_t fn, void *ctx,
+                               double ops, double bytes) {
+    tt_bench_result_t r = { name, "-", "-", 0, 0, 0, 0.0, 0.0, 0.0 };
+    if (!fn) return r;
+
+    /* warm up and calibrate: double until one repetition is long enough */
+    uint64_t iters = 1;
+    uint64_t ns = s_time_iters(fn, ctx, iters);
+    while (ns < TT_BENCH_MIN_NS && iters < (1ull << 40)) {
+        iters *= 2;
+        ns = s_time_iters(fn, ctx, iters);
+    }
+
+    uint64_t best = ns;
+    for (int rep = 1; rep < TT_BENCH_REPS; ++rep) {
+        ns = s_time_iters(fn, ctx, iters);
+        if (ns < best) best = ns;
+    }
+
+    r.iters       = iters;
+    r.ns_per_op   = (double)best / (double)iters;
+    r.gops        = r.ns_per_op > 0.0 ? ops / r.ns_per_op : 0.0;
+    r.bytes_per_s = r.ns_per_op > 0.0 ? bytes * 1e9 / r.ns_per_op : 0.0;
+    return r;
+}
+
+FILE *tt_bench_csv_open(const char *path) {
+    FILE *f = path ? fopen(path, "w") : NULL;
+    if (f) fprintf(f, "bench,backend,isa,in,out,iters,ns_per_op,gops,bytes_per_s\n");
+    printf("%-22s %-7s %-12s %6s %6s %14s %9s %14s\n",
+           "bench", "backend", "isa", "in", "out", "ns/op", "GOPS", "bytes/s");
+    return f;
+}
+
+void tt_bench_csv_row(FILE *f, const tt_bench_result_t *r) {
+    if (!r) return;
+    if (f) {
+        fprintf(f, "%s,%s,%s,%zu,%zu,%llu,%.3f,%.4f,%.0f\n",
+                r->name, r->backend, r->isa, r->in, r->out,
+                (unsigned long long)r->iters, r->ns_per_op, r->gops, r->bytes_per_s);
+        fflush(f);
+    }
+    printf("%-22s %-7s %-12s %6zu %6zu %14.2f %9.3f %14.4g\n",
+           r->name, r->backend, r->isa, r->in, r->out, r->ns_per_op, r->gops, r->bytes_per_s);
+}
+
+void tt_bench_csv_close(FILE *f) {
+    if (f) fclose(f);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file tt_bench.h
+ * @brief self-contained micro-benchmark timing loop and CSV report
+ * @details every benchmark is a body run over and over on a monotonic
+ * clock: the iteration count is calibrated to TT_BENCH_MIN_NS per
+ * repetition and the best of TT_BENCH_REPS repetitions is reported as
+ * ns/op, GOPS and bytes/s.
+ * @license MIT
+ */
+#ifndef TT_BENCH_H
+#define TT_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef TT_BENCH_MIN_NS
+#define TT_BENCH_MIN_NS     (50 * 1000 * 1000)    /* 50 ms per repetition */
+#endif
+#ifndef TT_BENCH_REPS
+#define TT_BENCH_REPS       (5)
+#endif
+
+/* benchmark body, one call = one op */
+typedef void (*tt_bench_fn_t)(void *ctx);
+
+typedef struct {
+    const char *name;       /* kernel */
+    const char *backend;    /* "tt", "nested" or "-" */
+    const char *isa;        /* kernel level in use */
+    size_t      in;         /* problem size */
+    size_t      out;
+    uint64_t    iters;      /* iterations per repetition */
+    double      ns_per_op;  /* best repetition */
+    double      gops;       /* integer ops per ns */
+    double      bytes_per_s;
+} tt_bench_result_t;
+
+/*
+ * times fn(ctx); ops and bytes are the integer operations and the bytes
+ * touched by one call, used for the GOPS and bytes/s columns
+ */
+tt_bench_result_t tt_bench_run(const char *name, tt_bench_fn_t fn, void *ctx,
+                               double ops, double bytes);
+
+/* CSV report: header once, one row per result (also echoed to stdout) */
+FILE *tt_bench_csv_open(const char *path);
+void  tt_bench_csv_row(FILE *f, const tt_bench_result_t *r);
+void  tt_bench_csv_close(FILE *f);
+
+#endif // TT_BENCH_H
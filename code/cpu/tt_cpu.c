@@ -0,0 +1,87 @@
+/**
+ * @file tt_cpu.c
+ * @brief runtime cpu feature probing for kernel dispatch
+ * @license MIT
+ */
+#include "tt_cpu.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#endif
+
+/* cached probe result, -1 = not probed yet; shared by the pool threads */
+static int s_isa = -1;
+
+/**
+ * @brief probes the cpu for the strongest supported instruction set
+ * @return instruction set level
+ */
+static tt_isa_t s_probe(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vnni"))
+        return TT_ISA_AVX512_VNNI;
+    if (__builtin_cpu_supports("avx2"))
+        return TT_ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return TT_ISA_SSE41;
+    return TT_ISA_SCALAR;
+#elif defined(__aarch64__)
+#if defined(__linux__) && defined(__ARM_FEATURE_DOTPROD)
+    if (getauxval(AT_HWCAP) & HWCAP_ASIMDDP)
+        return TT_ISA_NEON_DOT;
+#endif
+    return TT_ISA_NEON;
+#else
+    return TT_ISA_SCALAR;
+#endif
+}
+
+/**
+ * @brief best instruction set supported by the running cpu
+ * racing first callers probe alike and the first result is kept
+ * @return instruction set level, probed on first call only
+ */
+tt_isa_t tt_cpu_isa(void) {
+    int isa = __atomic_load_n(&s_isa, __ATOMIC_ACQUIRE);
+    if (isa < 0) {
+        int none = -1;
+        isa = (int)s_probe();
+        if (!__atomic_compare_exchange_n(&s_isa, &none, isa, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            isa = none;
+    }
+    return (tt_isa_t)isa;
+}
+
+/**
+ * @brief checks whether kernels of a given level can run here
+ * @param isa instruction set level
+ * @return 1 if supported, 0 otherwise
+ */
+int tt_cpu_supports(tt_isa_t isa) {
+    tt_isa_t best = tt_cpu_isa();
+    if (isa == TT_ISA_SCALAR) return 1;
+    /* levels only nest within the same architecture */
+    if (best >= TT_ISA_NEON) return isa >= TT_ISA_NEON && isa <= best;
+    return isa <= best;
+}
+
+/**
+ * @brief printable name of an instruction set level
+ * @param isa instruction set level
+ * @return static string
+ */
+const char *tt_cpu_isa_name(tt_isa_t isa) {
+    switch (isa) {
+    case TT_ISA_SCALAR:      return "scalar";
+    case TT_ISA_SSE41:       return "sse4.1";
+    case TT_ISA_AVX2:        return "avx2";
+    case TT_ISA_AVX512_VNNI: return "avx512-vnni";
+    case TT_ISA_NEON:        return "neon";
+    case TT_ISA_NEON_DOT:    return "neon-sdot";
+    }
+    return "unknown";
+}
@@ -0,0 +1,30 @@
+/**
+ * @file tt_cpu.h
+ * @brief runtime cpu feature probing for kernel dispatch
+ * @details the probe runs once and is cached, kernels pick their
+ * implementation from the returned instruction set level
+ * @license MIT
+ */
+#ifndef TT_CPU_H
+#define TT_CPU_H
+
+/* instruction set levels, ordered from weakest to strongest per arch */
+typedef enum {
+    TT_ISA_SCALAR = 0,      /* portable C reference */
+    TT_ISA_SSE41,           /* x86: pmovsx + pmaddwd, 16 lanes */
+    TT_ISA_AVX2,            /* x86: pmovsx + pmaddwd, 32 lanes */
+    TT_ISA_AVX512_VNNI,     /* x86: vpdpbusd, 64 lanes */
+    TT_ISA_NEON,            /* arm64: smull + sadalp */
+    TT_ISA_NEON_DOT,        /* arm64: sdot */
+} tt_isa_t;
+
+/* best instruction set supported by the running cpu (probed once) */
+tt_isa_t tt_cpu_isa(void);
+
+/* true if the running cpu can execute kernels of the given level */
+int tt_cpu_supports(tt_isa_t isa);
+
+/* printable name of an instruction set level */
+const char *tt_cpu_isa_name(tt_isa_t isa);
+
+#endif // TT_CPU_H
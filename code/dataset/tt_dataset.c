@@ -0,0 +1,325 @@
+/**
+ * @file tt_dataset.c
+ * @brief streaming reader of int8 sample files with a prefetch thread
+ * @license MIT
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "tt_dataset.h"
+#include "prng.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* the on-disk header is fixed at 64 bytes */
+typedef char tt_ds_header_size_check[sizeof(tt_ds_header_t) == 64 ? 1 : -1];
+
+#define S_ALIGN         (64)
+#define S_ALIGN_UP(n)   (((size_t)(n) + S_ALIGN - 1) & ~(size_t)(S_ALIGN - 1))
+
+static void s_put_scale(int8_t g[3], int8_t l[3], const scale_t *s) {
+    memset(g, 0, 3);
+    memset(l, 0, 3);
+    if (!s) return;
+#ifdef TENSOR_USE_NESTED
+    g[0] = s->g.S; g[1] = s->g.U; g[2] = s->g.D;
+    l[0] = s->l.S; l[1] = s->l.U; l[2] = s->l.D;
+#else
+    l[0] = s->S;   l[1] = s->U;   l[2] = s->D;
+#endif
+}
+
+static void s_get_scale(scale_t *s, const int8_t g[3], const int8_t l[3]) {
+#ifdef TENSOR_USE_NESTED
+    s->g.S = g[0]; s->g.U = g[1]; s->g.D = g[2];
+    s->l.S = l[0]; s->l.U = l[1]; s->l.D = l[2];
+#else
+    s->S = (int8_t)(g[0] + l[0]);
+    s->U = (int8_t)(g[1] + l[1]);
+    s->D = (int8_t)(g[2] + l[2]);
+#endif
+}
+
+/* pread until len bytes are in, 0 or -1 */
+static int s_read_full(int fd, void *dst, size_t len, off_t off) {
+    uint8_t *p = (uint8_t *)dst;
+    while (len) {
+        ssize_t r = pread(fd, p, len, off);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return -1;
+        p   += r;
+        off += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Prefetch thread: one pread per window, then gather the (permuted)
+ * records of every batch into the free slot.
+ *----------------------------------------------------------------------*/
+
+/* waits for slot i to be free, 0 or -1 if the reader is closing */
+static int s_wait_free(tt_dataset_t *ds, unsigned i) {
+    pthread_mutex_lock(&ds->lock);
+    while (ds->full[i] && !ds->stop) pthread_cond_wait(&ds->freed, &ds->lock);
+    int rc = ds->stop ? -1 : 0;
+    pthread_mutex_unlock(&ds->lock);
+    return rc;
+}
+
+static void s_publish(tt_dataset_t *ds, unsigned i) {
+    pthread_mutex_lock(&ds->lock);
+    ds->full[i] = 1;
+    pthread_cond_signal(&ds->filled);
+    pthread_mutex_unlock(&ds->lock);
+}
+
+static void s_fill(tt_dataset_t *ds, tt_ds_batch_t *b, size_t first, size_t n, uint32_t epoch) {
+    const size_t in_len = ds->hdr.in_len;
+    const size_t tg_len = ds->hdr.target_len;
+    for (size_t i = 0; i < n; ++i) {
+        const int8_t *rec = ds->chunk + (size_t)ds->perm[first + i] * ds->rec_bytes;
+        memcpy(b->in.data + i * in_len, rec, in_len);
+        if (tg_len) memcpy(b->target.data + i * tg_len, rec + in_len, tg_len);
+    }
+    b->in.len     = n * in_len;
+    b->target.len = n * (tg_len ? tg_len : in_len);
+    b->n          = n;
+    b->epoch      = epoch;
+}
+
+static void *s_prefetch(void *arg) {
+    tt_dataset_t *ds = (tt_dataset_t *)arg;
+    const uint64_t n_samples = ds->hdr.n_samples;
+    unsigned put = 0;
+
+    for (uint32_t epoch = 0;; ++epoch) {
+        for (uint64_t base = 0; base < n_samples; base += ds->window) {
+            size_t cnt = (size_t)(n_samples - base < ds->window ? n_samples - base : ds->window);
+            off_t  off = (off_t)(ds->hdr.data_off + base * ds->rec_bytes);
+            if (s_read_full(ds->fd, ds->chunk, cnt * ds->rec_bytes, off) != 0) {
+                pthread_mutex_lock(&ds->lock);
+                ds->err = 1;
+                pthread_cond_signal(&ds->filled);
+                pthread_mutex_unlock(&ds->lock);
+                return NULL;
+            }
+            for (size_t i = 0; i < cnt; ++i) ds->perm[i] = (uint32_t)i;
+            if (ds->shuffle) {
+                for (size_t i = cnt - 1; i > 0; --i) {
+                    size_t j = prng_next(&ds->rng) % (i + 1);
+                    uint32_t t = ds->perm[i];
+                    ds->perm[i] = ds->perm[j];
+                    ds->perm[j] = t;
+                }
+            }
+            for (size_t j = 0; j < cnt; j += ds->batch) {
+                size_t k = cnt - j < ds->batch ? cnt - j : ds->batch;
+                if (s_wait_free(ds, put) != 0) return NULL;
+                s_fill(ds, &ds->slot[put], j, k, epoch);
+                s_publish(ds, put);
+                put ^= 1u;
+            }
+        }
+        /* end of epoch marker */
+        if (s_wait_free(ds, put) != 0) return NULL;
+        ds->slot[put].n     = 0;
+        ds->slot[put].epoch = epoch;
+        ds->slot[put].in.len = ds->slot[put].target.len = 0;
+        s_publish(ds, put);
+        put ^= 1u;
+    }
+}
+
+/*----------------------------------------------------------------------*
+ * Reader
+ *----------------------------------------------------------------------*/
+static int s_valid(const tt_ds_header_t *h, uint64_t file_bytes) {
+    if (memcmp(h->magic, TT_DS_MAGIC, 4) != 0 || h->version != TT_DS_VERSION) return 0;
+    if (!h->in_len || h->data_off < sizeof(tt_ds_header_t) || h->data_off > file_bytes) return 0;
+    uint64_t rec = (uint64_t)h->in_len + h->target_len;
+    return h->n_samples <= (file_bytes - h->data_off) / rec;
+}
+
+/**
+ * @brief opens a sample file and starts the prefetch thread
+ * @param ds pointer of the reader
+ * @param path sample file written by tt_ds_writer_*
+ * @param batch samples per batch (> 0)
+ * @param window samples per read and shuffle window, rounded up to a multiple of batch
+ * @param shuffle permute the records inside every window
+ * @param seed PRNG seed of the permutation
+ * @return int 0 on success, -1 on failure
+ */
+int tt_dataset_open(tt_dataset_t *ds, const char *path, size_t batch,
+                    size_t window, int shuffle, uint32_t seed) {
+    if (!ds || !path || !batch) return -1;
+    memset(ds, 0, sizeof(*ds));
+    ds->fd = open(path, O_RDONLY);
+    if (ds->fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(ds->fd, &st) != 0 ||
+        s_read_full(ds->fd, &ds->hdr, sizeof(ds->hdr), 0) != 0 ||
+        !s_valid(&ds->hdr, (uint64_t)st.st_size) || !ds->hdr.n_samples) {
+        close(ds->fd);
+        return -1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(ds->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    const size_t in_len = ds->hdr.in_len;
+    const size_t tg_len = ds->hdr.target_len;
+    if (!window) window = batch;
+    window = (window + batch - 1) / batch * batch;
+    if (window > ds->hdr.n_samples) window = (size_t)ds->hdr.n_samples;
+    ds->rec_bytes = in_len + tg_len;
+    ds->batch     = batch;
+    ds->window    = window;
+    ds->shuffle   = shuffle;
+    prng_init(&ds->rng, seed);
+
+    /* chunk, perm and two slots of in (+ target) rows */
+    size_t chunk_b = S_ALIGN_UP(window * ds->rec_bytes);
+    size_t perm_b  = S_ALIGN_UP(window * sizeof(uint32_t));
+    size_t in_b    = S_ALIGN_UP(batch * in_len);
+    size_t tg_b    = S_ALIGN_UP(batch * tg_len);
+    ds->mem = malloc(chunk_b + perm_b + 2 * (in_b + tg_b) + S_ALIGN);
+    if (!ds->mem) {
+        close(ds->fd);
+        return -1;
+    }
+    uint8_t *p = (uint8_t *)S_ALIGN_UP((uintptr_t)ds->mem);
+    ds->chunk = (int8_t *)p;   p += chunk_b;
+    ds->perm  = (uint32_t *)p; p += perm_b;
+    for (unsigned i = 0; i < 2; ++i) {
+        tt_ds_batch_t *b = &ds->slot[i];
+        tt_tensor_init(&b->in, (int8_t *)p, batch * in_len);
+        p += in_b;
+        s_get_scale(&b->in.s, ds->hdr.in_g, ds->hdr.in_l);
+        if (tg_len) {
+            tt_tensor_init(&b->target, (int8_t *)p, batch * tg_len);
+            p += tg_b;
+            s_get_scale(&b->target.s, ds->hdr.tg_g, ds->hdr.tg_l);
+        } else {
+            b->target = b->in;
+        }
+    }
+
+    pthread_mutex_init(&ds->lock, NULL);
+    pthread_cond_init(&ds->filled, NULL);
+    pthread_cond_init(&ds->freed, NULL);
+    if (pthread_create(&ds->thread, NULL, s_prefetch, ds) != 0) {
+        pthread_cond_destroy(&ds->freed);
+        pthread_cond_destroy(&ds->filled);
+        pthread_mutex_destroy(&ds->lock);
+        free(ds->mem);
+        close(ds->fd);
+        memset(ds, 0, sizeof(*ds));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief stops the prefetch thread and releases the reader
+ * @param ds pointer of the reader
+ */
+void tt_dataset_close(tt_dataset_t *ds) {
+    if (!ds || !ds->mem) return;
+    pthread_mutex_lock(&ds->lock);
+    ds->stop = 1;
+    pthread_cond_broadcast(&ds->freed);
+    pthread_mutex_unlock(&ds->lock);
+    pthread_join(ds->thread, NULL);
+
+    pthread_cond_destroy(&ds->freed);
+    pthread_cond_destroy(&ds->filled);
+    pthread_mutex_destroy(&ds->lock);
+    free(ds->mem);
+    close(ds->fd);
+    memset(ds, 0, sizeof(*ds));
+}
+
+/**
+ * @brief hands out the next prefetched batch and frees the previous one
+ * @param ds pointer of the reader
+ * @param out batch views, valid until the next call
+ * @return int samples in the batch, 0 at the end of an epoch, -1 on error
+ */
+int tt_dataset_next(tt_dataset_t *ds, tt_ds_batch_t *out) {
+    if (!ds || !ds->mem || !out) return -1;
+    pthread_mutex_lock(&ds->lock);
+    if (ds->held) {
+        ds->full[ds->take] = 0;
+        ds->take ^= 1u;
+        ds->held = 0;
+        pthread_cond_signal(&ds->freed);
+    }
+    while (!ds->full[ds->take]) {
+        if (ds->err) {
+            pthread_mutex_unlock(&ds->lock);
+            return -1;
+        }
+        pthread_cond_wait(&ds->filled, &ds->lock);
+    }
+    *out = ds->slot[ds->take];
+    ds->held = 1;
+    pthread_mutex_unlock(&ds->lock);
+    return (int)out->n;
+}
+
+/*----------------------------------------------------------------------*
+ * Writer
+ *----------------------------------------------------------------------*/
+int tt_ds_writer_open(tt_ds_writer_t *w, const char *path, uint32_t in_len, uint32_t target_len,
+                      const scale_t *s_in, const scale_t *s_target) {
+    if (!w || !path || !in_len) return -1;
+    memset(w, 0, sizeof(*w));
+    memcpy(w->hdr.magic, TT_DS_MAGIC, 4);
+    w->hdr.version    = TT_DS_VERSION;
+#ifdef TENSOR_USE_NESTED
+    w->hdr.flags      = TT_DS_NESTED;
+#endif
+    w->hdr.in_len     = in_len;
+    w->hdr.target_len = target_len;
+    w->hdr.data_off   = sizeof(tt_ds_header_t);
+    s_put_scale(w->hdr.in_g, w->hdr.in_l, s_in);
+    s_put_scale(w->hdr.tg_g, w->hdr.tg_l, target_len ? s_target : NULL);
+
+    w->fp = fopen(path, "wb");
+    if (!w->fp) return -1;
+    /* written again with the final count on close */
+    if (fwrite(&w->hdr, sizeof(w->hdr), 1, w->fp) != 1) {
+        fclose(w->fp);
+        w->fp = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int tt_ds_writer_append(tt_ds_writer_t *w, const int8_t *in, const int8_t *target, size_t n) {
+    if (!w || !w->fp || !in || (w->hdr.target_len && !target)) return -1;
+    const size_t in_len = w->hdr.in_len;
+    const size_t tg_len = w->hdr.target_len;
+    for (size_t i = 0; i < n; ++i) {
+        if (fwrite(in + i * in_len, 1, in_len, w->fp) != in_len) return -1;
+        if (tg_len && fwrite(target + i * tg_len, 1, tg_len, w->fp) != tg_len) return -1;
+    }
+    w->hdr.n_samples += n;
+    return 0;
+}
+
+int tt_ds_writer_close(tt_ds_writer_t *w) {
+    if (!w || !w->fp) return -1;
+    int rc = 0;
+    if (fseek(w->fp, 0, SEEK_SET) != 0 ||
+        fwrite(&w->hdr, sizeof(w->hdr), 1, w->fp) != 1) rc = -1;
+    if (fclose(w->fp) != 0) rc = -1;
+    w->fp = NULL;
+    return rc;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file tt_dataset.h
+ * @brief streaming reader of int8 sample files with a prefetch thread
+ * @details little-endian layout:
+ *
+ *   offset 0        tt_ds_header_t (64 B)
+ *   data_off        n_samples records of in_len int8 inputs followed by
+ *                   target_len int8 targets (no padding between records)
+ *
+ * All inputs share one scale header and all targets another one, stored
+ * as global and local S/U/D like the model file (see tt_model_file.h), so
+ * a flat build loads S = g + l. target_len 0 means the target is the
+ * input (autoencoders).
+ *
+ * The reader walks the file in windows of whole batches: a background
+ * thread reads one window with a single pread, optionally permutes its
+ * records and gathers them into one of two batch buffers while the
+ * caller trains on the other one. Every epoch ends with an empty batch,
+ * the next call starts the next epoch.
+ * @license MIT
+ */
+#ifndef TT_DATASET_H
+#define TT_DATASET_H
+
+#include "tt_types.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define TT_DS_MAGIC     "TTDS"
+#define TT_DS_VERSION   (1)
+#define TT_DS_NESTED    (1u << 0)   /* flags: written by a nested build */
+
+typedef struct {
+    char     magic[4];     /* TT_DS_MAGIC */
+    uint16_t version;      /* TT_DS_VERSION */
+    uint16_t flags;        /* TT_DS_* */
+    uint32_t in_len;       /* int8 inputs per sample */
+    uint32_t target_len;   /* int8 targets per sample, 0 = the input */
+    uint64_t n_samples;
+    uint32_t data_off;     /* offset of the first record */
+    int8_t   in_g[3];      /* input header, global S, U, D (0 from flat builds) */
+    int8_t   in_l[3];      /* input header, local (or flat) S, U, D */
+    int8_t   tg_g[3];      /* target header, global */
+    int8_t   tg_l[3];      /* target header, local (or flat) */
+    uint8_t  reserved[24];
+} tt_ds_header_t;
+
+/* one batch: n rows of in_len inputs and target_len (or in_len) targets */
+typedef struct {
+    tensor_t in;           /* [n x in_len] */
+    tensor_t target;       /* [n x target_len], shares in.data if target_len is 0 */
+    size_t   n;            /* 0 at the end of an epoch */
+    uint32_t epoch;
+} tt_ds_batch_t;
+
+typedef struct {
+    int             fd;
+    tt_ds_header_t  hdr;
+    size_t          rec_bytes;  /* in_len + target_len */
+    size_t          batch;      /* samples per batch */
+    size_t          window;     /* samples per read, a multiple of batch */
+    int             shuffle;    /* permute the records of every window */
+    uint32_t        rng;
+
+    int8_t         *chunk;      /* window records, filled by the thread */
+    uint32_t       *perm;       /* record order of the window */
+    tt_ds_batch_t   slot[2];    /* double buffer */
+    uint8_t         full[2];
+    unsigned        take;       /* slot the caller reads next */
+    int             held;       /* the caller still uses slot take */
+    int             stop;
+    int             err;        /* the thread hit a read error */
+    uint8_t        *mem;        /* single allocation behind the buffers */
+
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  filled;
+    pthread_cond_t  freed;
+} tt_dataset_t;
+
+/*
+ * open path and start the prefetch thread. window is rounded up to a
+ * multiple of batch (0 = one batch); shuffle permutes inside each window
+ * with the PRNG seeded by seed. 0 or -1 (nothing to close on failure)
+ */
+int  tt_dataset_open(tt_dataset_t *ds, const char *path, size_t batch,
+                     size_t window, int shuffle, uint32_t seed);
+void tt_dataset_close(tt_dataset_t *ds);
+
+/*
+ * next batch, valid until the following call: returns its sample count,
+ * 0 at the end of an epoch, -1 on a read error
+ */
+int  tt_dataset_next(tt_dataset_t *ds, tt_ds_batch_t *out);
+
+/* sequential writer, the header is completed on close */
+typedef struct {
+    FILE           *fp;
+    tt_ds_header_t  hdr;
+} tt_ds_writer_t;
+
+/* s_target is ignored (may be NULL) when target_len is 0; 0 or -1 */
+int  tt_ds_writer_open(tt_ds_writer_t *w, const char *path, uint32_t in_len, uint32_t target_len,
+                       const scale_t *s_in, const scale_t *s_target);
+/* n records: in [n x in_len], target [n x target_len] (NULL if target_len is 0); 0 or -1 */
+int  tt_ds_writer_append(tt_ds_writer_t *w, const int8_t *in, const int8_t *target, size_t n);
+int  tt_ds_writer_close(tt_ds_writer_t *w);
+
+#endif // TT_DATASET_H
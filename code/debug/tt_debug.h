@@ -3,4 +3,9 @@
 
 #define TT_BIG_MACHINE_DEBUG_ENABLE (0)
 
+/* per-layer GEMV / epilogue / rescale hooks of tt_profile.h */
+#ifndef TT_PROFILE_ENABLE
+#define TT_PROFILE_ENABLE (0)
+#endif
+
 #endif
\ No newline at end of file
@@ -1,6 +1,15 @@
 #include "ntt_dense.h"
 #include "tt_math.h"    // shift_and_round32, upscale_4_3, downscale_4_5, eff_bitwidth_array
+#include "matrix.h"     // matrix_mul_acc, matrix_mul_batch_acc, matrix_tmul
+#include "matrix_tile.h"  // tiled weights
+#include "tt_utils.h"   // clip_int8
+#include "tt_epilogue.h"
+#include "tt_act_lut.h"
+#include "tt_update.h"
+#include "tt_profile.h"
+#include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 
 #ifdef TENSOR_USE_NESTED
 
@@ -12,181 +21,325 @@
 
 /* ---------- nested header utilities --------------------------- */
 static inline void roll_up(scale_t *h) {
+    int n = 0;
     /* local S */
-    if (h->l.S >  NTT_ROLL_LIM) { h->g.S += NTT_ROLL_STEP; h->l.S -= NTT_ROLL_STEP; }
-    if (h->l.S < -NTT_ROLL_LIM) { h->g.S -= NTT_ROLL_STEP; h->l.S += NTT_ROLL_STEP; }
+    if (h->l.S >  NTT_ROLL_LIM) { h->g.S += NTT_ROLL_STEP; h->l.S -= NTT_ROLL_STEP; n++; }
+    if (h->l.S < -NTT_ROLL_LIM) { h->g.S -= NTT_ROLL_STEP; h->l.S += NTT_ROLL_STEP; n++; }
     /* local U */
-    if (h->l.U >  NTT_ROLL_LIM) { h->g.U += NTT_ROLL_STEP; h->l.U -= NTT_ROLL_STEP; }
+    if (h->l.U >  NTT_ROLL_LIM) { h->g.U += NTT_ROLL_STEP; h->l.U -= NTT_ROLL_STEP; n++; }
     /* local D */
-    if (h->l.D >  NTT_ROLL_LIM) { h->g.D += NTT_ROLL_STEP; h->l.D -= NTT_ROLL_STEP; }
+    if (h->l.D >  NTT_ROLL_LIM) { h->g.D += NTT_ROLL_STEP; h->l.D -= NTT_ROLL_STEP; n++; }
+    TT_PROF_COUNT(n_rollup, n);
 }
 
-static void align_global(scale_t *w, scale_t *g) {
-    /* align global counters only (no data moves) */
+static void align_global(const scale_t *w, scale_t *g) {
+    /* align global counters only (no data moves): the difference is
+     * moved into the local counters of g, its value is unchanged */
     int8_t dS = w->g.S - g->g.S;
-    w->g.S -= dS;  g->l.S += dS;
+    g->g.S += dS;  g->l.S -= dS;
     int8_t dU = w->g.U - g->g.U;
-    w->g.U -= dU;  g->l.U += dU;
+    g->g.U += dU;  g->l.U -= dU;
     int8_t dD = w->g.D - g->g.D;
-    w->g.D -= dD;  g->l.D += dD;
+    g->g.D += dD;  g->l.D -= dD;
 }
 
-static void align_local(tensor_t *W, tensor_t *G) {
-    /* align local counters by shifting G.data accordingly */
+static void align_local(const tensor_t *W, tensor_t *G, uint8_t lr_shift, tt_grad_map_t *map) {
+    /* align local counters: the data moves are composed with the lr shift
+     * into one per-element map applied while the outer product is formed */
     int8_t dS = W->s.l.S - G->s.l.S;
-    if (dS > 0) {
-        for (size_t i = 0; i < G->len; ++i)
-            G->data[i] <<= dS;
-        G->s.l.S += dS;
-    } else if (dS < 0) {
-        dS = -dS;
-        for (size_t i = 0; i < G->len; ++i)
-            G->data[i] = shift_and_round32(G->data[i], dS);
-        G->s.l.S -= dS;
-    }
     int8_t dU = W->s.l.U - G->s.l.U;
-    while (dU-- > 0) {
-        for (size_t i = 0; i < G->len; ++i)
-            G->data[i] = upscale_4_3(G->data[i]);
-        G->s.l.U++;
-    }
     int8_t dD = W->s.l.D - G->s.l.D;
-    while (dD-- > 0) {
-        for (size_t i = 0; i < G->len; ++i)
-            G->data[i] = downscale_4_5(G->data[i]);
-        G->s.l.D++;
-    }
+    tt_grad_map_init(map, lr_shift, dS, dU, dD);
+    G->s.l.S += dS;
+    if (dU > 0) G->s.l.U += dU;
+    if (dD > 0) G->s.l.D += dD;
 }
 
-/* ---------- nested forward ------------------------------------- */
-void ntt_dense_forward(const tensor_t *w,
-                       const tensor_t *x,
-                       tensor_t       *y)
-{
-    size_t OUT = y->len;
-    size_t IN  = x->len;
-    int32_t acc[OUT];
-    /* 1) dot-product + ReLU */
-    for (size_t r = 0; r < OUT; ++r) {
-        int32_t sum = 0;
-        for (size_t c = 0; c < IN; ++c)
-            sum += (int32_t)w->data[r*IN + c] * (int32_t)x->data[c];
-        acc[r] = (sum < 0) ? 0 : sum;
+static void ntt_renorm(tensor_t *W, int maxw) {
+    if (maxw > 112) {
+        tt_rescale_i8(W->data, W->len, -1);
+        W->s.l.D++;
+        TT_PROF_COUNT(n_w_down, 1);
+    } else if (maxw < 32) {
+        tt_rescale_i8(W->data, W->len, +1);
+        W->s.l.U++;
+        TT_PROF_COUNT(n_w_up, 1);
     }
-    /* 2) choose shift */
-    uint8_t bw  = eff_bitwidth_array(acc, OUT);
-    uint8_t ksh = (bw > 8) ? (bw - 8) : 0;
-    /* 3) shrink to int8 and track max */
-    int8_t maxv = 0;
-    for (size_t r = 0; r < OUT; ++r) {
-        int8_t v = clip_int8( shift_and_round32(acc[r], ksh) );
-        y->data[r] = v;
-        if ((int8_t)abs(v) > maxv) maxv = abs(v);
+    roll_up(&W->s);
+}
+
+/* t NULL: row-major W, else the tiles of matrix_tile.h */
+static void ntt_backprop(const tensor_t *W, const matrix_tile_t *t, const tensor_t *err_next, tensor_t *err_prev) {
+    if (t) {
+        matrix_tmul_tile(t, W->data, err_next->data, 7, err_prev->data);
+    } else {
+        matrix_tmul(W, err_next, 7, err_prev);
     }
-    /* 4) nested header update */
+    /* error header nested */
+    err_prev->s.g.S = W->s.g.S + err_next->s.g.S;
+    err_prev->s.g.U = W->s.g.U + err_next->s.g.U;
+    err_prev->s.g.D = W->s.g.D + err_next->s.g.D;
+    err_prev->s.l.S = W->s.l.S + err_next->s.l.S - 7;
+    err_prev->s.l.U = W->s.l.U + err_next->s.l.U;
+    err_prev->s.l.D = W->s.l.D + err_next->s.l.D;
+    roll_up(&err_prev->s);
+}
+
+/* ---------- nested epilogue ------------------------------------ */
+void ntt_dense_epilogue(const tensor_t *w,
+                        const tensor_t *x,
+                        tensor_t       *y,
+                        int32_t        *acc,
+                        tt_act_t        act)
+{
+    /* 1) fused activation, shift choice, int8 shrink, max and up/downscale */
+    tt_epilogue_t e = tt_epilogue_act(act, acc, y->data, y->len);
+    /* 2) nested header update */
     /* global parts accumulate */
     y->s.g.S = w->s.g.S + x->s.g.S;
     y->s.g.U = w->s.g.U + x->s.g.U;
     y->s.g.D = w->s.g.D + x->s.g.D;
     /* local parts accumulate, including shift */
-    y->s.l.S = w->s.l.S + x->s.l.S - ksh;
+    y->s.l.S = w->s.l.S + x->s.l.S - e.ksh;
     y->s.l.U = w->s.l.U + x->s.l.U;
     y->s.l.D = w->s.l.D + x->s.l.D;
-    /* 5) up/downscale locally */
-    if (maxv < 32) {
-        for (size_t i = 0; i < OUT; ++i)
-            y->data[i] = upscale_4_3(y->data[i]);
-        y->s.l.U++;
-    } else if (maxv > 112) {
-        for (size_t i = 0; i < OUT; ++i)
-            y->data[i] = downscale_4_5(y->data[i]);
-        y->s.l.D++;
-    }
-    /* 6) roll-up to keep local bounded */
+    /* 3) record the local up/downscale */
+    if (e.rescale > 0)      { y->s.l.U++; TT_PROF_COUNT(n_up, 1); }
+    else if (e.rescale < 0) { y->s.l.D++; TT_PROF_COUNT(n_down, 1); }
+    /* 4) roll-up to keep local bounded */
     roll_up(&y->s);
+    /* 5) table activations once the header is final */
+    tt_act_lut_tensor(act, y);
+}
+
+/* ---------- nested forward ------------------------------------- */
+void ntt_dense_forward(const tensor_t *w,
+                       const tensor_t *x,
+                       tensor_t       *y,
+                       int32_t        *acc_buf,
+                       size_t          acc_size,
+                       tt_act_t        act)
+{
+    if (!w || !x || !y || !acc_buf || acc_size != y->len) return;
+    TT_PROF_MARK(t);
+    /* dot-product (dispatched kernel, int16 lanes if w->ext plans them) then fused requant */
+    matrix_mul_acc(w, x, (const matrix_acc_t *)w->ext, acc_buf);
+    TT_PROF_LAP(t, cyc_gemv);
+    ntt_dense_epilogue(w, x, y, acc_buf, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/* ---------- nested batched forward ------------------------------ */
+/* x is n rows of IN, y is n rows of OUT, one nested header per batch */
+void ntt_dense_forward_batch(const tensor_t *w,
+                             const tensor_t *x,
+                             tensor_t       *y,
+                             size_t          n,
+                             int32_t        *acc_buf,
+                             size_t          acc_size,
+                             tt_act_t        act)
+{
+    if (!w || !x || !y || !acc_buf || !n || acc_size != y->len || y->len % n) return;
+    TT_PROF_MARK(t);
+    matrix_mul_batch_acc(w, x, n, (const matrix_acc_t *)w->ext, acc_buf);
+    TT_PROF_LAP(t, cyc_gemv);
+    ntt_dense_epilogue(w, x, y, acc_buf, act);
+    TT_PROF_LAP(t, cyc_epilogue);
 }
 
 /* ---------- nested train (Alg 3) ------------------------------ */
-void ntt_dense_train(tensor_t *W,
-                     const tensor_t *x,
-                     const tensor_t *err_next,
-                     tensor_t *err_prev,
-                     tensor_t *buffer)
+/* row-major (t NULL) or tiled W, the gradient in the same order */
+static void ntt_train(tensor_t *W,
+                      const matrix_tile_t *t,
+                      const tensor_t *x,
+                      const tensor_t *err_next,
+                      tensor_t *err_prev,
+                      tensor_t *buffer)
 {
     size_t OUT = err_next->len;
     size_t IN  = x->len;
     /* ensure buffer length */
     buffer->len = W->len;
-    /* 1) outer-product gradient into buffer */
-    for (size_t r = 0; r < OUT; ++r) {
-        for (size_t c = 0; c < IN; ++c) {
-            int16_t g16 = err_next->data[r] * x->data[c];
-            buffer->data[r*IN + c] = clip_int8(g16);
-        }
-    }
-    /* grad header sum global and local */
-    buffer->s.g.S = W->s.g.S + x->s.g.S;
-    buffer->s.g.U = W->s.g.U + x->s.g.U;
-    buffer->s.g.D = W->s.g.D + x->s.g.D;
-    buffer->s.l.S = W->s.l.S + x->s.l.S;
-    buffer->s.l.U = W->s.l.U + x->s.l.U;
-    buffer->s.l.D = W->s.l.D + x->s.l.D;
-    /* 2) lr shift in local */
-    for (size_t i = 0; i < buffer->len; ++i)
-        buffer->data[i] = clip_int8( shift_and_round32(buffer->data[i], NTT_LR_SHIFT) );
-    buffer->s.l.S -= NTT_LR_SHIFT;
-    /* 3) align global then local */
+    /* grad header sum global and local, lr shift in local */
+    buffer->s.g.S = err_next->s.g.S + x->s.g.S;
+    buffer->s.g.U = err_next->s.g.U + x->s.g.U;
+    buffer->s.g.D = err_next->s.g.D + x->s.g.D;
+    buffer->s.l.S = err_next->s.l.S + x->s.l.S - NTT_LR_SHIFT;
+    buffer->s.l.U = err_next->s.l.U + x->s.l.U;
+    buffer->s.l.D = err_next->s.l.D + x->s.l.D;
+    /* 1)-3) align global then local; outer-product gradient, lr shift
+     * and local alignment in one pass */
+    tt_grad_map_t map;
     align_global(&W->s, &buffer->s);
-    align_local(W, buffer);
-    /* 4) margin-based bw adjust on buffer.local */
-    {
-        uint8_t b_g=0, b_w=0;
-        for (size_t i=0;i<W->len;++i) {
-            uint8_t bg = eff_bitwidth32(buffer->data[i]);
-            uint8_t bw = eff_bitwidth32(W->data[i]);
-            if(bg>b_g) b_g=bg;
-            if(bw>b_w) b_w=bw;
-        }
-        int8_t target = (int8_t)b_w - NTT_MARGIN;
-        int8_t shift = (int8_t)b_g - target;
-        if (shift>0) {
-            for (size_t i=0;i<buffer->len;++i)
-                buffer->data[i] = clip_int8( shift_and_round32(buffer->data[i], shift) );
-            buffer->s.l.S -= shift;
-        }
-    }
+    align_local(W, buffer, NTT_LR_SHIFT, &map);
+    int max_g, max_w;
+    if (t) tt_grad_outer_tile(buffer->data, err_next->data, OUT, x->data, IN,
+                              &map, W->data, &max_g, &max_w);
+    else   tt_grad_outer(buffer->data, err_next->data, OUT, x->data, IN,
+                         &map, W->data, &max_g, &max_w);
+    /* 4) margin-based bw adjust, applied on the fly by the update */
+    int8_t target = (int8_t)bitwidth32(max_w) - NTT_MARGIN;
+    int8_t shift = (int8_t)bitwidth32(max_g) - target;
+    if (shift < 0) shift = 0;
     /* 5) SGD update */
-    for (size_t i = 0; i < W->len; ++i)
-        W->data[i] = clip_int8(W->data[i] - buffer->data[i]);
+    int maxw = tt_sgd_apply(W->data, buffer->data, W->len, (uint8_t)shift);
     /* 6) optional weight renorm (local only) */
-    int8_t maxw=0;
-    for (size_t i=0;i<W->len;++i)
-        if(abs(W->data[i])>maxw) maxw=abs(W->data[i]);
-    if (maxw>112) {
-        for(size_t i=0;i<W->len;++i)
-            W->data[i] = downscale_4_5(W->data[i]);
-        W->s.l.D++;
-    } else if (maxw<32) {
-        for(size_t i=0;i<W->len;++i)
-            W->data[i] = upscale_4_3(W->data[i]);
-        W->s.l.U++;
-    }
-    roll_up(&W->s);
+    ntt_renorm(W, maxw);
     /* 7) backprop error */
-    for (size_t c = 0; c < IN; ++c) {
-        int32_t sum=0;
-        for (size_t r = 0; r < OUT; ++r)
-            sum += (int32_t)W->data[r*IN + c] * err_next->data[r];
-        err_prev->data[c] = clip_int8( shift_and_round32(sum, 7) );
+    ntt_backprop(W, t, err_next, err_prev);
+}
+
+void ntt_dense_train(tensor_t *W,
+                     const tensor_t *x,
+                     const tensor_t *err_next,
+                     tensor_t *err_prev,
+                     tensor_t *buffer)
+{
+    ntt_train(W, NULL, x, err_next, err_prev, buffer);
+}
+
+/* ---------- nested minibatch train ----------------------------- */
+/* raw gradient sums of one sample in the W frame (lr left to the pack) + backprop, W read only */
+static void ntt_grad(const tensor_t *W,
+                     const matrix_tile_t *t,
+                     const tensor_t *x,
+                     const tensor_t *err_next,
+                     tensor_t *err_prev,
+                     int32_t *acc)
+{
+    if (!W || !x || !err_next || !err_prev || !acc) return;
+    /* 1) raw product header, global aligned as in train, then the local
+     *    multiplier to the W frame; no lr yet */
+    tensor_t G = { 0 };
+    scale_combine(&G.s, &err_next->s, &x->s);
+    align_global(&W->s, &G.s);
+    int8_t dS = W->s.l.S - G.s.l.S;
+    int8_t dU = W->s.l.U - G.s.l.U;
+    int8_t dD = W->s.l.D - G.s.l.D;
+    tt_mult_t m = tt_align_mult(dS, dU > 0 ? (uint8_t)dU : 0, dD > 0 ? (uint8_t)dD : 0);
+    /* 2) outer product summed in int32, no clip, no lr */
+    if (t) tt_grad_outer_acc_tile(acc, err_next->data, err_next->len, x->data, x->len, m);
+    else   tt_grad_outer_acc(acc, err_next->data, err_next->len, x->data, x->len, m);
+    /* 3) backprop error with the current weights */
+    ntt_backprop(W, t, err_next, err_prev);
+}
+
+void ntt_dense_grad(const tensor_t *W,
+                    const tensor_t *x,
+                    const tensor_t *err_next,
+                    tensor_t *err_prev,
+                    int32_t *acc)
+{
+    ntt_grad(W, NULL, x, err_next, err_prev, acc);
+}
+
+/* int32 sums to int8, header = W header with the pack and lr shifts in local S */
+void ntt_dense_grad_pack(const tensor_t *W, const int32_t *acc, tensor_t *G)
+{
+    if (!W || !acc || !G) return;
+    G->len = W->len;
+    uint8_t k = tt_grad_pack_i8(G->data, acc, W->len);
+    G->s = W->s;
+    G->s.l.S += NTT_LR_SHIFT - k;
+}
+
+/* align n_grad packed gradients to the coarsest, sum, one SGD update */
+void ntt_dense_update(tensor_t *W,
+                      const tensor_t *G,
+                      size_t n_grad,
+                      size_t n_samples,
+                      int32_t *acc)
+{
+    if (!W || !G || !n_grad || !n_samples || !acc) return;
+    /* 1) coarsest local header (globals all equal W's) */
+    const tensor_t *ref = &G[0];
+    for (size_t i = 1; i < n_grad; ++i)
+        if (G[i].s.l.S < ref->s.l.S) ref = &G[i];
+    /* 2) local alignment and sum */
+    memset(acc, 0, W->len * sizeof(int32_t));
+    for (size_t i = 0; i < n_grad; ++i) {
+        int8_t dS = ref->s.l.S - G[i].s.l.S;
+        int8_t dU = ref->s.l.U - G[i].s.l.U;
+        int8_t dD = ref->s.l.D - G[i].s.l.D;
+        tt_grad_map_t map;
+        if (dS || dU > 0 || dD > 0) {
+            tt_grad_map_init(&map, 0, dS, dU, dD);
+            tt_grad_accum(acc, G[i].data, W->len, &map);
+        } else {
+            tt_grad_accum(acc, G[i].data, W->len, NULL);
+        }
     }
-    /* error header nested */
-    err_prev->s.g.S = W->s.g.S + err_next->s.g.S;
-    err_prev->s.g.U = W->s.g.U + err_next->s.g.U;
-    err_prev->s.g.D = W->s.g.D + err_next->s.g.D;
-    err_prev->s.l.S = W->s.l.S + err_next->s.l.S - 7;
-    err_prev->s.l.U = W->s.l.U + err_next->s.l.U;
-    err_prev->s.l.D = W->s.l.D + err_next->s.l.D;
-    roll_up(&err_prev->s);
+    /* 3) mean over the samples and margin adjust in one shift */
+    int e    = W->s.l.S - ref->s.l.S;
+    int lg_n = bitwidth32((int32_t)n_samples) - 1;
+    int bw_g = bitwidth32(tt_max_abs_i32(acc, W->len)) + e - lg_n;
+    int b    = (int)bitwidth32(tt_max_abs_i8(W->data, W->len)) - NTT_MARGIN;
+    int shift = bw_g - b;
+    if (shift < 0) shift = 0;
+    int sh = lg_n - e + shift;
+    if (sh >  31) sh =  31;
+    if (sh < -31) sh = -31;
+    /* 4) SGD update, renorm */
+    int maxw = tt_sgd_apply32(W->data, acc, W->len, (int8_t)sh);
+    ntt_renorm(W, maxw);
+}
+
+/* ---------- nested tiled weights -------------------------------- */
+/* W->data in the tiles of matrix_tile.h, W->ext their geometry (tt_tiled_weights_init) */
+void ntt_tiled_dense_forward(const tensor_t *w,
+                             const tensor_t *x,
+                             tensor_t       *y,
+                             int32_t        *acc_buf,
+                             size_t          acc_size,
+                             tt_act_t        act)
+{
+    if (!w || !x || !y || !w->ext || !acc_buf || acc_size != y->len) return;
+    const matrix_tile_t *t = (const matrix_tile_t *)w->ext;
+    if (t->rows != y->len || t->cols != x->len) return;
+    TT_PROF_MARK(tm);
+    matrix_mul_tile(t, w->data, x->data, acc_buf);
+    TT_PROF_LAP(tm, cyc_gemv);
+    ntt_dense_epilogue(w, x, y, acc_buf, act);
+    TT_PROF_LAP(tm, cyc_epilogue);
+}
+
+void ntt_tiled_dense_forward_batch(const tensor_t *w,
+                                   const tensor_t *x,
+                                   tensor_t       *y,
+                                   size_t          n,
+                                   int32_t        *acc_buf,
+                                   size_t          acc_size,
+                                   tt_act_t        act)
+{
+    if (!w || !x || !y || !w->ext || !acc_buf || !n || acc_size != y->len) return;
+    const matrix_tile_t *t = (const matrix_tile_t *)w->ext;
+    if ((size_t)t->rows * n != y->len || (size_t)t->cols * n != x->len) return;
+    TT_PROF_MARK(tm);
+    for (size_t i = 0; i < n; ++i)
+        matrix_mul_tile(t, w->data, x->data + i * t->cols, acc_buf + i * t->rows);
+    TT_PROF_LAP(tm, cyc_gemv);
+    ntt_dense_epilogue(w, x, y, acc_buf, act);
+    TT_PROF_LAP(tm, cyc_epilogue);
+}
+
+void ntt_tiled_dense_train(tensor_t *W,
+                           const tensor_t *x,
+                           const tensor_t *err_next,
+                           tensor_t *err_prev,
+                           tensor_t *buffer)
+{
+    if (!W || !W->ext) return;
+    ntt_train(W, (const matrix_tile_t *)W->ext, x, err_next, err_prev, buffer);
+}
+
+void ntt_tiled_dense_grad(const tensor_t *W,
+                          const tensor_t *x,
+                          const tensor_t *err_next,
+                          tensor_t *err_prev,
+                          int32_t *acc)
+{
+    if (!W || !W->ext) return;
+    ntt_grad(W, (const matrix_tile_t *)W->ext, x, err_next, err_prev, acc);
 }
 
 #endif
\ No newline at end of file
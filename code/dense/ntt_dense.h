@@ -2,12 +2,33 @@
 #ifndef NTT_DENSE_H
 #define NTT_DENSE_H
 #include "tt_types.h"
+#include "activations.h"
 
 #ifdef TENSOR_USE_NESTED
-/* forward pass:  y = ReLU(W · x)  (Tin‑Tin scaling handled internally) */
+/* forward pass:  y = act(W · x)  (Tin‑Tin scaling handled internally) */
+/* acc_buf holds y->len int32 accumulators (no stack scratch) */
 void ntt_dense_forward(const tensor_t *w,
                        const tensor_t *x,
-                       tensor_t       *y);
+                       tensor_t       *y,
+                       int32_t        *acc_buf,
+                       size_t          acc_size,
+                       tt_act_t        act);
+
+/* batched forward: x is n x IN, y is n x OUT, one nested header per batch */
+void ntt_dense_forward_batch(const tensor_t *w,
+                             const tensor_t *x,
+                             tensor_t       *y,
+                             size_t          n,
+                             int32_t        *acc_buf,
+                             size_t          acc_size,
+                             tt_act_t        act);
+
+/* activation, requantization and nested header of y from y->len accumulators */
+void ntt_dense_epilogue(const tensor_t *w,
+                        const tensor_t *x,
+                        tensor_t       *y,
+                        int32_t        *acc,
+                        tt_act_t        act);
 
 void ntt_dense_train(tensor_t *w,
                     const tensor_t *x,
@@ -15,5 +36,48 @@ void ntt_dense_train(tensor_t *w,
                     tensor_t *error_prev,
                     tensor_t *buffer);  /* output */
 
+/* minibatch split: per-sample grad sums (w read only), int8 pack, one update */
+void ntt_dense_grad(const tensor_t *w,
+                    const tensor_t *x,
+                    const tensor_t *error_next,
+                    tensor_t *error_prev,
+                    int32_t *acc);
+
+void ntt_dense_grad_pack(const tensor_t *w, const int32_t *acc, tensor_t *g);
+
+void ntt_dense_update(tensor_t *w,
+                      const tensor_t *g,
+                      size_t n_grad,
+                      size_t n_samples,
+                      int32_t *acc);
+
+/* tiled weights (tt_tiled_weights_init, tt_dense.h); grad pack and update as above */
+void ntt_tiled_dense_forward(const tensor_t *w,
+                             const tensor_t *x,
+                             tensor_t       *y,
+                             int32_t        *acc_buf,
+                             size_t          acc_size,
+                             tt_act_t        act);
+
+void ntt_tiled_dense_forward_batch(const tensor_t *w,
+                                   const tensor_t *x,
+                                   tensor_t       *y,
+                                   size_t          n,
+                                   int32_t        *acc_buf,
+                                   size_t          acc_size,
+                                   tt_act_t        act);
+
+void ntt_tiled_dense_train(tensor_t *w,
+                           const tensor_t *x,
+                           const tensor_t *error_next,
+                           tensor_t *error_prev,
+                           tensor_t *buffer);
+
+void ntt_tiled_dense_grad(const tensor_t *w,
+                          const tensor_t *x,
+                          const tensor_t *error_next,
+                          tensor_t *error_prev,
+                          int32_t *acc);
+
 #endif
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "tt_conv1d.h"
+#include "tt_dense.h"
+#include "ntt_dense.h"
+#include "tt_update.h"
+#include "tt_profile.h"
+#include <string.h>
+
+#define LR_SHIFT 8    /* lr = 1 / 256, as the dense layers */
+
+typedef void (*s_update_t)(tensor_t *, const tensor_t *, size_t, size_t, int32_t *);
+
+/**
+ * @brief Binds the geometry and the train scratch of a Conv1D layer to W.
+ *
+ * @param W Pointer to the weight tensor, len = c_out x c_in x k.
+ * @param ext Pointer to the extension, kept in W->ext.
+ * @param g Pointer to the geometry (matrix_conv1d_init), copied.
+ * @param acc Pointer to TT_CONV1D_ACC_LEN int32 of train scratch, NULL for inference only.
+ * @return int 0 on success, -1 on bad arguments.
+ */
+int tt_conv1d_weights_init(tensor_t *W, tt_conv1d_ext_t *ext, const matrix_conv1d_t *g, int32_t *acc) {
+    if (!W || !W->data || !ext || !g || W->len != MATRIX_CONV1D_W_LEN(g)) return -1;
+    ext->g   = *g;
+    ext->acc = acc;
+    W->ext   = ext;
+    return 0;
+}
+
+/**
+ * @brief Conv1D forward pass, then the dense epilogue.
+ */
+void tt_conv1d_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || acc_size != Y->len) return;
+    const matrix_conv1d_t *g = &((const tt_conv1d_ext_t *)W->ext)->g;
+    if (MATRIX_CONV1D_OUT_LEN(g) != Y->len || MATRIX_CONV1D_IN_LEN(g) != X->len) return;
+    TT_PROF_MARK(t);
+
+    // sliding-window convolution into the int32 accumulators
+    matrix_conv1d_fwd(g, W->data, X->data, acc_buffer);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/* x is N rows of c_in x l_in, y N rows of c_out x l_out, one header per batch */
+void tt_conv1d_forward_batch(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t N, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || !N || acc_size != Y->len) return;
+    const matrix_conv1d_t *g = &((const tt_conv1d_ext_t *)W->ext)->g;
+    const size_t in = MATRIX_CONV1D_IN_LEN(g), out = MATRIX_CONV1D_OUT_LEN(g);
+    if (out * N != Y->len || in * N != X->len) return;
+    TT_PROF_MARK(t);
+
+    for (size_t n = 0; n < N; ++n)
+        matrix_conv1d_fwd(g, W->data, X->data + n * in, acc_buffer + n * out);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/*
+ * int8 input error: transposed convolution of err_next in int32, packed
+ * with the smallest shift that fits, header W + err_next - shift
+ */
+static void s_backprop(const tensor_t *W, const tensor_t *err_next, tensor_t *err_prev, int32_t *acc) {
+    const matrix_conv1d_t *g = &((const tt_conv1d_ext_t *)W->ext)->g;
+    matrix_conv1d_bwd(g, W->data, err_next->data, acc);
+    uint8_t k = tt_grad_pack_i8(err_prev->data, acc, MATRIX_CONV1D_IN_LEN(g));
+    scale_combine(&err_prev->s, &W->s, &err_next->s);
+    scale_shift(&err_prev->s, -(int8_t)k);
+#ifdef TENSOR_USE_NESTED
+    scale_rollup(&err_prev->s);
+#endif
+}
+
+/*
+ * one train step: input error with the current weights, then the weight
+ * gradient summed over the positions, packed to int8 with its own header
+ * (err_next + x, the pack shift and the lr) and applied by the dense update
+ */
+static void s_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev,
+                    tensor_t *G_buffer, s_update_t update) {
+    if (!W || !W->ext || !x || !err_next || !err_prev || !G_buffer) return;
+    const tt_conv1d_ext_t *cv = (const tt_conv1d_ext_t *)W->ext;
+    if (!cv->acc || x->len != MATRIX_CONV1D_IN_LEN(&cv->g) || err_next->len != MATRIX_CONV1D_OUT_LEN(&cv->g)) return;
+
+    s_backprop(W, err_next, err_prev, cv->acc);
+
+    matrix_conv1d_wgrad(&cv->g, err_next->data, x->data, cv->acc);
+    G_buffer->len = W->len;
+    uint8_t k = tt_grad_pack_i8(G_buffer->data, cv->acc, W->len);
+    scale_combine(&G_buffer->s, &err_next->s, &x->s);
+    /* the pack shift coarsens the steps, lr = 2^-LR_SHIFT refines them */
+    scale_shift(&G_buffer->s, (int8_t)(LR_SHIFT - k));
+#ifdef TENSOR_USE_NESTED
+    /* the updates expect the global counters of W: move the rest into local */
+    G_buffer->s.l.S += G_buffer->s.g.S - W->s.g.S;  G_buffer->s.g.S = W->s.g.S;
+    G_buffer->s.l.U += G_buffer->s.g.U - W->s.g.U;  G_buffer->s.g.U = W->s.g.U;
+    G_buffer->s.l.D += G_buffer->s.g.D - W->s.g.D;  G_buffer->s.g.D = W->s.g.D;
+#endif
+
+    update(W, G_buffer, 1, 1, cv->acc);
+}
+
+void tt_conv1d_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, tensor_t *G_buffer) {
+    s_train(W, x, err_next, err_prev, G_buffer, tt_dense_update);
+}
+
+#ifdef TENSOR_USE_NESTED
+void ntt_conv1d_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, tensor_t *G_buffer) {
+    s_train(W, x, err_next, err_prev, G_buffer, ntt_dense_update);
+}
+#endif
@@ -0,0 +1,38 @@
+#ifndef TT_CONV1D_H
+#define TT_CONV1D_H
+#include "tt_types.h"
+#include "activations.h"
+#include "matrix_conv1d.h"
+
+/*
+ * Conv1D weights: W->data holds [c_out x c_in x k] int8, W->ext points to
+ * the tt_conv1d_ext_t below. x and y are channel major, x->len = c_in x l_in
+ * and y->len = c_out x l_out, so a Conv1D layer chains with dense layers on
+ * the flattened tensors. Forward runs matrix_conv1d_fwd and the dense
+ * epilogue (one header for the whole output). Training computes the input
+ * error with the current weights, packs the per-tap weight gradient to int8
+ * and applies it with the dense update rules (lr, margin, renorm).
+ */
+typedef struct {
+    matrix_conv1d_t g;
+    int32_t        *acc;   /* train scratch [TT_CONV1D_ACC_LEN] */
+} tt_conv1d_ext_t;
+
+/* int32 train scratch: the weight gradient or the input error */
+#define TT_CONV1D_ACC_LEN(C_IN, C_OUT, K, L_IN)                                    \
+    ((size_t)(C_OUT) * (C_IN) * (K) > (size_t)(C_IN) * (L_IN)                      \
+         ? (size_t)(C_OUT) * (C_IN) * (K) : (size_t)(C_IN) * (L_IN))
+
+/* binds geometry and scratch to W (len MATRIX_CONV1D_W_LEN(g)); 0 or -1 */
+int  tt_conv1d_weights_init(tensor_t *W, tt_conv1d_ext_t *ext, const matrix_conv1d_t *g, int32_t *acc);
+
+/* backend slots, same contracts as tt_dense.h */
+void tt_conv1d_forward(const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_conv1d_forward_batch(const tensor_t *w, const tensor_t *x, tensor_t *y, size_t n, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_conv1d_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);
+#ifdef TENSOR_USE_NESTED
+/* same step with the nested update (local renorm and roll-up) */
+void ntt_conv1d_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);
+#endif
+
+#endif
@@ -3,6 +3,11 @@
 #include "matrix.h"
 #include "tt_utils.h"
 #include "activations.h"
+#include "tt_epilogue.h"
+#include "tt_act_lut.h"
+#include "tt_update.h"
+#include "tt_profile.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -10,16 +15,14 @@
 #define LR_SHIFT 8    /* lr = 1 / 256   */
 #define MARGIN   2    /* Algorithm‑3 line 10 */
 
-#define T_LOW   (2 ^ (CHAR_BIT - 1) / 4)
-#define T_HIGH  ((2 ^ (CHAR_BIT - 1) * 7) / 8)
 
-
-static void align_scale(tensor_t *W, tensor_t *G_buffer);
-static inline void s_activation_func(int32_t * acc_buffer, size_t len, Activation_i8_t func);
-static inline void s_scale_by_func(tensor_t * Y, size_t len, scale_by_t func);
-static inline void s_shift_and_round_func(tensor_t * Y, size_t len, shift_round_t func);
-static inline void s_clip_func(tensor_t * Y, size_t len, clip_t func);
-static inline int8_t s_max_abs_value(tensor_t * Y, size_t len);
+static void align_scale(const tensor_t *W, _scale_t *g, tt_grad_map_t *map);
+static void s_renorm(tensor_t *W, int maxw);
+static void s_backprop(const tensor_t *W, const matrix_tile_t *t, const tensor_t *err_next, tensor_t *err_prev);
+static void s_train(tensor_t *W, const matrix_tile_t *t, const tensor_t *x, const tensor_t *err_next,
+                    tensor_t *err_prev, tensor_t *G_buffer);
+static void s_grad(const tensor_t *W, const matrix_tile_t *t, const tensor_t *x, const tensor_t *err_next,
+                   tensor_t *err_prev, int32_t *acc);
 
 /**
  * @brief Performs a forward pass of a dense (fully connected) layer for tin-tin and tin-tin nested.
@@ -31,6 +34,7 @@ static inline int8_t s_max_abs_value(tensor_t * Y, size_t len);
  * @param W Pointer to the weight tensor. It is assumed to be a 2D tensor
  * where the number of rows corresponds to the output features and the
  * number of columns corresponds to the input features. Must not be NULL.
+ * W->ext is NULL or the matrix_acc_t accumulation plan of the weights.
  * @param X Pointer to the input tensor. It is assumed to be a 1D tensor
  * representing the input features. Must not be NULL.
  * @param Y Pointer to the output tensor. This tensor will store the result
@@ -39,196 +43,179 @@ static inline int8_t s_max_abs_value(tensor_t * Y, size_t len);
  * @param acc_buffer Pointer to an int32_t buffer used for intermediate
  * accumulation during the matrix multiplication. Its size should be at
  * least the length of the output tensor `Y`. Must not be NULL.
+ * @param act Activation of the layer, fused into the epilogue.
  */
-void tt_dense_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t * acc_buffer, size_t acc_size) {
+void tt_dense_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t * acc_buffer, size_t acc_size, tt_act_t act) {
     if(!W || !X || !Y || !acc_buffer || acc_size != Y->len) return;
+    TT_PROF_MARK(t);
     
-    // raw int32 matrix-vector multiplication
-    matrix_mul(W, X, acc_buffer);
-
-    // apply ReLU to the int32 accumulators
-    s_activation_func(acc_buffer, Y->len, relu_i8);
-
-    // get effective max bit width
-    uint8_t bw   = eff_bitwidth_array(acc_buffer, Y->len);
-    
-    // get the bits to shift
-    uint8_t ksh  = (bw - CHAR_BIT) & -(bw > CHAR_BIT);
+    // raw int32 matrix-vector multiplication, int16 lanes where W->ext plans them
+    matrix_mul_acc(W, X, (const matrix_acc_t *)W->ext, acc_buffer);
+    TT_PROF_LAP(t, cyc_gemv);
 
-    // shift and round by 32
-    s_shift_and_round_func(Y, Y->len, shift_and_round32, ksh);
-
-    // clip by at int8_t
-    s_clip_func(Y, Y->len, clip_int8);
-
-    // get the max abs output value in the layer 
-    int8_t maxv = s_max_abs_value(Y, Y->len);
-
-    // combine the scales of weights and Activations 
-    scale_combine(&Y->s, &W->s, &X->s);
-
-    // shift the scale of Y
-    scale_shift(&Y->s, -(int8_t)ksh);
-
-    if(maxv < T_LOW) {
-        s_scale_by_func(Y, Y->len, upscale_4_3);
-        scale_up(&Y->s);           
-    } else if(maxv > T_HIGH) {
-        s_scale_by_func(Y, Y->len, downscale_4_5);
-        scale_down(&Y->s);  
-    }
-
-#ifdef TENSOR_USE_NESTED
-    // roll up scale
-    scale_rollup(&Y->s);
-#endif
+    // activation, requantization and scale update
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
     return;
 }
 
 /**
- * @brief Applies an activation function to each element of an integer array.
+ * @brief Binds an accumulation plan to a dense weight tensor.
  *
- * This function iterates through an array of 32-bit integers and applies a provided
- * activation function to each element in place.
+ * The plan starts empty, so the forward passes keep the int32 kernels until
+ * tt_dense_weights_sync has seen the weights.
  *
- * @param acc Pointer to the beginning of the integer array. If NULL, the function returns immediately.
- * @param len The number of elements in the array.
- * @param func A function pointer to the activation function. This function should
- * take an `int32_t` as input and return an `int32_t`. The type
- * `Activation_i8_t` is assumed to be defined as `int32_t (*)(int32_t)`.
+ * @param W Pointer to the weight tensor [OUT x IN], W->ext is set to plan.
+ * @param plan Pointer to the plan storage, owned by the caller.
+ * @param cols Row length IN.
+ * @return int 0 on success, -1 on bad arguments.
  */
-static inline void s_activation_func(int32_t *acc, size_t len, Activation_i8_t func) {
-    if(!acc) return;
-    for (size_t i = 0; i < len; ++i) {
-        acc[i] = func(acc[i]);
-    }
-    return;
+int tt_dense_weights_init(tensor_t *W, matrix_acc_t *plan, size_t cols) {
+    if (!W || !plan || !cols || W->len % cols) return -1;
+    matrix_acc_plan(plan, cols, CHAR_BIT);
+    W->ext = plan;
+    return 0;
 }
 
 /**
- * @brief Scales each element of a tensor's data using a provided scaling function.
+ * @brief Plans the accumulation width from the current weights.
  *
- * This function iterates through the data array of a given tensor and applies a
- * scaling function to each element in place.
+ * One max-abs pass over W: the bit-width of the largest weight decides
+ * whether the int16 kernels are exact and how often they spill.
  *
- * @param Y Pointer to the tensor structure. If NULL, the function returns immediately.
- * The tensor structure is assumed to have a data member accessible as `Y->data`.
- * @param len The number of elements in the tensor's data array.
- * @param func A function pointer to the scaling function. This function should
- * take an element from the tensor's data array as input and return
- * the scaled value of the same type. The type `scale_by_t` is assumed
- * to be defined appropriately for the data type of the tensor.
+ * @param W Pointer to the weight tensor bound by tt_dense_weights_init.
  */
-static inline void s_scale_by_func(tensor_t * Y, size_t len, scale_by_t func) {
-    if(!Y) return;
-    for (size_t i = 0; i < len; ++i) {
-        Y->data[i] = func(Y->data[i]);
-    }
-    return;
+void tt_dense_weights_sync(tensor_t *W) {
+    if (!W || !W->ext) return;
+    matrix_acc_t *plan = (matrix_acc_t *)W->ext;
+    matrix_acc_plan(plan, plan->in, eff_bitwidth32(tt_max_abs_i8(W->data, W->len)));
 }
 
 /**
- * @brief Applies a clipping function to each element of a tensor's data.
+ * @brief Performs a batched forward pass of a dense layer for tin-tin and tin-tin nested.
  *
- * This function iterates through the data array of a given tensor and applies a
- * clipping function to each element in place. Clipping typically limits values
- * within a specific range.
+ * All N samples share one scale header: X carries the header of the whole
+ * N x IN activation block and Y receives a single header for the N x OUT
+ * output block, so the requantization shift and the up/down decision are
+ * taken over the whole batch. For N == 1 this is exactly tt_dense_forward.
  *
- * @param Y Pointer to the tensor structure. If NULL, the function returns immediately.
- * The tensor structure is assumed to have a data member accessible as `Y->data`.
- * @param len The number of elements in the tensor's data array.
- * @param func A function pointer to the clipping function. This function should
- * take an element from the tensor's data array as input and return
- * the clipped value of the same type. The type `clip_t` is assumed
- * to be defined appropriately for the data type of the tensor.
+ * @param W Pointer to the weight tensor [OUT x IN]. Must not be NULL.
+ * @param X Pointer to the input block, N rows of IN features. Must not be NULL.
+ * @param Y Pointer to the output block, N rows of OUT features. Must not be NULL.
+ * @param N Number of samples in the batch.
+ * @param acc_buffer Pointer to an int32_t buffer of at least N * OUT elements.
+ * @param acc_size Size of acc_buffer, must equal Y->len.
+ * @param act Activation of the layer, fused into the epilogue.
  */
-static inline void s_clip_func(tensor_t * Y, size_t len, clip_t func) {
-    if(!Y) return;
-    for (size_t i = 0; i < len; ++i) {
-        Y->data[i] = func(Y->data[i]);
-    }
+void tt_dense_forward_batch(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t N, int32_t * acc_buffer, size_t acc_size, tt_act_t act) {
+    if(!W || !X || !Y || !acc_buffer || !N || acc_size != Y->len || Y->len % N) return;
+    TT_PROF_MARK(t);
+
+    // cache-blocked int32 matrix-matrix multiplication
+    matrix_mul_batch_acc(W, X, N, (const matrix_acc_t *)W->ext, acc_buffer);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    // activation, requantization and scale update over the whole block
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
     return;
 }
 
 /**
- * @brief Applies a shift and rounding operation to each element of a tensor's data,
- * casting the result to an 8-bit signed integer.
- *
- * This function iterates through the data array of a given tensor, applies a
- * shift and rounding function to each element along with a shift parameter, and
- * then casts the result to an `int8_t` before updating the element in place.
+ * @brief Dense layer epilogue: activation, requantization to int8 and scale update.
  *
- * @param Y Pointer to the tensor structure. If NULL, the function returns immediately.
- * The tensor structure is assumed to have a data member accessible as `Y->data`,
- * which is expected to store `int8_t` values after the operation.
- * @param len The number of elements in the tensor's data array.
- * @param func A function pointer to the shift and rounding function. This function
- * should take an element from the tensor's data array and a `uint8_t`
- * value as input, and return a value that can be cast to `int8_t`.
- * The type `shift_round_t` is assumed to be defined appropriately.
- * @param ksh An unsigned 8-bit integer value used as a shift parameter in the
- * `func` function.
+ * @param W Pointer to the weight tensor, its header feeds the output header.
+ * @param X Pointer to the input tensor, its header feeds the output header.
+ * @param Y Pointer to the output tensor, Y->len accumulators are consumed.
+ * @param acc_buffer Pointer to the int32_t accumulators of the matmul.
+ * @param act Activation; sigmoid and tanh are looked up once the header is known.
  */
-static inline void s_shift_and_round_func(tensor_t * Y, size_t len, shift_round_t func, uint8_t ksh) {
-    if(!Y) return;
-    for (size_t i = 0; i < len; ++i) {
-        Y->data[i] = (int8_t)(func(Y->data[i], ksh));
-    }
+void tt_dense_epilogue(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t * acc_buffer, tt_act_t act) {
+    // fused activation, shift-round, clip, max-abs and 4/3 | 4/5 rescale
+    tt_epilogue_t e = tt_epilogue_act(act, acc_buffer, Y->data, Y->len);
+
+    // output header from the shift and rescale just applied
+    tt_dense_epilogue_scale(W, X, e, &Y->s);
+
+    // table activations on the int8 output, with its final header
+    tt_act_lut_tensor(act, Y);
     return;
 }
 
 /**
- * @brief Finds the maximum absolute value among the elements of a tensor's data.
- *
- * This function iterates through the data array of a given tensor and determines
- * the largest absolute value present.
+ * @brief Output header of the dense epilogue, before any table activation.
  *
- * @param Y Pointer to the tensor structure. If NULL, the function returns.
- * The tensor structure is assumed to have a data member accessible as `Y->data`.
- * @param len The number of elements in the tensor's data array.
- * @return The maximum absolute value found in the tensor's data, as an 8-bit
- * signed integer (`int8_t`). If the input tensor pointer `Y` is NULL,
- * the behavior is undefined (it currently returns without a value).
- * It is recommended to handle the NULL case by returning a default value
- * like 0.
+ * @param W Pointer to the weight tensor.
+ * @param X Pointer to the input tensor.
+ * @param e Shift and rescale the epilogue applied.
+ * @param s Pointer to the header to write.
  */
-static inline int8_t s_max_abs_value(tensor_t * Y, size_t len) {
-    if(!Y) return;
-    int8_t maxv = 0;
-    for (size_t i = 0; i < len; ++i) {
-        maxv = max(abs(Y->data[i]), maxv);
+void tt_dense_epilogue_scale(const tensor_t *W, const tensor_t *X, tt_epilogue_t e, scale_t *s) {
+    // combine the scales of weights and Activations 
+    scale_combine(s, &W->s, &X->s);
+
+    // shift the scale of Y
+    scale_shift(s, -(int8_t)e.ksh);
+
+    if(e.rescale > 0) {
+        scale_up(s);           
+        TT_PROF_COUNT(n_up, 1);
+    } else if(e.rescale < 0) {
+        scale_down(s);  
+        TT_PROF_COUNT(n_down, 1);
     }
+
+#ifdef TENSOR_USE_NESTED
+    // roll up scale
+    TT_PROF_COUNT(n_rollup, scale_rollup(s));
+#endif
     return;
 }
 
-/* single‑header alignment (Alg 3 lines 1–6) */
-static void align_scale(tensor_t *W, tensor_t *G_buffer)
+/*
+ * the train path works on one header: a nested one is read as g + l, the
+ * same value the forward epilogue gave it, and changes are written into l
+ * and rolled up as the epilogue does
+ */
+static inline _scale_t s_hdr(const tensor_t *t)
 {
-    int8_t dS = W->s.S - G_buffer->s.S;
-    int8_t dU = W->s.U - G_buffer->s.U;
-    int8_t dD = W->s.D - G_buffer->s.D;
-
-    if (dS > 0) {
-        for (size_t i = 0; i < G_buffer->len; ++i)
-            G_buffer->data[i] <<= dS;
-        G_buffer->s.S += dS;
-    } else if (dS < 0) {
-        dS = -dS;
-        for (size_t i = 0; i < G_buffer->len; ++i)
-            G_buffer->data[i] = shift_and_round32(G_buffer->data[i], dS);
-        G_buffer->s.S -= dS;
-    }
+#ifdef TENSOR_USE_NESTED
+    _scale_t h = { t->s.g.S + t->s.l.S, t->s.g.U + t->s.l.U, t->s.g.D + t->s.l.D };
+    return h;
+#else
+    return t->s;
+#endif
+}
 
-    while (dU-- > 0) {
-        for (size_t i = 0; i < G_buffer->len; ++i)
-            G_buffer->data[i] = upscale_4_3(G_buffer->data[i]);
-        G_buffer->s.U++;
-    }
-    while (dD-- > 0) {
-        for (size_t i = 0; i < G_buffer->len; ++i)
-            G_buffer->data[i] = downscale_4_5(G_buffer->data[i]);
-        G_buffer->s.D++;
-    }
+static inline void s_hdr_set(tensor_t *t, _scale_t h)
+{
+#ifdef TENSOR_USE_NESTED
+    t->s.l.S = h.S - t->s.g.S;
+    t->s.l.U = h.U - t->s.g.U;
+    t->s.l.D = h.D - t->s.g.D;
+    TT_PROF_COUNT(n_rollup, scale_rollup(&t->s));
+#else
+    t->s = h;
+#endif
+}
+
+/*
+ * single‑header alignment (Alg 3 lines 1–6): moves the G header onto the
+ * W header and composes the lr shift with the matching data moves into one
+ * per‑element map, applied while the outer product is formed.
+ */
+static void align_scale(const tensor_t *W, _scale_t *g, tt_grad_map_t *map)
+{
+    _scale_t w = s_hdr(W);
+    int8_t dS = w.S - g->S;
+    int8_t dU = w.U - g->U;
+    int8_t dD = w.D - g->D;
+
+    tt_grad_map_init(map, LR_SHIFT, dS, dU, dD);
+
+    g->S += dS;
+    if (dU > 0) g->U += dU;
+    if (dD > 0) g->D += dD;
 }
 
 
@@ -237,6 +224,13 @@ void tt_dense_train(tensor_t *W,
                     const tensor_t *err_next,
                     tensor_t *err_prev,
                     tensor_t *G_buffer)
+{
+    s_train(W, NULL, x, err_next, err_prev, G_buffer);
+}
+
+/* train step on row-major (t NULL) or tiled W, G in the same order */
+static void s_train(tensor_t *W, const matrix_tile_t *t, const tensor_t *x, const tensor_t *err_next,
+                    tensor_t *err_prev, tensor_t *G_buffer)
 {
     size_t OUT = err_next->len;
     size_t IN  = x->len;
@@ -244,77 +238,250 @@ void tt_dense_train(tensor_t *W,
     /* make sure G_buffer has the right length */
     G_buffer->len = W->len;
 
-    /* 1. gradient wrt weights: outer‑product ----------------------- */
-    for (size_t r = 0; r < OUT; ++r) {
-        for (size_t c = 0; c < IN; ++c) {
-            int16_t g16 = (int16_t)err_next->data[r] * x->data[c];
-            G_buffer->data[r*IN + c] = clip_int8(g16);
-        }
-    }
-    G_buffer->s.S = err_next->s.S + x->s.S;
-    G_buffer->s.U = err_next->s.U + x->s.U;
-    G_buffer->s.D = err_next->s.D + x->s.D;
+    /* gradient header: outer‑product, then learning‑rate multiply (>>8) */
+    _scale_t e = s_hdr(err_next), xs = s_hdr(x);
+    _scale_t g = { e.S + xs.S - LR_SHIFT, e.U + xs.U, e.D + xs.D };
 
-    /* 2. learning‑rate multiply (>>8) */
-    for (size_t i = 0; i < G_buffer->len; ++i) {
-        G_buffer->data[i] = clip_int8( shift_and_round32(G_buffer->data[i], LR_SHIFT) );
-    }
-    G_buffer->s.S -= LR_SHIFT;
-
-    /* 3. align scales (Alg 3 lines 1–6) */
-    align_scale(W, G_buffer);
-
-    /* --- Alg 3 lines 8–11: margin bit‑width adjustment ---------- */
-    {
-        uint8_t b_g = 0, b_w = 0;
-        /* compute bit‑width of gradient and weights */
-        for (size_t i = 0; i < W->len; ++i) {
-            int32_t gv = G_buffer->data[i];
-            int32_t wv = W->data[i];
-            uint8_t bg = eff_bitwidth32(gv);
-            uint8_t bw = eff_bitwidth32(wv);
-            if (bg > b_g) b_g = bg;
-            if (bw > b_w) b_w = bw;
-        }
-        int8_t b = (int8_t)b_w - MARGIN;           /* target bit‑width */
-        int8_t shift_adj = (int8_t)b_g - b;        /* how much to shift G */
-        if (shift_adj > 0) {
-            for (size_t i = 0; i < G_buffer->len; ++i) {
-                G_buffer->data[i] = clip_int8(
-                    shift_and_round32(G_buffer->data[i], shift_adj)
-                );
-            }
-            G_buffer->s.S -= shift_adj;            /* update scale header */
-        }
-    }
+    /* 1.–3. outer‑product, lr shift and alignment in one pass ------ */
+    tt_grad_map_t map;
+    align_scale(W, &g, &map);
+    s_hdr_set(G_buffer, g);
 
-    /* 4. SGD update ---------------------------- */
-    for (size_t i = 0; i < W->len; ++i) {
-        W->data[i] = clip_int8(W->data[i] - G_buffer->data[i]);
-    }
+    int max_g, max_w;
+    if (t) tt_grad_outer_tile(G_buffer->data, err_next->data, OUT, x->data, IN,
+                              &map, W->data, &max_g, &max_w);
+    else   tt_grad_outer(G_buffer->data, err_next->data, OUT, x->data, IN,
+                         &map, W->data, &max_g, &max_w);
+
+    /* --- Alg 3 lines 8–11: margin bit‑width adjustment ---------- */
+    int8_t b = (int8_t)bitwidth32(max_w) - MARGIN;       /* target bit‑width */
+    int8_t shift_adj = (int8_t)bitwidth32(max_g) - b;    /* how much to shift G */
+    if (shift_adj < 0) shift_adj = 0;
+
+    /* 4. SGD update, margin shift applied on the fly (G keeps the
+     *    aligned header) --------------------------------------------- */
+    int maxw = tt_sgd_apply(W->data, G_buffer->data, W->len, (uint8_t)shift_adj);
 
     /* optional weight renorm ------------------ */
-    int8_t maxw = 0;
-    for (size_t i = 0; i < W->len; ++i)
-        if (abs(W->data[i]) > maxw) maxw = abs(W->data[i]);
+    s_renorm(W, maxw);
+
+    /* 5. error to previous layer: Wᵀ·err_next --------------------- */
+    s_backprop(W, t, err_next, err_prev);
+}
+
+/**
+ * @brief Gradient half of tt_dense_train for minibatch / data-parallel use.
+ *
+ * The raw outer product of one sample is aligned to the W frame and summed
+ * into an int32 buffer, without a per-sample clip or lr shift (the lr is
+ * applied by tt_dense_grad_pack); the error of the previous layer is
+ * computed with the current weights. W is not modified, so several
+ * threads can run this on the same layer.
+ *
+ * @param W Pointer to the weight tensor [OUT x IN], read only.
+ * @param x Pointer to the layer input [IN].
+ * @param err_next Pointer to the error at the layer output [OUT].
+ * @param err_prev Pointer to the error at the layer input [IN], written.
+ * @param acc Pointer to the int32 gradient sums [OUT x IN], accumulated.
+ */
+void tt_dense_grad(const tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, int32_t *acc)
+{
+    if (!W || !x || !err_next || !err_prev || !acc) return;
+    s_grad(W, NULL, x, err_next, err_prev, acc);
+}
+
+static void s_grad(const tensor_t *W, const matrix_tile_t *t, const tensor_t *x, const tensor_t *err_next,
+                   tensor_t *err_prev, int32_t *acc)
+{
+    /* raw products in the e + x frame, aligned to the W frame; no lr yet */
+    _scale_t w = s_hdr(W), e = s_hdr(err_next), xs = s_hdr(x);
+    int8_t dS = w.S - (e.S + xs.S);
+    int8_t dU = w.U - (e.U + xs.U);
+    int8_t dD = w.D - (e.D + xs.D);
+    tt_mult_t m = tt_align_mult(dS, dU > 0 ? (uint8_t)dU : 0, dD > 0 ? (uint8_t)dD : 0);
+
+    if (t) tt_grad_outer_acc_tile(acc, err_next->data, err_next->len, x->data, x->len, m);
+    else   tt_grad_outer_acc(acc, err_next->data, err_next->len, x->data, x->len, m);
 
+    s_backprop(W, t, err_next, err_prev);
+}
+
+/**
+ * @brief Packs int32 gradient sums of tt_dense_grad into an int8 gradient.
+ *
+ * The sums are raw gradients in the W frame: the pack shift and the
+ * learning rate both go into the header, so the lr is applied once here.
+ *
+ * @param W Pointer to the weight tensor the sums are framed in.
+ * @param acc Pointer to the int32 gradient sums [W->len].
+ * @param G Pointer to the int8 gradient [W->len]. Its header is the W
+ * header with the applied right shift and the lr shift.
+ */
+void tt_dense_grad_pack(const tensor_t *W, const int32_t *acc, tensor_t *G)
+{
+    if (!W || !acc || !G) return;
+    G->len = W->len;
+    uint8_t k = tt_grad_pack_i8(G->data, acc, W->len);
+    _scale_t h = s_hdr(W);
+    h.S += LR_SHIFT - k;
+    G->s = W->s;
+    s_hdr_set(G, h);
+}
+
+/**
+ * @brief Reduces int8 gradients and applies a single SGD update.
+ *
+ * Every gradient keeps its own header. They are aligned to the coarsest one
+ * with the align_scale rules, summed in int32, averaged over the samples
+ * (a rounding shift by floor(log2 n_samples)) and applied with the margin
+ * bit-width adjustment and the renorm of tt_dense_train.
+ *
+ * @param W Pointer to the weight tensor, updated in place.
+ * @param G Pointer to n_grad packed gradients (tt_dense_grad_pack).
+ * @param n_grad Number of gradients.
+ * @param n_samples Number of samples summed into all gradients.
+ * @param acc Pointer to an int32 scratch buffer [W->len].
+ */
+void tt_dense_update(tensor_t *W, const tensor_t *G, size_t n_grad, size_t n_samples, int32_t *acc)
+{
+    if (!W || !G || !n_grad || !n_samples || !acc) return;
+
+    /* 1. common header: the coarsest gradient */
+    _scale_t ref = s_hdr(&G[0]);
+    for (size_t i = 1; i < n_grad; ++i)
+        if (s_hdr(&G[i]).S < ref.S) ref = s_hdr(&G[i]);
+
+    /* 2. align and sum ------------------------------------------------ */
+    memset(acc, 0, W->len * sizeof(int32_t));
+    for (size_t i = 0; i < n_grad; ++i) {
+        _scale_t g = s_hdr(&G[i]);
+        int8_t dS = ref.S - g.S;
+        int8_t dU = ref.U - g.U;
+        int8_t dD = ref.D - g.D;
+        tt_grad_map_t map;
+        if (dS || dU > 0 || dD > 0) {
+            tt_grad_map_init(&map, 0, dS, dU, dD);
+            tt_grad_accum(acc, G[i].data, W->len, &map);
+        } else {
+            tt_grad_accum(acc, G[i].data, W->len, NULL);
+        }
+    }
+
+    /* 3. mean and margin adjustment folded into one shift ------------- */
+    int e    = s_hdr(W).S - ref.S;                               /* sums are 2^e in W frame */
+    int lg_n = bitwidth32((int32_t)n_samples) - 1;
+    int bw_g = bitwidth32(tt_max_abs_i32(acc, W->len)) + e - lg_n;
+    int b    = (int)bitwidth32(tt_max_abs_i8(W->data, W->len)) - MARGIN;
+    int shift_adj = bw_g - b;
+    if (shift_adj < 0) shift_adj = 0;
+    int sh = lg_n - e + shift_adj;
+    if (sh >  31) sh =  31;
+    if (sh < -31) sh = -31;
+
+    /* 4. SGD update and renorm ---------------------------------------- */
+    int maxw = tt_sgd_apply32(W->data, acc, W->len, (int8_t)sh);
+    s_renorm(W, maxw);
+}
+
+static void s_renorm(tensor_t *W, int maxw)
+{
+    _scale_t h = s_hdr(W);
     if (maxw > 112) {
-        for (size_t i = 0; i < W->len; ++i)
-            W->data[i] = downscale_4_5(W->data[i]);
-        W->s.D++;
+        tt_rescale_i8(W->data, W->len, -1);
+        h.D++;
+        TT_PROF_COUNT(n_w_down, 1);
     } else if (maxw < 32) {
-        for (size_t i = 0; i < W->len; ++i)
-            W->data[i] = upscale_4_3(W->data[i]);
-        W->s.U++;
+        tt_rescale_i8(W->data, W->len, +1);
+        h.U++;
+        TT_PROF_COUNT(n_w_up, 1);
+    } else {
+        return;
     }
+    s_hdr_set(W, h);
+}
 
-    /* 5. error to previous layer: Wᵀ·err_next --------------------- */
-    for (size_t c = 0; c < IN; ++c) {
-        int32_t acc = 0;
-        for (size_t r = 0; r < OUT; ++r) {
-            acc += (int32_t)W->data[r*IN + c] * err_next->data[r];
-        }
-        err_prev->data[c] = clip_int8( shift_and_round32(acc, 7) );  /* quick */
+static void s_backprop(const tensor_t *W, const matrix_tile_t *t, const tensor_t *err_next, tensor_t *err_prev)
+{
+    if (t) {
+        /* the tiles stream row block by row block, no stride of IN */
+        matrix_tmul_tile(t, W->data, err_next->data, 7, err_prev->data);
+    } else {
+        /* rows summed into int32 column panels, W read row-major */
+        matrix_tmul(W, err_next, 7, err_prev);
     }
-    err_prev->s.S = W->s.S + err_next->s.S - 7;
+    _scale_t h = s_hdr(err_prev);
+    h.S = s_hdr(W).S + s_hdr(err_next).S - 7;
+    s_hdr_set(err_prev, h);
+}
+
+/**
+ * @brief Binds tiled storage to a dense weight tensor.
+ *
+ * W->data becomes mem in the tile order of matrix_tile.h, zeroed, and W->len
+ * its MATRIX_TILE_LEN(rows, cols) bytes, pads included, so the elementwise
+ * paths (tt_dense_grad_pack, tt_dense_update, a G of W->len) run on the
+ * tiles as they are. Fill it with matrix_tile_pack, once at load, or at
+ * matrix_tile_idx.
+ *
+ * @param W Pointer to the weight tensor, W->ext is set to t.
+ * @param t Pointer to the geometry, owned by the caller.
+ * @param mem Pointer to MATRIX_TILE_LEN(rows, cols) bytes, 64-byte aligned.
+ * @param rows Number of rows (OUT).
+ * @param cols Number of columns (IN).
+ * @return int 0 on success, -1 on bad arguments.
+ */
+int tt_tiled_weights_init(tensor_t *W, matrix_tile_t *t, int8_t *mem, size_t rows, size_t cols) {
+    if (!W || !mem || ((uintptr_t)mem & 63) || matrix_tile_init(t, rows, cols) < 0) return -1;
+    W->data = mem;
+    W->len  = MATRIX_TILE_LEN(rows, cols);
+    W->ext  = t;
+    memset(mem, 0, W->len);
+    return 0;
+}
+
+/**
+ * @brief Forward pass on tiled weights, then the tt epilogue.
+ */
+void tt_tiled_dense_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || acc_size != Y->len) return;
+    const matrix_tile_t *t = (const matrix_tile_t *)W->ext;
+    if (t->rows != Y->len || t->cols != X->len) return;
+    TT_PROF_MARK(tm);
+
+    // one 64-byte tile against 4 inputs at a time
+    matrix_mul_tile(t, W->data, X->data, acc_buffer);
+    TT_PROF_LAP(tm, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(tm, cyc_epilogue);
+}
+
+/* x is N rows of IN, y N rows of OUT, one header per batch */
+void tt_tiled_dense_forward_batch(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t N, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || !N || acc_size != Y->len) return;
+    const matrix_tile_t *t = (const matrix_tile_t *)W->ext;
+    if ((size_t)t->rows * N != Y->len || (size_t)t->cols * N != X->len) return;
+    TT_PROF_MARK(tm);
+
+    for (size_t n = 0; n < N; ++n)
+        matrix_mul_tile(t, W->data, X->data + n * t->cols, acc_buffer + n * t->rows);
+    TT_PROF_LAP(tm, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(tm, cyc_epilogue);
+}
+
+/**
+ * @brief tt_dense_train on tiled weights: the gradient is formed in the
+ * tile order and Wᵀ·err_next streams the tiles.
+ */
+void tt_tiled_dense_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, tensor_t *G_buffer) {
+    if (!W || !W->ext) return;
+    s_train(W, (const matrix_tile_t *)W->ext, x, err_next, err_prev, G_buffer);
+}
+
+/* tt_dense_grad on tiled weights, acc in the tile order [W->len] */
+void tt_tiled_dense_grad(const tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, int32_t *acc) {
+    if (!W || !W->ext || !x || !err_next || !err_prev || !acc) return;
+    s_grad(W, (const matrix_tile_t *)W->ext, x, err_next, err_prev, acc);
 }
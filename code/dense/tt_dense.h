@@ -2,9 +2,43 @@
 #ifndef TT_DENSE_H
 #define TT_DENSE_H
 #include "tt_types.h"
+#include "activations.h"
+#include "tt_epilogue.h"
+#include "matrix.h"
+#include "matrix_tile.h"
 
-/* forward pass:  y = ReLU(W · x)  (Tin‑Tin scaling handled internally) */
-void tt_dense_forward( const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf);
+/* forward pass:  y = act(W · x)  (Tin‑Tin scaling handled internally),
+   W->ext NULL or its matrix_acc_t plan (int16 accumulation, see matrix.h) */
+void tt_dense_forward( const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+/* batched forward: x is N x IN, y is N x OUT, one scale header per batch */
+void tt_dense_forward_batch(const tensor_t *w, const tensor_t *x, tensor_t *y, size_t n, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+/* shared epilogue: activation, requantization of Y->len accumulators, Y header from W and x */
+void tt_dense_epilogue(const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, tt_act_t act);
+/* header part of the epilogue: y header from W, x and the applied shift / rescale (before table activations) */
+void tt_dense_epilogue_scale(const tensor_t *w, const tensor_t *x, tt_epilogue_t e, scale_t *s);
 void tt_dense_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);  /* output */
 
+/* binds an int16 accumulation plan to W (W->ext), unplanned (int32) until the first sync; 0 or -1 */
+int  tt_dense_weights_init(tensor_t *w, matrix_acc_t *plan, size_t cols);
+/* re-plans from the weights, after every write to them (update, load, randomize) */
+void tt_dense_weights_sync(tensor_t *w);
+
+/* minibatch training split: per-sample gradient sums (w read only), int8 pack, one update */
+void tt_dense_grad(const tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, int32_t *acc);
+void tt_dense_grad_pack(const tensor_t *w, const int32_t *acc, tensor_t *g);
+void tt_dense_update(tensor_t *w, const tensor_t *g, size_t n_grad, size_t n_samples, int32_t *acc);
+
+/*
+ * tiled weights: W->data in the 16 x 4 tiles of matrix_tile.h, W->len their
+ * padded length, W->ext the geometry. Same rules as above on the tiles; the
+ * gradient (G, acc) takes the tile order too, so tt_dense_grad_pack and
+ * tt_dense_update apply unchanged.
+ */
+/* binds MATRIX_TILE_LEN(rows, cols) bytes of 64-byte aligned mem to W, zeroed; 0 or -1 */
+int  tt_tiled_weights_init(tensor_t *w, matrix_tile_t *t, int8_t *mem, size_t rows, size_t cols);
+void tt_tiled_dense_forward(const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_tiled_dense_forward_batch(const tensor_t *w, const tensor_t *x, tensor_t *y, size_t n, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_tiled_dense_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);
+void tt_tiled_dense_grad(const tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, int32_t *acc);
+
 #endif
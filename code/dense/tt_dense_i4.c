@@ -0,0 +1,118 @@
+#include "tt_dense_i4.h"
+#include "tt_dense.h"
+#include "matrix_i4.h"
+#include "tt_profile.h"
+
+/* view of W on its int8 shadow weights, for the tt train rules */
+static tensor_t s_shadow(const tensor_t *W) {
+    const tt_i4_ext_t *e = (const tt_i4_ext_t *)W->ext;
+    tensor_t S = *W;
+    S.data = e->shadow;
+    S.ext  = NULL;
+    return S;
+}
+
+/**
+ * @brief Binds int4 storage to a weight tensor.
+ *
+ * @param W Pointer to the weight tensor, len = rows x cols.
+ * @param ext Pointer to the extension record, kept in W->ext.
+ * @param packed Pointer to TT_I4_BYTES(rows, cols) bytes of nibbles.
+ * @param shadow Pointer to rows x cols int8 master weights, may be NULL.
+ * @param rows Number of rows (OUT).
+ * @param cols Number of columns (IN).
+ * @return int 0 on success, -1 on bad arguments.
+ */
+int tt_i4_weights_init(tensor_t *W, tt_i4_ext_t *ext, uint8_t *packed, int8_t *shadow,
+                       size_t rows, size_t cols) {
+    if (!W || !ext || !packed || !rows || !cols || cols > UINT16_MAX) return -1;
+    W->data     = (int8_t *)packed;
+    W->len      = rows * cols;
+    W->ext      = ext;
+    ext->shadow = shadow;
+    ext->cols   = (uint16_t)cols;
+    ext->k      = 0;
+    tt_i4_weights_sync(W);
+    return 0;
+}
+
+void tt_i4_weights_sync(tensor_t *W) {
+    tt_i4_ext_t *e;
+    if (!W || !(e = (tt_i4_ext_t *)W->ext) || !e->shadow) return;
+    e->k = matrix_i4_shift(e->shadow, W->len);
+    matrix_i4_pack((uint8_t *)W->data, e->shadow, W->len / e->cols, e->cols, e->k);
+}
+
+/**
+ * @brief Forward pass on packed int4 weights.
+ *
+ * The accumulators are in nibble units, so the epilogue sees the W header
+ * shifted by the pack shift k; the rest is the tt epilogue.
+ */
+void tt_i4_dense_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || acc_size != Y->len) return;
+    const tt_i4_ext_t *e = (const tt_i4_ext_t *)W->ext;
+    TT_PROF_MARK(t);
+
+    // unpack-in-register int4 x int8 matrix-vector multiplication
+    matrix_mul_i4((const uint8_t *)W->data, Y->len, X, acc_buffer);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tensor_t Wq = *W;
+    scale_shift(&Wq.s, -(int8_t)e->k);
+    tt_dense_epilogue(&Wq, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/* x is N rows of IN, y N rows of OUT, one header per batch */
+void tt_i4_dense_forward_batch(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t N, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || !N || acc_size != Y->len || Y->len % N || X->len % N) return;
+    const tt_i4_ext_t *e = (const tt_i4_ext_t *)W->ext;
+    size_t IN = X->len / N, OUT = Y->len / N;
+    TT_PROF_MARK(t);
+
+    for (size_t n = 0; n < N; ++n) {
+        tensor_t xn = *X;
+        xn.data = X->data + n * IN;
+        xn.len  = IN;
+        matrix_mul_i4((const uint8_t *)W->data, OUT, &xn, acc_buffer + n * OUT);
+    }
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tensor_t Wq = *W;
+    scale_shift(&Wq.s, -(int8_t)e->k);
+    tt_dense_epilogue(&Wq, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/**
+ * @brief Train step: tt_dense_train on the int8 shadow, then repack.
+ * Does nothing for inference-only weights (no shadow).
+ */
+void tt_i4_dense_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, tensor_t *G_buffer) {
+    if (!W || !W->ext || !((tt_i4_ext_t *)W->ext)->shadow) return;
+    tensor_t Ws = s_shadow(W);
+    tt_dense_train(&Ws, x, err_next, err_prev, G_buffer);
+    W->s = Ws.s;
+    tt_i4_weights_sync(W);
+}
+
+void tt_i4_dense_grad(const tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, int32_t *acc) {
+    if (!W || !W->ext || !((tt_i4_ext_t *)W->ext)->shadow) return;
+    tensor_t Ws = s_shadow(W);
+    tt_dense_grad(&Ws, x, err_next, err_prev, acc);
+}
+
+void tt_i4_dense_grad_pack(const tensor_t *W, const int32_t *acc, tensor_t *G) {
+    if (!W || !W->ext || !((tt_i4_ext_t *)W->ext)->shadow) return;
+    tensor_t Ws = s_shadow(W);
+    tt_dense_grad_pack(&Ws, acc, G);
+}
+
+void tt_i4_dense_update(tensor_t *W, const tensor_t *G, size_t n_grad, size_t n_samples, int32_t *acc) {
+    if (!W || !W->ext || !((tt_i4_ext_t *)W->ext)->shadow) return;
+    tensor_t Ws = s_shadow(W);
+    tt_dense_update(&Ws, G, n_grad, n_samples, acc);
+    W->s = Ws.s;
+    tt_i4_weights_sync(W);
+}
@@ -0,0 +1,36 @@
+#ifndef TT_DENSE_I4_H
+#define TT_DENSE_I4_H
+#include "tt_types.h"
+#include "activations.h"
+#include "matrix_i4.h"
+
+/*
+ * int4 weights: W->data holds the packed nibbles (see matrix_i4.h), W->len
+ * the number of weights and W->s the header of the int8 shadow weights.
+ * W->ext points to the tt_i4_ext_t below. Forward only reads the nibbles;
+ * training updates the shadow with the tt rules and repacks.
+ */
+typedef struct {
+    int8_t  *shadow;   /* int8 master weights [len], NULL for inference only */
+    uint16_t cols;     /* row length (IN) */
+    uint8_t  k;        /* a nibble q stands for q << k shadow units */
+} tt_i4_ext_t;
+
+/* packed bytes of a rows x cols int4 matrix */
+#define TT_I4_BYTES(rows, cols) ((size_t)(rows) * MATRIX_I4_ROW_BYTES(cols))
+
+/* binds packed / shadow storage to W and packs the shadow (if any); 0 or -1 */
+int  tt_i4_weights_init(tensor_t *W, tt_i4_ext_t *ext, uint8_t *packed, int8_t *shadow,
+                        size_t rows, size_t cols);
+/* repacks the nibbles from the shadow weights */
+void tt_i4_weights_sync(tensor_t *W);
+
+/* backend slots, same contracts as tt_dense.h */
+void tt_i4_dense_forward(const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_i4_dense_forward_batch(const tensor_t *w, const tensor_t *x, tensor_t *y, size_t n, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_i4_dense_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);
+void tt_i4_dense_grad(const tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, int32_t *acc);
+void tt_i4_dense_grad_pack(const tensor_t *w, const int32_t *acc, tensor_t *g);
+void tt_i4_dense_update(tensor_t *w, const tensor_t *g, size_t n_grad, size_t n_samples, int32_t *acc);
+
+#endif
@@ -0,0 +1,191 @@
+#include "tt_dense_sparse.h"
+#include "tt_dense.h"
+#include "tt_math.h"
+#include "tt_profile.h"
+
+/* zero block (br, bc) of the dense W */
+static void s_zero_block(int8_t *W, const matrix_sp_t *sp, size_t br, size_t bc) {
+    size_t r0 = br * MATRIX_SP_BR, c0 = bc * MATRIX_SP_BC;
+    size_t r1 = r0 + MATRIX_SP_BR < sp->rows ? r0 + MATRIX_SP_BR : sp->rows;
+    size_t c1 = c0 + MATRIX_SP_BC < sp->cols ? c0 + MATRIX_SP_BC : sp->cols;
+    for (size_t r = r0; r < r1; ++r)
+        for (size_t c = c0; c < c1; ++c) W[r * sp->cols + c] = 0;
+}
+
+/* zero every block of W that is not kept, then refresh the tiles */
+static void s_mask_sync(tensor_t *W) {
+    matrix_sp_t *sp = (matrix_sp_t *)W->ext;
+    for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br) {
+        uint32_t k = sp->row_ptr[br], end = sp->row_ptr[br + 1];
+        for (size_t bc = 0; bc < MATRIX_SP_NBC(sp->cols); ++bc) {
+            if (k < end && sp->blk_col[k] == bc) { ++k; continue; }
+            s_zero_block(W->data, sp, br, bc);
+        }
+    }
+    matrix_sp_build(sp, W->data);
+}
+
+/* S/U/D the int8 values are expressed in (global + local when nested) */
+static _scale_t s_eff_hdr(const tensor_t *W) {
+#ifdef TENSOR_USE_NESTED
+    _scale_t h = { (int8_t)(W->s.g.S + W->s.l.S), (int8_t)(W->s.g.U + W->s.l.U), (int8_t)(W->s.g.D + W->s.l.D) };
+    return h;
+#else
+    return W->s;
+#endif
+}
+
+/* block L1 in the units of the reference header */
+static int32_t s_score(const tensor_t *W, size_t br, size_t bc, tt_mult_t m) {
+    return tt_mult_apply((int32_t)matrix_sp_block_l1((const matrix_sp_t *)W->ext, W->data, br, bc), m);
+}
+
+/**
+ * @brief Binds block-sparse storage to a dense weight tensor.
+ *
+ * @param W Pointer to the weight tensor, len = rows x cols.
+ * @param sp Pointer to the index, kept in W->ext.
+ * @param mem Pointer to MATRIX_SP_BYTES(rows, cols) bytes, 64-byte aligned.
+ * @param rows Number of rows (OUT).
+ * @param cols Number of columns (IN).
+ * @return int 0 on success, -1 on bad arguments.
+ */
+int tt_sparse_weights_init(tensor_t *W, matrix_sp_t *sp, void *mem, size_t rows, size_t cols) {
+    if (!W || !W->data || W->len != rows * cols) return -1;
+    if (matrix_sp_init(sp, mem, rows, cols) < 0) return -1;
+    W->ext = sp;
+    matrix_sp_build(sp, W->data);
+    return 0;
+}
+
+size_t tt_sparse_weights_sync(tensor_t *W) {
+    if (!W || !W->ext) return 0;
+    return matrix_sp_build((matrix_sp_t *)W->ext, W->data);
+}
+
+/**
+ * @brief Joint magnitude pruning of block-sparse tensors.
+ *
+ * Each tensor's block L1 is multiplied by tt_align_mult of the distance from
+ * its header to the finest header of the set, which puts every score in the
+ * same units. The threshold is the smallest score t with at least the
+ * target count of blocks <= t; blocks below t are zeroed, then blocks equal
+ * to t in index order until the target is met.
+ *
+ * @param W Array of n block-sparse weight tensors.
+ * @param n Number of tensors.
+ * @param pct Target percentage of zero blocks (0..100).
+ * @return size_t Number of zero blocks after pruning.
+ */
+size_t tt_sparse_prune(tensor_t *const *W, size_t n, uint8_t pct) {
+    if (!W || !n || n > TT_SPARSE_MAX_TENSORS || pct > 100) return 0;
+
+    /* reference header: the finest S/U/D of the set, every delta >= 0 */
+    _scale_t ref = s_eff_hdr(W[0]);
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!W[i] || !W[i]->ext) return 0;
+        const matrix_sp_t *sp = (const matrix_sp_t *)W[i]->ext;
+        _scale_t h = s_eff_hdr(W[i]);
+        if (h.S > ref.S) ref.S = h.S;
+        if (h.U > ref.U) ref.U = h.U;
+        if (h.D > ref.D) ref.D = h.D;
+        total += MATRIX_SP_NBR(sp->rows) * MATRIX_SP_NBC(sp->cols);
+    }
+    tt_mult_t mult[TT_SPARSE_MAX_TENSORS];
+    int32_t max_score = 0;
+    for (size_t i = 0; i < n; ++i) {
+        _scale_t h = s_eff_hdr(W[i]);
+        int dS = ref.S - h.S;
+        mult[i] = tt_align_mult((int8_t)(dS > 16 ? 16 : dS), (uint8_t)(ref.U - h.U), (uint8_t)(ref.D - h.D));
+        const matrix_sp_t *sp = (const matrix_sp_t *)W[i]->ext;
+        for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br)
+            for (size_t bc = 0; bc < MATRIX_SP_NBC(sp->cols); ++bc) {
+                int32_t sc = s_score(W[i], br, bc, mult[i]);
+                if (sc > max_score) max_score = sc;
+            }
+    }
+
+    size_t target = total * pct / 100;
+    if (target) {
+        /* smallest t with count(score <= t) >= target */
+        int32_t lo = 0, hi = max_score;
+        while (lo < hi) {
+            int32_t mid = lo + (hi - lo) / 2;
+            size_t cnt = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const matrix_sp_t *sp = (const matrix_sp_t *)W[i]->ext;
+                for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br)
+                    for (size_t bc = 0; bc < MATRIX_SP_NBC(sp->cols); ++bc)
+                        cnt += s_score(W[i], br, bc, mult[i]) <= mid;
+            }
+            if (cnt >= target) hi = mid; else lo = mid + 1;
+        }
+
+        /* zero the blocks below t, then the ties up to the target */
+        size_t zeroed = 0;
+        for (int pass = 0; pass < 2; ++pass)
+            for (size_t i = 0; i < n; ++i) {
+                const matrix_sp_t *sp = (const matrix_sp_t *)W[i]->ext;
+                for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br)
+                    for (size_t bc = 0; bc < MATRIX_SP_NBC(sp->cols); ++bc) {
+                        int32_t sc = s_score(W[i], br, bc, mult[i]);
+                        if (pass == 0 ? sc >= lo : (sc != lo || zeroed >= target)) continue;
+                        s_zero_block(W[i]->data, sp, br, bc);
+                        ++zeroed;
+                    }
+            }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i) kept += tt_sparse_weights_sync(W[i]);
+    return total - kept;
+}
+
+/**
+ * @brief Forward pass on the kept blocks, then the tt epilogue.
+ */
+void tt_sparse_dense_forward(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || acc_size != Y->len) return;
+    const matrix_sp_t *sp = (const matrix_sp_t *)W->ext;
+    if (sp->rows != Y->len || sp->cols != X->len) return;
+    TT_PROF_MARK(t);
+
+    // block-sparse matrix-vector multiplication
+    matrix_mul_sp(sp, X->data, acc_buffer);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/* x is N rows of IN, y N rows of OUT, one header per batch */
+void tt_sparse_dense_forward_batch(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t N, int32_t *acc_buffer, size_t acc_size, tt_act_t act) {
+    if (!W || !X || !Y || !W->ext || !acc_buffer || !N || acc_size != Y->len) return;
+    const matrix_sp_t *sp = (const matrix_sp_t *)W->ext;
+    if ((size_t)sp->rows * N != Y->len || (size_t)sp->cols * N != X->len) return;
+    TT_PROF_MARK(t);
+
+    for (size_t n = 0; n < N; ++n)
+        matrix_mul_sp(sp, X->data + n * sp->cols, acc_buffer + n * sp->rows);
+    TT_PROF_LAP(t, cyc_gemv);
+
+    tt_dense_epilogue(W, X, Y, acc_buffer, act);
+    TT_PROF_LAP(t, cyc_epilogue);
+}
+
+/**
+ * @brief Dense tt train step, then the pruned blocks are zeroed again and
+ * the tiles refreshed.
+ */
+void tt_sparse_dense_train(tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev, tensor_t *G_buffer) {
+    if (!W || !W->ext) return;
+    tt_dense_train(W, x, err_next, err_prev, G_buffer);
+    s_mask_sync(W);
+}
+
+void tt_sparse_dense_update(tensor_t *W, const tensor_t *G, size_t n_grad, size_t n_samples, int32_t *acc) {
+    if (!W || !W->ext) return;
+    tt_dense_update(W, G, n_grad, n_samples, acc);
+    s_mask_sync(W);
+}
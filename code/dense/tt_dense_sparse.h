@@ -0,0 +1,38 @@
+#ifndef TT_DENSE_SPARSE_H
+#define TT_DENSE_SPARSE_H
+#include "tt_types.h"
+#include "activations.h"
+#include "matrix_sparse.h"
+
+/*
+ * block-sparse weights: W->data keeps the dense [out x in] int8 master and
+ * W->ext points to the matrix_sp_t tiles of its kept blocks
+ * (matrix_sparse.h). Forward runs the block GEMV on the tiles. Training
+ * runs the tt rules on the dense array, zeroes the pruned blocks again and
+ * refreshes the tiles, so the pattern only changes through tt_sparse_prune.
+ */
+
+/* most tensors one tt_sparse_prune call ranks together */
+#define TT_SPARSE_MAX_TENSORS   (64)
+
+/* binds MATRIX_SP_BYTES(rows, cols) of 64-byte aligned mem to W and keeps its non-zero blocks; 0 or -1 */
+int    tt_sparse_weights_init(tensor_t *W, matrix_sp_t *sp, void *mem, size_t rows, size_t cols);
+/* keeps the non-zero blocks of W and refreshes their tiles, e.g. after loading new weights */
+size_t tt_sparse_weights_sync(tensor_t *W);
+
+/*
+ * magnitude pruning over n block-sparse tensors: the blocks with the lowest
+ * sum |w| are zeroed until pct % of all blocks are zero, then every index is
+ * rebuilt. Block magnitudes are brought to one common scale through each
+ * tensor's S/U/D header, so a single threshold spans layers whose headers
+ * have drifted apart. Returns the number of zero blocks.
+ */
+size_t tt_sparse_prune(tensor_t *const *W, size_t n, uint8_t pct);
+
+/* backend slots, same contracts as tt_dense.h */
+void tt_sparse_dense_forward(const tensor_t *w, const tensor_t *x, tensor_t *y, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_sparse_dense_forward_batch(const tensor_t *w, const tensor_t *x, tensor_t *y, size_t n, int32_t *acc_buf, size_t acc_size, tt_act_t act);
+void tt_sparse_dense_train(tensor_t *w, const tensor_t *x, const tensor_t *error_next, tensor_t *error_prev, tensor_t *buffer);
+void tt_sparse_dense_update(tensor_t *w, const tensor_t *g, size_t n_grad, size_t n_samples, int32_t *acc);
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file tt_epilogue.h
+ * @brief fused requantization epilogue shared by the dense forward passes
+ * @details activation, max bit-width, shift-and-round, int8 clip, max-abs and the
+ * conditional 4/3 or 4/5 rescale in two passes over the accumulators, with
+ * every helper inlined.
+ *
+ * The max-abs of the int8 output does not need its own pass: shift-and-round
+ * and clip are monotone and odd, so the largest output is
+ * clip(shift_round(max-abs act(acc))), which is known after the first pass.
+ * The rescale decision is therefore taken before any output is written and
+ * the 4/3 or 4/5 step is applied as the values are stored.
+ * @license MIT
+ */
+#ifndef TT_EPILOGUE_H
+#define TT_EPILOGUE_H
+
+#include <limits.h>
+#include "tt_utils.h"
+#include "tt_types.h"
+#include "activations.h"
+
+/* rescale thresholds on the int8 max-abs output (1/4 and 7/8 of full range) */
+#define TT_EPI_T_LOW   ((1 << (CHAR_BIT - 1)) / 4)
+#define TT_EPI_T_HIGH  (((1 << (CHAR_BIT - 1)) * 7) / 8)
+
+/* what the epilogue did, for the caller's scale header update */
+typedef struct {
+    uint8_t ksh;      /* right shift applied to the accumulators */
+    int8_t  rescale;  /* +1 upscaled (4/3), -1 downscaled (4/5), 0 none */
+} tt_epilogue_t;
+
+/* activations of the int32 accumulators, leaky matches leaky_relu_i8 (slope 1/4) */
+#define TT_EPI_RELU(a)    ((a) < 0 ? 0 : (a))
+#define TT_EPI_LEAKY(a)   ((a) < 0 ? ((a) >> 2) : (a))
+#define TT_EPI_LINEAR(a)  (a)
+
+/**
+ * @brief defines a fused activation + requantization of int32 accumulators
+ *
+ * Pass 1 reads the accumulators for the max-abs of ACT(acc) (which gives
+ * the bit-width, the shift and the output max-abs). Pass 2 writes y =
+ * clip(round(ACT(acc) >> ksh)) with the selected rescale folded in. acc is
+ * not modified. ACT is expanded into both loops, one function per
+ * activation, so there is no call per element.
+ *
+ * NAME(acc, y, len) returns the applied shift and rescale (tt_epilogue_t).
+ */
+#define TT_EPILOGUE_DEFINE(NAME, ACT)                                            \
+static inline tt_epilogue_t NAME(const int32_t *acc, int8_t *y, size_t len)      \
+{                                                                                \
+    tt_epilogue_t e = { 0, 0 };                                                  \
+                                                                                 \
+    /* pass 1: max-abs of ACT(acc) */                                            \
+    int32_t maxa = 0;                                                            \
+    for (size_t i = 0; i < len; ++i) {                                           \
+        int32_t a = ACT(acc[i]);                                                 \
+        a = a < 0 ? -a : a;                                                      \
+        maxa = a > maxa ? a : maxa;                                              \
+    }                                                                            \
+                                                                                 \
+    /* int8 holds 7 magnitude bits, a wider max would be clipped */              \
+    uint8_t bw = bitwidth32(maxa);                                               \
+    e.ksh = (bw > CHAR_BIT - 1) ? (uint8_t)(bw - (CHAR_BIT - 1)) : 0;            \
+                                                                                 \
+    int8_t maxv = clip_int8(shift_round32_inline(maxa, e.ksh));                  \
+    if      (maxv < TT_EPI_T_LOW)  e.rescale = +1;                               \
+    else if (maxv > TT_EPI_T_HIGH) e.rescale = -1;                               \
+                                                                                 \
+    /* pass 2: activation, shift-round, clip and rescale on the way out */       \
+    const uint8_t ksh = e.ksh;                                                   \
+    if (e.rescale > 0) {                                                         \
+        for (size_t i = 0; i < len; ++i)                                         \
+            y[i] = upscale_4_3_inline(clip_int8(shift_round32_inline(ACT(acc[i]), ksh))); \
+    } else if (e.rescale < 0) {                                                  \
+        for (size_t i = 0; i < len; ++i)                                         \
+            y[i] = downscale_4_5_inline(clip_int8(shift_round32_inline(ACT(acc[i]), ksh))); \
+    } else {                                                                     \
+        for (size_t i = 0; i < len; ++i)                                         \
+            y[i] = clip_int8(shift_round32_inline(ACT(acc[i]), ksh));            \
+    }                                                                            \
+    return e;                                                                    \
+}
+
+TT_EPILOGUE_DEFINE(tt_epilogue_relu,   TT_EPI_RELU)
+TT_EPILOGUE_DEFINE(tt_epilogue_leaky,  TT_EPI_LEAKY)
+TT_EPILOGUE_DEFINE(tt_epilogue_linear, TT_EPI_LINEAR)
+
+/**
+ * @brief epilogue of a layer activation, one branch per call
+ *
+ * Table activations (sigmoid, tanh) depend on the output header, so their
+ * accumulators go through the linear epilogue and the caller applies the
+ * table once the header is known (tt_act_lut_tensor).
+ */
+static inline tt_epilogue_t tt_epilogue_act(tt_act_t act, const int32_t *acc, int8_t *y, size_t len)
+{
+    switch (act) {
+    case TT_ACT_RELU:  return tt_epilogue_relu(acc, y, len);
+    case TT_ACT_LEAKY: return tt_epilogue_leaky(acc, y, len);
+    default:           return tt_epilogue_linear(acc, y, len);
+    }
+}
+
+/**
+ * @brief pass 2 alone, with a shift and rescale chosen earlier
+ *
+ * For values that must share a header fixed by a previous call (e.g. the
+ * newest column of a streamed layer). Outputs past int8 saturate.
+ */
+static inline void tt_epilogue_fixed(tt_act_t act, const int32_t *acc, int8_t *y, size_t len, tt_epilogue_t e)
+{
+    for (size_t i = 0; i < len; ++i) {
+        int32_t a = acc[i];
+        if      (act == TT_ACT_RELU)  a = TT_EPI_RELU(a);
+        else if (act == TT_ACT_LEAKY) a = TT_EPI_LEAKY(a);
+        int8_t v = clip_int8(shift_round32_inline(a, e.ksh));
+        y[i] = e.rescale > 0 ? upscale_4_3_inline(v) : e.rescale < 0 ? downscale_4_5_inline(v) : v;
+    }
+}
+
+#endif // TT_EPILOGUE_H
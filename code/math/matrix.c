@@ -1,12 +1,734 @@
 #include "matrix.h"
+#include "tt_utils.h"
+#include <limits.h>
+#include <string.h>
 /**
- * @file matrix.h
+ * @file matrix.c
  * @brief mat multiplication in int32_t with accumulator and other operations
+ * @details scalar reference plus SSE4.1, AVX2, AVX-512 VNNI and NEON (sdot)
+ * kernels, and int16-accumulating SSSE3, AVX2 and NEON kernels for weights
+ * the planner bounds. x86 kernels are compiled with per-function target attributes so the
+ * file builds without -m flags; the kernel is chosen once from tt_cpu_isa().
+ * The transposed product of backprop sums whole rows into int32 column
+ * panels (scalar: MATRIX_TMUL_BLOCK lanes in L1; AVX2: 64 columns in
+ * registers, two rows per pmaddwd; NEON: 64 columns, smlal per row) and
+ * requantizes each panel as it completes.
  * @author Shreyas Poyrekar
  * @date May 7, 2025
  * @license MIT
  */
 
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/* ---------- scalar reference ------------------------------------------ */
+
+/**
+ * @brief scalar int8 dot product
+ * @param a pointer of first vector
+ * @param b pointer of second vector
+ * @param n number of elements
+ * @return int32_t sum of products
+ */
+static int32_t s_dot_scalar(const int8_t *a, const int8_t *b, size_t n) {
+    int32_t sum = 0;
+    for (size_t c = 0; c < n; ++c) {
+        sum += (int32_t)a[c] * (int32_t)b[c];
+    }
+    return sum;
+}
+
+/**
+ * @brief scalar matrix-vector product, the reference every kernel must match
+ * @param W pointer of row-major weights [rows x cols]
+ * @param x pointer of activations [cols]
+ * @param y pointer of int32 outputs [rows]
+ * @param rows number of output rows
+ * @param cols number of input columns
+ * @return NULL
+ */
+static void s_gemv_scalar(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) {
+        y[r] = s_dot_scalar(&W[r * cols], x, cols);
+    }
+    return;
+}
+
+/**
+ * @brief scalar transposed product, rows summed into int32 column blocks
+ * @param W pointer of row-major weights [rows x cols]
+ * @param e pointer of errors [rows]
+ * @param y pointer of int8 outputs [cols]
+ * @param rows number of weight rows
+ * @param cols number of weight columns
+ * @param shift rounded right shift of the sums
+ * @return NULL
+ */
+static void s_tmul_scalar(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols, uint8_t shift) {
+    int32_t sum[MATRIX_TMUL_BLOCK];
+    for (size_t c0 = 0; c0 < cols; c0 += MATRIX_TMUL_BLOCK) {
+        size_t n = cols - c0 < MATRIX_TMUL_BLOCK ? cols - c0 : MATRIX_TMUL_BLOCK;
+        memset(sum, 0, n * sizeof(int32_t));
+        for (size_t r = 0; r < rows; ++r) {
+            const int8_t *w = &W[r * cols + c0];
+            int32_t er = e[r];
+            for (size_t j = 0; j < n; ++j) sum[j] += (int32_t)w[j] * er;
+        }
+        for (size_t j = 0; j < n; ++j) y[c0 + j] = clip_int8(shift_round32_inline(sum[j], shift));
+    }
+    return;
+}
+
+#if defined(MATRIX_X86) || defined(MATRIX_ARM64)
+/* last columns of a SIMD kernel, fewer than one vector: column by column */
+static void s_tmul_tail(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols,
+                        size_t c0, uint8_t shift) {
+    for (size_t c = c0; c < cols; ++c) {
+        int32_t sum = 0;
+        for (size_t r = 0; r < rows; ++r) sum += (int32_t)W[r * cols + c] * (int32_t)e[r];
+        y[c] = clip_int8(shift_round32_inline(sum, shift));
+    }
+    return;
+}
+#endif
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_X86
+
+/*
+ * SSE4.1 / AVX2: sign-extend to int16 (pmovsxbw) and multiply-add pairs into
+ * int32 (pmaddwd). pmaddubsw is not used because its int16 saturation breaks
+ * bit-exactness for -128 * -128 pairs.
+ */
+__attribute__((target("sse4.1")))
+static int32_t s_dot_sse41(const int8_t *a, const int8_t *b, size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    size_t c = 0;
+    for (; c + 16 <= n; c += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + c));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + c));
+        __m128i alo = _mm_cvtepi8_epi16(va);
+        __m128i blo = _mm_cvtepi8_epi16(vb);
+        __m128i ahi = _mm_cvtepi8_epi16(_mm_srli_si128(va, 8));
+        __m128i bhi = _mm_cvtepi8_epi16(_mm_srli_si128(vb, 8));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(alo, blo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(ahi, bhi));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(acc);
+    for (; c < n; ++c) sum += (int32_t)a[c] * (int32_t)b[c];
+    return sum;
+}
+
+__attribute__((target("sse4.1")))
+static void s_gemv_sse41(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot_sse41(&W[r * cols], x, cols);
+}
+
+__attribute__((target("avx2")))
+static int32_t s_dot_avx2(const int8_t *a, const int8_t *b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t c = 0;
+    for (; c + 32 <= n; c += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + c));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + c));
+        __m256i alo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+        __m256i blo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+        __m256i ahi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+        __m256i bhi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(alo, blo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(ahi, bhi));
+    }
+    if (c + 16 <= n) {
+        __m256i a16 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + c)));
+        __m256i b16 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + c)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a16, b16));
+        c += 16;
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(s);
+    for (; c < n; ++c) sum += (int32_t)a[c] * (int32_t)b[c];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+static void s_gemv_avx2(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot_avx2(&W[r * cols], x, cols);
+}
+
+/*
+ * int16 accumulation (see matrix_acc_plan): |x| as the unsigned operand and
+ * w with the sign of x as the signed one, so pmaddubsw sums two exact
+ * products per int16 lane without the sign-extend. The planner guarantees
+ * |w| <= 127 (no sign flip overflow) and that spill steps of lane sums fit
+ * int16, then pmaddwd by ones widens them into the int32 accumulator.
+ * Steps are 16 or 8 bytes here (32 with AVX2), each adds at most one pair
+ * to every lane.
+ */
+__attribute__((target("ssse3")))
+static int32_t s_dot16_ssse3(const int8_t *w, const int8_t *x, size_t n, size_t spill) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128(), a16 = _mm_setzero_si128();
+    size_t c = 0, k = 0;
+    for (; c + 16 <= n; c += 16) {
+        __m128i vx = _mm_loadu_si128((const __m128i *)(x + c));
+        __m128i vw = _mm_loadu_si128((const __m128i *)(w + c));
+        a16 = _mm_add_epi16(a16, _mm_maddubs_epi16(_mm_abs_epi8(vx), _mm_sign_epi8(vw, vx)));
+        if (++k == spill) {
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(a16, ones));
+            a16 = _mm_setzero_si128();
+            k = 0;
+        }
+    }
+    if (c + 8 <= n) {
+        __m128i vx = _mm_loadl_epi64((const __m128i *)(x + c));
+        __m128i vw = _mm_loadl_epi64((const __m128i *)(w + c));
+        a16 = _mm_add_epi16(a16, _mm_maddubs_epi16(_mm_abs_epi8(vx), _mm_sign_epi8(vw, vx)));
+        c += 8;
+    }
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(a16, ones));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(acc);
+    for (; c < n; ++c) sum += (int32_t)w[c] * (int32_t)x[c];
+    return sum;
+}
+
+/* four rows per pass, |x| shared, sums out through one hadd tree */
+__attribute__((target("ssse3")))
+static void s_gemv16_ssse3(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols, size_t spill) {
+    const __m128i ones = _mm_set1_epi16(1);
+    const size_t c16 = cols & ~(size_t)15;
+    const size_t c8  = cols & ~(size_t)7;
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const int8_t *w0 = W + r * cols, *w1 = w0 + cols, *w2 = w1 + cols, *w3 = w2 + cols;
+        __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+        __m128i a0 = s0, a1 = s0, a2 = s0, a3 = s0;
+        size_t k = 0;
+        for (size_t c = 0; c < c16; c += 16) {
+            __m128i vx = _mm_loadu_si128((const __m128i *)(x + c));
+            __m128i ux = _mm_abs_epi8(vx);
+            a0 = _mm_add_epi16(a0, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadu_si128((const __m128i *)(w0 + c)), vx)));
+            a1 = _mm_add_epi16(a1, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadu_si128((const __m128i *)(w1 + c)), vx)));
+            a2 = _mm_add_epi16(a2, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadu_si128((const __m128i *)(w2 + c)), vx)));
+            a3 = _mm_add_epi16(a3, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadu_si128((const __m128i *)(w3 + c)), vx)));
+            if (++k == spill) {
+                s0 = _mm_add_epi32(s0, _mm_madd_epi16(a0, ones)); a0 = _mm_setzero_si128();
+                s1 = _mm_add_epi32(s1, _mm_madd_epi16(a1, ones)); a1 = _mm_setzero_si128();
+                s2 = _mm_add_epi32(s2, _mm_madd_epi16(a2, ones)); a2 = _mm_setzero_si128();
+                s3 = _mm_add_epi32(s3, _mm_madd_epi16(a3, ones)); a3 = _mm_setzero_si128();
+                k = 0;
+            }
+        }
+        if (c16 < c8) {
+            __m128i vx = _mm_loadl_epi64((const __m128i *)(x + c16));
+            __m128i ux = _mm_abs_epi8(vx);
+            a0 = _mm_add_epi16(a0, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadl_epi64((const __m128i *)(w0 + c16)), vx)));
+            a1 = _mm_add_epi16(a1, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadl_epi64((const __m128i *)(w1 + c16)), vx)));
+            a2 = _mm_add_epi16(a2, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadl_epi64((const __m128i *)(w2 + c16)), vx)));
+            a3 = _mm_add_epi16(a3, _mm_maddubs_epi16(ux, _mm_sign_epi8(_mm_loadl_epi64((const __m128i *)(w3 + c16)), vx)));
+        }
+        s0 = _mm_add_epi32(s0, _mm_madd_epi16(a0, ones));
+        s1 = _mm_add_epi32(s1, _mm_madd_epi16(a1, ones));
+        s2 = _mm_add_epi32(s2, _mm_madd_epi16(a2, ones));
+        s3 = _mm_add_epi32(s3, _mm_madd_epi16(a3, ones));
+        int32_t t[4];
+        _mm_storeu_si128((__m128i *)t, _mm_hadd_epi32(_mm_hadd_epi32(s0, s1), _mm_hadd_epi32(s2, s3)));
+        for (size_t c = c8; c < cols; ++c) {
+            t[0] += (int32_t)w0[c] * (int32_t)x[c];
+            t[1] += (int32_t)w1[c] * (int32_t)x[c];
+            t[2] += (int32_t)w2[c] * (int32_t)x[c];
+            t[3] += (int32_t)w3[c] * (int32_t)x[c];
+        }
+        y[r] = t[0]; y[r + 1] = t[1]; y[r + 2] = t[2]; y[r + 3] = t[3];
+    }
+    for (; r < rows; ++r) y[r] = s_dot16_ssse3(&W[r * cols], x, cols, spill);
+}
+
+__attribute__((target("avx2")))
+static int32_t s_dot16_avx2(const int8_t *w, const int8_t *x, size_t n, size_t spill) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256(), a16 = _mm256_setzero_si256();
+    size_t c = 0, k = 0;
+    for (; c + 32 <= n; c += 32) {
+        __m256i vx = _mm256_loadu_si256((const __m256i *)(x + c));
+        __m256i vw = _mm256_loadu_si256((const __m256i *)(w + c));
+        a16 = _mm256_add_epi16(a16, _mm256_maddubs_epi16(_mm256_abs_epi8(vx), _mm256_sign_epi8(vw, vx)));
+        if (++k == spill) {
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a16, ones));
+            a16 = _mm256_setzero_si256();
+            k = 0;
+        }
+    }
+    /* 16 and 8 byte tails as one more step: 16 in the low lane, 8 in the high one */
+    if (c + 8 <= n) {
+        __m128i x0 = _mm_setzero_si128(), w0 = _mm_setzero_si128();
+        if (c + 16 <= n) {
+            x0 = _mm_loadu_si128((const __m128i *)(x + c));
+            w0 = _mm_loadu_si128((const __m128i *)(w + c));
+            c += 16;
+        }
+        __m128i x1 = _mm_setzero_si128(), w1 = _mm_setzero_si128();
+        if (c + 8 <= n) {
+            x1 = _mm_loadl_epi64((const __m128i *)(x + c));
+            w1 = _mm_loadl_epi64((const __m128i *)(w + c));
+            c += 8;
+        }
+        __m256i vx = _mm256_inserti128_si256(_mm256_castsi128_si256(x0), x1, 1);
+        __m256i vw = _mm256_inserti128_si256(_mm256_castsi128_si256(w0), w1, 1);
+        a16 = _mm256_add_epi16(a16, _mm256_maddubs_epi16(_mm256_abs_epi8(vx), _mm256_sign_epi8(vw, vx)));
+    }
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(a16, ones));
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(s);
+    for (; c < n; ++c) sum += (int32_t)w[c] * (int32_t)x[c];
+    return sum;
+}
+
+/* 32 bytes of x and the tail step, as |x| and x for the sign */
+typedef struct { __m256i u, x; } s_x16_t;
+
+__attribute__((target("avx2")))
+static inline __m256i s_step16_avx2(s_x16_t v, __m256i w) {
+    return _mm256_maddubs_epi16(v.u, _mm256_sign_epi8(w, v.x));
+}
+
+/* 16 + 8 byte tail at c as one 256-bit step (16 in the low lane, 8 in the high one) */
+__attribute__((target("avx2")))
+static inline __m256i s_tail16_avx2(const int8_t *p, size_t c, size_t n) {
+    __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    if (c + 16 <= n) { lo = _mm_loadu_si128((const __m128i *)(p + c)); c += 16; }
+    if (c + 8 <= n)  hi = _mm_loadl_epi64((const __m128i *)(p + c));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+/*
+ * four rows per pass: |x| is formed once per step for all of them and the
+ * four int32 sums leave through one hadd tree
+ */
+__attribute__((target("avx2")))
+static void s_gemv16_avx2(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols, size_t spill) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    const size_t c32 = cols & ~(size_t)31;
+    const size_t c8  = cols & ~(size_t)7;
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const int8_t *w0 = W + r * cols, *w1 = w0 + cols, *w2 = w1 + cols, *w3 = w2 + cols;
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        __m256i a0 = s0, a1 = s0, a2 = s0, a3 = s0;
+        size_t k = 0;
+        for (size_t c = 0; c < c32; c += 32) {
+            s_x16_t v;
+            v.x = _mm256_loadu_si256((const __m256i *)(x + c));
+            v.u = _mm256_abs_epi8(v.x);
+            a0 = _mm256_add_epi16(a0, s_step16_avx2(v, _mm256_loadu_si256((const __m256i *)(w0 + c))));
+            a1 = _mm256_add_epi16(a1, s_step16_avx2(v, _mm256_loadu_si256((const __m256i *)(w1 + c))));
+            a2 = _mm256_add_epi16(a2, s_step16_avx2(v, _mm256_loadu_si256((const __m256i *)(w2 + c))));
+            a3 = _mm256_add_epi16(a3, s_step16_avx2(v, _mm256_loadu_si256((const __m256i *)(w3 + c))));
+            if (++k == spill) {
+                s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(a0, ones)); a0 = _mm256_setzero_si256();
+                s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(a1, ones)); a1 = _mm256_setzero_si256();
+                s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(a2, ones)); a2 = _mm256_setzero_si256();
+                s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(a3, ones)); a3 = _mm256_setzero_si256();
+                k = 0;
+            }
+        }
+        if (c32 < c8) {
+            s_x16_t v;
+            v.x = s_tail16_avx2(x, c32, cols);
+            v.u = _mm256_abs_epi8(v.x);
+            a0 = _mm256_add_epi16(a0, s_step16_avx2(v, s_tail16_avx2(w0, c32, cols)));
+            a1 = _mm256_add_epi16(a1, s_step16_avx2(v, s_tail16_avx2(w1, c32, cols)));
+            a2 = _mm256_add_epi16(a2, s_step16_avx2(v, s_tail16_avx2(w2, c32, cols)));
+            a3 = _mm256_add_epi16(a3, s_step16_avx2(v, s_tail16_avx2(w3, c32, cols)));
+        }
+        s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(a0, ones));
+        s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(a1, ones));
+        s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(a2, ones));
+        s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(a3, ones));
+        /* [r0 r1 r2 r3] partial sums in each 128-bit lane */
+        __m256i h = _mm256_hadd_epi32(_mm256_hadd_epi32(s0, s1), _mm256_hadd_epi32(s2, s3));
+        __m128i q = _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+        int32_t t[4];
+        _mm_storeu_si128((__m128i *)t, q);
+        for (size_t c = c8; c < cols; ++c) {
+            t[0] += (int32_t)w0[c] * (int32_t)x[c];
+            t[1] += (int32_t)w1[c] * (int32_t)x[c];
+            t[2] += (int32_t)w2[c] * (int32_t)x[c];
+            t[3] += (int32_t)w3[c] * (int32_t)x[c];
+        }
+        y[r] = t[0]; y[r + 1] = t[1]; y[r + 2] = t[2]; y[r + 3] = t[3];
+    }
+    for (; r < rows; ++r) y[r] = s_dot16_avx2(&W[r * cols], x, cols, spill);
+}
+
+/*
+ * AVX-512 VNNI: vpdpbusd multiplies unsigned x signed bytes. a is biased to
+ * unsigned (a ^ 0x80 == a + 128) and the bias is removed with 128 * sum(b),
+ * which is itself a vpdpbusd against a vector of ones. int32 accumulation is
+ * exact so the result matches the scalar reference bit for bit. The tail uses
+ * masked loads (masked lanes load b = 0 and contribute nothing).
+ */
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static int32_t s_dot_vnni(const int8_t *a, const int8_t *b, size_t n) {
+    const __m512i bias = _mm512_set1_epi8((char)0x80);
+    const __m512i ones = _mm512_set1_epi8(1);
+    __m512i acc  = _mm512_setzero_si512();
+    __m512i sumb = _mm512_setzero_si512();
+    size_t c = 0;
+    for (; c + 64 <= n; c += 64) {
+        __m512i va = _mm512_xor_si512(_mm512_loadu_si512((const void *)(a + c)), bias);
+        __m512i vb = _mm512_loadu_si512((const void *)(b + c));
+        acc  = _mm512_dpbusd_epi32(acc, va, vb);
+        sumb = _mm512_dpbusd_epi32(sumb, ones, vb);
+    }
+    if (c < n) {
+        __mmask64 m = (__mmask64)(~0ULL >> (64 - (n - c)));
+        __m512i va = _mm512_xor_si512(_mm512_maskz_loadu_epi8(m, a + c), bias);
+        __m512i vb = _mm512_maskz_loadu_epi8(m, b + c);
+        acc  = _mm512_dpbusd_epi32(acc, va, vb);
+        sumb = _mm512_dpbusd_epi32(sumb, ones, vb);
+    }
+    acc = _mm512_sub_epi32(acc, _mm512_slli_epi32(sumb, 7));
+    return _mm512_reduce_add_epi32(acc);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void s_gemv_vnni(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot_vnni(&W[r * cols], x, cols);
+}
+
+/*
+ * AVX2 transposed: rows r, r+1 are interleaved bytewise (punpcklbw) and
+ * widened, so one pmaddwd against the broadcast pair (e[r], e[r+1]) adds
+ * both rows to 8 columns. nb 16-column chunks (at most 4, 8 accumulators)
+ * stay in registers over all rows, then round, shift and saturate
+ * (packssdw, packsswb == clip_int8) straight to y.
+ */
+__attribute__((target("avx2"), always_inline))
+static inline void s_tmul_panel_avx2(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols,
+                                     size_t c0, size_t nb, uint8_t shift) {
+    __m256i s[8];
+    for (size_t k = 0; k < 2 * nb; ++k) s[k] = _mm256_setzero_si256();
+    const int8_t *w = W + c0;
+    size_t r = 0;
+    for (; r + 2 <= rows; r += 2, w += 2 * cols) {
+        __m256i ep = _mm256_set1_epi32((int32_t)((uint32_t)(uint16_t)e[r] | ((uint32_t)(uint16_t)e[r + 1] << 16)));
+        for (size_t k = 0; k < nb; ++k) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(w + 16 * k));
+            __m128i b = _mm_loadu_si128((const __m128i *)(w + cols + 16 * k));
+            s[2 * k]     = _mm256_add_epi32(s[2 * k],     _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_unpacklo_epi8(a, b)), ep));
+            s[2 * k + 1] = _mm256_add_epi32(s[2 * k + 1], _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_unpackhi_epi8(a, b)), ep));
+        }
+    }
+    if (r < rows) {
+        __m256i ep = _mm256_set1_epi32((int32_t)(uint16_t)e[r]);
+        for (size_t k = 0; k < nb; ++k) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(w + 16 * k));
+            __m128i z = _mm_setzero_si128();
+            s[2 * k]     = _mm256_add_epi32(s[2 * k],     _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_unpacklo_epi8(a, z)), ep));
+            s[2 * k + 1] = _mm256_add_epi32(s[2 * k + 1], _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_unpackhi_epi8(a, z)), ep));
+        }
+    }
+    /* shift_round32_inline: add 2^(shift-1), one less for negative sums, then arithmetic shift */
+    const __m256i half = _mm256_set1_epi32(shift ? 1 << (shift - 1) : 0);
+    const __m256i nz   = _mm256_set1_epi32(shift ? -1 : 0);
+    const __m128i cnt  = _mm_cvtsi32_si128(shift);
+    for (size_t k = 0; k < 2 * nb; ++k) {
+        __m256i sg = _mm256_and_si256(_mm256_srai_epi32(s[k], 31), nz);
+        __m256i off = _mm256_add_epi32(half, sg);
+        s[k] = _mm256_sra_epi32(_mm256_add_epi32(s[k], off), cnt);
+    }
+    for (size_t k = 0; k < nb; ++k) {
+        __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(s[2 * k], s[2 * k + 1]), 0xD8);
+        _mm_storeu_si128((__m128i *)(y + c0 + 16 * k),
+                         _mm_packs_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1)));
+    }
+}
+
+__attribute__((target("avx2")))
+static void s_tmul_avx2(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols, uint8_t shift) {
+    size_t c = 0;
+    for (; c + 64 <= cols; c += 64) s_tmul_panel_avx2(W, e, y, rows, cols, c, 4, shift);
+    for (; c + 16 <= cols; c += 16) s_tmul_panel_avx2(W, e, y, rows, cols, c, 1, shift);
+    s_tmul_tail(W, e, y, rows, cols, c, shift);
+}
+
+#endif // MATRIX_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_ARM64
+
+/* NEON: widening multiply (smull) then pairwise add-accumulate (sadalp) */
+static int32_t s_dot_neon(const int8_t *a, const int8_t *b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t c = 0;
+    for (; c + 16 <= n; c += 16) {
+        int8x16_t va = vld1q_s8(a + c);
+        int8x16_t vb = vld1q_s8(b + c);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+    }
+    int32_t sum = vaddvq_s32(acc);
+    for (; c < n; ++c) sum += (int32_t)a[c] * (int32_t)b[c];
+    return sum;
+}
+
+static void s_gemv_neon(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot_neon(&W[r * cols], x, cols);
+}
+
+/*
+ * int16 accumulation: smlal sums the products straight into int16 lanes,
+ * two per lane and 16 byte step, sadalp spills them into int32
+ */
+static int32_t s_dot16_neon(const int8_t *w, const int8_t *x, size_t n, size_t spill) {
+    int32x4_t acc = vdupq_n_s32(0);
+    int16x8_t a16 = vdupq_n_s16(0);
+    size_t c = 0, k = 0;
+    for (; c + 16 <= n; c += 16) {
+        int8x16_t vw = vld1q_s8(w + c);
+        int8x16_t vx = vld1q_s8(x + c);
+        a16 = vmlal_s8(a16, vget_low_s8(vw), vget_low_s8(vx));
+        a16 = vmlal_high_s8(a16, vw, vx);
+        if (++k == spill) {
+            acc = vpadalq_s16(acc, a16);
+            a16 = vdupq_n_s16(0);
+            k = 0;
+        }
+    }
+    if (c + 8 <= n) {
+        a16 = vmlal_s8(a16, vld1_s8(w + c), vld1_s8(x + c));
+        c += 8;
+    }
+    acc = vpadalq_s16(acc, a16);
+    int32_t sum = vaddvq_s32(acc);
+    for (; c < n; ++c) sum += (int32_t)w[c] * (int32_t)x[c];
+    return sum;
+}
+
+static void s_gemv16_neon(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols, size_t spill) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot16_neon(&W[r * cols], x, cols, spill);
+}
+
+#ifdef __ARM_FEATURE_DOTPROD
+/* NEON sdot: four int8 products summed straight into each int32 lane */
+static int32_t s_dot_neon_dot(const int8_t *a, const int8_t *b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t c = 0;
+    for (; c + 16 <= n; c += 16) {
+        acc = vdotq_s32(acc, vld1q_s8(a + c), vld1q_s8(b + c));
+    }
+    int32_t sum = vaddvq_s32(acc);
+    for (; c < n; ++c) sum += (int32_t)a[c] * (int32_t)b[c];
+    return sum;
+}
+
+static void s_gemv_neon_dot(const int8_t *W, const int8_t *x, int32_t *y, size_t rows, size_t cols) {
+    for (size_t r = 0; r < rows; ++r) y[r] = s_dot_neon_dot(&W[r * cols], x, cols);
+}
+#endif
+
+/*
+ * NEON transposed: each row is widened and smlal'd into 16-column chunks
+ * (at most 4, 16 accumulators) held over all rows, then rounded, shifted
+ * and saturated (sqxtn twice == clip_int8) straight to y.
+ */
+static inline __attribute__((always_inline))
+void s_tmul_panel_neon(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols,
+                       size_t c0, size_t nb, uint8_t shift) {
+    int32x4_t s[16];
+    for (size_t k = 0; k < 4 * nb; ++k) s[k] = vdupq_n_s32(0);
+    const int8_t *w = W + c0;
+    for (size_t r = 0; r < rows; ++r, w += cols) {
+        int16_t er = e[r];
+        for (size_t k = 0; k < nb; ++k) {
+            int8x16_t wv = vld1q_s8(w + 16 * k);
+            int16x8_t lo = vmovl_s8(vget_low_s8(wv));
+            int16x8_t hi = vmovl_high_s8(wv);
+            s[4 * k]     = vmlal_n_s16(s[4 * k],     vget_low_s16(lo), er);
+            s[4 * k + 1] = vmlal_high_n_s16(s[4 * k + 1], lo, er);
+            s[4 * k + 2] = vmlal_n_s16(s[4 * k + 2], vget_low_s16(hi), er);
+            s[4 * k + 3] = vmlal_high_n_s16(s[4 * k + 3], hi, er);
+        }
+    }
+    /* shift_round32_inline: add 2^(shift-1), one less for negative sums, then
+     * arithmetic shift (vrshr rounds half up) */
+    const int32x4_t half = vdupq_n_s32(shift ? 1 << (shift - 1) : 0);
+    const int32x4_t nz   = vdupq_n_s32(shift ? -1 : 0);
+    const int32x4_t cnt  = vdupq_n_s32(-(int32_t)shift);
+    for (size_t k = 0; k < 4 * nb; ++k) {
+        int32x4_t sg  = vandq_s32(vshrq_n_s32(s[k], 31), nz);
+        int32x4_t off = vaddq_s32(half, sg);
+        s[k] = vshlq_s32(vaddq_s32(s[k], off), cnt);
+    }
+    for (size_t k = 0; k < nb; ++k) {
+        int16x8_t p0 = vcombine_s16(vqmovn_s32(s[4 * k]),     vqmovn_s32(s[4 * k + 1]));
+        int16x8_t p1 = vcombine_s16(vqmovn_s32(s[4 * k + 2]), vqmovn_s32(s[4 * k + 3]));
+        vst1q_s8(y + c0 + 16 * k, vcombine_s8(vqmovn_s16(p0), vqmovn_s16(p1)));
+    }
+}
+
+static void s_tmul_neon(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols, uint8_t shift) {
+    size_t c = 0;
+    for (; c + 64 <= cols; c += 64) s_tmul_panel_neon(W, e, y, rows, cols, c, 4, shift);
+    for (; c + 16 <= cols; c += 16) s_tmul_panel_neon(W, e, y, rows, cols, c, 1, shift);
+    s_tmul_tail(W, e, y, rows, cols, c, shift);
+}
+
+#endif // MATRIX_ARM64
+
+/* ---------- dispatch -------------------------------------------------- */
+
+/*
+ * one immutable table per level; matrix_set_isa publishes a whole table
+ * with a single atomic store, so a concurrent caller sees either the old
+ * or the new set of kernels, never a mix or a missing one
+ */
+typedef struct {
+    tt_isa_t        isa;
+    matrix_dot_t    dot;
+    matrix_gemv_t   gemv;
+    matrix_tmul_t   tmul;
+    matrix_dot16_t  dot16;    /* NULL where int32 is as wide (vnni, sdot, scalar) */
+    matrix_gemv16_t gemv16;
+} matrix_kernels_t;
+
+static const matrix_kernels_t s_k_scalar = {
+    TT_ISA_SCALAR, s_dot_scalar, s_gemv_scalar, s_tmul_scalar, NULL, NULL };
+#ifdef MATRIX_X86
+static const matrix_kernels_t s_k_sse41 = {
+    TT_ISA_SSE41, s_dot_sse41, s_gemv_sse41, s_tmul_scalar, s_dot16_ssse3, s_gemv16_ssse3 };
+static const matrix_kernels_t s_k_avx2 = {
+    TT_ISA_AVX2, s_dot_avx2, s_gemv_avx2, s_tmul_avx2, s_dot16_avx2, s_gemv16_avx2 };
+static const matrix_kernels_t s_k_vnni = {
+    TT_ISA_AVX512_VNNI, s_dot_vnni, s_gemv_vnni, s_tmul_avx2, NULL, NULL };
+#endif
+#ifdef MATRIX_ARM64
+static const matrix_kernels_t s_k_neon = {
+    TT_ISA_NEON, s_dot_neon, s_gemv_neon, s_tmul_neon, s_dot16_neon, s_gemv16_neon };
+#ifdef __ARM_FEATURE_DOTPROD
+static const matrix_kernels_t s_k_neon_dot = {
+    TT_ISA_NEON_DOT, s_dot_neon_dot, s_gemv_neon_dot, s_tmul_neon, NULL, NULL };
+#endif
+#endif
+
+/* NULL until the first call resolves it, then always a full table */
+static const matrix_kernels_t *s_k = NULL;
+
+static const matrix_kernels_t *s_table(tt_isa_t isa) {
+    if (!tt_cpu_supports(isa)) isa = TT_ISA_SCALAR;
+    switch (isa) {
+#ifdef MATRIX_X86
+    case TT_ISA_AVX512_VNNI: return &s_k_vnni;
+    case TT_ISA_AVX2:        return &s_k_avx2;
+    case TT_ISA_SSE41:       return &s_k_sse41;
+#endif
+#ifdef MATRIX_ARM64
+#ifdef __ARM_FEATURE_DOTPROD
+    case TT_ISA_NEON_DOT:    return &s_k_neon_dot;
+#endif
+    case TT_ISA_NEON:        return &s_k_neon;
+#endif
+    default:                 return &s_k_scalar;
+    }
+}
+
+/* kernels in use, resolving to the best level on the first call */
+static inline const matrix_kernels_t *s_kernels(void) {
+    const matrix_kernels_t *k = __atomic_load_n(&s_k, __ATOMIC_ACQUIRE);
+    if (!k) {
+        matrix_init();
+        k = __atomic_load_n(&s_k, __ATOMIC_ACQUIRE);
+    }
+    return k;
+}
+
+/**
+ * @brief forces a kernel level
+ * falls back to the scalar reference if the cpu cannot run the level or it
+ * was not compiled in
+ * @param isa requested instruction set level
+ * @return tt_isa_t level actually in use
+ */
+tt_isa_t matrix_set_isa(tt_isa_t isa) {
+    const matrix_kernels_t *k = s_table(isa);
+    __atomic_store_n(&s_k, k, __ATOMIC_RELEASE);
+    return k->isa;
+}
+
+/**
+ * @brief selects the best kernels for the running cpu, once
+ * racing first callers agree on the table, and a level forced by
+ * matrix_set_isa in the meantime is kept
+ * @return NULL
+ */
+void matrix_init(void) {
+    const matrix_kernels_t *none = NULL;
+    __atomic_compare_exchange_n(&s_k, &none, s_table(tt_cpu_isa()), 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return;
+}
+
+/**
+ * @brief kernel level in use
+ * @return tt_isa_t level, resolved on the first call
+ */
+tt_isa_t matrix_isa(void) {
+    return s_kernels()->isa;
+}
+
+/**
+ * @brief dispatched int8 dot product
+ * @param a pointer of first vector
+ * @param b pointer of second vector
+ * @param n number of elements
+ * @return int32_t sum of products
+ */
+int32_t matrix_dot(const int8_t *a, const int8_t *b, size_t n) {
+    return s_kernels()->dot(a, b, n);
+}
+
+/**
+ * @brief plans the accumulation width of a weight matrix
+ *
+ * A step of the int16 kernels adds at most one pair of products to every
+ * int16 lane, and a pair is bounded by 2 * 128 * (2^w_bw - 1) for weights
+ * of bit-width w_bw against any int8 input. The lanes can therefore sum
+ * INT16_MAX / pair steps before they must spill into int32: one step at
+ * w_bw 7, 4 at w_bw 5, never for w_bw 8 (a -128 weight), which keeps the
+ * int32 kernels. Rows of IN columns take at most ceil(IN / 8) steps, so
+ * small layers never spill before the end of the row.
+ *
+ * @param p pointer of the plan
+ * @param in row length (IN)
+ * @param w_bw eff_bitwidth32 of the largest weight magnitude
+ * @return NULL
+ */
+void matrix_acc_plan(matrix_acc_t *p, size_t in, uint8_t w_bw) {
+    if (!p) return;
+    p->in    = (uint32_t)in;
+    p->w_bw  = w_bw;
+    p->spill = 0;
+    if (!in || !w_bw || w_bw > CHAR_BIT - 1) return;
+    size_t pair  = 2 * 128 * (((size_t)1 << w_bw) - 1);
+    size_t steps = INT16_MAX / pair;
+    size_t row   = (in + 7) / 8;   /* steps of one row, at least 8 bytes each */
+    p->spill = (uint16_t)(steps < row ? steps : row);
+    return;
+}
+
 /**
  * @brief matrix mulitplication of tensors
  * @param W pointer of Weight Tensor
@@ -14,17 +736,118 @@
  * @param acc_buffer int32_t pointer accumulator to perfom the operations
  * @return NULL
  */
-static inline void matrix_mul( const tensor_t *W, const tensor_t *X, int32_t *acc_buffer) {
-    if (!W || !X || !acc_buffer) return;
+void matrix_mul(const tensor_t *W, const tensor_t *X, int32_t *acc_buffer) {
+    matrix_mul_acc(W, X, NULL, acc_buffer);
+    return;
+}
+
+/**
+ * @brief matrix mulitplication with a planned accumulation width
+ * @param W pointer of Weight Tensor
+ * @param X pointer of Activation Tensor
+ * @param p pointer of the plan of W (matrix_acc_plan), NULL for int32
+ * @param acc_buffer int32_t pointer accumulator to perfom the operations
+ * @return NULL
+ */
+void matrix_mul_acc(const tensor_t *W, const tensor_t *X, const matrix_acc_t *p, int32_t *acc_buffer) {
+    if (!W || !X || !acc_buffer || !X->len) return;
     size_t OUT = W->len / X->len;
     size_t IN  = X->len;
-    for (size_t r = 0; r < OUT; ++r) {
-        int32_t sum = 0;
-        const int8_t *row = &W->data[r * IN];
-        for (size_t c = 0; c < IN; ++c) {
-            sum += (int32_t)row[c] * (int32_t)X->data[c];
+    const matrix_kernels_t *k = s_kernels();
+    if (p && p->spill && k->gemv16) {
+        k->gemv16(W->data, X->data, acc_buffer, OUT, IN, p->spill);
+        return;
+    }
+    k->gemv(W->data, X->data, acc_buffer, OUT, IN);
+    return;
+}
+
+/**
+ * @brief transposed matrix multiplication, requantized to int8
+ * @param W pointer of Weight Tensor [rows x cols]
+ * @param E pointer of error Tensor [rows]
+ * @param shift rounded right shift of the int32 sums
+ * @param Y pointer of output Tensor [cols], data only
+ * @return NULL
+ */
+void matrix_tmul(const tensor_t *W, const tensor_t *E, uint8_t shift, tensor_t *Y) {
+    if (!W || !E || !Y || !E->len) return;
+    s_kernels()->tmul(W->data, E->data, Y->data, E->len, W->len / E->len, shift);
+    return;
+}
+
+/**
+ * @brief scalar reference matrix mulitplication of tensors
+ * @param W pointer of Weight Tensor
+ * @param X pointer of Activation Tensor
+ * @param acc_buffer int32_t pointer accumulator to perfom the operations
+ * @return NULL
+ */
+void matrix_mul_ref(const tensor_t *W, const tensor_t *X, int32_t *acc_buffer) {
+    if (!W || !X || !acc_buffer || !X->len) return;
+    size_t OUT = W->len / X->len;
+    size_t IN  = X->len;
+    s_gemv_scalar(W->data, X->data, acc_buffer, OUT, IN);
+    return;
+}
+
+/**
+ * @brief batched matrix mulitplication, acc[n*OUT + r] = W[r,:] . X[n,:]
+ *
+ * Cache-blocked over W: a block of rows x MATRIX_BLOCK_K columns stays in
+ * L1/L2 while all N samples stream past it, so W is read from memory once
+ * per batch instead of once per sample.
+ *
+ * @param W pointer of Weight Tensor [OUT x IN]
+ * @param X pointer of Activation Tensor, N rows of IN (X->len == N * IN)
+ * @param N number of samples in the batch
+ * @param acc_buffer int32_t pointer accumulator of N * OUT elements
+ * @return NULL
+ */
+void matrix_mul_batch(const tensor_t *W, const tensor_t *X, size_t N, int32_t *acc_buffer) {
+    matrix_mul_batch_acc(W, X, N, NULL, acc_buffer);
+    return;
+}
+
+/**
+ * @brief batched matrix mulitplication with a planned accumulation width
+ * @param W pointer of Weight Tensor [OUT x IN]
+ * @param X pointer of Activation Tensor, N rows of IN (X->len == N * IN)
+ * @param N number of samples in the batch
+ * @param p pointer of the plan of W (matrix_acc_plan), NULL for int32
+ * @param acc_buffer int32_t pointer accumulator of N * OUT elements
+ * @return NULL
+ */
+void matrix_mul_batch_acc(const tensor_t *W, const tensor_t *X, size_t N, const matrix_acc_t *p, int32_t *acc_buffer) {
+    if (!W || !X || !acc_buffer || !N || X->len % N) return;
+    size_t IN  = X->len / N;
+    if (!IN) return;
+    size_t OUT = W->len / IN;
+    const matrix_kernels_t *k = s_kernels();
+    const size_t spill = p && k->dot16 ? p->spill : 0;
+
+    if (N == 1) {
+        if (spill) k->gemv16(W->data, X->data, acc_buffer, OUT, IN, spill);
+        else       k->gemv(W->data, X->data, acc_buffer, OUT, IN);
+        return;
+    }
+
+    for (size_t k0 = 0; k0 < IN; k0 += MATRIX_BLOCK_K) {
+        size_t kb = (IN - k0 < MATRIX_BLOCK_K) ? IN - k0 : MATRIX_BLOCK_K;
+        size_t mb = MATRIX_BLOCK_BYTES / kb;
+        if (!mb) mb = 1;
+        for (size_t r0 = 0; r0 < OUT; r0 += mb) {
+            size_t r1 = (OUT - r0 < mb) ? OUT : r0 + mb;
+            for (size_t n = 0; n < N; ++n) {
+                const int8_t *x = &X->data[n * IN + k0];
+                int32_t *acc = &acc_buffer[n * OUT];
+                for (size_t r = r0; r < r1; ++r) {
+                    int32_t v = spill ? k->dot16(&W->data[r * IN + k0], x, kb, spill)
+                                      : k->dot(&W->data[r * IN + k0], x, kb);
+                    acc[r] = k0 ? acc[r] + v : v;
+                }
+            }
         }
-        acc_buffer[r] = sum;
     }
     return;
-}
\ No newline at end of file
+}
@@ -1,6 +1,9 @@
 /**
  * @file matrix.h
  * @brief mat multiplication in int32_t with accumulator and other operations
+ * @details the int8 x int8 -> int32 kernels are selected once at startup from
+ * the cpu probe (see tt_cpu.h). every vector kernel is bit-exact with the
+ * scalar reference matrix_mul_ref.
  * @author Shreyas Poyrekar
  * @date May 7, 2025
  * @license MIT
@@ -8,7 +11,85 @@
 #ifndef _MATRIX_H_
 #define _MATRIX_H_
 #include "tt_types.h"
+#include "tt_cpu.h"
 
-static inline void matrix_mul( const tensor_t *A, const tensor_t *X, int32_t *acc_buffer);
+/* cache blocking of the batched matmul: a W block of at most
+ * MATRIX_BLOCK_BYTES (rows x MATRIX_BLOCK_K columns) is reused by every
+ * sample of the batch before the next block is streamed in */
+#ifndef MATRIX_BLOCK_K
+#define MATRIX_BLOCK_K      (4096)
+#endif
+#ifndef MATRIX_BLOCK_BYTES
+#define MATRIX_BLOCK_BYTES  (32 * 1024)
+#endif
+/* columns of the transposed product summed at a time by the scalar kernel,
+ * an int32 block of this many lanes stays in L1 while the rows stream by */
+#ifndef MATRIX_TMUL_BLOCK
+#define MATRIX_TMUL_BLOCK   (256)
+#endif
+
+/* raw kernels: y[r] = sum_c W[r*cols + c] * x[c] */
+typedef int32_t (*matrix_dot_t)(const int8_t *a, const int8_t *b, size_t n);
+typedef void    (*matrix_gemv_t)(const int8_t *W, const int8_t *x, int32_t *y,
+                                 size_t rows, size_t cols);
+
+/* int16 accumulation kernels: spill = steps summed in int16 lanes between int32 spills */
+typedef int32_t (*matrix_dot16_t)(const int8_t *a, const int8_t *b, size_t n, size_t spill);
+typedef void    (*matrix_gemv16_t)(const int8_t *W, const int8_t *x, int32_t *y,
+                                   size_t rows, size_t cols, size_t spill);
+
+/* transposed kernel: y[c] = clip_int8(shift_and_round32(sum_r W[r*cols + c] * e[r], shift)) */
+typedef void    (*matrix_tmul_t)(const int8_t *W, const int8_t *e, int8_t *y,
+                                 size_t rows, size_t cols, uint8_t shift);
+
+/*
+ * accumulation plan of a weight matrix. Where the weight bit-width bounds
+ * the pair sums, the int16 kernels (SSSE3, AVX2, NEON) sum twice the lanes
+ * of the int32 ones and spill into int32 every `spill` steps; the result
+ * is the same bit for bit. spill 0 keeps the int32 kernels, as do levels
+ * whose int32 path is already as wide (VNNI, sdot). The plan is only valid
+ * for the weights it was made from.
+ */
+typedef struct {
+    uint32_t in;       /* row length the plan was made for */
+    uint16_t spill;    /* int16 steps per spill, 0 = int32 kernels */
+    uint8_t  w_bw;     /* weight bit-width the plan was made for */
+} matrix_acc_t;
+
+/*
+ * select the kernels for the running cpu, called lazily by the first matmul.
+ * The selection is one atomic table pointer, safe to read from any thread.
+ */
+void     matrix_init(void);
+/* force a kernel level (benchmarks / verification), returns the level in use */
+tt_isa_t matrix_set_isa(tt_isa_t isa);
+/* level in use, resolved on the first call; the tile, group, int4, sparse,
+   conv1d and update kernels dispatch on it as well */
+tt_isa_t matrix_isa(void);
+
+/* dispatched kernels */
+void    matrix_mul(const tensor_t *W, const tensor_t *X, int32_t *acc_buffer);
+int32_t matrix_dot(const int8_t *a, const int8_t *b, size_t n);
+
+/* batched: X holds N rows of IN, acc_buffer receives N rows of OUT */
+void    matrix_mul_batch(const tensor_t *W, const tensor_t *X, size_t N, int32_t *acc_buffer);
+
+/* plan for rows of in columns and weights of bit-width w_bw (eff_bitwidth32 of max |w|) */
+void    matrix_acc_plan(matrix_acc_t *p, size_t in, uint8_t w_bw);
+/* same products with the plan of W, NULL for the int32 kernels */
+void    matrix_mul_acc(const tensor_t *W, const tensor_t *X, const matrix_acc_t *p, int32_t *acc_buffer);
+void    matrix_mul_batch_acc(const tensor_t *W, const tensor_t *X, size_t N, const matrix_acc_t *p,
+                             int32_t *acc_buffer);
+
+/*
+ * transposed product for backprop, requantized in the same pass: E holds
+ * the rows errors, Y receives W->len / E->len int8 outputs (data only, the
+ * caller sets the header). The rows are summed one after the other into
+ * int32 column blocks, so W is read row-major like the forward pass.
+ */
+void    matrix_tmul(const tensor_t *W, const tensor_t *E, uint8_t shift, tensor_t *Y);
+
+/* scalar reference */
+void    matrix_mul_ref(const tensor_t *W, const tensor_t *X, int32_t *acc_buffer);
 
 #endif // TT_MATMUL_ACC_H
@@ -0,0 +1,343 @@
+/**
+ * @file matrix_conv1d.c
+ * @brief int8 Conv1D kernels -> int32, no im2col
+ * @details scalar reference plus AVX2, AVX-512 and NEON sliding-window
+ * kernels for stride 1, x86 ones built with per-function target attributes
+ * like matrix.c and picked from the level of matrix_isa(), as forced by
+ * matrix_set_isa.
+ * @license MIT
+ */
+#include "matrix_conv1d.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_C1_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_C1_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * one output row as a correlation over n_rows source rows:
+ *   y[t] = sum_a sum_j w[a * w_row + j] * src[a * s_len + t + off + j * step]
+ * forward: the input rows and the taps of one output channel; input
+ * gradient: the error rows and the mirrored taps of one input channel
+ */
+typedef struct {
+    const int8_t *w;
+    size_t        w_row;
+    const int8_t *src;
+    size_t        s_len;    /* length (and stride) of the source rows */
+    size_t        n_rows;
+    size_t        k;
+    ptrdiff_t     off;      /* source position of tap 0 at t = 0 */
+    ptrdiff_t     step;     /* source distance between taps */
+} s_corr_t;
+
+/**
+ * @brief fills the geometry of a Conv1D layer
+ * @param g pointer of the geometry
+ * @param c_in input channels
+ * @param c_out output channels
+ * @param k taps
+ * @param stride output step in input positions
+ * @param dil distance between taps
+ * @param pad implicit zeros on each side of the input
+ * @param l_in input length per channel
+ * @return int 0 on success, -1 if a size is 0, too large or the window does not fit
+ */
+int matrix_conv1d_init(matrix_conv1d_t *g, size_t c_in, size_t c_out, size_t k,
+                       size_t stride, size_t dil, size_t pad, size_t l_in) {
+    if (!g || !c_in || !c_out || !k || !stride || !dil || !l_in) return -1;
+    if (c_in > UINT16_MAX || c_out > UINT16_MAX || k > UINT16_MAX || stride > UINT16_MAX ||
+        dil > UINT16_MAX || pad > UINT16_MAX || l_in > UINT16_MAX) return -1;
+    if (l_in + 2 * pad < dil * (k - 1) + 1) return -1;
+    g->c_in   = (uint16_t)c_in;
+    g->c_out  = (uint16_t)c_out;
+    g->k      = (uint16_t)k;
+    g->stride = (uint16_t)stride;
+    g->dil    = (uint16_t)dil;
+    g->pad    = (uint16_t)pad;
+    g->l_in   = (uint16_t)l_in;
+    g->l_out  = (uint16_t)MATRIX_CONV1D_L_OUT(l_in, k, stride, dil, pad);
+    return 0;
+}
+
+/* t range [t0, t1) of l_t positions whose source t * stride + off lies in [0, l_src) */
+static void s_range(ptrdiff_t off, size_t stride, size_t l_src, size_t l_t, size_t *t0, size_t *t1) {
+    ptrdiff_t s = (ptrdiff_t)stride;
+    ptrdiff_t a = off >= 0 ? 0 : (-off + s - 1) / s;
+    ptrdiff_t b = (ptrdiff_t)l_src - 1 - off < 0 ? 0 : ((ptrdiff_t)l_src - 1 - off) / s + 1;
+    if (b > (ptrdiff_t)l_t) b = (ptrdiff_t)l_t;
+    if (a > b) a = b;
+    *t0 = (size_t)a;
+    *t1 = (size_t)b;
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+/* y[t] of one correlation, taps outside the source left out */
+static int32_t s_corr_at(const s_corr_t *c, size_t t) {
+    int32_t sum = 0;
+    for (size_t a = 0; a < c->n_rows; ++a) {
+        const int8_t *w = c->w + a * c->w_row;
+        const int8_t *s = c->src + a * c->s_len;
+        for (size_t j = 0; j < c->k; ++j) {
+            ptrdiff_t p = (ptrdiff_t)t + c->off + (ptrdiff_t)j * c->step;
+            if (p < 0 || p >= (ptrdiff_t)c->s_len) continue;
+            sum += (int32_t)w[j] * (int32_t)s[p];
+        }
+    }
+    return sum;
+}
+
+/* source of tap (a, j) at position t and its weight, then the next tap */
+static inline const int8_t *s_tap(const s_corr_t *c, size_t *a, size_t *j, size_t t, int8_t *w) {
+    const int8_t *p = c->src + *a * c->s_len + (ptrdiff_t)t + c->off + (ptrdiff_t)*j * c->step;
+    *w = c->w[*a * c->w_row + *j];
+    if (++*j == c->k) { *j = 0; ++*a; }
+    return p;
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_C1_X86
+
+/* 16 positions per block, two taps per pmaddwd on interleaved int16 */
+__attribute__((target("avx2")))
+static size_t s_corr_avx2(const s_corr_t *c, size_t t, size_t t1, int32_t *y) {
+    const size_t n = c->n_rows * c->k;
+    for (; t + 16 <= t1; t += 16) {
+        __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+        size_t a = 0, j = 0;
+        for (size_t i = 0; i < n; i += 2) {
+            int8_t w0, w1 = 0;
+            const int8_t *p0 = s_tap(c, &a, &j, t, &w0);
+            const int8_t *p1 = i + 1 < n ? s_tap(c, &a, &j, t, &w1) : p0;
+            __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)p0));
+            __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)p1));
+            __m256i wv = _mm256_set1_epi32((int32_t)(uint16_t)w0 | (int32_t)((uint32_t)(uint16_t)w1 << 16));
+            /* lo: positions 0-3 | 8-11, hi: 4-7 | 12-15 */
+            lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(x0, x1), wv));
+            hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(x0, x1), wv));
+        }
+        _mm256_storeu_si256((__m256i *)(y + t),     _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(y + t + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    return t;
+}
+
+/* 32 positions per block */
+__attribute__((target("avx512f,avx512bw")))
+static size_t s_corr_avx512(const s_corr_t *c, size_t t, size_t t1, int32_t *y) {
+    const size_t n = c->n_rows * c->k;
+    const __m512i ia = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+    const __m512i ib = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+    for (; t + 32 <= t1; t += 32) {
+        __m512i lo = _mm512_setzero_si512(), hi = _mm512_setzero_si512();
+        size_t a = 0, j = 0;
+        for (size_t i = 0; i < n; i += 2) {
+            int8_t w0, w1 = 0;
+            const int8_t *p0 = s_tap(c, &a, &j, t, &w0);
+            const int8_t *p1 = i + 1 < n ? s_tap(c, &a, &j, t, &w1) : p0;
+            __m512i x0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)p0));
+            __m512i x1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)p1));
+            __m512i wv = _mm512_set1_epi32((int32_t)(uint16_t)w0 | (int32_t)((uint32_t)(uint16_t)w1 << 16));
+            /* 128-bit lane L: lo holds positions 8L + 0-3, hi 8L + 4-7 */
+            lo = _mm512_add_epi32(lo, _mm512_madd_epi16(_mm512_unpacklo_epi16(x0, x1), wv));
+            hi = _mm512_add_epi32(hi, _mm512_madd_epi16(_mm512_unpackhi_epi16(x0, x1), wv));
+        }
+        _mm512_storeu_si512((void *)(y + t),      _mm512_permutex2var_epi64(lo, ia, hi));
+        _mm512_storeu_si512((void *)(y + t + 16), _mm512_permutex2var_epi64(lo, ib, hi));
+    }
+    return t;
+}
+
+#endif // MATRIX_C1_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_C1_ARM64
+
+/* 8 positions per block, one widening multiply-add per tap */
+static size_t s_corr_neon(const s_corr_t *c, size_t t, size_t t1, int32_t *y) {
+    const size_t n = c->n_rows * c->k;
+    for (; t + 8 <= t1; t += 8) {
+        int32x4_t lo = vdupq_n_s32(0), hi = vdupq_n_s32(0);
+        size_t a = 0, j = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int8_t w;
+            int16x8_t x = vmovl_s8(vld1_s8(s_tap(c, &a, &j, t, &w)));
+            lo = vmlal_n_s16(lo, vget_low_s16(x), w);
+            hi = vmlal_high_n_s16(hi, x, w);
+        }
+        vst1q_s32(y + t, lo);
+        vst1q_s32(y + t + 4, hi);
+    }
+    return t;
+}
+
+#endif // MATRIX_C1_ARM64
+
+/* interior positions [t, t1) in vector blocks, returns the first one left */
+static size_t s_corr_vec(const s_corr_t *c, size_t t, size_t t1, int32_t *y) {
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_C1_X86)
+    if (isa >= TT_ISA_AVX512_VNNI) return s_corr_avx512(c, t, t1, y);
+    if (isa >= TT_ISA_AVX2)        return s_corr_avx2(c, t, t1, y);
+#elif defined(MATRIX_C1_ARM64)
+    if (isa >= TT_ISA_NEON)        return s_corr_neon(c, t, t1, y);
+#endif
+    (void)isa; (void)c; (void)t1; (void)y;
+    return t;
+}
+
+/* y[0 .. l_y) of one correlation: borders scalar, interior in vector blocks */
+static void s_corr_row(const s_corr_t *c, int32_t *y, size_t l_y) {
+    ptrdiff_t span = (ptrdiff_t)(c->k - 1) * c->step;
+    ptrdiff_t lo = c->off + (span < 0 ? span : 0);   /* leftmost tap */
+    ptrdiff_t hi = c->off + (span > 0 ? span : 0);   /* rightmost tap */
+    /* every tap inside the source on [i0, i1) */
+    ptrdiff_t end = (ptrdiff_t)c->s_len - hi;
+    size_t i0 = lo < 0 ? (size_t)-lo : 0;
+    size_t i1 = end <= 0 ? 0 : (size_t)end;
+    if (i0 > l_y) i0 = l_y;
+    if (i1 > l_y) i1 = l_y;
+    if (i1 < i0)  i1 = i0;
+
+    size_t t = 0;
+    for (; t < i0; ++t) y[t] = s_corr_at(c, t);
+    t = s_corr_vec(c, t, i1, y);
+    for (; t < l_y; ++t) y[t] = s_corr_at(c, t);
+}
+
+/**
+ * @brief Conv1D forward
+ * @param g pointer of the geometry
+ * @param W pointer of the weights [c_out x c_in x k]
+ * @param x pointer of the input [c_in x l_in]
+ * @param y pointer of the int32 outputs [c_out x l_out]
+ * @return NULL
+ */
+void matrix_conv1d_fwd(const matrix_conv1d_t *g, const int8_t *W, const int8_t *x, int32_t *y) {
+    if (!g || !W || !x || !y) return;
+    const size_t ck = (size_t)g->c_in * g->k;
+    for (size_t co = 0; co < g->c_out; ++co) {
+        const int8_t *wr = W + co * ck;
+        int32_t      *yr = y + co * g->l_out;
+        if (g->stride == 1) {
+            s_corr_t c = { wr, g->k, x, g->l_in, g->c_in, g->k, -(ptrdiff_t)g->pad, (ptrdiff_t)g->dil };
+            s_corr_row(&c, yr, g->l_out);
+            continue;
+        }
+        /* strided: one scalar pass per tap over its valid positions */
+        memset(yr, 0, g->l_out * sizeof(int32_t));
+        for (size_t ci = 0; ci < g->c_in; ++ci)
+            for (size_t j = 0; j < g->k; ++j) {
+                int32_t w = wr[ci * g->k + j];
+                ptrdiff_t off = (ptrdiff_t)(j * g->dil) - (ptrdiff_t)g->pad;
+                size_t t0, t1;
+                s_range(off, g->stride, g->l_in, g->l_out, &t0, &t1);
+                const int8_t *xr = x + ci * g->l_in;
+                for (size_t t = t0; t < t1; ++t)
+                    yr[t] += w * (int32_t)xr[(ptrdiff_t)(t * g->stride) + off];
+            }
+    }
+}
+
+/**
+ * @brief one output position of every channel, scalar (c_in x k taps each)
+ * @param g pointer of the geometry
+ * @param W pointer of the weights [c_out x c_in x k]
+ * @param x pointer of the first input row, l_in valid positions per row
+ * @param x_stride distance between the input rows
+ * @param t output position
+ * @param y pointer of the int32 outputs [c_out]
+ * @return NULL
+ */
+void matrix_conv1d_col(const matrix_conv1d_t *g, const int8_t *W, const int8_t *x, size_t x_stride,
+                       size_t t, int32_t *y) {
+    if (!g || !W || !x || !y || t >= g->l_out) return;
+    const ptrdiff_t p0 = (ptrdiff_t)(t * g->stride) - (ptrdiff_t)g->pad;
+    for (size_t co = 0; co < g->c_out; ++co) {
+        const int8_t *wr = W + co * g->c_in * g->k;
+        int32_t sum = 0;
+        for (size_t ci = 0; ci < g->c_in; ++ci) {
+            const int8_t *xr = x + ci * x_stride;
+            for (size_t j = 0; j < g->k; ++j) {
+                ptrdiff_t p = p0 + (ptrdiff_t)(j * g->dil);
+                if (p < 0 || p >= (ptrdiff_t)g->l_in) continue;
+                sum += (int32_t)wr[ci * g->k + j] * (int32_t)xr[p];
+            }
+        }
+        y[co] = sum;
+    }
+}
+
+/**
+ * @brief Conv1D input gradient (transposed convolution of the error)
+ * @param g pointer of the geometry
+ * @param W pointer of the weights [c_out x c_in x k]
+ * @param e pointer of the output error [c_out x l_out]
+ * @param dx pointer of the int32 input error [c_in x l_in]
+ * @return NULL
+ */
+void matrix_conv1d_bwd(const matrix_conv1d_t *g, const int8_t *W, const int8_t *e, int32_t *dx) {
+    if (!g || !W || !e || !dx) return;
+    const size_t ck = (size_t)g->c_in * g->k;
+    if (g->stride == 1) {
+        /* dx[ci][u] = sum_co sum_j W[co][ci][j] * e[co][u + pad - j * dil] */
+        for (size_t ci = 0; ci < g->c_in; ++ci) {
+            s_corr_t c = { W + ci * g->k, ck, e, g->l_out, g->c_out, g->k, (ptrdiff_t)g->pad, -(ptrdiff_t)g->dil };
+            s_corr_row(&c, dx + ci * g->l_in, g->l_in);
+        }
+        return;
+    }
+    /* strided: scatter every tap back onto the positions it read */
+    memset(dx, 0, MATRIX_CONV1D_IN_LEN(g) * sizeof(int32_t));
+    for (size_t co = 0; co < g->c_out; ++co)
+        for (size_t ci = 0; ci < g->c_in; ++ci)
+            for (size_t j = 0; j < g->k; ++j) {
+                int32_t w = W[co * ck + ci * g->k + j];
+                ptrdiff_t off = (ptrdiff_t)(j * g->dil) - (ptrdiff_t)g->pad;
+                size_t t0, t1;
+                s_range(off, g->stride, g->l_in, g->l_out, &t0, &t1);
+                const int8_t *er = e + co * g->l_out;
+                int32_t      *dr = dx + ci * g->l_in;
+                for (size_t t = t0; t < t1; ++t)
+                    dr[(ptrdiff_t)(t * g->stride) + off] += w * (int32_t)er[t];
+            }
+}
+
+/**
+ * @brief Conv1D weight gradient
+ * @param g pointer of the geometry
+ * @param e pointer of the output error [c_out x l_out]
+ * @param x pointer of the layer input [c_in x l_in]
+ * @param dW pointer of the int32 weight gradient [c_out x c_in x k]
+ * @return NULL
+ */
+void matrix_conv1d_wgrad(const matrix_conv1d_t *g, const int8_t *e, const int8_t *x, int32_t *dW) {
+    if (!g || !e || !x || !dW) return;
+    for (size_t j = 0; j < g->k; ++j) {
+        ptrdiff_t off = (ptrdiff_t)(j * g->dil) - (ptrdiff_t)g->pad;
+        size_t t0, t1;
+        s_range(off, g->stride, g->l_in, g->l_out, &t0, &t1);
+        for (size_t co = 0; co < g->c_out; ++co) {
+            const int8_t *er = e + co * g->l_out;
+            for (size_t ci = 0; ci < g->c_in; ++ci) {
+                const int8_t *xr = x + ci * g->l_in;
+                int32_t sum = 0;
+                if (g->stride == 1) {
+                    /* contiguous on both sides: the dispatched dot product */
+                    sum = t1 > t0 ? matrix_dot(er + t0, xr + (ptrdiff_t)t0 + off, t1 - t0) : 0;
+                } else {
+                    for (size_t t = t0; t < t1; ++t)
+                        sum += (int32_t)er[t] * (int32_t)xr[(ptrdiff_t)(t * g->stride) + off];
+                }
+                dW[(co * g->c_in + ci) * g->k + j] = sum;
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file matrix_conv1d.h
+ * @brief int8 Conv1D kernels -> int32, no im2col
+ * @details tensors are channel major: x is [c_in x l_in], y [c_out x l_out]
+ * and W [c_out x c_in x k]. Output position t of channel co reads
+ *
+ *   y[co][t] = sum_ci sum_j W[co][ci][j] * x[ci][t * stride + j * dil - pad]
+ *
+ * with the taps that fall into the padding left out, so nothing is ever
+ * copied or zero padded. At stride 1 the interior positions (every tap
+ * inside x) run a sliding-window kernel: a block of output positions stays
+ * in int32 registers while the taps stream past as shifted unaligned loads
+ * of the input rows, two taps per pmaddwd. Border positions, tails and
+ * stride > 1 take the scalar path. The input gradient is the same
+ * correlation over the error rows with mirrored taps, the weight gradient
+ * a dot product per tap. The sliding window sums in int32 like the scalar
+ * borders, and tests/test_kernels.c checks all four entry points against
+ * the formula above at every level, strided and dilated shapes included.
+ * @license MIT
+ */
+#ifndef MATRIX_CONV1D_H
+#define MATRIX_CONV1D_H
+
+#include "tt_types.h"
+#include <stdint.h>
+
+typedef struct {
+    uint16_t c_in;
+    uint16_t c_out;
+    uint16_t k;          /* taps */
+    uint16_t stride;
+    uint16_t dil;        /* tap spacing */
+    uint16_t pad;        /* zero positions on each side of x */
+    uint16_t l_in;
+    uint16_t l_out;      /* set by matrix_conv1d_init */
+} matrix_conv1d_t;
+
+#define MATRIX_CONV1D_L_OUT(l_in, k, stride, dil, pad) \
+    (((size_t)(l_in) + 2 * (size_t)(pad) - (size_t)(dil) * ((size_t)(k) - 1) - 1) / (size_t)(stride) + 1)
+#define MATRIX_CONV1D_W_LEN(g)    ((size_t)(g)->c_out * (g)->c_in * (g)->k)
+#define MATRIX_CONV1D_IN_LEN(g)   ((size_t)(g)->c_in * (g)->l_in)
+#define MATRIX_CONV1D_OUT_LEN(g)  ((size_t)(g)->c_out * (g)->l_out)
+
+/* fills g and its l_out; 0 or -1 (zero sizes, window longer than the padded input) */
+int  matrix_conv1d_init(matrix_conv1d_t *g, size_t c_in, size_t c_out, size_t k,
+                        size_t stride, size_t dil, size_t pad, size_t l_in);
+
+/* y [c_out x l_out] = W (*) x */
+void matrix_conv1d_fwd(const matrix_conv1d_t *g, const int8_t *W, const int8_t *x, int32_t *y);
+/* y [c_out] = output position t of every channel, x rows x_stride apart (e.g. ring buffers) */
+void matrix_conv1d_col(const matrix_conv1d_t *g, const int8_t *W, const int8_t *x, size_t x_stride,
+                       size_t t, int32_t *y);
+/* dx [c_in x l_in] = sum over the taps of W^T e, e [c_out x l_out] */
+void matrix_conv1d_bwd(const matrix_conv1d_t *g, const int8_t *W, const int8_t *e, int32_t *dx);
+/* dW [c_out x c_in x k] = sum_t e[co][t] * x[ci][t * stride + j * dil - pad] */
+void matrix_conv1d_wgrad(const matrix_conv1d_t *g, const int8_t *e, const int8_t *x, int32_t *dW);
+
+#endif // MATRIX_CONV1D_H
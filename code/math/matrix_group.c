@@ -0,0 +1,235 @@
+/**
+ * @file matrix_group.c
+ * @brief grouped GEMV kernels, vector lanes over models
+ * @details one block of 8 models at a time; four output rows share every
+ * load of the interleaved inputs:
+ *  - AVX2: cvtepi8_epi16 + madd, one 8-lane int32 accumulator per row.
+ *  - SSE4.1: the same on the two 4-model halves of a block.
+ *  - NEON: smull + sadalp on the two halves (-128 * -128 fits int16).
+ * The lanes of an accumulator belong to different models, so nothing is
+ * reduced across lanes; they are scattered to the model-major output.
+ * @license MIT
+ */
+#include "matrix_group.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_GRP_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_GRP_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/* bytes of one row (one input pair) and of one model block of weights */
+#define S_PAIR  (2 * MATRIX_GRP_K)
+
+static inline size_t s_row_bytes(const matrix_grp_t *g) {
+    return MATRIX_GRP_IN2(g->in) * S_PAIR;
+}
+
+/**
+ * @brief carve the interleaved weights of K models
+ * @param g pointer of the group
+ * @param mem pointer of MATRIX_GRP_W_BYTES(K, out, in) bytes, 64-byte aligned
+ * @param K number of models
+ * @param out rows of every model
+ * @param in columns of every model
+ * @return int 0 on success, -1 on bad arguments
+ */
+int matrix_grp_init(matrix_grp_t *g, void *mem, size_t K, size_t out, size_t in) {
+    if (!g || !mem || !K || !out || !in || K > UINT32_MAX || out > UINT16_MAX || in > UINT16_MAX) return -1;
+    if ((uintptr_t)mem & 63) return -1;
+    g->w   = (int8_t *)mem;
+    g->K   = (uint32_t)K;
+    g->out = (uint16_t)out;
+    g->in  = (uint16_t)in;
+    memset(g->w, 0, MATRIX_GRP_W_BYTES(K, out, in));
+    return 0;
+}
+
+void matrix_grp_pack(matrix_grp_t *g, size_t k, const int8_t *W) {
+    if (!g || !W || k >= g->K) return;
+    const size_t rb = s_row_bytes(g);
+    int8_t *w = g->w + (k / MATRIX_GRP_K) * g->out * rb + (k % MATRIX_GRP_K) * 2;
+    for (size_t o = 0; o < g->out; ++o)
+        for (size_t i = 0; i < g->in; ++i)
+            w[o * rb + (i / 2) * S_PAIR + (i & 1)] = W[o * g->in + i];
+}
+
+void matrix_grp_pack_x(const matrix_grp_t *g, const int8_t *const *x, int8_t *xg) {
+    if (!g || !x || !xg) return;
+    const size_t rb = s_row_bytes(g);
+    /* zero pad models and the odd input */
+    memset(xg, 0, MATRIX_GRP_X_BYTES(g->K, g->in));
+    const size_t n2 = g->in / 2;
+    for (size_t k = 0; k < g->K; ++k) {
+        int8_t *d = xg + (k / MATRIX_GRP_K) * rb + (k % MATRIX_GRP_K) * 2;
+        const int8_t *xk = x[k];
+        /* one 2-byte move per input pair */
+        for (size_t p = 0; p < n2; ++p) memcpy(d + p * S_PAIR, xk + 2 * p, 2);
+        if (g->in & 1) d[n2 * S_PAIR] = xk[g->in - 1];
+    }
+}
+
+/* lanes of rows o0 .. o0 + nr - 1 of block blk to the model-major output */
+static inline void s_scatter(const matrix_grp_t *g, size_t blk, size_t o0, size_t nr,
+                             const int32_t lanes[][MATRIX_GRP_K], int32_t *acc) {
+    size_t k0 = blk * MATRIX_GRP_K, nk = g->K - k0 < MATRIX_GRP_K ? g->K - k0 : MATRIX_GRP_K;
+    for (size_t j = 0; j < nk; ++j)
+        for (size_t r = 0; r < nr; ++r) acc[(k0 + j) * g->out + o0 + r] = lanes[r][j];
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+static void s_mul_scalar(const matrix_grp_t *g, const int8_t *xg, int32_t *acc) {
+    const size_t rb = s_row_bytes(g), n2 = MATRIX_GRP_IN2(g->in);
+    for (size_t blk = 0; blk < MATRIX_GRP_NBLK(g->K); ++blk) {
+        const int8_t *wb = g->w + blk * g->out * rb, *xb = xg + blk * rb;
+        for (size_t o = 0; o < g->out; ++o) {
+            int32_t lanes[1][MATRIX_GRP_K] = { { 0 } };
+            for (size_t p = 0; p < n2; ++p)
+                for (size_t j = 0; j < 2 * MATRIX_GRP_K; ++j)
+                    lanes[0][j / 2] += (int32_t)wb[o * rb + p * S_PAIR + j] * (int32_t)xb[p * S_PAIR + j];
+            s_scatter(g, blk, o, 1, lanes, acc);
+        }
+    }
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_GRP_X86
+
+__attribute__((target("avx2")))
+static inline __m256i s_madd_avx2(const int8_t *w, __m256i xv) {
+    return _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)w)), xv);
+}
+
+__attribute__((target("avx2")))
+static void s_mul_avx2(const matrix_grp_t *g, const int8_t *xg, int32_t *acc) {
+    const size_t rb = s_row_bytes(g), n2 = MATRIX_GRP_IN2(g->in);
+    int32_t lanes[4][MATRIX_GRP_K];
+    for (size_t blk = 0; blk < MATRIX_GRP_NBLK(g->K); ++blk) {
+        const int8_t *wb = g->w + blk * g->out * rb, *xb = xg + blk * rb;
+        size_t o = 0;
+        for (; o + 4 <= g->out; o += 4) {
+            const int8_t *w0 = wb + o * rb, *w1 = w0 + rb, *w2 = w1 + rb, *w3 = w2 + rb;
+            __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+            __m256i a2 = _mm256_setzero_si256(), a3 = _mm256_setzero_si256();
+            for (size_t p = 0; p < n2; ++p) {
+                const size_t c = p * S_PAIR;
+                __m256i xv = _mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(xb + c)));
+                a0 = _mm256_add_epi32(a0, s_madd_avx2(w0 + c, xv));
+                a1 = _mm256_add_epi32(a1, s_madd_avx2(w1 + c, xv));
+                a2 = _mm256_add_epi32(a2, s_madd_avx2(w2 + c, xv));
+                a3 = _mm256_add_epi32(a3, s_madd_avx2(w3 + c, xv));
+            }
+            _mm256_storeu_si256((__m256i *)lanes[0], a0);
+            _mm256_storeu_si256((__m256i *)lanes[1], a1);
+            _mm256_storeu_si256((__m256i *)lanes[2], a2);
+            _mm256_storeu_si256((__m256i *)lanes[3], a3);
+            s_scatter(g, blk, o, 4, lanes, acc);
+        }
+        for (; o < g->out; ++o) {
+            const int8_t *w0 = wb + o * rb;
+            __m256i a0 = _mm256_setzero_si256();
+            for (size_t p = 0; p < n2; ++p) {
+                const size_t c = p * S_PAIR;
+                a0 = _mm256_add_epi32(a0, s_madd_avx2(w0 + c, _mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(xb + c)))));
+            }
+            _mm256_storeu_si256((__m256i *)lanes[0], a0);
+            s_scatter(g, blk, o, 1, lanes, acc);
+        }
+    }
+}
+
+/* models 0-3 of the 16 bytes at w in lo, 4-7 in hi */
+__attribute__((target("sse4.1")))
+static inline void s_madd_sse41(const int8_t *w, __m128i xlo, __m128i xhi, __m128i *lo, __m128i *hi) {
+    __m128i v = _mm_load_si128((const __m128i *)w);
+    *lo = _mm_add_epi32(*lo, _mm_madd_epi16(_mm_cvtepi8_epi16(v), xlo));
+    *hi = _mm_add_epi32(*hi, _mm_madd_epi16(_mm_cvtepi8_epi16(_mm_srli_si128(v, 8)), xhi));
+}
+
+__attribute__((target("sse4.1")))
+static void s_mul_sse41(const matrix_grp_t *g, const int8_t *xg, int32_t *acc) {
+    const size_t rb = s_row_bytes(g), n2 = MATRIX_GRP_IN2(g->in);
+    int32_t lanes[4][MATRIX_GRP_K];
+    for (size_t blk = 0; blk < MATRIX_GRP_NBLK(g->K); ++blk) {
+        const int8_t *wb = g->w + blk * g->out * rb, *xb = xg + blk * rb;
+        for (size_t o = 0; o < g->out; o += 4) {
+            const size_t nr = g->out - o < 4 ? g->out - o : 4;
+            __m128i lo[4], hi[4];
+            for (size_t r = 0; r < 4; ++r) lo[r] = hi[r] = _mm_setzero_si128();
+            for (size_t p = 0; p < n2; ++p) {
+                const size_t c = p * S_PAIR;
+                __m128i xv  = _mm_load_si128((const __m128i *)(xb + c));
+                __m128i xlo = _mm_cvtepi8_epi16(xv), xhi = _mm_cvtepi8_epi16(_mm_srli_si128(xv, 8));
+                s_madd_sse41(wb + o * rb + c, xlo, xhi, &lo[0], &hi[0]);
+                if (nr > 1) s_madd_sse41(wb + (o + 1) * rb + c, xlo, xhi, &lo[1], &hi[1]);
+                if (nr > 2) s_madd_sse41(wb + (o + 2) * rb + c, xlo, xhi, &lo[2], &hi[2]);
+                if (nr > 3) s_madd_sse41(wb + (o + 3) * rb + c, xlo, xhi, &lo[3], &hi[3]);
+            }
+            for (size_t r = 0; r < nr; ++r) {
+                _mm_storeu_si128((__m128i *)lanes[r], lo[r]);
+                _mm_storeu_si128((__m128i *)(lanes[r] + 4), hi[r]);
+            }
+            s_scatter(g, blk, o, nr, lanes, acc);
+        }
+    }
+}
+
+#endif // MATRIX_GRP_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_GRP_ARM64
+
+static void s_mul_neon(const matrix_grp_t *g, const int8_t *xg, int32_t *acc) {
+    const size_t rb = s_row_bytes(g), n2 = MATRIX_GRP_IN2(g->in);
+    int32_t lanes[4][MATRIX_GRP_K];
+    for (size_t blk = 0; blk < MATRIX_GRP_NBLK(g->K); ++blk) {
+        const int8_t *wb = g->w + blk * g->out * rb, *xb = xg + blk * rb;
+        for (size_t o = 0; o < g->out; o += 4) {
+            const size_t nr = g->out - o < 4 ? g->out - o : 4;
+            int32x4_t lo[4], hi[4];
+            for (size_t r = 0; r < 4; ++r) lo[r] = hi[r] = vdupq_n_s32(0);
+            for (size_t p = 0; p < n2; ++p) {
+                const size_t c = p * S_PAIR;
+                int8x16_t xv = vld1q_s8(xb + c);
+                for (size_t r = 0; r < nr; ++r) {
+                    int8x16_t wv = vld1q_s8(wb + (o + r) * rb + c);
+                    lo[r] = vpadalq_s16(lo[r], vmull_s8(vget_low_s8(wv), vget_low_s8(xv)));
+                    hi[r] = vpadalq_s16(hi[r], vmull_high_s8(wv, xv));
+                }
+            }
+            for (size_t r = 0; r < nr; ++r) {
+                vst1q_s32(lanes[r], lo[r]);
+                vst1q_s32(lanes[r] + 4, hi[r]);
+            }
+            s_scatter(g, blk, o, nr, lanes, acc);
+        }
+    }
+}
+
+#endif // MATRIX_GRP_ARM64
+
+/**
+ * @brief grouped matrix-vector product of K models
+ * @param g pointer of the packed group
+ * @param xg pointer of the inputs interleaved by matrix_grp_pack_x
+ * @param acc_buffer pointer of the int32 outputs [K x out]
+ * @return NULL
+ */
+void matrix_mul_grp(const matrix_grp_t *g, const int8_t *xg, int32_t *acc_buffer) {
+    if (!g || !xg || !acc_buffer) return;
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_GRP_X86)
+    if (isa >= TT_ISA_AVX2)  { s_mul_avx2(g, xg, acc_buffer); return; }
+    if (isa >= TT_ISA_SSE41) { s_mul_sse41(g, xg, acc_buffer); return; }
+#elif defined(MATRIX_GRP_ARM64)
+    if (isa >= TT_ISA_NEON)  { s_mul_neon(g, xg, acc_buffer); return; }
+#endif
+    (void)isa;
+    s_mul_scalar(g, xg, acc_buffer);
+}
@@ -0,0 +1,57 @@
+/**
+ * @file matrix_group.h
+ * @brief grouped int8 GEMV: one input per model over K models of one shape
+ * @details K models with the same [out x in] layer but their own weights
+ * are evaluated in one call, acc_k = W_k x_k for every k. The weights are
+ * interleaved so that the vector lanes span models instead of inputs: the
+ * models are taken in blocks of MATRIX_GRP_K and, for every output row and
+ * pair of inputs, the 8 models' two weights sit next to each other
+ *
+ *   w[blk][o][i / 2][k][i % 2]     (16 bytes per row and input pair)
+ *
+ * with the inputs interleaved the same way, x[blk][i / 2][k][i % 2]. One
+ * pmaddwd of the widened 16 bytes then leaves one int32 partial sum per
+ * model in its own lane, so a short layer (in = 32, out = 24) fills whole
+ * registers where a single model leaves most lanes idle, and K models cost
+ * one call instead of K. Missing models of the last block and the odd input
+ * are zero padded. The int16 products and int32 lane sums cannot overflow
+ * for int8 operands, so every level returns the per-model sums exactly;
+ * tests/test_kernels.c compares them with one GEMV per model.
+ * @license MIT
+ */
+#ifndef MATRIX_GROUP_H
+#define MATRIX_GROUP_H
+
+#include "tt_types.h"
+#include <stdint.h>
+
+#define MATRIX_GRP_K            (8)
+/* model blocks / input pairs */
+#define MATRIX_GRP_NBLK(K)      (((size_t)(K) + MATRIX_GRP_K - 1) / MATRIX_GRP_K)
+#define MATRIX_GRP_IN2(in)      (((size_t)(in) + 1) / 2)
+/* interleaved weights of K models [out x in], interleaved inputs of K models */
+#define MATRIX_GRP_W_BYTES(K, out, in) \
+    (MATRIX_GRP_NBLK(K) * (size_t)(out) * MATRIX_GRP_IN2(in) * 2 * MATRIX_GRP_K)
+#define MATRIX_GRP_X_BYTES(K, in) \
+    (MATRIX_GRP_NBLK(K) * MATRIX_GRP_IN2(in) * 2 * MATRIX_GRP_K)
+
+typedef struct {
+    int8_t  *w;          /* MATRIX_GRP_W_BYTES(K, out, in) interleaved weights */
+    uint32_t K;          /* models */
+    uint16_t out;
+    uint16_t in;
+} matrix_grp_t;
+
+/* carves MATRIX_GRP_W_BYTES(K, out, in) bytes of 64-byte aligned mem, zeroed; 0 or -1 */
+int  matrix_grp_init(matrix_grp_t *g, void *mem, size_t K, size_t out, size_t in);
+
+/* copies the row-major [out x in] weights of model k into the interleaved layout */
+void matrix_grp_pack(matrix_grp_t *g, size_t k, const int8_t *W);
+
+/* interleaves the K inputs x[k] [in] into xg, MATRIX_GRP_X_BYTES(K, in) bytes 16-byte aligned */
+void matrix_grp_pack_x(const matrix_grp_t *g, const int8_t *const *x, int8_t *xg);
+
+/* acc [K x out], model major: acc[k * out + o] = sum_i W_k[o][i] * x_k[i] */
+void matrix_mul_grp(const matrix_grp_t *g, const int8_t *xg, int32_t *acc_buffer);
+
+#endif // MATRIX_GROUP_H
@@ -0,0 +1,245 @@
+/**
+ * @file matrix_i4.c
+ * @brief packed int4 weights x int8 activations -> int32 kernels
+ * @details scalar reference plus AVX2, AVX-512 VNNI and NEON kernels,
+ * chosen from the level of matrix_isa(). The nibbles are split in registers with a
+ * mask and a shift. x86 multiplies them as unsigned q + 8 (maddubs /
+ * dpbusd) and corrects by 8 * sum x once per call; NEON interleaves them
+ * back to element order, sign-extends with (q ^ 8) - 8 and follows the
+ * int16 multiply-add path of the int8 kernels.
+ * @license MIT
+ */
+#include "matrix_i4.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include "tt_utils.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_I4_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_I4_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/* nibble to int8: low or high half of a byte, sign-extended */
+#define I4_LO(b) ((int8_t)((uint8_t)((b) << 4)) >> 4)
+#define I4_HI(b) ((int8_t)(b) >> 4)
+
+static inline int8_t s_clip4(int32_t v) {
+    return (int8_t)(v > 7 ? 7 : (v < -8 ? -8 : v));
+}
+
+/**
+ * @brief pack shift of a weight array
+ * @param w pointer of the int8 weights
+ * @param n number of weights
+ * @return uint8_t shift so that round(w >> k) is in [-8, 7]
+ */
+uint8_t matrix_i4_shift(const int8_t *w, size_t n) {
+    if (!w) return 0;
+    uint8_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        /* rounding may carry one bit, so test the rounded value */
+        while (shift_round32_inline(w[i], k) > 7 || shift_round32_inline(w[i], k) < -8) ++k;
+    }
+    return k;
+}
+
+/**
+ * @brief packs int8 weights to nibbles
+ * @param dst pointer of the packed rows [rows x MATRIX_I4_ROW_BYTES(cols)]
+ * @param src pointer of the int8 weights [rows x cols]
+ * @param rows number of rows
+ * @param cols number of columns
+ * @param k right shift applied before the nibble clip
+ * @return NULL
+ */
+void matrix_i4_pack(uint8_t *dst, const int8_t *src, size_t rows, size_t cols, uint8_t k) {
+    if (!dst || !src) return;
+    size_t rb = MATRIX_I4_ROW_BYTES(cols);
+    for (size_t r = 0; r < rows; ++r) {
+        const int8_t *s = src + r * cols;
+        uint8_t *d = dst + r * rb;
+        for (size_t c = 0; c < cols; c += 2) {
+            uint8_t lo = (uint8_t)s_clip4(shift_round32_inline(s[c], k)) & 0x0F;
+            uint8_t hi = (c + 1 < cols) ? (uint8_t)s_clip4(shift_round32_inline(s[c + 1], k)) & 0x0F : 0;
+            d[c / 2] = (uint8_t)(lo | (hi << 4));
+        }
+    }
+}
+
+void matrix_i4_unpack(int8_t *dst, const uint8_t *src, size_t rows, size_t cols) {
+    if (!dst || !src) return;
+    size_t rb = MATRIX_I4_ROW_BYTES(cols);
+    for (size_t r = 0; r < rows; ++r) {
+        const uint8_t *s = src + r * rb;
+        for (size_t c = 0; c < cols; ++c)
+            dst[r * cols + c] = (c & 1) ? I4_HI(s[c / 2]) : I4_LO(s[c / 2]);
+    }
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+static int32_t s_dot_i4_scalar(const uint8_t *w, const int8_t *x, size_t n) {
+    int32_t sum = 0;
+    size_t c = 0;
+    for (; c + 2 <= n; c += 2) {
+        sum += I4_LO(w[c / 2]) * (int32_t)x[c];
+        sum += I4_HI(w[c / 2]) * (int32_t)x[c + 1];
+    }
+    if (c < n) sum += I4_LO(w[c / 2]) * (int32_t)x[c];
+    return sum;
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_I4_X86
+
+/*
+ * The x86 kernels work on offset nibbles u = q + 8 (one xor with 0x88 per
+ * byte), which are unsigned and fit maddubs / dpbusd as they are:
+ * sum u * x = sum q * x + 8 * sum x, the second term is taken off once per
+ * call (xs8). maddubs cannot saturate: two products of at most 15 * 128.
+ */
+
+/* 16 packed bytes -> 32 offset weights in element order */
+__attribute__((target("avx2")))
+static inline __m256i s_unpack32_avx2(const uint8_t *w) {
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    __m128i v  = _mm_xor_si128(_mm_loadu_si128((const __m128i *)w), _mm_set1_epi8((char)0x88));
+    __m128i lo = _mm_and_si128(v, m4);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), m4);
+    return _mm256_set_m128i(_mm_unpackhi_epi8(lo, hi), _mm_unpacklo_epi8(lo, hi));
+}
+
+/*
+ * 32 packed bytes -> 64 offset weights as two halves of
+ * [e0-15 | e32-47] and [e16-31 | e48-63] (unpack works per 128-bit lane)
+ */
+__attribute__((target("avx2")))
+static inline void s_unpack64_avx2(const uint8_t *w, __m256i *a0, __m256i *a1) {
+    const __m256i m4 = _mm256_set1_epi8(0x0F);
+    __m256i v  = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)w), _mm256_set1_epi8((char)0x88));
+    __m256i lo = _mm256_and_si256(v, m4);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), m4);
+    *a0 = _mm256_unpacklo_epi8(lo, hi);
+    *a1 = _mm256_unpackhi_epi8(lo, hi);
+}
+
+__attribute__((target("avx2")))
+static inline int32_t s_hsum_avx2(__m256i acc) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+/* n is a multiple of 32 */
+__attribute__((target("avx2")))
+static int32_t s_dot_i4_avx2(const uint8_t *w, const int8_t *x, size_t n, int32_t xs8) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t c = 0;
+    for (; c + 64 <= n; c += 64) {
+        __m256i a0, a1;
+        s_unpack64_avx2(w + c / 2, &a0, &a1);
+        __m256i x0 = _mm256_loadu_si256((const __m256i *)(x + c));
+        __m256i x1 = _mm256_loadu_si256((const __m256i *)(x + c + 32));
+        __m256i p  = _mm256_add_epi16(_mm256_maddubs_epi16(a0, _mm256_permute2x128_si256(x0, x1, 0x20)),
+                                      _mm256_maddubs_epi16(a1, _mm256_permute2x128_si256(x0, x1, 0x31)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(p, ones));
+    }
+    if (c < n) {
+        __m256i p = _mm256_maddubs_epi16(s_unpack32_avx2(w + c / 2),
+                                         _mm256_loadu_si256((const __m256i *)(x + c)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(p, ones));
+    }
+    return s_hsum_avx2(acc) - xs8;
+}
+
+/* n is a multiple of 32; one dpbusd per 64 weights */
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static int32_t s_dot_i4_vnni(const uint8_t *w, const int8_t *x, size_t n, int32_t xs8) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t c = 0;
+    for (; c + 64 <= n; c += 64) {
+        __m256i a0, a1;
+        s_unpack64_avx2(w + c / 2, &a0, &a1);
+        /* weights as lanes [e0-15 | e32-47 | e16-31 | e48-63], x to match */
+        __m512i a  = _mm512_inserti64x4(_mm512_castsi256_si512(a0), a1, 1);
+        __m512i vx = _mm512_loadu_si512((const void *)(x + c));
+        vx  = _mm512_shuffle_i64x2(vx, vx, _MM_SHUFFLE(3, 1, 2, 0));
+        acc = _mm512_dpbusd_epi32(acc, a, vx);
+    }
+    int32_t sum = _mm512_reduce_add_epi32(acc);
+    if (c < n) {
+        __m256i p = _mm256_maddubs_epi16(s_unpack32_avx2(w + c / 2),
+                                         _mm256_loadu_si256((const __m256i *)(x + c)));
+        sum += s_hsum_avx2(_mm256_madd_epi16(p, _mm256_set1_epi16(1)));
+    }
+    return sum - xs8;
+}
+
+#endif // MATRIX_I4_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_I4_ARM64
+
+/* 8 packed bytes -> 16 weights (zip of low / high nibbles), smull + sadalp */
+static int32_t s_dot_i4_neon(const uint8_t *w, const int8_t *x, size_t n) {
+    const uint8x8_t m4 = vdup_n_u8(0x0F);
+    const int8x16_t s8 = vdupq_n_s8(8);
+    int32x4_t acc = vdupq_n_s32(0);
+    size_t c = 0;
+    for (; c + 16 <= n; c += 16) {
+        uint8x8_t b  = vld1_u8(w + c / 2);
+        uint8x8x2_t z = vzip_u8(vand_u8(b, m4), vshr_n_u8(b, 4));
+        int8x16_t q  = vreinterpretq_s8_u8(vcombine_u8(z.val[0], z.val[1]));
+        q = vsubq_s8(veorq_s8(q, s8), s8);
+        int8x16_t vx = vld1q_s8(x + c);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(q), vget_low_s8(vx)));
+        acc = vpadalq_s16(acc, vmull_high_s8(q, vx));
+    }
+    return vaddvq_s32(acc) + s_dot_i4_scalar(w + c / 2, x + c, n - c);
+}
+
+#endif // MATRIX_I4_ARM64
+
+/**
+ * @brief packed int4 matrix-vector product
+ * @param W4 pointer of the packed weights [rows x MATRIX_I4_ROW_BYTES(X->len)]
+ * @param rows number of output rows
+ * @param X pointer of the input tensor
+ * @param acc_buffer pointer of the int32 outputs [rows]
+ * @return NULL
+ */
+void matrix_mul_i4(const uint8_t *W4, size_t rows, const tensor_t *X, int32_t *acc_buffer) {
+    if (!W4 || !X || !acc_buffer) return;
+    size_t cols = X->len;
+    size_t rb   = MATRIX_I4_ROW_BYTES(cols);
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_I4_X86)
+    if (isa >= TT_ISA_AVX2) {
+        /* vector part: multiples of 32 columns, the rest in scalar */
+        size_t nv = cols & ~(size_t)31;
+        int32_t xs8 = 0;
+        for (size_t c = 0; c < nv; ++c) xs8 += X->data[c];
+        xs8 *= 8;
+        const int8_t *xt = X->data + nv;
+        int vnni = isa >= TT_ISA_AVX512_VNNI;
+        for (size_t r = 0; r < rows; ++r) {
+            const uint8_t *w = W4 + r * rb;
+            int32_t sum = vnni ? s_dot_i4_vnni(w, X->data, nv, xs8) : s_dot_i4_avx2(w, X->data, nv, xs8);
+            acc_buffer[r] = sum + s_dot_i4_scalar(w + nv / 2, xt, cols - nv);
+        }
+        return;
+    }
+#elif defined(MATRIX_I4_ARM64)
+    if (isa >= TT_ISA_NEON) {
+        for (size_t r = 0; r < rows; ++r) acc_buffer[r] = s_dot_i4_neon(W4 + r * rb, X->data, cols);
+        return;
+    }
+#endif
+    (void)isa;
+    for (size_t r = 0; r < rows; ++r) acc_buffer[r] = s_dot_i4_scalar(W4 + r * rb, X->data, cols);
+}
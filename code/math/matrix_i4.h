@@ -0,0 +1,31 @@
+/**
+ * @file matrix_i4.h
+ * @brief packed int4 weights x int8 activations -> int32 kernels
+ * @details two weights per byte, row-major, element 2i in the low nibble
+ * and 2i+1 in the high nibble; a row takes MATRIX_I4_ROW_BYTES(cols) bytes
+ * (odd rows end with a zero nibble). A nibble q in [-8, 7] stands for
+ * q << k of the int8 weights it was packed from. The vector kernels unpack
+ * in registers; tests/test_kernels.c checks them against q x for unpacked q.
+ * @license MIT
+ */
+#ifndef MATRIX_I4_H
+#define MATRIX_I4_H
+
+#include "tt_types.h"
+#include <stdint.h>
+
+#define MATRIX_I4_ROW_BYTES(cols)  (((size_t)(cols) + 1) / 2)
+
+/* smallest k so that every w >> k (rounded) fits a nibble */
+uint8_t matrix_i4_shift(const int8_t *w, size_t n);
+
+/* q = clip4(round(w >> k)) of a rows x cols int8 matrix */
+void    matrix_i4_pack(uint8_t *dst, const int8_t *src, size_t rows, size_t cols, uint8_t k);
+
+/* nibbles back to int8 (q, without the << k) */
+void    matrix_i4_unpack(int8_t *dst, const uint8_t *src, size_t rows, size_t cols);
+
+/* acc[r] = sum_c q[r][c] * x[c], rows x X->len packed weights */
+void    matrix_mul_i4(const uint8_t *W4, size_t rows, const tensor_t *X, int32_t *acc_buffer);
+
+#endif // MATRIX_I4_H
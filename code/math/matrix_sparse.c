@@ -0,0 +1,247 @@
+/**
+ * @file matrix_sparse.c
+ * @brief block-CSR GEMV kernels
+ * @details one kept block is a 64-byte tile of 4 rows x 16 columns against
+ * one 16-byte slice of x, summed into 4 row accumulators:
+ *  - AVX-512 VNNI: x is broadcast to the four 128-bit lanes and biased to
+ *    unsigned (x ^ 0x80 == x + 128), one vpdpbusd per tile leaves row i in
+ *    lane i; the bias is removed with the per-row 128 * sum w of the build.
+ *  - AVX2: cvtepi8_epi16 + madd per tile row, reduced with hadd.
+ *  - NEON: smull + sadalp per tile row.
+ * A short last block column reads x through a zero-padded copy (or a masked
+ * load), the tiles themselves are zero padded.
+ * @license MIT
+ */
+#include "matrix_sparse.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_SP_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_SP_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief carve the index and tile storage of a rows x cols matrix
+ * @param sp pointer of the index
+ * @param mem pointer of MATRIX_SP_BYTES(rows, cols) bytes, 64-byte aligned
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return int 0 on success, -1 on bad arguments
+ */
+int matrix_sp_init(matrix_sp_t *sp, void *mem, size_t rows, size_t cols) {
+    if (!sp || !mem || !rows || !cols || rows > UINT16_MAX || cols > UINT16_MAX) return -1;
+    if ((uintptr_t)mem & 63) return -1;
+    size_t nbr = MATRIX_SP_NBR(rows), nbc = MATRIX_SP_NBC(cols);
+    uint8_t *p = (uint8_t *)mem;
+    sp->vals     = (int8_t *)p;    p += MATRIX_SP_PAD64(nbr * nbc * MATRIX_SP_TILE);
+    sp->row_bias = (int32_t *)p;   p += MATRIX_SP_PAD64(nbr * MATRIX_SP_BR * sizeof(int32_t));
+    sp->row_ptr  = (uint32_t *)p;  p += MATRIX_SP_PAD64((nbr + 1) * sizeof(uint32_t));
+    sp->blk_col  = (uint16_t *)p;
+    sp->rows     = (uint16_t)rows;
+    sp->cols     = (uint16_t)cols;
+    memset(sp->row_ptr, 0, (nbr + 1) * sizeof(uint32_t));
+    memset(sp->row_bias, 0, nbr * MATRIX_SP_BR * sizeof(int32_t));
+    return 0;
+}
+
+static inline size_t s_min(size_t a, size_t b) { return a < b ? a : b; }
+
+/**
+ * @brief rebuild the index and the tiles from the dense weights
+ * @param sp pointer of the index
+ * @param W pointer of the dense rows x cols weights
+ * @return size_t number of kept blocks
+ */
+size_t matrix_sp_build(matrix_sp_t *sp, const int8_t *W) {
+    if (!sp || !W) return 0;
+    size_t nbr = MATRIX_SP_NBR(sp->rows), nbc = MATRIX_SP_NBC(sp->cols);
+    uint32_t k = 0;
+    for (size_t br = 0; br < nbr; ++br) {
+        size_t r0 = br * MATRIX_SP_BR, nr = s_min(MATRIX_SP_BR, sp->rows - r0);
+        int32_t *bias = sp->row_bias + r0;
+        for (size_t i = 0; i < MATRIX_SP_BR; ++i) bias[i] = 0;
+        sp->row_ptr[br] = k;
+        for (size_t bc = 0; bc < nbc; ++bc) {
+            size_t c0 = bc * MATRIX_SP_BC, nc = s_min(MATRIX_SP_BC, sp->cols - c0);
+            int8_t any = 0;
+            for (size_t i = 0; i < nr; ++i)
+                for (size_t j = 0; j < nc; ++j) any |= W[(r0 + i) * sp->cols + c0 + j];
+            if (!any) continue;
+
+            int8_t *t = sp->vals + (size_t)k * MATRIX_SP_TILE;
+            memset(t, 0, MATRIX_SP_TILE);
+            for (size_t i = 0; i < nr; ++i)
+                for (size_t j = 0; j < nc; ++j) {
+                    int8_t v = W[(r0 + i) * sp->cols + c0 + j];
+                    t[i * MATRIX_SP_BC + j] = v;
+                    bias[i] += 128 * (int32_t)v;
+                }
+            sp->blk_col[k++] = (uint16_t)bc;
+        }
+    }
+    sp->row_ptr[nbr] = k;
+    return k;
+}
+
+size_t matrix_sp_kept(const matrix_sp_t *sp) {
+    return sp ? sp->row_ptr[MATRIX_SP_NBR(sp->rows)] : 0;
+}
+
+uint32_t matrix_sp_block_l1(const matrix_sp_t *sp, const int8_t *W, size_t br, size_t bc) {
+    if (!sp || !W) return 0;
+    size_t r0 = br * MATRIX_SP_BR, nr = s_min(MATRIX_SP_BR, sp->rows - r0);
+    size_t c0 = bc * MATRIX_SP_BC, nc = s_min(MATRIX_SP_BC, sp->cols - c0);
+    uint32_t l1 = 0;
+    for (size_t i = 0; i < nr; ++i)
+        for (size_t j = 0; j < nc; ++j) {
+            int8_t v = W[(r0 + i) * sp->cols + c0 + j];
+            l1 += (uint32_t)(v < 0 ? -v : v);
+        }
+    return l1;
+}
+
+/* x slice of block column bc, through a zero-padded copy when short */
+static inline const int8_t *s_x_slice(const matrix_sp_t *sp, const int8_t *x, size_t bc, int8_t *pad) {
+    size_t c0 = bc * MATRIX_SP_BC;
+    if (c0 + MATRIX_SP_BC <= sp->cols) return x + c0;
+    memset(pad, 0, MATRIX_SP_BC);
+    memcpy(pad, x + c0, sp->cols - c0);
+    return pad;
+}
+
+static inline void s_store_rows(const matrix_sp_t *sp, size_t br, const int32_t *sum, int32_t *acc) {
+    size_t r0 = br * MATRIX_SP_BR, nr = s_min(MATRIX_SP_BR, sp->rows - r0);
+    for (size_t i = 0; i < nr; ++i) acc[r0 + i] = sum[i];
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+static void s_mul_scalar(const matrix_sp_t *sp, const int8_t *x, int32_t *acc) {
+    int8_t pad[MATRIX_SP_BC];
+    for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br) {
+        int32_t sum[MATRIX_SP_BR] = { 0 };
+        for (uint32_t k = sp->row_ptr[br]; k < sp->row_ptr[br + 1]; ++k) {
+            const int8_t *t  = sp->vals + (size_t)k * MATRIX_SP_TILE;
+            const int8_t *xs = s_x_slice(sp, x, sp->blk_col[k], pad);
+            for (size_t i = 0; i < MATRIX_SP_BR; ++i)
+                for (size_t j = 0; j < MATRIX_SP_BC; ++j)
+                    sum[i] += (int32_t)t[i * MATRIX_SP_BC + j] * (int32_t)xs[j];
+        }
+        s_store_rows(sp, br, sum, acc);
+    }
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_SP_X86
+
+__attribute__((target("avx2")))
+static void s_mul_avx2(const matrix_sp_t *sp, const int8_t *x, int32_t *acc) {
+    int8_t pad[MATRIX_SP_BC];
+    for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br) {
+        __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+        __m256i a2 = _mm256_setzero_si256(), a3 = _mm256_setzero_si256();
+        for (uint32_t k = sp->row_ptr[br]; k < sp->row_ptr[br + 1]; ++k) {
+            const int8_t *t = sp->vals + (size_t)k * MATRIX_SP_TILE;
+            __m256i xv = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)s_x_slice(sp, x, sp->blk_col[k], pad)));
+            a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(t +  0))), xv));
+            a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(t + 16))), xv));
+            a2 = _mm256_add_epi32(a2, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(t + 32))), xv));
+            a3 = _mm256_add_epi32(a3, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(t + 48))), xv));
+        }
+        /* [sum a0, sum a1, sum a2, sum a3] */
+        __m256i h = _mm256_hadd_epi32(_mm256_hadd_epi32(a0, a1), _mm256_hadd_epi32(a2, a3));
+        int32_t sum[MATRIX_SP_BR];
+        _mm_storeu_si128((__m128i *)sum, _mm_add_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1)));
+        s_store_rows(sp, br, sum, acc);
+    }
+}
+
+/* x slice of block column bc in every 128-bit lane, biased to unsigned */
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static inline __m512i s_x_bcast_vnni(const matrix_sp_t *sp, const int8_t *x, size_t bc) {
+    size_t c0 = bc * MATRIX_SP_BC;
+    __m128i v;
+    if (c0 + MATRIX_SP_BC <= sp->cols)
+        v = _mm_loadu_si128((const __m128i *)(x + c0));
+    else   /* masked lanes neither fault nor load */
+        v = _mm512_castsi512_si128(_mm512_maskz_loadu_epi8((__mmask64)((1u << (sp->cols - c0)) - 1), x + c0));
+    return _mm512_xor_si512(_mm512_broadcast_i32x4(v), _mm512_set1_epi8((char)0x80));
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void s_mul_vnni(const matrix_sp_t *sp, const int8_t *x, int32_t *acc) {
+    for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br) {
+        __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+        uint32_t k = sp->row_ptr[br], end = sp->row_ptr[br + 1];
+        /* two chains hide the vpdpbusd latency */
+        for (; k + 2 <= end; k += 2) {
+            a0 = _mm512_dpbusd_epi32(a0, s_x_bcast_vnni(sp, x, sp->blk_col[k]),
+                                     _mm512_load_si512((const void *)(sp->vals + (size_t)k * MATRIX_SP_TILE)));
+            a1 = _mm512_dpbusd_epi32(a1, s_x_bcast_vnni(sp, x, sp->blk_col[k + 1]),
+                                     _mm512_load_si512((const void *)(sp->vals + (size_t)(k + 1) * MATRIX_SP_TILE)));
+        }
+        if (k < end) {
+            a0 = _mm512_dpbusd_epi32(a0, s_x_bcast_vnni(sp, x, sp->blk_col[k]),
+                                     _mm512_load_si512((const void *)(sp->vals + (size_t)k * MATRIX_SP_TILE)));
+        }
+        /* row i is the 128-bit lane i */
+        __m512i s = _mm512_add_epi32(a0, a1);
+        s = _mm512_add_epi32(s, _mm512_shuffle_epi32(s, (_MM_PERM_ENUM)0x4E));
+        s = _mm512_add_epi32(s, _mm512_shuffle_epi32(s, (_MM_PERM_ENUM)0xB1));
+        int32_t lanes[16], sum[MATRIX_SP_BR];
+        _mm512_storeu_si512((void *)lanes, s);
+        for (size_t i = 0; i < MATRIX_SP_BR; ++i) sum[i] = lanes[4 * i] - sp->row_bias[br * MATRIX_SP_BR + i];
+        s_store_rows(sp, br, sum, acc);
+    }
+}
+
+#endif // MATRIX_SP_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_SP_ARM64
+
+static void s_mul_neon(const matrix_sp_t *sp, const int8_t *x, int32_t *acc) {
+    int8_t pad[MATRIX_SP_BC];
+    for (size_t br = 0; br < MATRIX_SP_NBR(sp->rows); ++br) {
+        int32x4_t a[MATRIX_SP_BR] = { vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0) };
+        for (uint32_t k = sp->row_ptr[br]; k < sp->row_ptr[br + 1]; ++k) {
+            const int8_t *t = sp->vals + (size_t)k * MATRIX_SP_TILE;
+            int8x16_t xv = vld1q_s8(s_x_slice(sp, x, sp->blk_col[k], pad));
+            for (size_t i = 0; i < MATRIX_SP_BR; ++i) {
+                int8x16_t wv = vld1q_s8(t + i * MATRIX_SP_BC);
+                a[i] = vpadalq_s16(a[i], vmull_s8(vget_low_s8(wv), vget_low_s8(xv)));
+                a[i] = vpadalq_s16(a[i], vmull_high_s8(wv, xv));
+            }
+        }
+        int32_t sum[MATRIX_SP_BR];
+        for (size_t i = 0; i < MATRIX_SP_BR; ++i) sum[i] = vaddvq_s32(a[i]);
+        s_store_rows(sp, br, sum, acc);
+    }
+}
+
+#endif // MATRIX_SP_ARM64
+
+/**
+ * @brief block-sparse matrix-vector product on the kept tiles
+ * @param sp pointer of the built index
+ * @param x pointer of the cols inputs
+ * @param acc_buffer pointer of the int32 outputs [rows]
+ * @return NULL
+ */
+void matrix_mul_sp(const matrix_sp_t *sp, const int8_t *x, int32_t *acc_buffer) {
+    if (!sp || !x || !acc_buffer) return;
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_SP_X86)
+    if (isa >= TT_ISA_AVX512_VNNI) { s_mul_vnni(sp, x, acc_buffer); return; }
+    if (isa >= TT_ISA_AVX2)        { s_mul_avx2(sp, x, acc_buffer); return; }
+#elif defined(MATRIX_SP_ARM64)
+    if (isa >= TT_ISA_NEON)        { s_mul_neon(sp, x, acc_buffer); return; }
+#endif
+    (void)isa;
+    s_mul_scalar(sp, x, acc_buffer);
+}
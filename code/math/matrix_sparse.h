@@ -0,0 +1,60 @@
+/**
+ * @file matrix_sparse.h
+ * @brief block-sparse int8 weights x int8 activations -> int32 kernels
+ * @details block-CSR (BSR) with MATRIX_SP_BR x MATRIX_SP_BC blocks: the
+ * row-major weights are cut into block rows of BR rows and each block row
+ * into blocks of BC columns. The index lists the kept blocks of every block
+ * row and their values are copied out, zero padded, into one contiguous
+ * BR x BC tile each, so a kept block is a single 64-byte load against one
+ * BC-wide slice of x. The dense array stays the master copy (the train
+ * kernels work on it); matrix_sp_build refreshes the tiles from it.
+ * The VNNI kernel feeds x + 128 as the unsigned operand and takes row_bias
+ * back out, which is exact in int32; tests/test_kernels.c checks every
+ * level against the dense product of the pruned W.
+ * @license MIT
+ */
+#ifndef MATRIX_SPARSE_H
+#define MATRIX_SPARSE_H
+
+#include "tt_types.h"
+#include <stdint.h>
+
+#define MATRIX_SP_BR            (4)
+#define MATRIX_SP_BC            (16)
+#define MATRIX_SP_TILE          (MATRIX_SP_BR * MATRIX_SP_BC)
+/* block rows / blocks per block row */
+#define MATRIX_SP_NBR(rows)     (((size_t)(rows) + MATRIX_SP_BR - 1) / MATRIX_SP_BR)
+#define MATRIX_SP_NBC(cols)     (((size_t)(cols) + MATRIX_SP_BC - 1) / MATRIX_SP_BC)
+#define MATRIX_SP_PAD64(n)      (((size_t)(n) + 63) & ~(size_t)63)
+/* worst-case storage of a rows x cols matrix: tiles, row bias, row_ptr, blk_col */
+#define MATRIX_SP_BYTES(rows, cols)                                                   \
+    (MATRIX_SP_PAD64(MATRIX_SP_NBR(rows) * MATRIX_SP_NBC(cols) * MATRIX_SP_TILE) +   \
+     MATRIX_SP_PAD64(MATRIX_SP_NBR(rows) * MATRIX_SP_BR * sizeof(int32_t)) +         \
+     MATRIX_SP_PAD64((MATRIX_SP_NBR(rows) + 1) * sizeof(uint32_t)) +                 \
+     MATRIX_SP_PAD64(MATRIX_SP_NBR(rows) * MATRIX_SP_NBC(cols) * sizeof(uint16_t)))
+
+typedef struct {
+    int8_t   *vals;      /* [kept x TILE] tiles, row-major within a tile */
+    int32_t  *row_bias;  /* [nbr x BR] 128 * sum of the kept weights of each row */
+    uint32_t *row_ptr;   /* [nbr + 1] first kept block of each block row */
+    uint16_t *blk_col;   /* [nbr x nbc] kept block columns, ascending */
+    uint16_t  rows;
+    uint16_t  cols;
+} matrix_sp_t;
+
+/* carves MATRIX_SP_BYTES(rows, cols) bytes of 64-byte aligned mem; 0 or -1 */
+int    matrix_sp_init(matrix_sp_t *sp, void *mem, size_t rows, size_t cols);
+
+/* keeps every block of W holding a non-zero and copies their tiles, returns the kept count */
+size_t matrix_sp_build(matrix_sp_t *sp, const int8_t *W);
+
+/* kept blocks */
+size_t matrix_sp_kept(const matrix_sp_t *sp);
+
+/* sum |w| of block (br, bc) of the dense rows x cols W */
+uint32_t matrix_sp_block_l1(const matrix_sp_t *sp, const int8_t *W, size_t br, size_t bc);
+
+/* acc[r] = sum over the kept blocks of row r of w[r][c] * x[c] */
+void   matrix_mul_sp(const matrix_sp_t *sp, const int8_t *x, int32_t *acc_buffer);
+
+#endif // MATRIX_SPARSE_H
@@ -0,0 +1,333 @@
+/**
+ * @file matrix_tile.c
+ * @brief GEMV and transposed GEMV on 16 x 4 weight tiles
+ * @details forward, one row block at a time, every tile against 4 bytes of x:
+ *  - AVX-512 VNNI: the weights are biased to unsigned (w ^ 0x80 == w + 128)
+ *    and x is broadcast as is, one vpdpbusd per tile leaves row i in lane i;
+ *    the bias 128 * sum x is the same for every row and taken once per call.
+ *  - AVX2: cvtepi8_epi16 + madd per 16-byte quarter, reduced with hadd.
+ *  - NEON: sdot per quarter where the compiler targets it, else smull +
+ *    sadalp per 8-byte half.
+ * Transposed, MATRIX_TILE_TCB column blocks at a time so the tiles of a
+ * row block are read back to back: AVX2 interleaves the row pairs of each
+ * column with one pshufb and madds them against the matching error pairs,
+ * NEON widens and multiply-accumulates one row at a time.
+ * A short last block reads x / e through a zero-padded copy.
+ * @license MIT
+ */
+#include "matrix_tile.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include "tt_utils.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MATRIX_TILE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define MATRIX_TILE_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/* column blocks summed together by the transposed kernels */
+#define MATRIX_TILE_TCB         (8)
+
+/**
+ * @brief geometry of a rows x cols matrix
+ * @param t pointer of the geometry
+ * @param rows number of rows
+ * @param cols number of columns
+ * @return int 0 on success, -1 on bad arguments
+ */
+int matrix_tile_init(matrix_tile_t *t, size_t rows, size_t cols) {
+    if (!t || !rows || !cols || rows > UINT16_MAX || cols > UINT16_MAX) return -1;
+    t->rows = (uint16_t)rows;
+    t->cols = (uint16_t)cols;
+    return 0;
+}
+
+static inline size_t s_min(size_t a, size_t b) { return a < b ? a : b; }
+
+/**
+ * @brief copy row-major weights into the tiles
+ * @param t pointer of the geometry
+ * @param W pointer of the rows x cols weights
+ * @param Wt pointer of the MATRIX_TILE_LEN(rows, cols) tiled bytes
+ * @return NULL
+ */
+void matrix_tile_pack(const matrix_tile_t *t, const int8_t *W, int8_t *Wt) {
+    if (!t || !W || !Wt) return;
+    memset(Wt, 0, MATRIX_TILE_LEN(t->rows, t->cols));
+    for (size_t r = 0; r < t->rows; ++r)
+        for (size_t c = 0; c < t->cols; c += MATRIX_TILE_C)
+            memcpy(Wt + matrix_tile_idx(t, r, c), W + r * t->cols + c, s_min(MATRIX_TILE_C, t->cols - c));
+}
+
+/**
+ * @brief copy the tiles back to row-major weights
+ * @param t pointer of the geometry
+ * @param Wt pointer of the tiled bytes
+ * @param W pointer of the rows x cols weights
+ * @return NULL
+ */
+void matrix_tile_unpack(const matrix_tile_t *t, const int8_t *Wt, int8_t *W) {
+    if (!t || !Wt || !W) return;
+    for (size_t r = 0; r < t->rows; ++r)
+        for (size_t c = 0; c < t->cols; c += MATRIX_TILE_C)
+            memcpy(W + r * t->cols + c, Wt + matrix_tile_idx(t, r, c), s_min(MATRIX_TILE_C, t->cols - c));
+}
+
+/* the 4 inputs of column block cb as one int32, zero padded */
+static inline int32_t s_x4(const matrix_tile_t *t, const int8_t *x, size_t cb) {
+    size_t c0 = cb * MATRIX_TILE_C;
+    int32_t v = 0;
+    if (c0 + MATRIX_TILE_C <= t->cols) memcpy(&v, x + c0, MATRIX_TILE_C);
+    else                               memcpy(&v, x + c0, t->cols - c0);
+    return v;
+}
+
+/* the 16 errors of row block rb, through a zero-padded copy when short */
+static inline const int8_t *s_e_slice(const matrix_tile_t *t, const int8_t *e, size_t rb, int8_t *pad) {
+    size_t r0 = rb * MATRIX_TILE_R;
+    if (r0 + MATRIX_TILE_R <= t->rows) return e + r0;
+    memset(pad, 0, MATRIX_TILE_R);
+    memcpy(pad, e + r0, t->rows - r0);
+    return pad;
+}
+
+static inline void s_store_rows(const matrix_tile_t *t, size_t rb, const int32_t *sum, int32_t *acc) {
+    size_t r0 = rb * MATRIX_TILE_R;
+    memcpy(acc + r0, sum, s_min(MATRIX_TILE_R, t->rows - r0) * sizeof(int32_t));
+}
+
+static inline void s_store_cols(const matrix_tile_t *t, size_t cb, const int32_t *sum, uint8_t shift, int8_t *y) {
+    size_t c0 = cb * MATRIX_TILE_C, n = s_min(MATRIX_TILE_C, t->cols - c0);
+    for (size_t j = 0; j < n; ++j) y[c0 + j] = clip_int8(shift_round32_inline(sum[j], shift));
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+static void s_mul_scalar(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc) {
+    size_t nc = MATRIX_TILE_NC(t->cols);
+    for (size_t rb = 0; rb < MATRIX_TILE_NR(t->rows); ++rb) {
+        int32_t sum[MATRIX_TILE_R] = { 0 };
+        for (size_t cb = 0; cb < nc; ++cb) {
+            const int8_t *w = Wt + (rb * nc + cb) * MATRIX_TILE;
+            int32_t x4 = s_x4(t, x, cb);
+            const int8_t *xs = (const int8_t *)&x4;
+            for (size_t i = 0; i < MATRIX_TILE_R; ++i)
+                for (size_t j = 0; j < MATRIX_TILE_C; ++j)
+                    sum[i] += (int32_t)w[i * MATRIX_TILE_C + j] * (int32_t)xs[j];
+        }
+        s_store_rows(t, rb, sum, acc);
+    }
+}
+
+static void s_tmul_scalar(const matrix_tile_t *t, const int8_t *Wt, const int8_t *e, uint8_t shift, int8_t *y) {
+    size_t nc = MATRIX_TILE_NC(t->cols);
+    int8_t pad[MATRIX_TILE_R];
+    for (size_t cb = 0; cb < nc; ++cb) {
+        int32_t sum[MATRIX_TILE_C] = { 0 };
+        for (size_t rb = 0; rb < MATRIX_TILE_NR(t->rows); ++rb) {
+            const int8_t *w  = Wt + (rb * nc + cb) * MATRIX_TILE;
+            const int8_t *es = s_e_slice(t, e, rb, pad);
+            for (size_t i = 0; i < MATRIX_TILE_R; ++i)
+                for (size_t j = 0; j < MATRIX_TILE_C; ++j)
+                    sum[j] += (int32_t)w[i * MATRIX_TILE_C + j] * (int32_t)es[i];
+        }
+        s_store_cols(t, cb, sum, shift, y);
+    }
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef MATRIX_TILE_X86
+
+__attribute__((target("avx2")))
+static void s_mul_avx2(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc) {
+    size_t nc = MATRIX_TILE_NC(t->cols);
+    for (size_t rb = 0; rb < MATRIX_TILE_NR(t->rows); ++rb) {
+        const int8_t *w = Wt + rb * nc * MATRIX_TILE;
+        __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+        __m256i a2 = _mm256_setzero_si256(), a3 = _mm256_setzero_si256();
+        for (size_t cb = 0; cb < nc; ++cb, w += MATRIX_TILE) {
+            /* x0..x3 in every group of 4 lanes */
+            __m256i xv = _mm256_cvtepi8_epi16(_mm_set1_epi32(s_x4(t, x, cb)));
+            a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(w +  0))), xv));
+            a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(w + 16))), xv));
+            a2 = _mm256_add_epi32(a2, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(w + 32))), xv));
+            a3 = _mm256_add_epi32(a3, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm_load_si128((const __m128i *)(w + 48))), xv));
+        }
+        /* quarter q holds rows 4q..4q+3 as pairs of partial sums */
+        int32_t sum[MATRIX_TILE_R];
+        _mm256_storeu_si256((__m256i *)(sum + 0), _mm256_permute4x64_epi64(_mm256_hadd_epi32(a0, a1), 0xD8));
+        _mm256_storeu_si256((__m256i *)(sum + 8), _mm256_permute4x64_epi64(_mm256_hadd_epi32(a2, a3), 0xD8));
+        s_store_rows(t, rb, sum, acc);
+    }
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void s_mul_vnni(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc) {
+    size_t nc = MATRIX_TILE_NC(t->cols);
+    const __m512i k80 = _mm512_set1_epi8((char)0x80);
+    int32_t xsum = 0;
+    for (size_t c = 0; c < t->cols; ++c) xsum += x[c];
+    const __m512i bias = _mm512_set1_epi32(128 * xsum);
+    for (size_t rb = 0; rb < MATRIX_TILE_NR(t->rows); ++rb) {
+        const int8_t *w = Wt + rb * nc * MATRIX_TILE;
+        __m512i a0 = _mm512_setzero_si512(), a1 = _mm512_setzero_si512();
+        size_t cb = 0;
+        /* two chains hide the vpdpbusd latency */
+        for (; cb + 2 <= nc; cb += 2, w += 2 * MATRIX_TILE) {
+            a0 = _mm512_dpbusd_epi32(a0, _mm512_xor_si512(_mm512_load_si512((const void *)w), k80),
+                                     _mm512_set1_epi32(s_x4(t, x, cb)));
+            a1 = _mm512_dpbusd_epi32(a1, _mm512_xor_si512(_mm512_load_si512((const void *)(w + MATRIX_TILE)), k80),
+                                     _mm512_set1_epi32(s_x4(t, x, cb + 1)));
+        }
+        if (cb < nc) {
+            a0 = _mm512_dpbusd_epi32(a0, _mm512_xor_si512(_mm512_load_si512((const void *)w), k80),
+                                     _mm512_set1_epi32(s_x4(t, x, cb)));
+        }
+        int32_t sum[MATRIX_TILE_R];
+        _mm512_storeu_si512((void *)sum, _mm512_sub_epi32(_mm512_add_epi32(a0, a1), bias));
+        s_store_rows(t, rb, sum, acc);
+    }
+}
+
+__attribute__((target("avx2")))
+static void s_tmul_avx2(const matrix_tile_t *t, const int8_t *Wt, const int8_t *e, uint8_t shift, int8_t *y) {
+    size_t nc = MATRIX_TILE_NC(t->cols), nr = MATRIX_TILE_NR(t->rows);
+    /* per 16-byte quarter: rows (0, 1) then (2, 3) of every column side by side */
+    const __m256i shuf = _mm256_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15,
+                                          0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+    int8_t pad[MATRIX_TILE_R];
+    for (size_t cb0 = 0; cb0 < nc; cb0 += MATRIX_TILE_TCB) {
+        size_t nb = s_min(MATRIX_TILE_TCB, nc - cb0);
+        __m256i s[MATRIX_TILE_TCB];
+        for (size_t k = 0; k < nb; ++k) s[k] = _mm256_setzero_si256();
+        for (size_t rb = 0; rb < nr; ++rb) {
+            /* error pairs (e0, e1), (e2, e3), ... as int32 units, four per quarter */
+            __m256i ev = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)s_e_slice(t, e, rb, pad)));
+            __m256i e0 = _mm256_permutevar8x32_epi32(ev, _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1));
+            __m256i e1 = _mm256_permutevar8x32_epi32(ev, _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3));
+            __m256i e2 = _mm256_permutevar8x32_epi32(ev, _mm256_setr_epi32(4, 4, 4, 4, 5, 5, 5, 5));
+            __m256i e3 = _mm256_permutevar8x32_epi32(ev, _mm256_setr_epi32(6, 6, 6, 6, 7, 7, 7, 7));
+            const int8_t *w = Wt + (rb * nc + cb0) * MATRIX_TILE;
+            for (size_t k = 0; k < nb; ++k, w += MATRIX_TILE) {
+                __m256i w01 = _mm256_shuffle_epi8(_mm256_load_si256((const __m256i *)(w +  0)), shuf);
+                __m256i w23 = _mm256_shuffle_epi8(_mm256_load_si256((const __m256i *)(w + 32)), shuf);
+                __m256i p = _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(w01)), e0);
+                p = _mm256_add_epi32(p, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(w01, 1)), e1));
+                p = _mm256_add_epi32(p, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(w23)), e2));
+                p = _mm256_add_epi32(p, _mm256_madd_epi16(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(w23, 1)), e3));
+                s[k] = _mm256_add_epi32(s[k], p);
+            }
+        }
+        for (size_t k = 0; k < nb; ++k) {
+            int32_t sum[MATRIX_TILE_C];
+            _mm_storeu_si128((__m128i *)sum, _mm_add_epi32(_mm256_castsi256_si128(s[k]), _mm256_extracti128_si256(s[k], 1)));
+            s_store_cols(t, cb0 + k, sum, shift, y);
+        }
+    }
+}
+
+#endif // MATRIX_TILE_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef MATRIX_TILE_ARM64
+
+static void s_mul_neon(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc) {
+    size_t nc = MATRIX_TILE_NC(t->cols);
+    for (size_t rb = 0; rb < MATRIX_TILE_NR(t->rows); ++rb) {
+        const int8_t *w = Wt + rb * nc * MATRIX_TILE;
+        int32_t sum[MATRIX_TILE_R];
+#ifdef __ARM_FEATURE_DOTPROD
+        /* sdot: quarter q leaves rows 4q..4q+3 in its lanes */
+        int32x4_t a[4] = { vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0), vdupq_n_s32(0) };
+        for (size_t cb = 0; cb < nc; ++cb, w += MATRIX_TILE) {
+            int8x16_t xv = vreinterpretq_s8_s32(vdupq_n_s32(s_x4(t, x, cb)));
+            for (size_t q = 0; q < 4; ++q) a[q] = vdotq_s32(a[q], vld1q_s8(w + 16 * q), xv);
+        }
+        for (size_t q = 0; q < 4; ++q) vst1q_s32(sum + 4 * q, a[q]);
+#else
+        /* half h holds rows 2h, 2h + 1; sadalp leaves two partial sums per row */
+        int32x4_t a[8];
+        for (size_t h = 0; h < 8; ++h) a[h] = vdupq_n_s32(0);
+        for (size_t cb = 0; cb < nc; ++cb, w += MATRIX_TILE) {
+            int8x8_t xv = vreinterpret_s8_s32(vdup_n_s32(s_x4(t, x, cb)));
+            for (size_t h = 0; h < 8; ++h) a[h] = vpadalq_s16(a[h], vmull_s8(vld1_s8(w + 8 * h), xv));
+        }
+        for (size_t q = 0; q < 4; ++q) vst1q_s32(sum + 4 * q, vpaddq_s32(a[2 * q], a[2 * q + 1]));
+#endif
+        s_store_rows(t, rb, sum, acc);
+    }
+}
+
+static void s_tmul_neon(const matrix_tile_t *t, const int8_t *Wt, const int8_t *e, uint8_t shift, int8_t *y) {
+    size_t nc = MATRIX_TILE_NC(t->cols), nr = MATRIX_TILE_NR(t->rows);
+    int8_t pad[MATRIX_TILE_R];
+    for (size_t cb0 = 0; cb0 < nc; cb0 += MATRIX_TILE_TCB) {
+        size_t nb = s_min(MATRIX_TILE_TCB, nc - cb0);
+        int32x4_t s[MATRIX_TILE_TCB];
+        for (size_t k = 0; k < nb; ++k) s[k] = vdupq_n_s32(0);
+        for (size_t rb = 0; rb < nr; ++rb) {
+            const int8_t *es = s_e_slice(t, e, rb, pad);
+            const int8_t *w  = Wt + (rb * nc + cb0) * MATRIX_TILE;
+            for (size_t k = 0; k < nb; ++k, w += MATRIX_TILE) {
+                for (size_t h = 0; h < 8; ++h) {
+                    int16x8_t wv = vmovl_s8(vld1_s8(w + 8 * h));
+                    s[k] = vmlal_n_s16(s[k], vget_low_s16(wv),  es[2 * h]);
+                    s[k] = vmlal_n_s16(s[k], vget_high_s16(wv), es[2 * h + 1]);
+                }
+            }
+        }
+        for (size_t k = 0; k < nb; ++k) {
+            int32_t sum[MATRIX_TILE_C];
+            vst1q_s32(sum, s[k]);
+            s_store_cols(t, cb0 + k, sum, shift, y);
+        }
+    }
+}
+
+#endif // MATRIX_TILE_ARM64
+
+/**
+ * @brief matrix-vector product on the tiles
+ * @param t pointer of the geometry
+ * @param Wt pointer of the tiled weights, 64-byte aligned
+ * @param x pointer of the cols inputs
+ * @param acc_buffer pointer of the int32 outputs [rows]
+ * @return NULL
+ */
+void matrix_mul_tile(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc_buffer) {
+    if (!t || !Wt || !x || !acc_buffer) return;
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_TILE_X86)
+    if (isa >= TT_ISA_AVX512_VNNI) { s_mul_vnni(t, Wt, x, acc_buffer); return; }
+    if (isa >= TT_ISA_AVX2)        { s_mul_avx2(t, Wt, x, acc_buffer); return; }
+#elif defined(MATRIX_TILE_ARM64)
+    if (isa >= TT_ISA_NEON)        { s_mul_neon(t, Wt, x, acc_buffer); return; }
+#endif
+    (void)isa;
+    s_mul_scalar(t, Wt, x, acc_buffer);
+}
+
+/**
+ * @brief transposed matrix-vector product on the tiles, requantized to int8
+ * @param t pointer of the geometry
+ * @param Wt pointer of the tiled weights, 64-byte aligned
+ * @param e pointer of the rows errors
+ * @param shift rounded right shift of the int32 sums
+ * @param y pointer of the cols int8 outputs
+ * @return NULL
+ */
+void matrix_tmul_tile(const matrix_tile_t *t, const int8_t *Wt, const int8_t *e, uint8_t shift, int8_t *y) {
+    if (!t || !Wt || !e || !y) return;
+    tt_isa_t isa = matrix_isa();
+#if defined(MATRIX_TILE_X86)
+    if (isa >= TT_ISA_AVX2) { s_tmul_avx2(t, Wt, e, shift, y); return; }
+#elif defined(MATRIX_TILE_ARM64)
+    if (isa >= TT_ISA_NEON) { s_tmul_neon(t, Wt, e, shift, y); return; }
+#endif
+    (void)isa;
+    s_tmul_scalar(t, Wt, e, shift, y);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file matrix_tile.h
+ * @brief int8 weights in VNNI / sdot tiles: forward and transposed GEMV
+ * @details the [rows x cols] weights are cut into tiles of MATRIX_TILE_R
+ * rows x MATRIX_TILE_C columns, 64 bytes each, stored row-block major
+ *
+ *   t[(rb * nc + cb) * 64 + i * 4 + j] = W[rb * 16 + i][cb * 4 + j]
+ *
+ * with the last row and column blocks zero padded. Four consecutive bytes
+ * are one row against one 4-wide slice of x, which is exactly the operand
+ * of vpdpbusd (16 int32 lanes) and sdot (4 lanes per 16 bytes): a tile is
+ * one 64-byte load and a broadcast of 4 input bytes, with no shuffle. The
+ * transposed product Wt e streams the same tiles, so the backward pass
+ * never walks W with a stride of cols.
+ *
+ * The layout is the storage, not a copy: the tiled dense backends train
+ * W->data in this order, and the elementwise update kernels (tt_update.h)
+ * do not care about the order as long as G has the same one. Pads stay
+ * zero through training since their gradient is zero.
+ * The VNNI, AVX2 and NEON paths of both products return the plain sums
+ * (tests/test_kernels.c checks them against the loops above).
+ * @license MIT
+ */
+#ifndef MATRIX_TILE_H
+#define MATRIX_TILE_H
+
+#include "tt_types.h"
+#include <stdint.h>
+
+#define MATRIX_TILE_R           (16)
+#define MATRIX_TILE_C           (4)
+#define MATRIX_TILE             (MATRIX_TILE_R * MATRIX_TILE_C)
+/* row blocks / column blocks */
+#define MATRIX_TILE_NR(rows)    (((size_t)(rows) + MATRIX_TILE_R - 1) / MATRIX_TILE_R)
+#define MATRIX_TILE_NC(cols)    (((size_t)(cols) + MATRIX_TILE_C - 1) / MATRIX_TILE_C)
+/* tiled bytes of a rows x cols matrix, pads included */
+#define MATRIX_TILE_LEN(rows, cols) \
+    (MATRIX_TILE_NR(rows) * MATRIX_TILE_NC(cols) * MATRIX_TILE)
+
+typedef struct {
+    uint16_t rows;
+    uint16_t cols;
+} matrix_tile_t;
+
+/* geometry of a rows x cols matrix; 0 or -1 */
+int  matrix_tile_init(matrix_tile_t *t, size_t rows, size_t cols);
+
+/* tiled position of W[r][c] */
+static inline size_t matrix_tile_idx(const matrix_tile_t *t, size_t r, size_t c) {
+    return ((r / MATRIX_TILE_R) * MATRIX_TILE_NC(t->cols) + c / MATRIX_TILE_C) * MATRIX_TILE +
+           (r % MATRIX_TILE_R) * MATRIX_TILE_C + c % MATRIX_TILE_C;
+}
+
+/* row-major W [rows x cols] into the MATRIX_TILE_LEN bytes of Wt, pads zeroed */
+void matrix_tile_pack(const matrix_tile_t *t, const int8_t *W, int8_t *Wt);
+/* and back */
+void matrix_tile_unpack(const matrix_tile_t *t, const int8_t *Wt, int8_t *W);
+
+/* acc[r] = sum_c W[r][c] * x[c], Wt 64-byte aligned */
+void matrix_mul_tile(const matrix_tile_t *t, const int8_t *Wt, const int8_t *x, int32_t *acc_buffer);
+
+/* y[c] = clip_int8(shift_and_round32(sum_r W[r][c] * e[r], shift)), Wt 64-byte aligned */
+void matrix_tmul_tile(const matrix_tile_t *t, const int8_t *Wt, const int8_t *e, uint8_t shift, int8_t *y);
+
+#endif // MATRIX_TILE_H
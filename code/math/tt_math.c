@@ -4,16 +4,10 @@
 #include <string.h>
 
 /* ---------- helpers ---------------------------------------------------- */
-int32_t shift_and_round32(int32_t x, uint8_t k)
-{
-    if (k == 0) return x;
-    int32_t off = 1 << (k - 1);
-    if (x < 0) off = -off;
-    return (x + off) >> k;
-}
+int32_t shift_and_round32(int32_t x, uint8_t k) { return shift_round32_inline(x, k); }
 
-int8_t upscale_4_3(int8_t x)   { return clip_int8(x + (x >> 2) + (x >> 4)); }
-int8_t downscale_4_5(int8_t x) { return clip_int8(x - (x >> 2)); }
+int8_t upscale_4_3(int8_t x)   { return upscale_4_3_inline(x); }
+int8_t downscale_4_5(int8_t x) { return downscale_4_5_inline(x); }
 
 uint8_t eff_bitwidth32(int32_t v) { return bitwidth32(v); }
 
@@ -21,7 +15,105 @@ uint8_t eff_bitwidth_array(const int32_t *p, size_t n)
 {
     uint32_t maxa = 0;
     for (size_t i = 0; i < n; ++i) {
-        maxa = max(abs(p[i]), maxa);
+        uint32_t a = (uint32_t)abs(p[i]);
+        if (a > maxa) maxa = a;
     }
     return maxa ? 32u - __builtin_clz(maxa) : 1;
+}
+
+/* ---------- closed‑form alignment ------------------------------------- */
+
+/* (21/16)^k and (3/4)^k, k < TT_ALIGN_TABLE, as m / 2^30 * 2^e */
+static const tt_mult_t s_up_pow[TT_ALIGN_TABLE] = {
+    { 536870912, 1 },  /* 1 */
+    { 704643072, 1 },  /* 1.3125 */
+    { 924844032, 1 },  /* 1.72266 */
+    { 606928896, 2 },  /* 2.26099 */
+    { 796594176, 2 },  /* 2.96754 */
+    { 1045529856, 2 }, /* 3.8949 */
+    { 686128968, 3 },  /* 5.11206 */
+    { 900544270, 3 },  /* 6.70958 */
+    { 590982178, 4 },  /* 8.80632 */
+    { 775664108, 4 },  /* 11.5583 */
+    { 1018059142, 4 }, /* 15.1703 */
+    { 668101312, 5 },  /* 19.911 */
+    { 876882972, 5 },  /* 26.1331 */
+    { 575454450, 6 },  /* 34.2998 */
+    { 755283966, 6 },  /* 45.0184 */
+    { 991310205, 6 },  /* 59.0867 */
+};
+
+static const tt_mult_t s_down_pow[TT_ALIGN_TABLE] = {
+    { 536870912, 1 },  /* 1 */
+    { 805306368, 0 },  /* 0.75 */
+    { 603979776, 0 },  /* 0.5625 */
+    { 905969664, -1 }, /* 0.421875 */
+    { 679477248, -1 }, /* 0.316406 */
+    { 1019215872, -2 },/* 0.237305 */
+    { 764411904, -2 }, /* 0.177979 */
+    { 573308928, -2 }, /* 0.133484 */
+    { 859963392, -3 }, /* 0.100113 */
+    { 644972544, -3 }, /* 0.0750847 */
+    { 967458816, -4 }, /* 0.0563135 */
+    { 725594112, -4 }, /* 0.0422351 */
+    { 544195584, -4 }, /* 0.0316764 */
+    { 816293376, -5 }, /* 0.0237573 */
+    { 612220032, -5 }, /* 0.0178179 */
+    { 918330048, -6 }, /* 0.0133635 */
+};
+
+static tt_mult_t s_mult_mul(tt_mult_t a, tt_mult_t b)
+{
+    tt_mult_t r;
+    r.m = (int32_t)(((int64_t)a.m * b.m + (1 << 29)) >> 30);
+    r.e = a.e + b.e;
+    if (r.m < (1 << 29)) { r.m <<= 1; r.e -= 1; }
+    return r;
+}
+
+static tt_mult_t s_mult_pow(const tt_mult_t *table, uint8_t k)
+{
+    tt_mult_t r = table[0];
+    while (k >= TT_ALIGN_TABLE) {
+        r = s_mult_mul(r, table[TT_ALIGN_TABLE - 1]);
+        k -= TT_ALIGN_TABLE - 1;
+    }
+    return s_mult_mul(r, table[k]);
+}
+
+/* multiplier of 2^dS * (21/16)^dU * (3/4)^dD */
+tt_mult_t tt_align_mult(int8_t dS, uint8_t dU, uint8_t dD)
+{
+    tt_mult_t r = s_mult_mul(s_mult_pow(s_up_pow, dU), s_mult_pow(s_down_pow, dD));
+    r.e += dS;
+    return r;
+}
+
+/* round(x * m) half away from zero, saturated to int32 */
+int32_t tt_mult_apply(int32_t x, tt_mult_t m)
+{
+    int64_t p  = (int64_t)x * m.m;
+    int     sh = 30 - m.e;
+    if (sh > 0) {
+        if (sh > 62) return 0;
+        int64_t off = (int64_t)1 << (sh - 1);
+        p = (p + (p < 0 ? -off : off)) / ((int64_t)1 << sh);
+    } else if (sh < 0) {
+        int k = -sh;
+        if (p == 0) return 0;
+        if (k > 31 || p > (INT64_MAX >> k) || p < -(INT64_MAX >> k))
+            return p < 0 ? INT32_MIN : INT32_MAX;
+        p *= (int64_t)1 << k;
+    }
+    if (p > INT32_MAX) return INT32_MAX;
+    if (p < INT32_MIN) return INT32_MIN;
+    return (int32_t)p;
+}
+
+/* one multiply‑shift pass: x = clip(round(x * m)) */
+void tt_align_i8(int8_t *x, size_t n, tt_mult_t m)
+{
+    if (!x) return;
+    for (size_t i = 0; i < n; ++i)
+        x[i] = clip_int8(tt_mult_apply(x[i], m));
 }
\ No newline at end of file
@@ -10,6 +10,43 @@ int32_t shift_and_round32(int32_t x, uint8_t k);   /* divide by 2^k, nearest */
 int8_t  upscale_4_3(int8_t x);                     /* x *= 4/3, clip */
 int8_t  downscale_4_5(int8_t x);                   /* x *= 4/5, clip */
 
+/* closed‑form alignment ---------------------------------------------------
+ * A header delta (dS, dU, dD) is the factor 2^dS * (4/3)^dU * (4/5)^dD, with
+ * the 4/3 and 4/5 steps realized exactly as upscale_4_3 (x * 21/16) and
+ * downscale_4_5 (x * 3/4) realize them. tt_align_mult folds any delta into
+ * one fixed‑point multiplier (from a precomputed table of the first
+ * TT_ALIGN_TABLE powers), so aligning a buffer is one multiply‑shift pass
+ * instead of one pass per unit of dU / dD.
+ *
+ * Rounding differs from the iterated form, which truncates (arithmetic
+ * shifts) and clips after every step and wraps on left shifts:
+ *   - closed form rounds once, half away from zero, and saturates once;
+ *   - iterated upscale floors x/4 and x/16, so negative values drift by up
+ *     to 2 units per step and the drift compounds with the gain (max
+ *     difference over all int8 inputs: 2, 4, 6, 8, 11, 16 for k = 1..6);
+ *     +1 never grows (1 + 0 + 0) while -1 goes -3, -5, -8;
+ *   - iterated downscale differs by at most 1 (k <= 2), 2 (k <= 6) or
+ *     3 (k >= 7); it keeps +1 forever and maps -1 to 0, the closed form decays both
+ *     to 0 once 0.75^k < 1/2;
+ *   - iterated left shifts wrap in int8 (100 << 1 == -56), the closed
+ *     form saturates (127).
+ * Against exact rational arithmetic clip_int8(tt_mult_apply(x, m)) is
+ * correctly rounded for every int8 input, dS in [-12, 8] and dU, dD in
+ * [0, 40). The exactness is post-clip: the int32 result keeps growing past
+ * the int8 range (127 * 21/16 == 167) where every iterated step clips.
+ * tests/test_math.c checks all of the above exhaustively.
+ *---------------------------------------------------------------------------*/
+#define TT_ALIGN_TABLE 16
+
+typedef struct {
+    int32_t m;   /* mantissa, value = m / 2^30 * 2^e, m in [2^29, 2^30) */
+    int16_t e;   /* power‑of‑two exponent */
+} tt_mult_t;
+
+tt_mult_t tt_align_mult(int8_t dS, uint8_t dU, uint8_t dD);
+int32_t   tt_mult_apply(int32_t x, tt_mult_t m);       /* round(x * m), saturated */
+void      tt_align_i8(int8_t *x, size_t n, tt_mult_t m); /* x = clip(x * m) */
+
 /* effective bit‑width of an int32_t (magnitude) */
 uint8_t eff_bitwidth32(int32_t v);
 uint8_t eff_bitwidth_array(const int32_t *p, size_t n);
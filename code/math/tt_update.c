@@ -0,0 +1,894 @@
+/**
+ * @file tt_update.c
+ * @brief fused weight-update kernels shared by the dense train passes
+ * @details scalar reference plus AVX2 and NEON kernels. The composed map is
+ * a 256-entry table: AVX2 looks it up in 16 pshufb slices of 16 entries,
+ * NEON with tbl/tbx over four 64-entry registers. The vector kernels run
+ * when the level of matrix_isa() has them, so matrix_set_isa forces them
+ * too.
+ * @license MIT
+ */
+#include "tt_update.h"
+#include "tt_utils.h"
+#include "tt_cpu.h"
+#include "tt_math.h"
+#include "matrix.h"
+#include "matrix_tile.h"
+#include <limits.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define UPDATE_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define UPDATE_ARM64 1
+#include <arm_neon.h>
+#endif
+
+/* magnitude of an int8 as int, |-128| = 128 */
+#define ABS_I8(v) ((v) < 0 ? -(int)(v) : (int)(v))
+
+/*
+ * tiled gradients (matrix_tile.h): the 16 errors of a row block and the 4
+ * inputs of a column block, zero padded past OUT / IN. map[0] is 0, so the
+ * pads of G come out zero like those of W.
+ */
+static inline void s_tile_e(const int8_t *e, size_t OUT, size_t rb, int8_t *es) {
+    size_t r0 = rb * MATRIX_TILE_R;
+    if (r0 + MATRIX_TILE_R <= OUT) { memcpy(es, e + r0, MATRIX_TILE_R); return; }
+    memset(es, 0, MATRIX_TILE_R);
+    memcpy(es, e + r0, OUT - r0);
+}
+
+static inline int32_t s_tile_x(const int8_t *x, size_t IN, size_t cb) {
+    size_t c0 = cb * MATRIX_TILE_C;
+    int32_t v = 0;
+    if (c0 + MATRIX_TILE_C <= IN) memcpy(&v, x + c0, MATRIX_TILE_C);
+    else                          memcpy(&v, x + c0, IN - c0);
+    return v;
+}
+
+/*
+ * minibatch sums: e[r] * m with TT_GRAD_Q fraction bits, saturated to
+ * TT_GRAD_Q_MAX (m.e already carries the TT_GRAD_Q), and one rounded term
+ * of the sum. q * x stays within 2^29, so the term within 2^21.
+ */
+static inline int32_t s_err_q(int8_t e, tt_mult_t m) {
+    int32_t q = tt_mult_apply(e, m);
+    return q > TT_GRAD_Q_MAX ? TT_GRAD_Q_MAX : q < -TT_GRAD_Q_MAX ? -TT_GRAD_Q_MAX : q;
+}
+
+static inline int32_t s_term(int32_t q, int8_t x) {
+    return shift_round32_inline(q * x, TT_GRAD_Q);
+}
+
+/* s_err_q of the 16 errors of a row block, zero past OUT */
+static inline void s_tile_q(const int8_t *e, size_t OUT, size_t rb, tt_mult_t m, int32_t *q) {
+    int8_t es[MATRIX_TILE_R];
+    s_tile_e(e, OUT, rb, es);
+    for (size_t i = 0; i < MATRIX_TILE_R; ++i) q[i] = s_err_q(es[i], m);
+}
+
+/**
+ * @brief builds the composed LR-shift + alignment map
+ * the alignment is the closed-form multiplier of tt_align_mult, so the cost
+ * is 256 multiply-shifts whatever the size of the delta
+ * @param m pointer of the map
+ * @param lr_shift learning-rate shift (lr = 2^-lr_shift)
+ * @param dS shift alignment, > 0 left shift, < 0 rounded right shift
+ * @param dU number of 4/3 up-scales (ignored if <= 0)
+ * @param dD number of 4/5 down-scales (ignored if <= 0)
+ * @return NULL
+ */
+void tt_grad_map_init(tt_grad_map_t *m, uint8_t lr_shift, int8_t dS, int8_t dU, int8_t dD) {
+    if (!m) return;
+    tt_mult_t k = tt_align_mult(dS, dU > 0 ? (uint8_t)dU : 0, dD > 0 ? (uint8_t)dD : 0);
+    for (int i = 0; i < 256; ++i) {
+        int8_t v = clip_int8(shift_round32_inline((int8_t)i, lr_shift));
+        m->map[(uint8_t)i] = clip_int8(tt_mult_apply(v, k));
+    }
+    return;
+}
+
+/* ---------- scalar reference ------------------------------------------ */
+
+static void s_outer_scalar(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                           const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    int mg = 0, mw = 0;
+    for (size_t r = 0; r < OUT; ++r) {
+        int16_t er = e[r];
+        int8_t *g = &G[r * IN];
+        for (size_t c = 0; c < IN; ++c) {
+            int8_t v = m->map[(uint8_t)clip_int8(er * x[c])];
+            g[c] = v;
+            if (ABS_I8(v) > mg) mg = ABS_I8(v);
+        }
+    }
+    if (W) {
+        size_t n = OUT * IN;
+        for (size_t i = 0; i < n; ++i)
+            if (ABS_I8(W[i]) > mw) mw = ABS_I8(W[i]);
+    }
+    *max_g = mg;
+    *max_w = mw;
+}
+
+static void s_outer_tile_scalar(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                                const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    int8_t es[MATRIX_TILE_R];
+    int mg = 0, mw = 0;
+    for (size_t rb = 0; rb < nr; ++rb) {
+        s_tile_e(e, OUT, rb, es);
+        for (size_t cb = 0; cb < nc; ++cb) {
+            int8_t *g = &G[(rb * nc + cb) * MATRIX_TILE];
+            int32_t x4 = s_tile_x(x, IN, cb);
+            const int8_t *xs = (const int8_t *)&x4;
+            for (size_t i = 0; i < MATRIX_TILE_R; ++i)
+                for (size_t j = 0; j < MATRIX_TILE_C; ++j) {
+                    int8_t v = m->map[(uint8_t)clip_int8((int16_t)es[i] * xs[j])];
+                    g[i * MATRIX_TILE_C + j] = v;
+                    if (ABS_I8(v) > mg) mg = ABS_I8(v);
+                }
+        }
+    }
+    if (W) {
+        size_t n = nr * nc * MATRIX_TILE;
+        for (size_t i = 0; i < n; ++i)
+            if (ABS_I8(W[i]) > mw) mw = ABS_I8(W[i]);
+    }
+    *max_g = mg;
+    *max_w = mw;
+}
+
+static int s_sgd_scalar(int8_t *W, const int8_t *G, size_t n, uint8_t shift) {
+    int mw = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int8_t g = clip_int8(shift_round32_inline(G[i], shift));
+        int8_t w = clip_int8(W[i] - g);
+        W[i] = w;
+        if (ABS_I8(w) > mw) mw = ABS_I8(w);
+    }
+    return mw;
+}
+
+static void s_rescale_scalar(int8_t *x, size_t n, int dir) {
+    if (dir > 0) {
+        for (size_t i = 0; i < n; ++i) x[i] = upscale_4_3_inline(x[i]);
+    } else if (dir < 0) {
+        for (size_t i = 0; i < n; ++i) x[i] = downscale_4_5_inline(x[i]);
+    }
+}
+
+/* ---------- x86 kernels ----------------------------------------------- */
+#ifdef UPDATE_X86
+
+__attribute__((target("avx2")))
+static inline int s_hmax_epu8(__m256i v) {
+    __m128i m = _mm_max_epu8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+    return _mm_cvtsi128_si32(m) & 0xFF;
+}
+
+/* saturated e * x for 32 bytes: pmullw on sign-extended halves, packsswb */
+__attribute__((target("avx2")))
+static inline __m256i s_mul_sat_avx2(__m256i ve, const int8_t *x) {
+    __m256i xv = _mm256_loadu_si256((const __m256i *)x);
+    __m256i lo = _mm256_mullo_epi16(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(xv)), ve);
+    __m256i hi = _mm256_mullo_epi16(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(xv, 1)), ve);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+}
+
+/* the map as 16 slices of 16 entries, each in both 128-bit lanes */
+__attribute__((target("avx2")))
+static inline void s_lut_load_avx2(const tt_grad_map_t *m, __m256i lut[16]) {
+    for (int k = 0; k < 16; ++k)
+        lut[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&m->map[16 * k]));
+}
+
+/*
+ * map[v] for 32 bytes: slice k sees v - 16k, which adds_epu8(., 0x70) keeps
+ * below 0x80 only for v in [16k, 16k + 15]; pshufb takes the low nibble
+ * there and writes 0 wherever bit 7 is set, so the slices OR together
+ */
+__attribute__((target("avx2")))
+static inline __m256i s_lut_avx2(const __m256i lut[16], __m256i v) {
+    const __m256i k16 = _mm256_set1_epi8(16), k70 = _mm256_set1_epi8(0x70);
+    __m256i r = _mm256_shuffle_epi8(lut[0], _mm256_adds_epu8(v, k70));
+    for (int k = 1; k < 16; ++k) {
+        v = _mm256_sub_epi8(v, k16);
+        r = _mm256_or_si256(r, _mm256_shuffle_epi8(lut[k], _mm256_adds_epu8(v, k70)));
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static int s_max_abs_avx2(const int8_t *W, size_t n) {
+    size_t i = 0;
+    __m256i vmw = _mm256_setzero_si256();
+    for (; i + 32 <= n; i += 32)
+        vmw = _mm256_max_epu8(vmw, _mm256_abs_epi8(_mm256_loadu_si256((const __m256i *)&W[i])));
+    int mw = s_hmax_epu8(vmw);
+    for (; i < n; ++i)
+        if (ABS_I8(W[i]) > mw) mw = ABS_I8(W[i]);
+    return mw;
+}
+
+__attribute__((target("avx2")))
+static void s_outer_avx2(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                         const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    __m256i vmg = _mm256_setzero_si256();
+    __m256i lut[16];
+    s_lut_load_avx2(m, lut);
+    int mg = 0;
+    for (size_t r = 0; r < OUT; ++r) {
+        __m256i ve = _mm256_set1_epi16(e[r]);
+        int8_t *g = &G[r * IN];
+        size_t c = 0;
+        for (; c + 32 <= IN; c += 32) {
+            __m256i gv = s_lut_avx2(lut, s_mul_sat_avx2(ve, &x[c]));
+            _mm256_storeu_si256((__m256i *)&g[c], gv);
+            vmg = _mm256_max_epu8(vmg, _mm256_abs_epi8(gv));
+        }
+        for (; c < IN; ++c) {
+            int8_t v = m->map[(uint8_t)clip_int8((int16_t)e[r] * x[c])];
+            g[c] = v;
+            if (ABS_I8(v) > mg) mg = ABS_I8(v);
+        }
+    }
+    if (s_hmax_epu8(vmg) > mg) mg = s_hmax_epu8(vmg);
+    *max_g = mg;
+    *max_w = W ? s_max_abs_avx2(W, OUT * IN) : 0;
+}
+
+/* every error of the row block 4 times, so lane i * 4 + j of a tile meets x[j] */
+__attribute__((target("avx2")))
+static void s_outer_tile_avx2(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                              const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    const __m128i rep = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+    __m256i vmg = _mm256_setzero_si256();
+    __m256i lut[16];
+    s_lut_load_avx2(m, lut);
+    int8_t es[MATRIX_TILE_R];
+    for (size_t rb = 0; rb < nr; ++rb) {
+        s_tile_e(e, OUT, rb, es);
+        __m128i ev = _mm_loadu_si128((const __m128i *)es);
+        __m256i e0 = _mm256_cvtepi8_epi16(_mm_shuffle_epi8(ev, rep));
+        __m256i e1 = _mm256_cvtepi8_epi16(_mm_shuffle_epi8(_mm_srli_si128(ev, 4), rep));
+        __m256i e2 = _mm256_cvtepi8_epi16(_mm_shuffle_epi8(_mm_srli_si128(ev, 8), rep));
+        __m256i e3 = _mm256_cvtepi8_epi16(_mm_shuffle_epi8(_mm_srli_si128(ev, 12), rep));
+        for (size_t cb = 0; cb < nc; ++cb) {
+            int8_t *g = &G[(rb * nc + cb) * MATRIX_TILE];
+            __m256i xv = _mm256_cvtepi8_epi16(_mm_set1_epi32(s_tile_x(x, IN, cb)));
+            __m256i p01 = _mm256_packs_epi16(_mm256_mullo_epi16(e0, xv), _mm256_mullo_epi16(e1, xv));
+            __m256i p23 = _mm256_packs_epi16(_mm256_mullo_epi16(e2, xv), _mm256_mullo_epi16(e3, xv));
+            __m256i g0 = s_lut_avx2(lut, _mm256_permute4x64_epi64(p01, 0xD8));
+            __m256i g1 = s_lut_avx2(lut, _mm256_permute4x64_epi64(p23, 0xD8));
+            _mm256_storeu_si256((__m256i *)&g[0],  g0);
+            _mm256_storeu_si256((__m256i *)&g[32], g1);
+            vmg = _mm256_max_epu8(vmg, _mm256_max_epu8(_mm256_abs_epi8(g0), _mm256_abs_epi8(g1)));
+        }
+    }
+    *max_g = s_hmax_epu8(vmg);
+    *max_w = W ? s_max_abs_avx2(W, nr * nc * MATRIX_TILE) : 0;
+}
+
+/* clip(round(g >> k)) on 32 bytes, k >= 1, computed in int16 lanes */
+__attribute__((target("avx2")))
+static inline __m256i s_shift_round_avx2(__m256i g, __m128i k, __m256i half) {
+    __m256i lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(g));
+    __m256i hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(g, 1));
+    lo = _mm256_sra_epi16(_mm256_add_epi16(lo, _mm256_add_epi16(half, _mm256_srai_epi16(lo, 15))), k);
+    hi = _mm256_sra_epi16(_mm256_add_epi16(hi, _mm256_add_epi16(half, _mm256_srai_epi16(hi, 15))), k);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+}
+
+__attribute__((target("avx2")))
+static int s_sgd_avx2(int8_t *W, const int8_t *G, size_t n, uint8_t shift) {
+    __m256i vmw = _mm256_setzero_si256();
+    __m128i k = _mm_cvtsi32_si128(shift);
+    __m256i half = _mm256_set1_epi16(shift ? (int16_t)(1 << (shift - 1)) : 0);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i g = _mm256_loadu_si256((const __m256i *)&G[i]);
+        if (shift) g = s_shift_round_avx2(g, k, half);
+        __m256i w = _mm256_subs_epi8(_mm256_loadu_si256((const __m256i *)&W[i]), g);
+        _mm256_storeu_si256((__m256i *)&W[i], w);
+        vmw = _mm256_max_epu8(vmw, _mm256_abs_epi8(w));
+    }
+    int mw = s_hmax_epu8(vmw);
+    int mt = s_sgd_scalar(&W[i], &G[i], n - i, shift);
+    return mt > mw ? mt : mw;
+}
+
+__attribute__((target("avx2")))
+static void s_rescale_avx2(int8_t *x, size_t n, int dir) {
+    if (!dir) return;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v  = _mm256_loadu_si256((const __m256i *)&x[i]);
+        __m256i lo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(v));
+        __m256i hi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(v, 1));
+        if (dir > 0) {
+            lo = _mm256_add_epi16(_mm256_add_epi16(lo, _mm256_srai_epi16(lo, 2)), _mm256_srai_epi16(lo, 4));
+            hi = _mm256_add_epi16(_mm256_add_epi16(hi, _mm256_srai_epi16(hi, 2)), _mm256_srai_epi16(hi, 4));
+        } else {
+            lo = _mm256_sub_epi16(lo, _mm256_srai_epi16(lo, 2));
+            hi = _mm256_sub_epi16(hi, _mm256_srai_epi16(hi, 2));
+        }
+        _mm256_storeu_si256((__m256i *)&x[i], _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+    }
+    s_rescale_scalar(&x[i], n - i, dir);
+}
+
+/* round(q * x / 2^TT_GRAD_Q) of 8 lanes, half away from zero like shift_round32_inline */
+__attribute__((target("avx2")))
+static inline __m256i s_term8_avx2(__m256i q, __m256i xv) {
+    __m256i p = _mm256_mullo_epi32(q, xv);
+    __m256i off = _mm256_add_epi32(_mm256_set1_epi32(1 << (TT_GRAD_Q - 1)), _mm256_srai_epi32(p, 31));
+    return _mm256_srai_epi32(_mm256_add_epi32(p, off), TT_GRAD_Q);
+}
+
+__attribute__((target("avx2")))
+static void s_outer_acc_avx2(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    for (size_t r = 0; r < OUT; ++r) {
+        int32_t q = s_err_q(e[r], m);
+        if (!q) continue;
+        __m256i vq = _mm256_set1_epi32(q);
+        int32_t *row = acc + r * IN;
+        size_t c = 0;
+        for (; c + 8 <= IN; c += 8) {
+            __m256i xv = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)&x[c]));
+            __m256i *a = (__m256i *)&row[c];
+            _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), s_term8_avx2(vq, xv)));
+        }
+        for (; c < IN; ++c)
+            row[c] += s_term(q, x[c]);
+    }
+}
+
+__attribute__((target("avx2")))
+static void s_outer_acc_tile_avx2(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    int32_t q[MATRIX_TILE_R];
+    __m256i vq[MATRIX_TILE_R / 2];
+    for (size_t rb = 0; rb < nr; ++rb) {
+        /* lanes 0-3 row 2i, lanes 4-7 row 2i + 1, as the tile stores them */
+        s_tile_q(e, OUT, rb, m, q);
+        for (size_t i = 0; i < MATRIX_TILE_R / 2; ++i)
+            vq[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi32(q[2 * i])),
+                                            _mm_set1_epi32(q[2 * i + 1]), 1);
+        for (size_t cb = 0; cb < nc; ++cb) {
+            __m256i *a = (__m256i *)(acc + (rb * nc + cb) * MATRIX_TILE);
+            __m256i xv = _mm256_cvtepi8_epi32(_mm_set1_epi32(s_tile_x(x, IN, cb)));
+            for (size_t i = 0; i < MATRIX_TILE_R / 2; ++i)
+                _mm256_storeu_si256(a + i, _mm256_add_epi32(_mm256_loadu_si256(a + i), s_term8_avx2(vq[i], xv)));
+        }
+    }
+}
+
+/* clip_int8(shift_round32(acc, k)) of 32 sums, k >= 0; half = 1 << (k - 1), 0 for k = 0 */
+__attribute__((target("avx2")))
+static inline __m256i s_pack32_avx2(const int32_t *acc, __m128i k, __m256i half) {
+    const __m256i nz = _mm256_cmpgt_epi32(half, _mm256_setzero_si256());   /* -1 for k > 0 */
+    __m256i v[4];
+    for (int q = 0; q < 4; ++q) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(acc + 8 * q));
+        __m256i off = _mm256_add_epi32(half, _mm256_and_si256(_mm256_srai_epi32(a, 31), nz));
+        v[q] = _mm256_sra_epi32(_mm256_add_epi32(a, off), k);
+    }
+    __m256i b = _mm256_packs_epi16(_mm256_packs_epi32(v[0], v[1]), _mm256_packs_epi32(v[2], v[3]));
+    return _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+__attribute__((target("avx2")))
+static int32_t s_max_abs_i32_avx2(const int32_t *x, size_t n) {
+    __m256i vm = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        vm = _mm256_max_epi32(vm, _mm256_abs_epi32(_mm256_loadu_si256((const __m256i *)&x[i])));
+    int32_t t[8], m = 0;
+    _mm256_storeu_si256((__m256i *)t, vm);
+    for (int j = 0; j < 8; ++j) if (t[j] > m) m = t[j];
+    for (; i < n; ++i) {
+        int32_t a = x[i] < 0 ? -x[i] : x[i];
+        if (a > m) m = a;
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+static size_t s_pack_avx2(int8_t *G, const int32_t *acc, size_t n, uint8_t k) {
+    __m128i kv = _mm_cvtsi32_si128(k);
+    __m256i half = _mm256_set1_epi32(k ? 1 << (k - 1) : 0);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        _mm256_storeu_si256((__m256i *)&G[i], s_pack32_avx2(&acc[i], kv, half));
+    return i;
+}
+
+__attribute__((target("avx2")))
+static int s_sgd32_avx2(int8_t *W, const int32_t *acc, size_t n, uint8_t shift, size_t *done) {
+    __m128i kv = _mm_cvtsi32_si128(shift);
+    __m256i half = _mm256_set1_epi32(shift ? 1 << (shift - 1) : 0);
+    __m256i vmw = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i w = _mm256_subs_epi8(_mm256_loadu_si256((const __m256i *)&W[i]), s_pack32_avx2(&acc[i], kv, half));
+        _mm256_storeu_si256((__m256i *)&W[i], w);
+        vmw = _mm256_max_epu8(vmw, _mm256_abs_epi8(w));
+    }
+    *done = i;
+    return s_hmax_epu8(vmw);
+}
+
+#endif // UPDATE_X86
+
+/* ---------- arm64 kernels --------------------------------------------- */
+#ifdef UPDATE_ARM64
+
+/* 256-entry lookup: tbl on the first 64 entries, tbx on the other three */
+static inline int8x16_t s_lut_neon(const int8x16x4_t t[4], uint8x16_t idx) {
+    const uint8x16_t k64 = vdupq_n_u8(64);
+    int8x16_t r = vqtbl4q_s8(t[0], idx);
+    idx = vsubq_u8(idx, k64); r = vqtbx4q_s8(r, t[1], idx);
+    idx = vsubq_u8(idx, k64); r = vqtbx4q_s8(r, t[2], idx);
+    idx = vsubq_u8(idx, k64); r = vqtbx4q_s8(r, t[3], idx);
+    return r;
+}
+
+static int s_max_abs_neon(const int8_t *W, size_t n) {
+    size_t i = 0;
+    /* vabsq on s16 keeps |-128| = 128 */
+    uint16x8_t vmw = vdupq_n_u16(0);
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t w = vld1q_s8(&W[i]);
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_s8(vget_low_s8(w)))));
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_high_s8(w))));
+    }
+    int mw = vmaxvq_u16(vmw);
+    for (; i < n; ++i)
+        if (ABS_I8(W[i]) > mw) mw = ABS_I8(W[i]);
+    return mw;
+}
+
+static void s_outer_neon(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                         const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    int8x16x4_t t[4];
+    for (int j = 0; j < 4; ++j) t[j] = vld1q_s8_x4(&m->map[64 * j]);
+    uint8x16_t vmg = vdupq_n_u8(0);
+    int mg = 0;
+    for (size_t r = 0; r < OUT; ++r) {
+        int8x8_t ve = vdup_n_s8(e[r]);
+        int8_t *g = &G[r * IN];
+        size_t c = 0;
+        for (; c + 16 <= IN; c += 16) {
+            int8x16_t xv = vld1q_s8(&x[c]);
+            int8x16_t p = vcombine_s8(vqmovn_s16(vmull_s8(vget_low_s8(xv), ve)),
+                                      vqmovn_s16(vmull_s8(vget_high_s8(xv), ve)));
+            int8x16_t gv = s_lut_neon(t, vreinterpretq_u8_s8(p));
+            vst1q_s8(&g[c], gv);
+            vmg = vmaxq_u8(vmg, vreinterpretq_u8_s8(vqabsq_s8(gv)));
+        }
+        for (; c < IN; ++c) {
+            int8_t v = m->map[(uint8_t)clip_int8((int16_t)e[r] * x[c])];
+            g[c] = v;
+            if (ABS_I8(v) > mg) mg = ABS_I8(v);
+        }
+    }
+    if (vmaxvq_u8(vmg) > mg) mg = vmaxvq_u8(vmg);
+    *max_g = mg;
+    *max_w = W ? s_max_abs_neon(W, OUT * IN) : 0;
+}
+
+static void s_outer_tile_neon(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                              const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    int8x16x4_t t[4];
+    for (int j = 0; j < 4; ++j) t[j] = vld1q_s8_x4(&m->map[64 * j]);
+    uint8x16_t vmg = vdupq_n_u8(0);
+    int8_t es[MATRIX_TILE_R], ex[MATRIX_TILE];
+    for (size_t rb = 0; rb < nr; ++rb) {
+        /* every error of the row block 4 times, so lane i * 4 + j meets x[j] */
+        s_tile_e(e, OUT, rb, es);
+        for (size_t i = 0; i < MATRIX_TILE; ++i) ex[i] = es[i / MATRIX_TILE_C];
+        for (size_t cb = 0; cb < nc; ++cb) {
+            int8_t *g = &G[(rb * nc + cb) * MATRIX_TILE];
+            int8x8_t xv = vreinterpret_s8_s32(vdup_n_s32(s_tile_x(x, IN, cb)));
+            for (size_t q = 0; q < 4; ++q) {
+                int8x16_t ev = vld1q_s8(&ex[16 * q]);
+                int8x16_t p = vcombine_s8(vqmovn_s16(vmull_s8(vget_low_s8(ev), xv)),
+                                          vqmovn_s16(vmull_s8(vget_high_s8(ev), xv)));
+                int8x16_t gv = s_lut_neon(t, vreinterpretq_u8_s8(p));
+                vst1q_s8(&g[16 * q], gv);
+                vmg = vmaxq_u8(vmg, vreinterpretq_u8_s8(vqabsq_s8(gv)));
+            }
+        }
+    }
+    *max_g = vmaxvq_u8(vmg);
+    *max_w = W ? s_max_abs_neon(W, nr * nc * MATRIX_TILE) : 0;
+}
+
+static int s_sgd_neon(int8_t *W, const int8_t *G, size_t n, uint8_t shift) {
+    /* vrshr rounds half up while the reference rounds half away from zero,
+     * so only the shift-free update (the common case) is vectorized */
+    if (shift) return s_sgd_scalar(W, G, n, shift);
+    uint16x8_t vmw = vdupq_n_u16(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t w = vqsubq_s8(vld1q_s8(&W[i]), vld1q_s8(&G[i]));
+        vst1q_s8(&W[i], w);
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_s8(vget_low_s8(w)))));
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_high_s8(w))));
+    }
+    int mw = vmaxvq_u16(vmw);
+    int mt = s_sgd_scalar(&W[i], &G[i], n - i, 0);
+    return mt > mw ? mt : mw;
+}
+
+/* acc[0..15] += g[0..15], sign extended */
+/* round(q * x / 2^TT_GRAD_Q) of 4 lanes, half away from zero like shift_round32_inline */
+static inline int32x4_t s_term4_neon(int32x4_t q, int32x4_t xv) {
+    int32x4_t p = vmulq_s32(q, xv);
+    int32x4_t off = vaddq_s32(vdupq_n_s32(1 << (TT_GRAD_Q - 1)), vshrq_n_s32(p, 31));
+    return vshrq_n_s32(vaddq_s32(p, off), TT_GRAD_Q);
+}
+
+static void s_outer_acc_neon(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    for (size_t r = 0; r < OUT; ++r) {
+        int32_t q = s_err_q(e[r], m);
+        if (!q) continue;
+        int32x4_t vq = vdupq_n_s32(q);
+        int32_t *row = acc + r * IN;
+        size_t c = 0;
+        for (; c + 16 <= IN; c += 16) {
+            int8x16_t xv = vld1q_s8(&x[c]);
+            int16x8_t lo = vmovl_s8(vget_low_s8(xv)), hi = vmovl_high_s8(xv);
+            vst1q_s32(&row[c +  0], vaddq_s32(vld1q_s32(&row[c +  0]), s_term4_neon(vq, vmovl_s16(vget_low_s16(lo)))));
+            vst1q_s32(&row[c +  4], vaddq_s32(vld1q_s32(&row[c +  4]), s_term4_neon(vq, vmovl_high_s16(lo))));
+            vst1q_s32(&row[c +  8], vaddq_s32(vld1q_s32(&row[c +  8]), s_term4_neon(vq, vmovl_s16(vget_low_s16(hi)))));
+            vst1q_s32(&row[c + 12], vaddq_s32(vld1q_s32(&row[c + 12]), s_term4_neon(vq, vmovl_high_s16(hi))));
+        }
+        for (; c < IN; ++c)
+            row[c] += s_term(q, x[c]);
+    }
+}
+
+static void s_outer_acc_tile_neon(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    int32_t q[MATRIX_TILE_R];
+    for (size_t rb = 0; rb < nr; ++rb) {
+        s_tile_q(e, OUT, rb, m, q);
+        for (size_t cb = 0; cb < nc; ++cb) {
+            int32_t *a = acc + (rb * nc + cb) * MATRIX_TILE;
+            int8x8_t x8 = vreinterpret_s8_s32(vdup_n_s32(s_tile_x(x, IN, cb)));
+            int32x4_t xv = vmovl_s16(vget_low_s16(vmovl_s8(x8)));
+            for (size_t i = 0; i < MATRIX_TILE_R; ++i)
+                vst1q_s32(&a[i * MATRIX_TILE_C],
+                          vaddq_s32(vld1q_s32(&a[i * MATRIX_TILE_C]), s_term4_neon(vdupq_n_s32(q[i]), xv)));
+        }
+    }
+}
+
+/* clip_int8(shift_round32(acc, k)) of 16 sums, half away from zero like
+ * shift_round32_inline: negative sums add one less than half (vrshr would
+ * round half up) */
+static inline int8x16_t s_pack16_neon(const int32_t *acc, int32x4_t nk, int32x4_t half) {
+    const int32x4_t nz = vreinterpretq_s32_u32(vcgtzq_s32(half));   /* -1 for k > 0 */
+    int16x4_t h[4];
+    for (int q = 0; q < 4; ++q) {
+        int32x4_t a = vld1q_s32(acc + 4 * q);
+        int32x4_t sg = vandq_s32(vshrq_n_s32(a, 31), nz);
+        int32x4_t off = vaddq_s32(half, sg);
+        h[q] = vqmovn_s32(vshlq_s32(vaddq_s32(a, off), nk));
+    }
+    return vcombine_s8(vqmovn_s16(vcombine_s16(h[0], h[1])), vqmovn_s16(vcombine_s16(h[2], h[3])));
+}
+
+static int32_t s_max_abs_i32_neon(const int32_t *x, size_t n) {
+    int32x4_t vm = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        vm = vmaxq_s32(vm, vabsq_s32(vld1q_s32(&x[i])));
+    int32_t m = vmaxvq_s32(vm);
+    for (; i < n; ++i) {
+        int32_t a = x[i] < 0 ? -x[i] : x[i];
+        if (a > m) m = a;
+    }
+    return m;
+}
+
+static size_t s_pack_neon(int8_t *G, const int32_t *acc, size_t n, uint8_t k) {
+    int32x4_t nk = vdupq_n_s32(-(int32_t)k), half = vdupq_n_s32(k ? 1 << (k - 1) : 0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        vst1q_s8(&G[i], s_pack16_neon(&acc[i], nk, half));
+    return i;
+}
+
+static int s_sgd32_neon(int8_t *W, const int32_t *acc, size_t n, uint8_t shift, size_t *done) {
+    int32x4_t nk = vdupq_n_s32(-(int32_t)shift), half = vdupq_n_s32(shift ? 1 << (shift - 1) : 0);
+    uint16x8_t vmw = vdupq_n_u16(0);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t w = vqsubq_s8(vld1q_s8(&W[i]), s_pack16_neon(&acc[i], nk, half));
+        vst1q_s8(&W[i], w);
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_s8(vget_low_s8(w)))));
+        vmw = vmaxq_u16(vmw, vreinterpretq_u16_s16(vabsq_s16(vmovl_high_s8(w))));
+    }
+    *done = i;
+    return vmaxvq_u16(vmw);
+}
+
+#endif // UPDATE_ARM64
+
+/* ---------- dispatch -------------------------------------------------- */
+
+/* vector kernels at the level matrix.c resolved (or matrix_set_isa forced) */
+static inline int s_simd(void) {
+#if defined(UPDATE_X86)
+    return matrix_isa() >= TT_ISA_AVX2;
+#elif defined(UPDATE_ARM64)
+    return matrix_isa() >= TT_ISA_NEON;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief fused outer product + composed requantization + bit-width scans
+ * @param G pointer of the OUT x IN gradient output
+ * @param e pointer of the OUT errors
+ * @param OUT number of rows
+ * @param x pointer of the IN activations
+ * @param IN number of columns
+ * @param m pointer of the composed map
+ * @param W pointer of the OUT x IN weights to scan, may be NULL
+ * @param max_g largest |G| written
+ * @param max_w largest |W| (0 if W is NULL)
+ * @return NULL
+ */
+void tt_grad_outer(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                   const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    if (!G || !e || !x || !m || !max_g || !max_w) return;
+#if defined(UPDATE_X86)
+    if (s_simd()) { s_outer_avx2(G, e, OUT, x, IN, m, W, max_g, max_w); return; }
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) { s_outer_neon(G, e, OUT, x, IN, m, W, max_g, max_w); return; }
+#endif
+    s_outer_scalar(G, e, OUT, x, IN, m, W, max_g, max_w);
+}
+
+/**
+ * @brief tt_grad_outer with G and W in the tile order of matrix_tile.h
+ * @param G pointer of the MATRIX_TILE_LEN(OUT, IN) tiled gradient output
+ * @param e pointer of the OUT errors
+ * @param OUT number of rows
+ * @param x pointer of the IN activations
+ * @param IN number of columns
+ * @param m pointer of the composed map
+ * @param W pointer of the tiled weights to scan, may be NULL
+ * @param max_g largest |G| written
+ * @param max_w largest |W| (0 if W is NULL)
+ * @return NULL
+ */
+void tt_grad_outer_tile(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                        const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w) {
+    if (!G || !e || !x || !m || !max_g || !max_w) return;
+#if defined(UPDATE_X86)
+    if (s_simd()) { s_outer_tile_avx2(G, e, OUT, x, IN, m, W, max_g, max_w); return; }
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) { s_outer_tile_neon(G, e, OUT, x, IN, m, W, max_g, max_w); return; }
+#endif
+    s_outer_tile_scalar(G, e, OUT, x, IN, m, W, max_g, max_w);
+}
+
+/**
+ * @brief fused SGD subtract + max-abs scan
+ * @param W pointer of the weights, updated in place
+ * @param G pointer of the aligned gradient
+ * @param n number of elements
+ * @param shift extra rounded right shift of G (margin adjustment)
+ * @return int largest |W| after the update
+ */
+int tt_sgd_apply(int8_t *W, const int8_t *G, size_t n, uint8_t shift) {
+    if (!W || !G) return 0;
+#if defined(UPDATE_X86)
+    if (s_simd()) return s_sgd_avx2(W, G, n, shift);
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) return s_sgd_neon(W, G, n, shift);
+#endif
+    return s_sgd_scalar(W, G, n, shift);
+}
+
+/**
+ * @brief in-place 4/3 or 4/5 rescale
+ * @param x pointer of the data
+ * @param n number of elements
+ * @param dir > 0 up-scale, < 0 down-scale, 0 nothing
+ * @return NULL
+ */
+void tt_rescale_i8(int8_t *x, size_t n, int dir) {
+    if (!x) return;
+#ifdef UPDATE_X86
+    if (s_simd()) {
+        s_rescale_avx2(x, n, dir);
+        return;
+    }
+#endif
+    s_rescale_scalar(x, n, dir);
+}
+
+/* ---------- minibatch accumulation ------------------------------------ */
+
+/**
+ * @brief raw outer product, aligned and summed into int32
+ * no clip and no learning-rate shift: with m == 1 the sums gain the exact
+ * e[r] * x[c], otherwise e[r] * m is taken with TT_GRAD_Q fraction bits
+ * @param acc pointer of the OUT x IN int32 sums
+ * @param e pointer of the OUT errors
+ * @param OUT number of rows
+ * @param x pointer of the IN inputs
+ * @param IN number of columns
+ * @param m alignment of the products to the frame of the sums (tt_align_mult)
+ * @return NULL
+ */
+void tt_grad_outer_acc(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    if (!acc || !e || !x) return;
+    m.e += TT_GRAD_Q;
+#if defined(UPDATE_X86)
+    if (s_simd()) { s_outer_acc_avx2(acc, e, OUT, x, IN, m); return; }
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) { s_outer_acc_neon(acc, e, OUT, x, IN, m); return; }
+#endif
+    for (size_t r = 0; r < OUT; ++r) {
+        int32_t *row = acc + r * IN;
+        int32_t q = s_err_q(e[r], m);
+        if (!q) continue;
+        for (size_t c = 0; c < IN; ++c)
+            row[c] += s_term(q, x[c]);
+    }
+}
+
+/**
+ * @brief tt_grad_outer_acc with acc in the tile order of matrix_tile.h
+ * @param acc pointer of the MATRIX_TILE_LEN(OUT, IN) int32 sums
+ * @param e pointer of the OUT errors
+ * @param OUT number of rows
+ * @param x pointer of the IN inputs
+ * @param IN number of columns
+ * @param m alignment of the products to the frame of the sums (tt_align_mult)
+ * @return NULL
+ */
+void tt_grad_outer_acc_tile(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m) {
+    if (!acc || !e || !x) return;
+    m.e += TT_GRAD_Q;
+#if defined(UPDATE_X86)
+    if (s_simd()) { s_outer_acc_tile_avx2(acc, e, OUT, x, IN, m); return; }
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) { s_outer_acc_tile_neon(acc, e, OUT, x, IN, m); return; }
+#endif
+    size_t nr = MATRIX_TILE_NR(OUT), nc = MATRIX_TILE_NC(IN);
+    int32_t q[MATRIX_TILE_R];
+    for (size_t rb = 0; rb < nr; ++rb) {
+        s_tile_q(e, OUT, rb, m, q);
+        for (size_t cb = 0; cb < nc; ++cb) {
+            int32_t *a = acc + (rb * nc + cb) * MATRIX_TILE;
+            int32_t x4 = s_tile_x(x, IN, cb);
+            const int8_t *xs = (const int8_t *)&x4;
+            for (size_t i = 0; i < MATRIX_TILE_R; ++i)
+                for (size_t j = 0; j < MATRIX_TILE_C; ++j)
+                    a[i * MATRIX_TILE_C + j] += s_term(q[i], xs[j]);
+        }
+    }
+}
+
+/**
+ * @brief sums an int8 gradient into int32, optionally through a map
+ * @param acc pointer of the int32 sums
+ * @param G pointer of the int8 gradient
+ * @param n number of elements
+ * @param m pointer of the alignment map, NULL for none
+ * @return NULL
+ */
+void tt_grad_accum(int32_t *acc, const int8_t *G, size_t n, const tt_grad_map_t *m) {
+    if (!acc || !G) return;
+    if (m) {
+        for (size_t i = 0; i < n; ++i) acc[i] += m->map[(uint8_t)G[i]];
+    } else {
+        for (size_t i = 0; i < n; ++i) acc[i] += G[i];
+    }
+}
+
+/**
+ * @brief packs int32 sums to int8
+ * @param G pointer of the int8 output
+ * @param acc pointer of the int32 sums
+ * @param n number of elements
+ * @return uint8_t applied right shift
+ */
+uint8_t tt_grad_pack_i8(int8_t *G, const int32_t *acc, size_t n) {
+    if (!G || !acc) return 0;
+    uint8_t bw = bitwidth32(tt_max_abs_i32(acc, n));
+    uint8_t k = (bw > CHAR_BIT - 1) ? (uint8_t)(bw - (CHAR_BIT - 1)) : 0;
+    size_t i = 0;
+#if defined(UPDATE_X86)
+    if (s_simd()) i = s_pack_avx2(G, acc, n, k);
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) i = s_pack_neon(G, acc, n, k);
+#endif
+    for (; i < n; ++i)
+        G[i] = clip_int8(shift_round32_inline(acc[i], k));
+    return k;
+}
+
+/**
+ * @brief SGD subtract of int32 sums + max-abs scan
+ * @param W pointer of the weights, updated in place
+ * @param acc pointer of the int32 gradient sums
+ * @param n number of elements
+ * @param shift rounded right shift (< 0: saturated left shift)
+ * @return int largest |W| after the update
+ */
+int tt_sgd_apply32(int8_t *W, const int32_t *acc, size_t n, int8_t shift) {
+    if (!W || !acc) return 0;
+    int mw = 0;
+    if (shift >= 0) {
+        size_t i = 0;
+#if defined(UPDATE_X86)
+        if (s_simd()) mw = s_sgd32_avx2(W, acc, n, (uint8_t)shift, &i);
+#elif defined(UPDATE_ARM64)
+        if (s_simd()) mw = s_sgd32_neon(W, acc, n, (uint8_t)shift, &i);
+#endif
+        for (; i < n; ++i) {
+            int8_t g = clip_int8(shift_round32_inline(acc[i], (uint8_t)shift));
+            int8_t w = clip_int8(W[i] - g);
+            W[i] = w;
+            if (ABS_I8(w) > mw) mw = ABS_I8(w);
+        }
+    } else {
+        /* anything past int8 saturates anyway, so the shift is capped */
+        uint8_t ls = (uint8_t)(-shift > CHAR_BIT ? CHAR_BIT : -shift);
+        for (size_t i = 0; i < n; ++i) {
+            int32_t a = acc[i] >  INT8_MAX ? INT8_MAX + 1 : acc[i];
+            a = a < INT8_MIN ? INT8_MIN : a;
+            int8_t g = clip_int8(a * (1 << ls));
+            int8_t w = clip_int8(W[i] - g);
+            W[i] = w;
+            if (ABS_I8(w) > mw) mw = ABS_I8(w);
+        }
+    }
+    return mw;
+}
+
+int tt_max_abs_i8(const int8_t *x, size_t n) {
+    int m = 0;
+    if (!x) return 0;
+#if defined(UPDATE_X86)
+    if (s_simd()) return s_max_abs_avx2(x, n);
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) return s_max_abs_neon(x, n);
+#endif
+    for (size_t i = 0; i < n; ++i)
+        if (ABS_I8(x[i]) > m) m = ABS_I8(x[i]);
+    return m;
+}
+
+int32_t tt_max_abs_i32(const int32_t *x, size_t n) {
+    int32_t m = 0;
+    if (!x) return 0;
+#if defined(UPDATE_X86)
+    if (s_simd()) return s_max_abs_i32_avx2(x, n);
+#elif defined(UPDATE_ARM64)
+    if (s_simd()) return s_max_abs_i32_neon(x, n);
+#endif
+    for (size_t i = 0; i < n; ++i) {
+        int32_t a = x[i] < 0 ? -x[i] : x[i];
+        if (a > m) m = a;
+    }
+    return m;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file tt_update.h
+ * @brief fused weight-update kernels shared by the dense train passes
+ * @details the LR shift and the scale alignment of a gradient element only
+ * depend on its int8 value, so they are composed once per step into a
+ * 256-entry map. The outer product, the composed requantization and the
+ * bit-width scans then take one pass, and the SGD subtract plus the max-abs
+ * scan a second one. Kernels follow the level of matrix_isa().
+ * @license MIT
+ */
+#ifndef TT_UPDATE_H
+#define TT_UPDATE_H
+
+#include "tt_types.h"
+#include "tt_math.h"
+
+/* composed per-element requantization, indexed by (uint8_t)value */
+typedef struct {
+    int8_t map[256];
+} tt_grad_map_t;
+
+/*
+ * build the map of: clip(round(g >> lr_shift)) followed by the closed-form
+ * alignment by (dS, dU, dD) of tt_align_mult (see tt_math.h for how its
+ * rounding differs from iterated upscale_4_3 / downscale_4_5)
+ */
+void tt_grad_map_init(tt_grad_map_t *m, uint8_t lr_shift, int8_t dS, int8_t dU, int8_t dD);
+
+/*
+ * pass 1: G[r*IN + c] = map[clip(e[r] * x[c])] for the OUT x IN outer product.
+ * returns the largest |G| and, if W is not NULL, the largest |W| (0..128)
+ */
+void tt_grad_outer(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                   const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w);
+
+/* same, G and W in the tile order of matrix_tile.h (MATRIX_TILE_LEN(OUT, IN) bytes, pads zero) */
+void tt_grad_outer_tile(int8_t *G, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                        const tt_grad_map_t *m, const int8_t *W, int *max_g, int *max_w);
+
+/*
+ * pass 2: W = clip(W - clip(round(G >> shift))) over n elements.
+ * returns the largest |W| after the update (0..128)
+ */
+int  tt_sgd_apply(int8_t *W, const int8_t *G, size_t n, uint8_t shift);
+
+/* in-place x *= 4/3 (dir > 0) or x *= 4/5 (dir < 0) over n elements */
+void tt_rescale_i8(int8_t *x, size_t n, int dir);
+
+/*
+ * minibatch / data-parallel path: the raw e[r] * x[c] products of every
+ * sample are aligned and summed in int32, with no per-sample clip and no
+ * learning-rate shift; the packed int8 gradient and the margin shift come
+ * once per batch (tt_grad_pack_i8, tt_sgd_apply32). Gradients packed with
+ * their own header are aligned and summed again before one update. The
+ * per-sample sums and the once-per-batch scans, pack and update have AVX2 /
+ * NEON kernels, bit-exact with the scalar loops; tt_grad_accum is left to
+ * the compiler's vectorizer.
+ *
+ * the errors are aligned with TT_GRAD_Q fraction bits and saturated to
+ * TT_GRAD_Q_MAX, so one term is below 2^21 and the sums of 1024 samples
+ * cannot overflow
+ */
+#define TT_GRAD_Q       (8)
+#define TT_GRAD_Q_MAX   ((1 << 22) - 1)
+
+/* acc[r*IN + c] += round(round(e[r] * m * 2^TT_GRAD_Q) * x[c] / 2^TT_GRAD_Q) */
+void tt_grad_outer_acc(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m);
+
+/* same, acc in the tile order of matrix_tile.h */
+void tt_grad_outer_acc_tile(int32_t *acc, const int8_t *e, size_t OUT, const int8_t *x, size_t IN, tt_mult_t m);
+
+/* acc += map[G] (G as is if m is NULL) over n elements */
+void tt_grad_accum(int32_t *acc, const int8_t *G, size_t n, const tt_grad_map_t *m);
+
+/* G = clip(round(acc >> k)) with the smallest k that fits int8, returns k */
+uint8_t tt_grad_pack_i8(int8_t *G, const int32_t *acc, size_t n);
+
+/*
+ * W = clip(W - clip(round(acc >> shift))) over n elements, shift < 0 is a
+ * saturated left shift. returns the largest |W| after the update (0..128)
+ */
+int  tt_sgd_apply32(int8_t *W, const int32_t *acc, size_t n, int8_t shift);
+
+/* largest |x| */
+int     tt_max_abs_i8(const int8_t *x, size_t n);
+int32_t tt_max_abs_i32(const int32_t *x, size_t n);
+
+#endif // TT_UPDATE_H
@@ -0,0 +1,64 @@
+/**
+ * @file tt_mem_plan.c
+ * @brief liveness based static memory planner
+ * @license MIT
+ */
+#include "tt_mem_plan.h"
+
+static size_t s_align_up(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+static int s_live_overlap(const tt_mem_buf_t *a, const tt_mem_buf_t *b) {
+    return a->first <= b->last && b->first <= a->last;
+}
+
+/**
+ * @brief plans the offsets of a set of buffers
+ * @param bufs pointer of the buffer descriptions, offsets are written back
+ * @param n number of buffers (at most TT_MEM_PLAN_MAX)
+ * @param align alignment of every offset in bytes
+ * @return size_t peak bytes of the arena
+ */
+size_t tt_mem_plan(tt_mem_buf_t *bufs, size_t n, size_t align) {
+    if (!bufs || n > TT_MEM_PLAN_MAX) return 0;
+    if (!align) align = 1;
+
+    /* placement order: decreasing size (stable for equal sizes) */
+    uint16_t order[TT_MEM_PLAN_MAX];
+    for (size_t i = 0; i < n; ++i) order[i] = (uint16_t)i;
+    for (size_t i = 1; i < n; ++i) {
+        uint16_t k = order[i];
+        size_t j = i;
+        while (j > 0 && bufs[order[j - 1]].size < bufs[k].size) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = k;
+    }
+
+    size_t peak = 0;
+    for (size_t i = 0; i < n; ++i) {
+        tt_mem_buf_t *b = &bufs[order[i]];
+        size_t size = s_align_up(b->size, align);
+        size_t off  = 0;
+        /* first fit: bump past every placed, time-overlapping buffer that
+         * collides until the candidate range is free */
+        int moved = 1;
+        while (moved) {
+            moved = 0;
+            for (size_t j = 0; j < i; ++j) {
+                const tt_mem_buf_t *p = &bufs[order[j]];
+                size_t pend = p->offset + s_align_up(p->size, align);
+                if (!s_live_overlap(b, p)) continue;
+                if (off < pend && p->offset < off + size) {
+                    off = pend;
+                    moved = 1;
+                }
+            }
+        }
+        b->offset = off;
+        if (off + size > peak) peak = off + size;
+    }
+    return peak;
+}
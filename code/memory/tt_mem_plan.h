@@ -0,0 +1,30 @@
+/**
+ * @file tt_mem_plan.h
+ * @brief liveness based static memory planner
+ * @details every scratch buffer is described by its size and the range of
+ * execution steps it is live in. buffers whose ranges do not overlap may
+ * share bytes; the planner assigns offsets inside one arena (largest
+ * buffers first, each at the lowest aligned offset that does not collide
+ * with a time-overlapping buffer) and returns the peak size.
+ * @license MIT
+ */
+#ifndef TT_MEM_PLAN_H
+#define TT_MEM_PLAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    size_t   size;     /* bytes */
+    uint16_t first;    /* first step the buffer is live in */
+    uint16_t last;     /* last step the buffer is live in (inclusive) */
+    size_t   offset;   /* out: planned offset inside the arena */
+} tt_mem_buf_t;
+
+/* upper bound on the number of buffers of one plan */
+#define TT_MEM_PLAN_MAX (256)
+
+/* assign offsets, returns the peak arena bytes (0 on bad input) */
+size_t tt_mem_plan(tt_mem_buf_t *bufs, size_t n, size_t align);
+
+#endif // TT_MEM_PLAN_H
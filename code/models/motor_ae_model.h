@@ -5,6 +5,9 @@
 #ifndef TT_MOTOR_AE_MODEL_H
 #define TT_MOTOR_AE_MODEL_H
 
+#include "tt_seq_model.h"
+#include "tt_seq_group.h"
+#include "tt_model_file.h"
 #include "tt_tensor_backend.h"
 #include "tt_types.h"
 #include <stdint.h>
@@ -13,49 +16,38 @@
 #define MOTOR_H1 (24)
 #define MOTOR_H2 (24)
 #define MOTOR_OUT (MOTOR_IN)
+#define MOTOR_LAYERS (3)
 
 /*----------------------------------------------------------------------*
- * Macro to declare a DenseLayer type specialized to IN×OUT dimensions.
- * It defines:
- *   - a packed buffer W_buf[OUT*IN]
- *   - a tensor_t   W (view into W_buf)
- *   - an activation buf a_buf[OUT]
- *   - a tensor_t   A (view into a_buf)
+ * Arena holding every buffer of the three dense layers
+ * IN -> H1 -> H2 -> OUT, planned by the sequential runtime. The scratch
+ * part is a bound, m->seq.scratch_bytes holds the planned peak. Layers
+ * are sized to fit every backend (int8, int4, block-sparse, tiled).
  *----------------------------------------------------------------------*/
-#define DECLARE_DENSE_LAYER(NAME, IN, OUT)                     \
-  typedef struct {                                            \
-    int8_t     W_buf[(IN)*(OUT)];    /* weight storage */     \
-    tensor_t   W;                     /* tensor view of W_buf*/\
-    int8_t     A_buf[(OUT)];         /* activation storage */ \
-    tensor_t   A;                     /* tensor view of A_buf*/\
-  } NAME;
-
-/* Use the macro to create three specific layer types: */
-DECLARE_DENSE_LAYER(Layer1_t, MOTOR_IN, MOTOR_H1)
-DECLARE_DENSE_LAYER(Layer2_t, MOTOR_H1, MOTOR_H2)
-DECLARE_DENSE_LAYER(Layer3_t, MOTOR_H2, MOTOR_OUT)
+#define MOTOR_MAX_W     TT_SEQ_MAX(MOTOR_IN * MOTOR_H1, MATRIX_TILE_LEN(MOTOR_H1, MOTOR_IN))
+#define MOTOR_MAX_WIDTH (MOTOR_IN)
+#define MOTOR_ARENA_BYTES                                         \
+  (TT_SEQ_IO_BYTES(MOTOR_IN) +                                    \
+   TT_SEQ_DENSE_ANY_BYTES(MOTOR_IN, MOTOR_H1) +                   \
+   TT_SEQ_DENSE_ANY_BYTES(MOTOR_H1, MOTOR_H2) +                   \
+   TT_SEQ_DENSE_ANY_BYTES(MOTOR_H2, MOTOR_OUT) +                  \
+   TT_SEQ_SCRATCH_BYTES(MOTOR_MAX_W, MOTOR_MAX_WIDTH) + TT_SEQ_ALIGN)
 
 
 typedef struct {
-    const TensorBackend_t *ops;   /* TT vs nested‑TT vs 4‑bit etc. */
-  
-    /* I/O buffers and views */
-    int8_t    in_buf [MOTOR_IN];
-    tensor_t  input;
-    int8_t    out_buf[MOTOR_OUT];
-    tensor_t  output;
-  
-    /* Hidden layers */
-    Layer1_t  layer1;
-    Layer2_t  layer2;
-    Layer3_t  layer3;
-
-    int32_t rng;
+    tt_seq_model_t  seq;
+    tt_layer_t      layers[MOTOR_LAYERS];
+    uint8_t         arena[MOTOR_ARENA_BYTES];
   } tt_motor_ae_model_t;
   
 
-void motor_ae_model_init(tt_motor_ae_model_t *m,const TensorBackend_t *backend, uint32_t seed);
-uint32_t motor_ae_model_forward(tt_motor_ae_model_t *m, const tensor_t *x);
-void motor_ae_model_backward(tt_motor_ae_model_t *m, const tensor_t *x);
+/* layers on backend with weights drawn from seed; 0, or -1 if tt_seq_model_init fails (or m / backend is NULL) */
+int  motor_ae_model_init(tt_motor_ae_model_t *m,const TensorBackend_t *backend, uint32_t seed);
+/* weights from an open model file (no copy, f stays open); 0, or -1 if it is not a motor AE */
+int  motor_ae_model_load(tt_motor_ae_model_t *m, const tt_model_file_t *f, const TensorBackend_t *backend);
+uint32_t tt_motor_ae_forward(tt_motor_ae_model_t *m, const int8_t *in_data);
+/* tt_motor_ae_forward of every motor of g (built over their seq models), sse[k] of in[k] */
+void tt_motor_ae_forward_group(tt_seq_group_t *g, const int8_t *const *in, uint32_t *sse);
+void tt_motor_ae_backward(tt_motor_ae_model_t *m);
 
 #endif // TT_MOTOR_AE_MODEL_H
@@ -0,0 +1,196 @@
+#include "tt_dp_trainer.h"
+#include "tt_utils.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------*
+ * bump allocation inside one malloc'ed block, TT_SEQ_ALIGN aligned
+ *----------------------------------------------------------------------*/
+static void *s_take(uint8_t **cur, size_t bytes) {
+    void *p = *cur;
+    *cur += TT_SEQ_PAD(bytes);
+    return p;
+}
+
+static size_t s_max_out(const tt_seq_model_t *m) {
+    size_t mo = 0;
+    for (size_t l = 0; l < m->n_layers; ++l)
+        if (m->layers[l].A.len > mo) mo = m->layers[l].A.len;
+    return mo;
+}
+
+static size_t s_worker_bytes(const tt_seq_model_t *m) {
+    size_t n = m->n_layers;
+    size_t bytes = TT_SEQ_PAD(m->input.len) + TT_SEQ_PAD(m->err.len) +
+                   TT_SEQ_PAD(2 * n * sizeof(tensor_t)) +
+                   TT_SEQ_PAD(n * sizeof(int32_t *)) +
+                   TT_SEQ_PAD(s_max_out(m) * sizeof(int32_t));
+    for (size_t l = 0; l < n; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        bytes += TT_SEQ_PAD(L->A.len) + TT_SEQ_PAD(L->E.len) +
+                 TT_SEQ_PAD(L->W.len * sizeof(int32_t));
+    }
+    return bytes + TT_SEQ_ALIGN;
+}
+
+static int s_worker_init(tt_dp_worker_t *w, const tt_seq_model_t *m) {
+    size_t n = m->n_layers;
+    memset(w, 0, sizeof(*w));
+    w->mem = malloc(s_worker_bytes(m));
+    if (!w->mem) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)w->mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+
+    tt_tensor_init(&w->input, s_take(&cur, m->input.len), m->input.len);
+    tt_tensor_init(&w->err,   s_take(&cur, m->err.len),   m->err.len);
+    w->A    = s_take(&cur, 2 * n * sizeof(tensor_t));
+    w->E    = w->A + n;
+    w->gacc = s_take(&cur, n * sizeof(int32_t *));
+    w->acc  = s_take(&cur, s_max_out(m) * sizeof(int32_t));
+    for (size_t l = 0; l < n; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        tt_tensor_init(&w->A[l], s_take(&cur, L->A.len), L->A.len);
+        tt_tensor_init(&w->E[l], s_take(&cur, L->E.len), L->E.len);
+        w->gacc[l] = s_take(&cur, L->W.len * sizeof(int32_t));
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Buffers of every lane and of the reduction.
+ *----------------------------------------------------------------------*/
+int tt_dp_trainer_init(tt_dp_trainer_t *t, tt_seq_model_t *m, tt_pool_t *pool) {
+    if (!t || !m || !pool || !m->n_layers) return -1;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        const TensorBackend_t *ops = m->layers[l].desc.ops;
+        if (!ops->dense_grad || !ops->dense_grad_pack || !ops->dense_update) return -1;
+    }
+
+    /* resolve the lazily dispatched kernels before the lanes share them */
+    (void)tt_cpu_isa();
+    matrix_init();
+
+    memset(t, 0, sizeof(*t));
+    t->m         = m;
+    t->pool      = pool;
+    t->n_workers = tt_pool_lanes(pool);
+
+    size_t n = m->n_layers, nw = t->n_workers, max_w = 0, g_bytes = 0;
+    for (size_t l = 0; l < n; ++l) {
+        if (m->layers[l].W.len > max_w) max_w = m->layers[l].W.len;
+        g_bytes += nw * TT_SEQ_PAD(m->layers[l].W.len);
+    }
+    size_t bytes = TT_SEQ_PAD(nw * sizeof(tt_dp_worker_t)) +
+                   TT_SEQ_PAD(n * nw * sizeof(tensor_t)) +
+                   TT_SEQ_PAD(nw * sizeof(tensor_t)) +
+                   TT_SEQ_PAD(max_w * sizeof(int32_t)) + g_bytes + TT_SEQ_ALIGN;
+    t->mem = malloc(bytes);
+    if (!t->mem) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)t->mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+
+    t->workers = s_take(&cur, nw * sizeof(tt_dp_worker_t));
+    t->G       = s_take(&cur, n * nw * sizeof(tensor_t));
+    t->Gv      = s_take(&cur, nw * sizeof(tensor_t));
+    t->red_acc = s_take(&cur, max_w * sizeof(int32_t));
+    for (size_t l = 0; l < n; ++l)
+        for (size_t w = 0; w < nw; ++w) {
+            size_t len = m->layers[l].W.len;
+            tt_tensor_init(&t->G[l * nw + w], s_take(&cur, len), len);
+        }
+
+    for (size_t w = 0; w < nw; ++w) {
+        if (s_worker_init(&t->workers[w], m) != 0) {
+            t->n_workers = w;
+            tt_dp_trainer_free(t);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void tt_dp_trainer_free(tt_dp_trainer_t *t) {
+    if (!t || !t->mem) return;
+    for (size_t w = 0; w < t->n_workers; ++w) free(t->workers[w].mem);
+    free(t->mem);
+    memset(t, 0, sizeof(*t));
+}
+
+/*----------------------------------------------------------------------*
+ * One lane: forward, output error and dense_grad over its shard, then
+ * the int8 pack of every layer's gradient sums.
+ *----------------------------------------------------------------------*/
+static void s_shard(void *ctx, size_t task) {
+    tt_dp_trainer_t *t = (tt_dp_trainer_t *)ctx;
+    tt_dp_worker_t  *w = &t->workers[task];
+    const tt_seq_model_t *m = t->m;
+    size_t n = m->n_layers, in = w->input.len, out = w->err.len;
+
+    w->sse = 0;
+    if (!w->count) return;
+    for (size_t l = 0; l < n; ++l)
+        memset(w->gacc[l], 0, m->layers[l].W.len * sizeof(int32_t));
+
+    for (size_t s = w->first; s < w->first + w->count; ++s) {
+        /* forward on the lane's activations */
+        memcpy(w->input.data, t->in + s * in, in);
+        const tensor_t *x = &w->input;
+        for (size_t l = 0; l < n; ++l) {
+            const tt_layer_t *L = &m->layers[l];
+            L->desc.ops->dense_forward(&L->W, x, &w->A[l], w->acc, w->A[l].len, L->desc.act);
+            x = &w->A[l];
+        }
+
+        /* err = output - target: the loss gradient, W -= G descends */
+        const int8_t *tg = t->target + s * out;
+        for (size_t i = 0; i < out; ++i) {
+            int16_t d = x->data[i] - (int16_t)tg[i];
+            w->err.data[i] = clip_int8(d);
+            w->sse += (uint32_t)(d * d);
+        }
+
+        /* gradient sums and errors, last layer first */
+        const tensor_t *err_next = &w->err;
+        for (size_t l = n; l-- > 0; ) {
+            const tt_layer_t *L = &m->layers[l];
+            const tensor_t *xp = l ? &w->A[l - 1] : &w->input;
+            L->desc.ops->dense_grad(&L->W, xp, err_next, &w->E[l], w->gacc[l]);
+            err_next = &w->E[l];
+        }
+    }
+
+    for (size_t l = 0; l < n; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        L->desc.ops->dense_grad_pack(&L->W, w->gacc[l], &t->G[l * t->n_workers + task]);
+    }
+}
+
+/*----------------------------------------------------------------------*
+ * Shard, run the lanes, reduce and update every layer once.
+ *----------------------------------------------------------------------*/
+uint32_t tt_dp_train_batch(tt_dp_trainer_t *t, const int8_t *in, const int8_t *target, size_t n) {
+    if (!t || !t->mem || !in || !target || !n) return 0;
+    size_t nw = t->n_workers;
+    t->in     = in;
+    t->target = target;
+    for (size_t w = 0; w < nw; ++w) {
+        t->workers[w].first = n * w / nw;
+        t->workers[w].count = n * (w + 1) / nw - t->workers[w].first;
+    }
+
+    tt_pool_run(t->pool, s_shard, t, nw);
+
+    uint32_t sse = 0;
+    for (size_t w = 0; w < nw; ++w) sse += t->workers[w].sse;
+
+    tt_seq_model_t *m = t->m;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        size_t n_grad = 0;
+        for (size_t w = 0; w < nw; ++w)
+            if (t->workers[w].count) t->Gv[n_grad++] = t->G[l * nw + w];
+        L->desc.ops->dense_update(&L->W, t->Gv, n_grad, n, t->red_acc);
+        if (L->W.ext == &L->acc16) tt_dense_weights_sync(&L->W);
+    }
+    return sse;
+}
@@ -0,0 +1,58 @@
+/*============================================================
+ * File: tt_dp_trainer.h
+ * Data-parallel minibatch training of a sequential model
+ *============================================================*/
+#ifndef TT_DP_TRAINER_H
+#define TT_DP_TRAINER_H
+
+#include "tt_seq_model.h"
+#include "tt_thread_pool.h"
+#include <stdint.h>
+
+/*----------------------------------------------------------------------*
+ * A minibatch is split in one contiguous shard per pool lane. Each lane
+ * runs forward and the backend's dense_grad on its own activations and
+ * errors (the weights are only read), sums the gradients of its shard in
+ * int32 and packs them to an int8 gradient with its own scale header.
+ * The caller then reduces the per-lane gradients of every layer with
+ * dense_update (headers aligned like align_scale) and applies one SGD
+ * step. Buffers are allocated once, at init.
+ *----------------------------------------------------------------------*/
+
+typedef struct {
+    tensor_t   input;       /* [layers[0].in] */
+    tensor_t   err;         /* [layers[n-1].out] */
+    tensor_t  *A;           /* activations [n_layers] */
+    tensor_t  *E;           /* input errors [n_layers] */
+    int32_t   *acc;         /* forward accumulators [max out] */
+    int32_t  **gacc;        /* gradient sums [n_layers][W len] */
+    uint8_t   *mem;         /* single allocation behind the above */
+
+    size_t     first;       /* shard of the current batch */
+    size_t     count;
+    uint32_t   sse;
+} tt_dp_worker_t;
+
+typedef struct {
+    tt_seq_model_t *m;
+    tt_pool_t      *pool;
+    tt_dp_worker_t *workers;
+    size_t          n_workers;  /* = tt_pool_lanes(pool) */
+
+    tensor_t       *G;          /* packed gradients [n_layers][n_workers] */
+    tensor_t       *Gv;         /* gradients of the non-empty shards [n_workers] */
+    int32_t        *red_acc;    /* reduction sums [max W len] */
+    uint8_t        *mem;
+
+    const int8_t   *in;         /* current batch */
+    const int8_t   *target;
+} tt_dp_trainer_t;
+
+/* returns 0 on success, -1 on bad arguments, a backend without dense_grad or no memory */
+int      tt_dp_trainer_init(tt_dp_trainer_t *t, tt_seq_model_t *m, tt_pool_t *pool);
+void     tt_dp_trainer_free(tt_dp_trainer_t *t);
+
+/* in: n rows of layers[0].in, target: n rows of layers[n-1].out; returns the batch SSE */
+uint32_t tt_dp_train_batch(tt_dp_trainer_t *t, const int8_t *in, const int8_t *target, size_t n);
+
+#endif // TT_DP_TRAINER_H
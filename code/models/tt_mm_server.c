@@ -0,0 +1,276 @@
+#include "tt_mm_server.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*----------------------------------------------------------------------*
+ * bump allocation inside one malloc'ed block, TT_SEQ_ALIGN aligned
+ *----------------------------------------------------------------------*/
+static void *s_take(uint8_t **cur, size_t bytes) {
+    void *p = *cur;
+    *cur += TT_SEQ_PAD(bytes);
+    return p;
+}
+
+int tt_mm_server_init(tt_mm_server_t *s, tt_seq_model_t *const *models, size_t n_models,
+                      tt_pool_t *pool, size_t cap) {
+    if (!s || !models || !n_models || n_models > UINT32_MAX || !pool || !cap || cap > UINT32_MAX) return -1;
+    size_t lanes = tt_pool_lanes(pool), max_in = 0;
+    if (lanes > UINT16_MAX) return -1;
+    for (size_t id = 0; id < n_models; ++id) {
+        const tt_seq_model_t *m = models[id];
+        if (!m || !m->n_layers) return -1;
+        if (m->input.len > max_in) max_in = m->input.len;
+    }
+
+    /* resolve the lazily dispatched kernels before the lanes share them */
+    (void)tt_cpu_isa();
+    matrix_init();
+
+    memset(s, 0, sizeof(*s));
+    s->models   = models;
+    s->n_models = n_models;
+    s->max_in   = max_in;
+    s->pool     = pool;
+    s->n_lanes  = lanes;
+    s->cap      = cap;
+
+    size_t bytes = TT_SEQ_PAD(n_models * sizeof(uint16_t)) +
+                   2 * TT_SEQ_PAD(n_models * sizeof(uint32_t)) +
+                   3 * TT_SEQ_PAD(cap * sizeof(uint32_t)) +
+                   TT_SEQ_PAD(lanes * sizeof(tt_mm_lane_t)) + TT_SEQ_ALIGN;
+    s->mem = malloc(bytes);
+    if (!s->mem) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)s->mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+
+    s->home    = s_take(&cur, n_models * sizeof(uint16_t));
+    s->count   = s_take(&cur, n_models * sizeof(uint32_t));
+    s->end     = s_take(&cur, n_models * sizeof(uint32_t));
+    s->order   = s_take(&cur, cap * sizeof(uint32_t));
+    s->groups  = s_take(&cur, cap * sizeof(uint32_t));
+    s->touched = s_take(&cur, cap * sizeof(uint32_t));
+    s->lanes   = s_take(&cur, lanes * sizeof(tt_mm_lane_t));
+    for (size_t id = 0; id < n_models; ++id) {
+        s->home[id]  = (uint16_t)(id % lanes);
+        s->count[id] = 0;
+    }
+    memset(s->lanes, 0, lanes * sizeof(tt_mm_lane_t));
+    return 0;
+}
+
+void tt_mm_server_free(tt_mm_server_t *s) {
+    if (!s) return;
+    free(s->mem);
+    memset(s, 0, sizeof(*s));
+}
+
+/*----------------------------------------------------------------------*
+ * Lane queues: the owner pops the front, thieves the back, both by one
+ * compare-and-swap of the packed head and tail.
+ *----------------------------------------------------------------------*/
+static inline uint64_t s_range(uint32_t head, uint32_t tail) {
+    return (uint64_t)tail << 32 | head;
+}
+
+static int s_pop(tt_mm_lane_t *q, int back, uint32_t *slot) {
+    uint64_t r = __atomic_load_n(&q->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t head = (uint32_t)r, tail = (uint32_t)(r >> 32);
+        if (head >= tail) return 0;
+        uint64_t next = back ? s_range(head, tail - 1) : s_range(head + 1, tail);
+        if (__atomic_compare_exchange_n(&q->range, &r, next, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            *slot = back ? tail - 1 : head;
+            return 1;
+        }
+    }
+}
+
+/* every request of one model, back to back */
+static void s_group(tt_mm_server_t *s, uint32_t id) {
+    tt_seq_model_t *m = s->models[id];
+    const uint32_t end = s->end[id];
+    for (uint32_t k = end - s->count[id]; k < end; ++k) {
+        tt_mm_req_t *r = &s->reqs[s->order[k]];
+        const tensor_t *y = tt_seq_model_forward(m, r->in);
+
+        uint32_t sse = 0;
+        if (y->len == m->input.len) {
+            for (size_t i = 0; i < y->len; ++i) {
+                int16_t d = (int16_t)m->input.data[i] - y->data[i];
+                sse += (uint32_t)(d * d);
+            }
+        }
+        if (r->out) memcpy(r->out, y->data, y->len);
+        r->sse    = sse;
+        r->status = 0;
+    }
+}
+
+static void s_lane(void *ctx, size_t lane) {
+    tt_mm_server_t *s = (tt_mm_server_t *)ctx;
+    const size_t nl = s->n_lanes;
+    uint32_t slot;
+
+    while (s_pop(&s->lanes[lane], 0, &slot)) s_group(s, s->groups[slot]);
+
+    /* own queue empty: steal from the back of the others until all are */
+    for (size_t v = 1; v < nl; ) {
+        if (!s_pop(&s->lanes[(lane + v) % nl], 1, &slot)) {
+            ++v;
+            continue;
+        }
+        uint32_t id = s->groups[slot];
+        s_group(s, id);
+        /* the model is hot here now, only this lane writes its home */
+        s->home[id] = (uint16_t)lane;
+        s->lanes[lane].stolen++;
+    }
+}
+
+/*----------------------------------------------------------------------*
+ * One batch of at most cap requests: group, place, run.
+ *----------------------------------------------------------------------*/
+static size_t s_batch(tt_mm_server_t *s, tt_mm_req_t *reqs, size_t n) {
+    const size_t nl = s->n_lanes;
+    size_t n_groups = 0, n_ok = 0;
+
+    /* requests per model, and the models of the batch */
+    for (size_t i = 0; i < n; ++i) {
+        tt_mm_req_t *r = &reqs[i];
+        r->sse = 0;
+        if (r->model >= s->n_models || !r->in) {
+            r->status = -1;
+            continue;
+        }
+        r->status = 0;
+        if (s->count[r->model]++ == 0) s->touched[n_groups++] = r->model;
+        ++n_ok;
+    }
+    if (!n_groups) return 0;
+
+    /* groups by home lane: lane l owns groups[head, tail) */
+    uint32_t pos = 0;
+    for (size_t l = 0; l < nl; ++l) {
+        uint32_t head = pos;
+        for (size_t g = 0; g < n_groups; ++g)
+            if (s->home[s->touched[g]] == l) s->groups[pos++] = s->touched[g];
+        s->lanes[l].range = s_range(head, pos);
+    }
+
+    /* request indices grouped by model, end[id] left at each group's end */
+    uint32_t off = 0;
+    for (size_t g = 0; g < n_groups; ++g) {
+        uint32_t id = s->groups[g];
+        s->end[id] = off;
+        off += s->count[id];
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (reqs[i].status == 0) s->order[s->end[reqs[i].model]++] = (uint32_t)i;
+
+    s->reqs = reqs;
+    tt_pool_run_lanes(s->pool, s_lane, s);
+    s->reqs = NULL;
+
+    for (size_t g = 0; g < n_groups; ++g) s->count[s->touched[g]] = 0;
+    return n_ok;
+}
+
+size_t tt_mm_server_run(tt_mm_server_t *s, tt_mm_req_t *reqs, size_t n) {
+    if (!s || !s->mem || !reqs) return 0;
+    size_t done = 0;
+    for (size_t i = 0; i < n; i += s->cap) {
+        size_t k = n - i < s->cap ? n - i : s->cap;
+        done += s_batch(s, reqs + i, k);
+    }
+    return done;
+}
+
+/*----------------------------------------------------------------------*
+ * Stream front-end.
+ *----------------------------------------------------------------------*/
+static int s_write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len) {
+        ssize_t w = write(fd, p, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p   += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+int tt_mm_server_serve_fd(tt_mm_server_t *s, int in_fd, int out_fd) {
+    if (!s || !s->mem || in_fd < 0 || out_fd < 0) return -1;
+    const size_t rec_max = sizeof(tt_mm_wire_req_t) + s->max_in;
+    const size_t buf_len = TT_SEQ_PAD(s->cap * rec_max);
+
+    uint8_t *mem = malloc(buf_len + s->cap * (sizeof(tt_mm_req_t) + sizeof(tt_mm_wire_resp_t)));
+    if (!mem) return -1;
+    uint8_t           *buf  = mem;
+    tt_mm_req_t       *reqs = (tt_mm_req_t *)(mem + buf_len);
+    tt_mm_wire_resp_t *resp = (tt_mm_wire_resp_t *)(reqs + s->cap);
+
+    size_t have = 0;
+    int rc = 0;
+    for (;;) {
+        ssize_t got = read(in_fd, buf + have, buf_len - have);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            rc = -1;
+            break;
+        }
+        if (got == 0) {
+            /* a partial request at end of file */
+            if (have) rc = -1;
+            break;
+        }
+        have += (size_t)got;
+
+        /* batches of up to cap until no whole request is left: short
+         * requests fit more than cap into the buffer, and a full buffer
+         * would read 0 bytes and look like end of file */
+        size_t used = 0, n;
+        do {
+            n = 0;
+            while (n < s->cap && have - used >= sizeof(tt_mm_wire_req_t)) {
+                tt_mm_wire_req_t h;
+                memcpy(&h, buf + used, sizeof(h));
+                if (h.len > s->max_in) {
+                    rc = -1;
+                    break;
+                }
+                if (have - used < sizeof(h) + h.len) break;
+                resp[n].model = h.model;
+                resp[n].tag   = h.tag;
+                tt_mm_req_t *r = &reqs[n++];
+                r->model = h.model;
+                r->tag   = h.tag;
+                r->in    = (const int8_t *)(buf + used + sizeof(h));
+                r->out   = NULL;
+                /* a length that does not match the model marks it unknown */
+                if (h.model < s->n_models && h.len != s->models[h.model]->input.len) r->model = UINT32_MAX;
+                used += sizeof(h) + h.len;
+            }
+            if (n) {
+                tt_mm_server_run(s, reqs, n);
+                for (size_t i = 0; i < n; ++i) {
+                    resp[i].sse    = reqs[i].sse;
+                    resp[i].status = reqs[i].status;
+                }
+                if (s_write_all(out_fd, resp, n * sizeof(*resp)) != 0) rc = -1;
+            }
+        } while (n == s->cap && !rc);
+        if (rc) break;
+
+        memmove(buf, buf + used, have - used);
+        have -= used;
+    }
+    free(mem);
+    return rc;
+}
@@ -0,0 +1,115 @@
+/*============================================================
+ * File: tt_mm_server.h
+ * Many-model inference: requests of thousands of small models on one pool
+ *============================================================*/
+#ifndef TT_MM_SERVER_H
+#define TT_MM_SERVER_H
+
+#include "tt_seq_model.h"
+#include "tt_thread_pool.h"
+#include <stdint.h>
+
+/*----------------------------------------------------------------------*
+ * A gateway runs one small model per motor and scores their samples as
+ * they arrive. The server holds a registry of those models (caller owned,
+ * indexed by model id) and serves batches of requests tagged with an id:
+ *
+ *   1. group  the requests of a batch by model (counting sort, arrival
+ *             order kept inside a model), one group per model
+ *   2. place  every group on the queue of its model's home lane
+ *   3. run    one per-lane pool job: a lane pops groups from the front
+ *             of its own queue, then steals from the back of the others
+ *
+ * A group runs its requests back to back through tt_seq_model_forward, so
+ * the model's weights and buffers are loaded once per batch and stay in
+ * the lane's caches. Homes are sticky: a model starts on lane id mod
+ * lanes and moves to the lane that last stole it, so hot models keep the
+ * core they run on (pin the workers with tt_pool_pin) and load drifts to
+ * the lanes that ran dry. A model never runs on two lanes at once, its
+ * buffers hold one sample at a time; one very hot model is therefore
+ * bounded by one lane.
+ *
+ * Every request is scored like tt_motor_ae_forward: the SSE of the output
+ * against the input when both have the same length (autoencoders), and
+ * the output is copied out when the request asks for it. The models must
+ * not be trained while the server runs them.
+ *----------------------------------------------------------------------*/
+
+typedef struct {
+    uint32_t      model;    /* id: index into the registry */
+    uint32_t      tag;      /* the caller's, not read */
+    const int8_t *in;       /* [layers[0].in] of the model */
+    int8_t       *out;      /* [layers[n-1].out] of the model, or NULL */
+    uint32_t      sse;      /* out: reconstruction SSE, 0 if out len != in len */
+    int32_t       status;   /* out: 0, -1 for an unknown model */
+} tt_mm_req_t;
+
+/* queue of one lane: head (low half) and tail of its groups, one CAS word */
+typedef struct {
+    uint64_t range;
+    uint64_t stolen;        /* groups this lane took from the others */
+    uint8_t  pad[TT_SEQ_ALIGN - 2 * sizeof(uint64_t)];
+} tt_mm_lane_t;
+
+typedef struct {
+    tt_seq_model_t *const *models;
+    size_t          n_models;
+    size_t          max_in;     /* largest layers[0].in of the registry */
+    tt_pool_t      *pool;
+    size_t          n_lanes;    /* = tt_pool_lanes(pool) */
+    size_t          cap;        /* requests per batch */
+
+    uint16_t       *home;       /* lane of every model [n_models] */
+    uint32_t       *count;      /* requests per model in the batch, 0 between batches [n_models] */
+    uint32_t       *end;        /* end of every model's group in order [n_models] */
+    uint32_t       *order;      /* request indices grouped by model [cap] */
+    uint32_t       *groups;     /* model ids of the batch, by home lane [cap] */
+    uint32_t       *touched;    /* model ids of the batch, first seen order [cap] */
+    tt_mm_lane_t   *lanes;      /* [n_lanes] */
+    uint8_t        *mem;        /* single allocation behind the above */
+
+    tt_mm_req_t    *reqs;       /* current batch */
+} tt_mm_server_t;
+
+/*
+ * models[id] for id < n_models (stay owned by the caller, weights set);
+ * cap bounds the requests grouped per batch. 0, or -1 on bad arguments,
+ * more than 65535 lanes or no memory
+ */
+int    tt_mm_server_init(tt_mm_server_t *s, tt_seq_model_t *const *models, size_t n_models,
+                         tt_pool_t *pool, size_t cap);
+void   tt_mm_server_free(tt_mm_server_t *s);
+
+/* serves n requests in batches of cap, fills sse, status and out; returns how many ran */
+size_t tt_mm_server_run(tt_mm_server_t *s, tt_mm_req_t *reqs, size_t n);
+
+/*----------------------------------------------------------------------*
+ * Stream front-end for a local pipe or socket, host byte order:
+ *
+ *   request   tt_mm_wire_req_t, then len int8 inputs
+ *   response  tt_mm_wire_resp_t, in request order
+ *
+ * Whatever whole requests a read returns form batches of up to cap, so
+ * batches grow with the load; all of them are answered before the next
+ * read, and at end of file before a partial request is reported. A
+ * request whose len does not match its model gets status -1 and is not
+ * run.
+ *----------------------------------------------------------------------*/
+typedef struct {
+    uint32_t model;
+    uint32_t tag;
+    uint16_t len;
+    uint16_t reserved;
+} tt_mm_wire_req_t;
+
+typedef struct {
+    uint32_t model;
+    uint32_t tag;
+    uint32_t sse;
+    int32_t  status;
+} tt_mm_wire_resp_t;
+
+/* serves in_fd until end of file; 0, or -1 on an I/O error, a truncated or oversized request */
+int    tt_mm_server_serve_fd(tt_mm_server_t *s, int in_fd, int out_fd);
+
+#endif // TT_MM_SERVER_H
@@ -0,0 +1,228 @@
+#include "tt_model_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* the on-disk records are fixed at 64 bytes */
+typedef char tt_mf_header_size_check[sizeof(tt_mf_header_t) == 64 ? 1 : -1];
+typedef char tt_mf_layer_size_check[sizeof(tt_mf_layer_t) == 64 ? 1 : -1];
+
+#define S_ALIGN_UP(n)   (((uint64_t)(n) + TT_MF_ALIGN - 1) & ~(uint64_t)(TT_MF_ALIGN - 1))
+
+static uint64_t s_payload_bytes(uint8_t w_bits, uint16_t in, uint16_t out) {
+    return w_bits == 4 ? (uint64_t)TT_I4_BYTES(out, in) : (uint64_t)in * out;
+}
+
+static int s_write_pad(FILE *fp, uint64_t from, uint64_t to) {
+    static const uint8_t zero[TT_MF_ALIGN] = { 0 };
+    while (from < to) {
+        size_t k = (size_t)(to - from < TT_MF_ALIGN ? to - from : TT_MF_ALIGN);
+        if (fwrite(zero, 1, k, fp) != k) return -1;
+        from += k;
+    }
+    return 0;
+}
+
+/* tiled weights go to the file row-major, TT_MF_ALIGN bytes at a time */
+static int s_write_tiled(FILE *fp, const tt_layer_t *L) {
+    const matrix_tile_t *t = &L->tile;
+    int8_t buf[TT_MF_ALIGN];
+    size_t k = 0;
+    for (size_t r = 0; r < t->rows; ++r)
+        for (size_t c = 0; c < t->cols; ++c) {
+            buf[k++] = L->W.data[matrix_tile_idx(t, r, c)];
+            if (k == TT_MF_ALIGN) {
+                if (fwrite(buf, 1, k, fp) != k) return -1;
+                k = 0;
+            }
+        }
+    return k && fwrite(buf, 1, k, fp) != k ? -1 : 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Save: header, layer table, then every payload on a 64-byte boundary.
+ *----------------------------------------------------------------------*/
+int tt_model_file_save(const char *path, const tt_seq_model_t *m) {
+    if (!path || !m || !m->layers || !m->n_layers || m->n_layers > TT_SEQ_MAX_LAYERS) return -1;
+
+    tt_mf_header_t hdr;
+    tt_mf_layer_t  table[TT_SEQ_MAX_LAYERS];
+    memset(&hdr, 0, sizeof(hdr));
+    memset(table, 0, sizeof(table));
+
+    uint64_t off = S_ALIGN_UP(sizeof(hdr) + m->n_layers * sizeof(tt_mf_layer_t));
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        tt_mf_layer_t *e = &table[l];
+        if (L->desc.type != TT_LAYER_DENSE) return -1;   /* payloads are [out x in] */
+        e->type   = (uint8_t)L->desc.type;
+        e->act    = (uint8_t)L->desc.act;
+        e->w_bits = L->w_bits;
+        e->i4_k   = L->w_bits == 4 ? L->i4.k : 0;
+        e->in     = L->desc.in;
+        e->out    = L->desc.out;
+#ifdef TENSOR_USE_NESTED
+        e->g[0] = L->W.s.g.S; e->g[1] = L->W.s.g.U; e->g[2] = L->W.s.g.D;
+        e->l[0] = L->W.s.l.S; e->l[1] = L->W.s.l.U; e->l[2] = L->W.s.l.D;
+#else
+        e->l[0] = L->W.s.S;   e->l[1] = L->W.s.U;   e->l[2] = L->W.s.D;
+#endif
+        e->w_off   = off;
+        e->w_bytes = s_payload_bytes(e->w_bits, e->in, e->out);
+        off = S_ALIGN_UP(off + e->w_bytes);
+    }
+    memcpy(hdr.magic, TT_MF_MAGIC, 4);
+    hdr.version    = TT_MF_VERSION;
+#ifdef TENSOR_USE_NESTED
+    hdr.flags      = TT_MF_NESTED;
+#endif
+    hdr.n_layers   = (uint32_t)m->n_layers;
+#ifdef TENSOR_USE_NESTED
+    hdr.in_g[0] = m->input.s.g.S; hdr.in_g[1] = m->input.s.g.U; hdr.in_g[2] = m->input.s.g.D;
+    hdr.in_l[0] = m->input.s.l.S; hdr.in_l[1] = m->input.s.l.U; hdr.in_l[2] = m->input.s.l.D;
+#else
+    hdr.in_l[0] = m->input.s.S;   hdr.in_l[1] = m->input.s.U;   hdr.in_l[2] = m->input.s.D;
+#endif
+    hdr.table_off  = sizeof(hdr);
+    hdr.file_bytes = off;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return -1;
+    int rc = 0;
+    uint64_t pos = sizeof(hdr) + m->n_layers * sizeof(tt_mf_layer_t);
+    if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+        fwrite(table, sizeof(tt_mf_layer_t), m->n_layers, fp) != m->n_layers) rc = -1;
+    for (size_t l = 0; l < m->n_layers && rc == 0; ++l) {
+        const tt_mf_layer_t *e = &table[l];
+        const tt_layer_t *L = &m->layers[l];
+        if (s_write_pad(fp, pos, e->w_off) != 0) rc = -1;
+        else if (L->w_tiled) rc = s_write_tiled(fp, L);
+        else if (fwrite(L->W.data, 1, (size_t)e->w_bytes, fp) != e->w_bytes) rc = -1;
+        pos = e->w_off + e->w_bytes;
+    }
+    if (rc == 0) rc = s_write_pad(fp, pos, off);
+    if (fclose(fp) != 0) rc = -1;
+    return rc;
+}
+
+/* every bound of the header and the table against the mapping */
+static int s_valid(const uint8_t *map, size_t bytes) {
+    if (bytes < sizeof(tt_mf_header_t)) return 0;
+    const tt_mf_header_t *h = (const tt_mf_header_t *)map;
+    if (memcmp(h->magic, TT_MF_MAGIC, 4) != 0 || h->version < TT_MF_VERSION_MIN || h->version > TT_MF_VERSION) return 0;
+    if (h->file_bytes != bytes || !h->n_layers || h->n_layers > TT_SEQ_MAX_LAYERS) return 0;
+    if (h->table_off % TT_MF_ALIGN || h->table_off + (uint64_t)h->n_layers * sizeof(tt_mf_layer_t) > bytes) return 0;
+
+    const tt_mf_layer_t *t = (const tt_mf_layer_t *)(map + h->table_off);
+    for (uint32_t l = 0; l < h->n_layers; ++l) {
+        const tt_mf_layer_t *e = &t[l];
+        if (e->type != TT_LAYER_DENSE || e->act >= TT_ACT_COUNT) return 0;
+        if ((e->w_bits != 8 && e->w_bits != 4) || !e->in || !e->out) return 0;
+        if (l && t[l - 1].out != e->in) return 0;
+        if (e->w_bytes != s_payload_bytes(e->w_bits, e->in, e->out)) return 0;
+        if (e->w_off % TT_MF_ALIGN || e->w_off > bytes || e->w_bytes > bytes - e->w_off) return 0;
+    }
+    return 1;
+}
+
+/*----------------------------------------------------------------------*
+ * Open: private writable mapping, so training on a bound model never
+ * writes back to the file and untouched pages stay shared.
+ *----------------------------------------------------------------------*/
+int tt_model_file_open(tt_model_file_t *f, const char *path) {
+    if (!f || !path) return -1;
+    memset(f, 0, sizeof(*f));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);   /* the mapping keeps the file */
+    if (map == MAP_FAILED) return -1;
+    if (!s_valid(map, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+    f->map       = map;
+    f->map_bytes = (size_t)st.st_size;
+    f->hdr       = (const tt_mf_header_t *)map;
+    f->table     = (const tt_mf_layer_t *)(f->map + f->hdr->table_off);
+    return 0;
+}
+
+void tt_model_file_close(tt_model_file_t *f) {
+    if (!f || !f->map) return;
+    munmap(f->map, f->map_bytes);
+    memset(f, 0, sizeof(*f));
+}
+
+size_t tt_model_file_descs(const tt_model_file_t *f, const TensorBackend_t *ops,
+                           tt_layer_desc_t *descs, size_t max_descs) {
+    if (!f || !f->map || !ops || !descs || f->hdr->n_layers > max_descs) return 0;
+    for (uint32_t l = 0; l < f->hdr->n_layers; ++l) {
+        const tt_mf_layer_t *e = &f->table[l];
+        /* the payload must be what the backend keeps in W->data */
+        if ((ops->w_bits == 4) != (e->w_bits == 4)) return 0;
+        descs[l].type = (tt_layer_type_t)e->type;
+        descs[l].in   = e->in;
+        descs[l].out  = e->out;
+        descs[l].act  = (tt_act_t)e->act;
+        descs[l].ops  = ops;
+    }
+    return f->hdr->n_layers;
+}
+
+size_t tt_model_file_arena_size(const tt_model_file_t *f, const TensorBackend_t *ops) {
+    tt_layer_desc_t descs[TT_SEQ_MAX_LAYERS];
+    size_t n = tt_model_file_descs(f, ops, descs, TT_SEQ_MAX_LAYERS);
+    return n ? tt_seq_model_arena_size_weights(descs, n) : 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Bind: the seq runtime places everything but the weights in the arena.
+ *----------------------------------------------------------------------*/
+int tt_model_file_bind(const tt_model_file_t *f, tt_seq_model_t *m, tt_layer_t *layers,
+                       const TensorBackend_t *ops, void *arena, size_t arena_size) {
+    tt_layer_desc_t descs[TT_SEQ_MAX_LAYERS];
+    void *weights[TT_SEQ_MAX_LAYERS];
+    size_t n = tt_model_file_descs(f, ops, descs, TT_SEQ_MAX_LAYERS);
+    if (!n || !m || !layers) return -1;
+    for (size_t l = 0; l < n; ++l) weights[l] = f->map + f->table[l].w_off;
+
+    if (tt_seq_model_init_weights(m, layers, descs, n, weights, arena, arena_size) != 0) return -1;
+
+    for (size_t l = 0; l < n; ++l) {
+        const tt_mf_layer_t *e = &f->table[l];
+        tensor_t *W = &layers[l].W;
+#ifdef TENSOR_USE_NESTED
+        W->s.g.S = e->g[0]; W->s.g.U = e->g[1]; W->s.g.D = e->g[2];
+        W->s.l.S = e->l[0]; W->s.l.U = e->l[1]; W->s.l.D = e->l[2];
+#else
+        W->s.S = (int8_t)(e->g[0] + e->l[0]);
+        W->s.U = (int8_t)(e->g[1] + e->l[1]);
+        W->s.D = (int8_t)(e->g[2] + e->l[2]);
+#endif
+        if (layers[l].w_bits == 4) layers[l].i4.k = e->i4_k;
+    }
+    /* version 1 left these bytes reserved */
+    int8_t in_g[3] = { 0 }, in_l[3] = { 0 };
+    if (f->hdr->version >= 2) {
+        memcpy(in_g, f->hdr->in_g, 3);
+        memcpy(in_l, f->hdr->in_l, 3);
+    }
+#ifdef TENSOR_USE_NESTED
+    m->input.s.g.S = in_g[0]; m->input.s.g.U = in_g[1]; m->input.s.g.D = in_g[2];
+    m->input.s.l.S = in_l[0]; m->input.s.l.U = in_l[1]; m->input.s.l.D = in_l[2];
+#else
+    m->input.s.S = (int8_t)(in_g[0] + in_l[0]);
+    m->input.s.U = (int8_t)(in_g[1] + in_l[1]);
+    m->input.s.D = (int8_t)(in_g[2] + in_l[2]);
+#endif
+    return 0;
+}
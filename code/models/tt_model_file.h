@@ -0,0 +1,92 @@
+/**
+ * @file tt_model_file.h
+ * @brief versioned binary model file, loaded by mmap with zero copies
+ * @details little-endian layout, every section on a 64-byte boundary:
+ *
+ *   offset 0        tt_mf_header_t (64 B)
+ *   table_off       n_layers x tt_mf_layer_t (64 B each)
+ *   w_off of l      int8 [out x in] weights, or TT_I4_BYTES(out, in) packed
+ *                   int4 nibbles (w_bits 4, pack shift i4_k)
+ *
+ * Every W header is stored as both the global and the local S/U/D part:
+ * a flat build writes g = 0 and loads S = g + l, so files move between
+ * the tt and the nested builds. The header of the model input is kept the
+ * same way since version 2; version 1 files (those bytes reserved) still
+ * open and load with a zero input header. tt_model_file_open maps the file
+ * private (copy-on-write): tensor_t::data points straight into the mapping, pages
+ * are shared by every process mapping the same file until one trains.
+ * Payloads are always row-major: tiled backends repack them into their
+ * arena at bind and unpack them at save.
+ * @license MIT
+ */
+#ifndef TT_MODEL_FILE_H
+#define TT_MODEL_FILE_H
+
+#include "tt_seq_model.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define TT_MF_MAGIC     "TTMF"
+#define TT_MF_VERSION     (2)       /* 2: model input header in_g / in_l */
+#define TT_MF_VERSION_MIN (1)       /* oldest version still loaded */
+#define TT_MF_ALIGN     (64)
+#define TT_MF_NESTED    (1u << 0)   /* flags: written by a nested build */
+
+typedef struct {
+    char     magic[4];     /* TT_MF_MAGIC */
+    uint16_t version;      /* TT_MF_VERSION_MIN .. TT_MF_VERSION */
+    uint16_t flags;        /* TT_MF_* */
+    uint32_t n_layers;
+    uint32_t table_off;    /* offset of the layer table */
+    uint64_t file_bytes;   /* total size, checked against the mapping */
+    int8_t   in_g[3];      /* v2: model input header, global S, U, D (0 from flat builds) */
+    int8_t   in_l[3];      /* v2: model input header, local (or flat) S, U, D */
+    uint8_t  reserved[34];
+} tt_mf_header_t;
+
+typedef struct {
+    uint8_t  type;         /* tt_layer_type_t */
+    uint8_t  act;          /* tt_act_t */
+    uint8_t  w_bits;       /* payload: 8 int8, 4 packed int4 */
+    uint8_t  i4_k;         /* pack shift of an int4 payload */
+    uint16_t in;
+    uint16_t out;
+    int8_t   g[3];         /* W header, global S, U, D (0 from flat builds) */
+    int8_t   l[3];         /* W header, local (or flat) S, U, D */
+    uint8_t  reserved0[2];
+    uint64_t w_off;        /* payload offset, multiple of TT_MF_ALIGN */
+    uint64_t w_bytes;      /* payload bytes */
+    uint8_t  reserved[32];
+} tt_mf_layer_t;
+
+/* an open (mapped) model file */
+typedef struct {
+    uint8_t             *map;
+    size_t               map_bytes;
+    const tt_mf_header_t *hdr;
+    const tt_mf_layer_t  *table;
+} tt_model_file_t;
+
+/* write the layers of m (W headers and weights) and its input header to path; 0 or -1 (dense layers only) */
+int    tt_model_file_save(const char *path, const tt_seq_model_t *m);
+
+/* map and validate a file; 0 or -1 (nothing to close on failure) */
+int    tt_model_file_open(tt_model_file_t *f, const char *path);
+void   tt_model_file_close(tt_model_file_t *f);
+
+/* layer descriptors of the file on backend ops; n or 0 if the file does not fit ops */
+size_t tt_model_file_descs(const tt_model_file_t *f, const TensorBackend_t *ops,
+                           tt_layer_desc_t *descs, size_t max_descs);
+
+/* arena bytes of tt_model_file_bind on backend ops (0 if it does not fit) */
+size_t tt_model_file_arena_size(const tt_model_file_t *f, const TensorBackend_t *ops);
+
+/*
+ * build a model on backend ops whose weights are the mapped payloads (no
+ * copy) and whose W and input headers come from the file. f must stay open while m
+ * is used. 0 or -1
+ */
+int    tt_model_file_bind(const tt_model_file_t *f, tt_seq_model_t *m, tt_layer_t *layers,
+                          const TensorBackend_t *ops, void *arena, size_t arena_size);
+
+#endif // TT_MODEL_FILE_H
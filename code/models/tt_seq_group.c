@@ -0,0 +1,108 @@
+#include "tt_seq_group.h"
+#include "matrix.h"
+#include "tt_cpu.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------*
+ * bump allocation inside one malloc'ed block, TT_SEQ_ALIGN aligned
+ *----------------------------------------------------------------------*/
+static void *s_take(uint8_t **cur, size_t bytes) {
+    void *p = *cur;
+    *cur += TT_SEQ_PAD(bytes);
+    return p;
+}
+
+/* every model has the layers of models[0], dense and with a separate epilogue */
+static int s_same_shape(tt_seq_model_t *const *models, size_t K) {
+    const tt_seq_model_t *m0 = models[0];
+    for (size_t k = 0; k < K; ++k) {
+        const tt_seq_model_t *m = models[k];
+        if (!m || m->n_layers != m0->n_layers) return 0;
+        for (size_t l = 0; l < m->n_layers; ++l) {
+            const tt_layer_desc_t *d = &m->layers[l].desc, *d0 = &m0->layers[l].desc;
+            if (d->type != TT_LAYER_DENSE || d->in != d0->in || d->out != d0->out) return 0;
+            if (!d->ops->dense_epilogue || m->layers[l].w_bits != 8) return 0;
+        }
+    }
+    return 1;
+}
+
+int tt_seq_group_init(tt_seq_group_t *g, tt_seq_model_t *const *models, size_t K) {
+    if (!g || !models || !K || !models[0] || !models[0]->n_layers) return -1;
+    if (!s_same_shape(models, K)) return -1;
+
+    /* resolve the dispatched kernels once, outside the forward pass */
+    (void)tt_cpu_isa();
+    matrix_init();
+
+    memset(g, 0, sizeof(*g));
+    g->models   = models;
+    g->K        = K;
+    g->n_layers = models[0]->n_layers;
+
+    const tt_layer_t *L0 = models[0]->layers;
+    size_t max_out = 0, max_x = 0, w_bytes = 0;
+    for (size_t l = 0; l < g->n_layers; ++l) {
+        const tt_layer_desc_t *d = &L0[l].desc;
+        if (d->out > max_out) max_out = d->out;
+        if (MATRIX_GRP_X_BYTES(K, d->in) > max_x) max_x = MATRIX_GRP_X_BYTES(K, d->in);
+        w_bytes += TT_SEQ_PAD(MATRIX_GRP_W_BYTES(K, d->out, d->in));
+    }
+    size_t bytes = TT_SEQ_PAD(g->n_layers * sizeof(matrix_grp_t)) +
+                   TT_SEQ_PAD(max_x) +
+                   TT_SEQ_PAD(K * max_out * sizeof(int32_t)) +
+                   TT_SEQ_PAD(K * sizeof(const int8_t *)) + w_bytes + TT_SEQ_ALIGN;
+    g->mem = malloc(bytes);
+    if (!g->mem) return -1;
+    uint8_t *cur = (uint8_t *)(((uintptr_t)g->mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+
+    g->layers = s_take(&cur, g->n_layers * sizeof(matrix_grp_t));
+    g->xg     = s_take(&cur, max_x);
+    g->acc    = s_take(&cur, K * max_out * sizeof(int32_t));
+    g->x      = s_take(&cur, K * sizeof(const int8_t *));
+    for (size_t l = 0; l < g->n_layers; ++l) {
+        const tt_layer_desc_t *d = &L0[l].desc;
+        matrix_grp_init(&g->layers[l], s_take(&cur, MATRIX_GRP_W_BYTES(K, d->out, d->in)), K, d->out, d->in);
+    }
+    tt_seq_group_sync(g);
+    return 0;
+}
+
+void tt_seq_group_free(tt_seq_group_t *g) {
+    if (!g) return;
+    free(g->mem);
+    memset(g, 0, sizeof(*g));
+}
+
+void tt_seq_group_sync(tt_seq_group_t *g) {
+    if (!g || !g->mem) return;
+    for (size_t l = 0; l < g->n_layers; ++l)
+        for (size_t k = 0; k < g->K; ++k) matrix_grp_pack(&g->layers[l], k, g->models[k]->layers[l].W.data);
+}
+
+/*----------------------------------------------------------------------*
+ * Layer by layer: one grouped GEMV, then the epilogue of every model on
+ * its own accumulators and headers.
+ *----------------------------------------------------------------------*/
+void tt_seq_group_forward(tt_seq_group_t *g, const int8_t *const *in) {
+    if (!g || !g->mem || !in) return;
+    for (size_t k = 0; k < g->K; ++k) {
+        tt_seq_model_t *m = g->models[k];
+        memcpy(m->input.data, in[k], m->input.len);
+        g->x[k] = m->input.data;
+    }
+
+    for (size_t l = 0; l < g->n_layers; ++l) {
+        const matrix_grp_t *gl = &g->layers[l];
+        matrix_grp_pack_x(gl, g->x, g->xg);
+        matrix_mul_grp(gl, g->xg, g->acc);
+        for (size_t k = 0; k < g->K; ++k) {
+            tt_seq_model_t *m = g->models[k];
+            tt_layer_t *L = &m->layers[l];
+            const tensor_t *x = l ? &m->layers[l - 1].A : &m->input;
+            L->desc.ops->dense_epilogue(&L->W, x, &L->A, g->acc + k * gl->out, L->desc.act);
+            g->x[k] = L->A.data;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*============================================================
+ * File: tt_seq_group.h
+ * One forward pass over K sequential models of the same shape
+ *============================================================*/
+#ifndef TT_SEQ_GROUP_H
+#define TT_SEQ_GROUP_H
+
+#include "tt_seq_model.h"
+#include "matrix_group.h"
+#include <stdint.h>
+
+/*----------------------------------------------------------------------*
+ * Fleets of tiny models (one motor AE per motor) share one architecture
+ * and differ only in their weights and scale headers. A group evaluates
+ * one input per model for K such models at once: every layer runs one
+ * grouped GEMV over the interleaved weights of all K models (vector lanes
+ * span models, see matrix_group.h), then each model's own backend
+ * epilogue requantizes its accumulators with its own headers and
+ * activation. The result of model k is bit for bit its
+ * tt_seq_model_forward output and is left in its buffers (input, every
+ * A), so the models can be trained or scored as usual afterwards.
+ *
+ * Every layer must be dense with the same in / out across the models, on
+ * a backend with a separate epilogue (tt_backend, nested_backend). The
+ * interleaved weights are a copy: call tt_seq_group_sync after the
+ * weights of any model changed. Buffers are allocated once, at init.
+ *----------------------------------------------------------------------*/
+
+typedef struct {
+    tt_seq_model_t *const *models;
+    size_t          K;
+    size_t          n_layers;
+    matrix_grp_t   *layers;     /* interleaved weights of every layer [n_layers] */
+    int8_t         *xg;         /* interleaved inputs of the current layer */
+    int32_t        *acc;        /* accumulators [K x max out], model major */
+    const int8_t  **x;          /* input of every model for the current layer [K] */
+    uint8_t        *mem;        /* single allocation behind the above */
+} tt_seq_group_t;
+
+/* models[0..K-1] stay owned by the caller; 0, or -1 on bad arguments, mismatched shapes or no memory */
+int  tt_seq_group_init(tt_seq_group_t *g, tt_seq_model_t *const *models, size_t K);
+void tt_seq_group_free(tt_seq_group_t *g);
+
+/* repacks the interleaved weights from the models */
+void tt_seq_group_sync(tt_seq_group_t *g);
+
+/* in[k] is the input of model k; each output is left in the last A of its model */
+void tt_seq_group_forward(tt_seq_group_t *g, const int8_t *const *in);
+
+#endif // TT_SEQ_GROUP_H
@@ -0,0 +1,406 @@
+#include "tt_seq_model.h"
+#include "tt_utils.h"
+#include "prng.h"
+#include "tt_mem_plan.h"
+#include "tt_debug.h"
+#include <string.h>
+#if TT_BIG_MACHINE_DEBUG_ENABLE
+#include <stdio.h>
+#endif
+
+/*----------------------------------------------------------------------*
+ * bump allocation inside the model arena
+ *----------------------------------------------------------------------*/
+static void *s_arena_take(tt_seq_model_t *m, size_t bytes) {
+    size_t need = TT_SEQ_PAD(bytes);
+    if (m->arena_used + need > m->arena_size) return NULL;
+    void *p = m->arena + m->arena_used;
+    m->arena_used += need;
+    return p;
+}
+
+static size_t s_max_out(const tt_layer_desc_t *descs, size_t n) {
+    size_t mo = 0;
+    for (size_t l = 0; l < n; ++l)
+        if (descs[l].out > mo) mo = descs[l].out;
+    return mo;
+}
+
+/* a Conv1D geometry that matrix_conv1d_init accepts and that spans in and out */
+static int s_conv_valid(const tt_layer_desc_t *d) {
+    const matrix_conv1d_t *c = &d->conv;
+    matrix_conv1d_t chk;
+    if (matrix_conv1d_init(&chk, c->c_in, c->c_out, c->k, c->stride, c->dil, c->pad, c->l_in) < 0) return 0;
+    if (chk.l_out != c->l_out) return 0;
+    return MATRIX_CONV1D_IN_LEN(c) == d->in && MATRIX_CONV1D_OUT_LEN(c) == d->out;
+}
+
+static int s_descs_valid(const tt_layer_desc_t *descs, size_t n) {
+    if (!descs || !n || n > TT_SEQ_MAX_LAYERS) return 0;
+    for (size_t l = 0; l < n; ++l) {
+        const tt_layer_desc_t *d = &descs[l];
+        if (!d->in || !d->out || !d->ops) return 0;
+        if (d->type == TT_LAYER_DENSE) {
+            if (d->ops->w_conv) return 0;
+        } else if (d->type == TT_LAYER_CONV1D) {
+            if (!d->ops->w_conv || !s_conv_valid(d)) return 0;
+        } else {
+            return 0;
+        }
+        if ((unsigned)d->act >= TT_ACT_COUNT) return 0;
+        if (l && descs[l - 1].out != d->in) return 0;
+    }
+    return 1;
+}
+
+/* weights (and gradient) elements of a layer, pads of the tiles included */
+static size_t s_w_len(const tt_layer_desc_t *d) {
+    if (d->type == TT_LAYER_CONV1D) return MATRIX_CONV1D_W_LEN(&d->conv);
+    return d->ops->w_tiled ? MATRIX_TILE_LEN(d->out, d->in) : (size_t)d->in * d->out;
+}
+
+/*----------------------------------------------------------------------*
+ * Scratch buffers and their live steps, see tt_seq_model.h:
+ *   [0] acc, [1] err, [2 + 2l] G of layer l, [3 + 2l] E of layer l
+ *----------------------------------------------------------------------*/
+#define S_BUF_ACC       (0)
+#define S_BUF_ERR       (1)
+#define S_BUF_G(l)      (2 + 2 * (l))
+#define S_BUF_E(l)      (3 + 2 * (l))
+#define S_N_BUFS(n)     (2 + 2 * (n))
+
+static size_t s_plan_scratch(const tt_layer_desc_t *descs, size_t n, tt_mem_buf_t *bufs) {
+    bufs[S_BUF_ACC] = (tt_mem_buf_t){ s_max_out(descs, n) * sizeof(int32_t), 0, 0, 0 };
+    bufs[S_BUF_ERR] = (tt_mem_buf_t){ descs[n - 1].out, 1, 1, 0 };
+    for (size_t l = 0; l < n; ++l) {
+        uint16_t t = (uint16_t)(1 + (n - 1 - l));
+        /* E of layer l is read by the train step of layer l - 1 */
+        uint16_t e_last = l ? (uint16_t)(t + 1) : t;
+        bufs[S_BUF_G(l)] = (tt_mem_buf_t){ s_w_len(&descs[l]), t, t, 0 };
+        bufs[S_BUF_E(l)] = (tt_mem_buf_t){ descs[l].in, t, e_last, 0 };
+    }
+    return tt_mem_plan(bufs, S_N_BUFS(n), TT_SEQ_ALIGN);
+}
+
+/* persistent bytes of one layer, without the weights when they are external */
+static size_t s_layer_bytes(const tt_layer_desc_t *d, int ext_w) {
+    if (d->type == TT_LAYER_CONV1D) {
+        const matrix_conv1d_t *c = &d->conv;
+        size_t bytes = TT_SEQ_CONV1D_BYTES(c->c_in, c->c_out, c->k, c->l_in, c->l_out);
+        return ext_w ? bytes - TT_SEQ_PAD(s_w_len(d)) : bytes;
+    }
+    if (d->ops->w_bits == 4)
+        return ext_w ? TT_SEQ_PAD(d->out) : TT_SEQ_DENSE_I4_BYTES(d->in, d->out);
+    /* external row-major weights are repacked into the arena */
+    if (d->ops->w_tiled)
+        return TT_SEQ_DENSE_TILED_BYTES(d->in, d->out);
+    size_t bytes = d->ops->w_sparse ? TT_SEQ_DENSE_SPARSE_BYTES(d->in, d->out)
+                                    : TT_SEQ_DENSE_BYTES(d->in, d->out);
+    return ext_w ? bytes - TT_SEQ_PAD((size_t)d->in * d->out) : bytes;
+}
+
+static size_t s_persist_bytes(const tt_layer_desc_t *descs, size_t n, int ext_w) {
+    size_t bytes = TT_SEQ_IO_BYTES(descs[0].in);
+    for (size_t l = 0; l < n; ++l)
+        bytes += s_layer_bytes(&descs[l], ext_w);
+    return bytes;
+}
+
+static size_t s_arena_size(const tt_layer_desc_t *descs, size_t n, int ext_w) {
+    if (!s_descs_valid(descs, n)) return 0;
+    tt_mem_buf_t bufs[S_N_BUFS(TT_SEQ_MAX_LAYERS)];
+    size_t bytes = s_persist_bytes(descs, n, ext_w) + s_plan_scratch(descs, n, bufs);
+    /* slack for aligning the arena base */
+    return bytes + TT_SEQ_ALIGN;
+}
+
+/*----------------------------------------------------------------------*
+ * Arena bytes needed by a list of layer descriptors (0 if invalid).
+ *----------------------------------------------------------------------*/
+size_t tt_seq_model_arena_size(const tt_layer_desc_t *descs, size_t n) {
+    return s_arena_size(descs, n, 0);
+}
+
+size_t tt_seq_model_arena_size_weights(const tt_layer_desc_t *descs, size_t n) {
+    return s_arena_size(descs, n, 1);
+}
+
+/*----------------------------------------------------------------------*
+ * Plan all buffers of the model inside the arena; weights[l], if given,
+ * is used in place as the W storage of layer l.
+ *----------------------------------------------------------------------*/
+static int s_init(tt_seq_model_t *m, tt_layer_t *layers,
+                  const tt_layer_desc_t *descs, size_t n, void *const *weights,
+                  void *arena, size_t arena_size) {
+    if (!m || !layers || !arena) return -1;
+    if (arena_size < s_arena_size(descs, n, weights != NULL) || !s_descs_valid(descs, n)) return -1;
+
+    memset(m, 0, sizeof(*m));
+    m->layers   = layers;
+    m->n_layers = n;
+
+    /* align the arena base for the SIMD kernels */
+    uintptr_t base = ((uintptr_t)arena + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1);
+    m->arena      = (uint8_t *)base;
+    m->arena_size = arena_size - (size_t)(base - (uintptr_t)arena);
+    memset(m->arena, 0, m->arena_size);
+
+    /* persistent buffers: bump allocated */
+    size_t in  = descs[0].in;
+    tt_tensor_init(&m->input, s_arena_take(m, in), in);
+    for (size_t l = 0; l < n; ++l) {
+        tt_layer_t *L = &layers[l];
+        size_t lin  = descs[l].in;
+        size_t lout = descs[l].out;
+        L->desc   = descs[l];
+        L->w_bits   = descs[l].ops->w_bits == 4 ? 4 : 8;
+        L->w_sparse = L->w_bits == 8 && descs[l].ops->w_sparse;
+        L->w_tiled  = L->w_bits == 8 && descs[l].ops->w_tiled && descs[l].type == TT_LAYER_DENSE;
+        if (weights && !weights[l]) return -1;
+        if (descs[l].type == TT_LAYER_CONV1D) {
+            const matrix_conv1d_t *c = &descs[l].conv;
+            size_t wlen = s_w_len(&descs[l]);
+            int32_t *acc = s_arena_take(m, TT_CONV1D_ACC_LEN(c->c_in, c->c_out, c->k, c->l_in) * sizeof(int32_t));
+            tt_tensor_init(&L->W, weights ? weights[l] : s_arena_take(m, wlen), wlen);
+            if (tt_conv1d_weights_init(&L->W, &L->cv, c, acc) < 0) return -1;
+        } else if (L->w_bits == 4) {
+            /* W->data holds the nibbles; external ones come without a shadow (inference only) */
+            int8_t  *shadow = weights ? NULL : s_arena_take(m, lin * lout);
+            uint8_t *packed = weights ? weights[l] : s_arena_take(m, TT_I4_BYTES(lout, lin));
+            tt_tensor_init(&L->W, NULL, 0);
+            if (tt_i4_weights_init(&L->W, &L->i4, packed, shadow, lout, lin) < 0) return -1;
+        } else if (L->w_tiled) {
+            /* the one repack of external weights, training then runs on the tiles */
+            size_t wlen = MATRIX_TILE_LEN(lout, lin);
+            int8_t *tiles = s_arena_take(m, wlen);
+            tt_tensor_init(&L->W, tiles, wlen);
+            if (tt_tiled_weights_init(&L->W, &L->tile, tiles, lout, lin) < 0) return -1;
+            if (weights) matrix_tile_pack(&L->tile, weights[l], L->W.data);
+        } else {
+            tt_tensor_init(&L->W, weights ? weights[l] : s_arena_take(m, lin * lout), lin * lout);
+        }
+        if (L->w_sparse) {
+            if (tt_sparse_weights_init(&L->W, &L->sp, s_arena_take(m, MATRIX_SP_BYTES(lout, lin)),
+                                       lout, lin) < 0) return -1;
+        } else if (L->w_bits == 8 && descs[l].type == TT_LAYER_DENSE && !L->w_tiled) {
+            /* external weights are final: plan them now */
+            if (tt_dense_weights_init(&L->W, &L->acc16, lin) < 0) return -1;
+            if (weights) tt_dense_weights_sync(&L->W);
+        }
+        tt_tensor_init(&L->A, s_arena_take(m, lout), lout);
+    }
+    m->persist_bytes = m->arena_used;
+
+    /* scratch buffers: placed by liveness after the persistent ones */
+    tt_mem_buf_t bufs[S_N_BUFS(TT_SEQ_MAX_LAYERS)];
+    m->scratch_bytes = s_plan_scratch(descs, n, bufs);
+    int8_t *scratch = s_arena_take(m, m->scratch_bytes);
+    if (!scratch) return -1;
+
+    m->acc_len = s_max_out(descs, n);
+    m->acc     = (int32_t *)(scratch + bufs[S_BUF_ACC].offset);
+    tt_tensor_init(&m->err, scratch + bufs[S_BUF_ERR].offset, descs[n - 1].out);
+    for (size_t l = 0; l < n; ++l) {
+        tt_layer_t *L = &layers[l];
+        tt_tensor_init(&L->G, scratch + bufs[S_BUF_G(l)].offset, bufs[S_BUF_G(l)].size);
+        tt_tensor_init(&L->E, scratch + bufs[S_BUF_E(l)].offset, bufs[S_BUF_E(l)].size);
+    }
+
+#if TT_BIG_MACHINE_DEBUG_ENABLE
+    printf("tt_seq_model: %zu layers, persistent %zu B, scratch peak %zu B, arena %zu B\n",
+           n, m->persist_bytes, m->scratch_bytes, m->arena_used);
+#endif
+    return 0;
+}
+
+int tt_seq_model_init(tt_seq_model_t *m, tt_layer_t *layers,
+                      const tt_layer_desc_t *descs, size_t n,
+                      void *arena, size_t arena_size) {
+    return s_init(m, layers, descs, n, NULL, arena, arena_size);
+}
+
+int tt_seq_model_init_weights(tt_seq_model_t *m, tt_layer_t *layers,
+                              const tt_layer_desc_t *descs, size_t n, void *const *weights,
+                              void *arena, size_t arena_size) {
+    if (!weights) return -1;
+    return s_init(m, layers, descs, n, weights, arena, arena_size);
+}
+
+/* derived weight state after a write: int4 nibbles, sparse index, int16 plan */
+static void s_weights_sync(tt_layer_t *L) {
+    if (L->w_bits == 4)             tt_i4_weights_sync(&L->W);
+    else if (L->w_sparse)           tt_sparse_weights_sync(&L->W);
+    else if (L->W.ext == &L->acc16) tt_dense_weights_sync(&L->W);
+}
+
+/*----------------------------------------------------------------------*
+ * Uniform random weights, same generator as the motor model.
+ *----------------------------------------------------------------------*/
+void tt_seq_model_randomize(tt_seq_model_t *m, uint32_t seed, int8_t lo, int8_t hi) {
+    if (!m) return;
+    uint32_t rng;
+    prng_init(&rng, seed);
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        int8_t *w = L->w_bits == 4 ? L->i4.shadow : L->W.data;
+        if (!w) continue;   /* int4 weights without a shadow */
+        if (L->w_tiled) {
+            /* row-major draw order, so a tiled layer gets the weights of the row-major one */
+            for (size_t r = 0; r < L->tile.rows; ++r)
+                for (size_t c = 0; c < L->tile.cols; ++c)
+                    w[matrix_tile_idx(&L->tile, r, c)] = prng_rand_range(&rng, lo, hi);
+        } else {
+            for (size_t i = 0; i < L->W.len; ++i)
+                w[i] = prng_rand_range(&rng, lo, hi);
+        }
+        s_weights_sync(L);
+    }
+    return;
+}
+
+void tt_seq_model_sync(tt_seq_model_t *m) {
+    if (!m) return;
+    for (size_t l = 0; l < m->n_layers; ++l)
+        s_weights_sync(&m->layers[l]);
+    return;
+}
+
+/*----------------------------------------------------------------------*
+ * Forward pass loops over each layer, feeding activations to the next.
+ *----------------------------------------------------------------------*/
+const tensor_t *tt_seq_model_forward(tt_seq_model_t *m, const int8_t *in_data) {
+    if (!m || !in_data) return NULL;
+    memcpy(m->input.data, in_data, m->input.len);
+
+    const tensor_t *x = &m->input;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        L->desc.ops->dense_forward(&L->W, x, &L->A, m->acc, L->A.len, L->desc.act);
+        x = &L->A;
+    }
+    return x;
+}
+
+/*----------------------------------------------------------------------*
+ * Backward pass: train every layer from the last one, each producing the
+ * error of its input for the layer below.
+ *----------------------------------------------------------------------*/
+void tt_seq_model_backward(tt_seq_model_t *m) {
+    if (!m) return;
+    const tensor_t *err_next = &m->err;
+    for (size_t l = m->n_layers; l-- > 0; ) {
+        tt_layer_t *L = &m->layers[l];
+        const tensor_t *x = l ? &m->layers[l - 1].A : &m->input;
+        L->desc.ops->dense_train(&L->W, x, err_next, &L->E, &L->G);
+        if (L->W.ext == &L->acc16) tt_dense_weights_sync(&L->W);
+        err_next = &L->E;
+    }
+    return;
+}
+
+/*----------------------------------------------------------------------*
+ * One training step: forward, output error, backward. Returns the SSE.
+ *----------------------------------------------------------------------*/
+uint32_t tt_seq_model_train_step(tt_seq_model_t *m, const int8_t *in_data, const int8_t *target) {
+    if (!m || !in_data || !target) return 0;
+    const tensor_t *y = tt_seq_model_forward(m, in_data);
+
+    uint32_t sse = 0;
+    for (size_t i = 0; i < m->err.len; ++i) {
+        int16_t d = y->data[i] - (int16_t)target[i];
+        m->err.data[i] = clip_int8(d);
+        sse += (uint32_t)(d * d);
+    }
+    tt_seq_model_backward(m);
+    return sse;
+}
+
+/*----------------------------------------------------------------------*
+ * Minibatch: int32 gradient sums over the batch, one pack and one update
+ * per layer at the end. The sums are the only state kept across samples;
+ * G is free again once the batch is through, so it takes the packed
+ * gradient, and each layer's sums are the update's scratch once packed.
+ *----------------------------------------------------------------------*/
+size_t tt_seq_model_batch_bytes(const tt_seq_model_t *m) {
+    if (!m || !m->n_layers) return 0;
+    size_t bytes = TT_SEQ_ALIGN;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        const TensorBackend_t *ops = L->desc.ops;
+        if (!ops->dense_grad || !ops->dense_grad_pack || !ops->dense_update) return 0;
+        bytes += TT_SEQ_PAD(L->G.len * sizeof(int32_t));
+    }
+    return bytes;
+}
+
+uint32_t tt_seq_model_train_batch(tt_seq_model_t *m, const int8_t *in, const int8_t *target, size_t n,
+                                  void *buf, size_t buf_size) {
+    if (!m || !in || !target || !n || !buf) return 0;
+    size_t need = tt_seq_model_batch_bytes(m);
+    if (!need || buf_size < need) return 0;
+
+    int32_t *gacc[TT_SEQ_MAX_LAYERS];
+    uint8_t *cur = (uint8_t *)(((uintptr_t)buf + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        size_t bytes = m->layers[l].G.len * sizeof(int32_t);
+        gacc[l] = (int32_t *)cur;
+        memset(gacc[l], 0, bytes);
+        cur += TT_SEQ_PAD(bytes);
+    }
+
+    size_t n_in = m->input.len, n_out = m->err.len;
+    uint32_t sse = 0;
+    for (size_t s = 0; s < n; ++s) {
+        const tensor_t *y = tt_seq_model_forward(m, in + s * n_in);
+
+        const int8_t *tg = target + s * n_out;
+        for (size_t i = 0; i < n_out; ++i) {
+            int16_t d = y->data[i] - (int16_t)tg[i];
+            m->err.data[i] = clip_int8(d);
+            sse += (uint32_t)(d * d);
+        }
+
+        /* gradient sums and errors, last layer first; W is only read */
+        const tensor_t *err_next = &m->err;
+        for (size_t l = m->n_layers; l-- > 0; ) {
+            tt_layer_t *L = &m->layers[l];
+            const tensor_t *x = l ? &m->layers[l - 1].A : &m->input;
+            L->desc.ops->dense_grad(&L->W, x, err_next, &L->E, gacc[l]);
+            err_next = &L->E;
+        }
+    }
+
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        L->desc.ops->dense_grad_pack(&L->W, gacc[l], &L->G);
+        L->desc.ops->dense_update(&L->W, &L->G, 1, n, gacc[l]);
+        if (L->W.ext == &L->acc16) tt_dense_weights_sync(&L->W);
+    }
+    return sse;
+}
+
+/*----------------------------------------------------------------------*
+ * Joint magnitude pruning of every block-sparse layer.
+ *----------------------------------------------------------------------*/
+size_t tt_seq_model_prune(tt_seq_model_t *m, uint8_t pct) {
+    if (!m) return 0;
+    tensor_t *W[TT_SEQ_MAX_LAYERS];
+    size_t n = 0;
+    for (size_t l = 0; l < m->n_layers; ++l)
+        if (m->layers[l].w_sparse) W[n++] = &m->layers[l].W;
+    return n ? tt_sparse_prune(W, n, pct) : 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Register every layer with the profile and swap in the wrapper backend.
+ *----------------------------------------------------------------------*/
+int tt_seq_model_profile(tt_seq_model_t *m, tt_profile_t *p) {
+    if (!m || !p || p->max_layers - p->n_layers < m->n_layers) return -1;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        int idx = tt_profile_add_layer(p, &L->W, L->desc.ops);
+        if (idx < 0) return -1;
+        L->desc.ops = p->layers[idx].ops;
+    }
+    return 0;
+}
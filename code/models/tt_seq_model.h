@@ -0,0 +1,184 @@
+/*============================================================
+ * File: tt_seq_model.h
+ * Generic sequential model runtime over pluggable backends
+ *============================================================*/
+#ifndef TT_SEQ_MODEL_H
+#define TT_SEQ_MODEL_H
+
+#include "tt_tensor_backend.h"
+#include "activations.h"
+#include "tt_types.h"
+#include "tt_profile.h"
+#include "tt_dense.h"
+#include "tt_dense_i4.h"
+#include "tt_dense_sparse.h"
+#include "tt_conv1d.h"
+#include <stdint.h>
+
+/*----------------------------------------------------------------------*
+ * A model is a list of layer descriptors. tt_seq_model_init places every
+ * buffer (weights, activations, gradients, errors, accumulators) inside
+ * one caller-provided arena, so nothing is allocated on the heap or on
+ * the stack per call. Size the arena with tt_seq_model_arena_size, or at
+ * compile time with the TT_SEQ_* macros below.
+ *
+ * Weights, activations and the input persist. The scratch buffers are
+ * placed by the liveness planner (tt_mem_plan.h) over the steps
+ *   0            forward (acc)
+ *   1 + n-1-l    train of layer l (G of l, E of l, error from above)
+ * so e.g. every G shares one slot and the errors ping-pong. m->err
+ * shares bytes with acc: write it after the forward pass.
+ *----------------------------------------------------------------------*/
+
+typedef enum {
+    TT_LAYER_DENSE = 0,
+    TT_LAYER_CONV1D,
+} tt_layer_type_t;
+
+typedef struct {
+    tt_layer_type_t        type;
+    uint16_t               in;
+    uint16_t               out;
+    tt_act_t               act;   /* fused into the backend forward epilogue */
+    const TensorBackend_t *ops;   /* TT vs nested‑TT vs 4‑bit etc. */
+    matrix_conv1d_t        conv;  /* TT_LAYER_CONV1D: matrix_conv1d_init geometry,
+                                     in = c_in x l_in, out = c_out x l_out, ops->w_conv */
+} tt_layer_desc_t;
+
+typedef struct {
+    tt_layer_desc_t desc;
+    tensor_t        W;      /* weights [out x in], [c_out x c_in x k] for Conv1D */
+    tensor_t        A;      /* output activations [out] */
+    tensor_t        G;      /* gradient scratch [W.len] */
+    tensor_t        E;      /* error wrt this layer's input [in] */
+    uint8_t         w_bits; /* weight storage of desc.ops at init (8 or 4) */
+    uint8_t         w_sparse; /* block-sparse weights (desc.ops->w_sparse at init) */
+    uint8_t         w_tiled;  /* W.data in 16 x 4 tiles (desc.ops->w_tiled at init) */
+    tt_i4_ext_t     i4;     /* W->ext of int4 layers: shadow weights, pack shift */
+    matrix_sp_t     sp;     /* W->ext of block-sparse layers: kept tiles and index */
+    tt_conv1d_ext_t cv;     /* W->ext of Conv1D layers: geometry, train scratch */
+    matrix_tile_t   tile;   /* W->ext of tiled layers: geometry */
+    matrix_acc_t    acc16;  /* W->ext of int8 dense layers: int16 accumulation plan */
+} tt_layer_t;
+
+typedef struct {
+    tt_layer_t *layers;
+    size_t      n_layers;
+
+    tensor_t    input;      /* [layers[0].in] */
+    tensor_t    err;        /* error at the output [layers[n-1].out], planned */
+    int32_t    *acc;        /* dot-product accumulators [max out], planned */
+    size_t      acc_len;
+
+    uint8_t    *arena;
+    size_t      arena_size;
+    size_t      arena_used;     /* persistent bytes + scratch peak */
+    size_t      persist_bytes;  /* W, A and input */
+    size_t      scratch_bytes;  /* peak of the planned scratch */
+} tt_seq_model_t;
+
+/* arena layout: every buffer starts on a TT_SEQ_ALIGN boundary */
+#define TT_SEQ_ALIGN            (64)
+#define TT_SEQ_PAD(n)           (((size_t)(n) + TT_SEQ_ALIGN - 1) & ~(size_t)(TT_SEQ_ALIGN - 1))
+#define TT_SEQ_MAX_LAYERS       (64)
+/* persistent bytes of one dense layer: W, A */
+#define TT_SEQ_DENSE_BYTES(IN, OUT) \
+    (TT_SEQ_PAD((IN) * (OUT)) + TT_SEQ_PAD(OUT))
+/* persistent bytes of one int4 dense layer: packed W, int8 shadow W, A */
+#define TT_SEQ_DENSE_I4_BYTES(IN, OUT) \
+    (TT_SEQ_PAD(TT_I4_BYTES(OUT, IN)) + TT_SEQ_DENSE_BYTES(IN, OUT))
+/* persistent bytes of one block-sparse dense layer: W, A, tiles and index */
+#define TT_SEQ_DENSE_SPARSE_BYTES(IN, OUT) \
+    (TT_SEQ_DENSE_BYTES(IN, OUT) + TT_SEQ_PAD(MATRIX_SP_BYTES(OUT, IN)))
+/* persistent bytes of one tiled dense layer: padded tiles, A (also with external weights) */
+#define TT_SEQ_DENSE_TILED_BYTES(IN, OUT) \
+    (TT_SEQ_PAD(MATRIX_TILE_LEN(OUT, IN)) + TT_SEQ_PAD(OUT))
+#define TT_SEQ_MAX(a, b)        ((a) > (b) ? (a) : (b))
+/* persistent bytes of one dense layer on any of the backends above */
+#define TT_SEQ_DENSE_ANY_BYTES(IN, OUT)                                           \
+    TT_SEQ_MAX(TT_SEQ_MAX(TT_SEQ_DENSE_I4_BYTES(IN, OUT), TT_SEQ_DENSE_SPARSE_BYTES(IN, OUT)), \
+               TT_SEQ_DENSE_TILED_BYTES(IN, OUT))
+/* persistent bytes of one Conv1D layer: W, A, int32 train scratch */
+#define TT_SEQ_CONV1D_BYTES(C_IN, C_OUT, K, L_IN, L_OUT)                          \
+    (TT_SEQ_PAD((size_t)(C_OUT) * (C_IN) * (K)) + TT_SEQ_PAD((size_t)(C_OUT) * (L_OUT)) + \
+     TT_SEQ_PAD(TT_CONV1D_ACC_LEN(C_IN, C_OUT, K, L_IN) * sizeof(int32_t)))
+/* persistent bytes of the model input */
+#define TT_SEQ_IO_BYTES(IN) \
+    (TT_SEQ_PAD(IN))
+/*
+ * bound on the planned scratch peak for layers of at most MAX_W weights
+ * (MATRIX_TILE_LEN of the tiled layers) and
+ * MAX_WIDTH inputs/outputs: a train step overlaps at most two G and three
+ * error buffers, the forward step only the accumulators
+ */
+#define TT_SEQ_SCRATCH_BYTES(MAX_W, MAX_WIDTH)                                   \
+    ((2 * TT_SEQ_PAD(MAX_W) + 3 * TT_SEQ_PAD(MAX_WIDTH)) >                       \
+             TT_SEQ_PAD((MAX_WIDTH) * sizeof(int32_t))                           \
+         ? (2 * TT_SEQ_PAD(MAX_W) + 3 * TT_SEQ_PAD(MAX_WIDTH))                   \
+         : TT_SEQ_PAD((MAX_WIDTH) * sizeof(int32_t)))
+
+/* exact arena bytes (persistent + planned scratch peak + base alignment), 0 if invalid */
+size_t tt_seq_model_arena_size(const tt_layer_desc_t *descs, size_t n);
+
+/* returns 0 on success, -1 on bad descriptors or a too small arena */
+int  tt_seq_model_init(tt_seq_model_t *m, tt_layer_t *layers,
+                       const tt_layer_desc_t *descs, size_t n,
+                       void *arena, size_t arena_size);
+
+/*
+ * same, with the weights of layer l in caller storage weights[l] (e.g. a
+ * file mapping, see tt_model_file.h) used in place: rows x cols int8, or
+ * TT_I4_BYTES packed nibbles for int4 layers, which are then inference only
+ * (no shadow, set layers[l].i4.k). Tiled layers repack the row-major int8
+ * weights into their arena tiles once, here. The arena holds everything else.
+ */
+size_t tt_seq_model_arena_size_weights(const tt_layer_desc_t *descs, size_t n);
+int  tt_seq_model_init_weights(tt_seq_model_t *m, tt_layer_t *layers,
+                               const tt_layer_desc_t *descs, size_t n, void *const *weights,
+                               void *arena, size_t arena_size);
+
+/* uniform random weights in [lo, hi] */
+void tt_seq_model_randomize(tt_seq_model_t *m, uint32_t seed, int8_t lo, int8_t hi);
+
+/*
+ * after weights were written directly (not through randomize, a backward
+ * pass or a trainer): repacks int4 shadows, re-indexes block-sparse tiles
+ * and re-plans the accumulation width of the int8 dense layers. Layers
+ * whose weights are still unplanned run the int32 kernels. Tiled weights
+ * have no derived state: write them at matrix_tile_idx or with
+ * matrix_tile_pack.
+ */
+void tt_seq_model_sync(tt_seq_model_t *m);
+
+/* forward pass, returns the output activations */
+const tensor_t *tt_seq_model_forward(tt_seq_model_t *m, const int8_t *in_data);
+
+/* backward + update of every layer from the error in m->err */
+void tt_seq_model_backward(tt_seq_model_t *m);
+
+/* forward, err = output - target, backward; returns the SSE */
+uint32_t tt_seq_model_train_step(tt_seq_model_t *m, const int8_t *in_data, const int8_t *target);
+
+/*
+ * minibatch training on the calling thread: dense_grad sums the gradient
+ * of every sample in int32, then each layer is packed to int8 once, into
+ * its G scratch, and updated once with the mean (dense_grad_pack,
+ * dense_update), so the max scans, alignment, margin adjustment and renorm
+ * run once per batch instead of once per sample. The sums live in caller
+ * memory of tt_seq_model_batch_bytes; tt_dp_trainer.h spreads the same
+ * steps over a pool. Every layer needs dense_grad (no Conv1D).
+ */
+/* bytes of the int32 sums (plus base alignment), 0 if a layer has no dense_grad */
+size_t   tt_seq_model_batch_bytes(const tt_seq_model_t *m);
+/* in: n rows of layers[0].in, target: n rows of layers[n-1].out; returns the batch SSE */
+uint32_t tt_seq_model_train_batch(tt_seq_model_t *m, const int8_t *in, const int8_t *target, size_t n,
+                                  void *buf, size_t buf_size);
+
+/* magnitude pruning of the block-sparse layers to pct % zero blocks, see
+   tt_sparse_prune; returns the zero block count */
+size_t tt_seq_model_prune(tt_seq_model_t *m, uint8_t pct);
+
+/* route every layer through the tt_profile_wrap table of its backend (layer l = profile layer l); 0 or -1 */
+int  tt_seq_model_profile(tt_seq_model_t *m, tt_profile_t *p);
+
+#endif // TT_SEQ_MODEL_H
@@ -0,0 +1,213 @@
+#include "tt_stream.h"
+#include "tt_dense.h"
+#include "matrix_conv1d.h"
+#include <string.h>
+
+/*----------------------------------------------------------------------*
+ * Mirrored ring: every value is written at head and head + len.
+ *----------------------------------------------------------------------*/
+static inline int8_t *s_row(const tt_stream_ring_t *r, size_t row) {
+    return r->buf + row * 2 * (size_t)r->len;
+}
+
+static inline void s_ring_set(tt_stream_ring_t *r, size_t row, int8_t v) {
+    int8_t *p = s_row(r, row);
+    p[r->head] = v;
+    p[r->head + r->len] = v;
+}
+
+static inline void s_ring_advance(tt_stream_ring_t *r) {
+    if (++r->head == r->len) r->head = 0;
+}
+
+/* whole ring from rows x len channel-major values, oldest first */
+static void s_ring_load(tt_stream_ring_t *r, const int8_t *src) {
+    r->head = 0;
+    for (size_t row = 0; row < r->rows; ++row) {
+        memcpy(s_row(r, row), src + row * r->len, r->len);
+        memcpy(s_row(r, row) + r->len, src + row * r->len, r->len);
+    }
+}
+
+/*
+ * the window of r as a tensor: a view of the ring for one row when
+ * view_ok, else gathered into dst (rows x len channel-major)
+ */
+static const tensor_t *s_window(tt_stream_t *s, const tt_stream_ring_t *r, tensor_t *dst, int view_ok) {
+    if (view_ok && r->rows == 1) {
+        s->win.data = r->buf + r->head;
+        s->win.len  = r->len;
+        s->win.s    = r->s;
+        return &s->win;
+    }
+    for (size_t row = 0; row < r->rows; ++row)
+        memcpy(dst->data + row * r->len, s_row(r, row) + r->head, r->len);
+    dst->s = r->s;
+    return dst;
+}
+
+/*----------------------------------------------------------------------*
+ * Layer analysis: the leading Conv1D layers that slide with the input
+ * (stride 1, no padding, channel rows chained) and the ring shapes.
+ *----------------------------------------------------------------------*/
+static size_t s_streamed(const tt_seq_model_t *m) {
+    size_t n = 0;
+    while (n < m->n_layers && n < TT_STREAM_MAX_CONV) {
+        const tt_layer_desc_t *d = &m->layers[n].desc;
+        if (d->type != TT_LAYER_CONV1D || d->conv.stride != 1 || d->conv.pad) break;
+        if (n) {
+            const matrix_conv1d_t *p = &m->layers[n - 1].desc.conv;
+            if (d->conv.c_in != p->c_out || d->conv.l_in != p->l_out) break;
+        }
+        ++n;
+    }
+    return n;
+}
+
+/* rows and len of ring r, 0 if channels does not fit the first layer */
+static int s_ring_dims(const tt_seq_model_t *m, size_t n_conv, size_t channels, size_t r,
+                       size_t *rows, size_t *len) {
+    if (r) {
+        const matrix_conv1d_t *g = &m->layers[r - 1].desc.conv;
+        *rows = g->c_out;
+        *len  = g->l_out;
+        return 1;
+    }
+    if (n_conv) {
+        const matrix_conv1d_t *g = &m->layers[0].desc.conv;
+        if (channels != g->c_in) return 0;
+        *rows = g->c_in;
+        *len  = g->l_in;
+        return 1;
+    }
+    size_t in = m->layers[0].desc.in;
+    if (!channels || in % channels || in / channels > UINT16_MAX) return 0;
+    *rows = channels;
+    *len  = in / channels;
+    return 1;
+}
+
+size_t tt_stream_mem_size(const tt_seq_model_t *m, size_t channels) {
+    if (!m || !m->layers || !m->n_layers) return 0;
+    size_t n_conv = s_streamed(m), bytes = 0;
+    for (size_t r = 0; r <= n_conv; ++r) {
+        size_t rows, len;
+        if (!s_ring_dims(m, n_conv, channels, r, &rows, &len)) return 0;
+        bytes += TT_SEQ_PAD(rows * 2 * len);
+    }
+    /* slack for aligning the base */
+    return bytes + TT_SEQ_ALIGN;
+}
+
+int tt_stream_init(tt_stream_t *s, tt_seq_model_t *m, size_t channels, size_t hop,
+                   void *mem, size_t mem_size) {
+    size_t need = tt_stream_mem_size(m, channels);
+    if (!s || !mem || !hop || !need || mem_size < need) return -1;
+
+    memset(s, 0, sizeof(*s));
+    s->m      = m;
+    s->hop    = hop;
+    s->n_conv = s_streamed(m);
+
+    uint8_t *cur = (uint8_t *)(((uintptr_t)mem + TT_SEQ_ALIGN - 1) & ~(uintptr_t)(TT_SEQ_ALIGN - 1));
+    for (size_t r = 0; r <= s->n_conv; ++r) {
+        size_t rows = 0, len = 0;
+        s_ring_dims(m, s->n_conv, channels, r, &rows, &len);
+        s->ring[r].buf  = (int8_t *)cur;
+        s->ring[r].rows = (uint16_t)rows;
+        s->ring[r].len  = (uint16_t)len;
+        cur += TT_SEQ_PAD(rows * 2 * len);
+    }
+    for (size_t l = 0; l < s->n_conv; ++l)
+        tt_act_lut_init(&s->lut[l], m->layers[l].desc.act == TT_ACT_TANH ? TT_LUT_TANH : TT_LUT_SIGMOID);
+    return 0;
+}
+
+void tt_stream_reset(tt_stream_t *s) {
+    if (!s) return;
+    s->fill   = 0;
+    s->since  = 0;
+    s->primed = 0;
+    for (size_t r = 0; r <= s->n_conv; ++r) s->ring[r].head = 0;
+}
+
+/*----------------------------------------------------------------------*
+ * Layers after the streamed ones, on the window of the last ring.
+ *----------------------------------------------------------------------*/
+static const tensor_t *s_tail(tt_stream_t *s) {
+    tt_seq_model_t *m = s->m;
+    const size_t l0 = s->n_conv;
+    tensor_t *dst = l0 ? &m->layers[l0 - 1].A : &m->input;
+    /* the model output is always left in the last A */
+    const tensor_t *x = s_window(s, &s->ring[l0], dst, l0 < m->n_layers);
+    for (size_t l = l0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        L->desc.ops->dense_forward(&L->W, x, &L->A, m->acc, L->A.len, L->desc.act);
+        x = &L->A;
+    }
+    return x;
+}
+
+/*----------------------------------------------------------------------*
+ * Priming: every streamed layer over its whole window, as the backend
+ * forward does, keeping the shift, rescale and header it chose.
+ *----------------------------------------------------------------------*/
+const tensor_t *tt_stream_prime(tt_stream_t *s) {
+    if (!s || s->fill < s->ring[0].len) return NULL;
+    tt_seq_model_t *m = s->m;
+
+    s->ring[0].s = m->input.s;
+    const tensor_t *x = s->n_conv ? s_window(s, &s->ring[0], &m->input, 0) : NULL;
+    for (size_t l = 0; l < s->n_conv; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        matrix_conv1d_fwd(&L->cv.g, L->W.data, x->data, m->acc);
+        s->e[l] = tt_epilogue_act(L->desc.act, m->acc, L->A.data, L->A.len);
+        tt_dense_epilogue_scale(&L->W, x, s->e[l], &L->A.s);
+        /* the table of the frozen header serves every later column */
+        if (L->desc.act == TT_ACT_SIGMOID || L->desc.act == TT_ACT_TANH)
+            tt_act_lut_apply(&s->lut[l], &L->A, &L->A);
+        s_ring_load(&s->ring[l + 1], L->A.data);
+        s->ring[l + 1].s = L->A.s;
+        x = &L->A;
+    }
+    s->primed = 1;
+    s->since  = 0;
+    return s_tail(s);
+}
+
+/*----------------------------------------------------------------------*
+ * One sample per channel: into the input ring, then the newest column of
+ * every streamed layer, then the tail when an output is due.
+ *----------------------------------------------------------------------*/
+const tensor_t *tt_stream_push(tt_stream_t *s, const int8_t *sample) {
+    if (!s || !sample) return NULL;
+    tt_stream_ring_t *in = &s->ring[0];
+    for (size_t row = 0; row < in->rows; ++row) s_ring_set(in, row, sample[row]);
+    s_ring_advance(in);
+
+    if (!s->primed) {
+        if (++s->fill < in->len) return NULL;
+        return tt_stream_prime(s);
+    }
+
+    int32_t *acc = s->m->acc;
+    for (size_t l = 0; l < s->n_conv; ++l) {
+        const tt_layer_t *L = &s->m->layers[l];
+        const matrix_conv1d_t *g = &L->cv.g;
+        const tt_stream_ring_t *x = &s->ring[l];
+        tt_stream_ring_t *y = &s->ring[l + 1];
+        const int8_t *map = L->desc.act == TT_ACT_SIGMOID || L->desc.act == TT_ACT_TANH ? s->lut[l].map : NULL;
+
+        matrix_conv1d_col(g, L->W.data, x->buf + x->head, 2 * (size_t)x->len, g->l_out - 1, acc);
+        for (size_t co = 0; co < g->c_out; ++co) {
+            int8_t v;
+            tt_epilogue_fixed(L->desc.act, acc + co, &v, 1, s->e[l]);
+            s_ring_set(y, co, map ? map[(uint8_t)v] : v);
+        }
+        s_ring_advance(y);
+    }
+
+    if (++s->since < s->hop) return NULL;
+    s->since = 0;
+    return s_tail(s);
+}
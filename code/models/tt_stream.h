@@ -0,0 +1,96 @@
+/*============================================================
+ * File: tt_stream.h
+ * Streaming inference of a sequential model over a sliding window
+ *============================================================*/
+#ifndef TT_STREAM_H
+#define TT_STREAM_H
+
+#include "tt_seq_model.h"
+#include "tt_epilogue.h"
+#include "tt_act_lut.h"
+#include "tt_types.h"
+#include <stdint.h>
+
+/*----------------------------------------------------------------------*
+ * Sensor samples come in one at a time and the model looks at the last
+ * window of them. Instead of copying the window and running the whole
+ * network per sample, a stream keeps ring buffers:
+ *
+ *   ring 0      the input window, channels x (layers[0].in / channels)
+ *   ring l + 1  the output of streamed layer l, c_out x l_out
+ *
+ * A streamed layer is one of the leading Conv1D layers with stride 1 and
+ * no padding (dilation is fine). Every output column of such a layer only
+ * reads input columns, so when a sample comes in only the newest column
+ * of each streamed layer is new: c_out x c_in x k MACs per layer instead
+ * of the full window, a constant cost per sample. The remaining layers
+ * (dense, strided or padded Conv1D) run through their backend on the
+ * window of the last ring every hop samples.
+ *
+ * Rings are mirrored: row r holds its len values twice, at head and at
+ * head + len, so the window is always the len bytes from the head and is
+ * handed to the next layer without a copy (rows further apart by 2 len).
+ *
+ * The first full window primes the stream: every streamed layer runs over
+ * its whole window like tt_seq_model_forward (same output, bit for bit)
+ * and its shift, rescale and header are frozen. The new columns are then
+ * requantized with the frozen ones, so a later output equals the full
+ * forward pass with those headers held. Values that grow past the primed
+ * range saturate; call tt_stream_prime to requantize on the current
+ * window when the signal level changes.
+ *
+ * Models without a streamed layer (e.g. the dense motor AE) still skip the
+ * per-sample window copy when they have one input channel, the ring is
+ * handed to the first layer in place. The model must not be trained while
+ * a stream runs on it. The ring memory is caller provided, see
+ * tt_stream_mem_size.
+ *----------------------------------------------------------------------*/
+
+#define TT_STREAM_MAX_CONV  (8)
+
+typedef struct {
+    int8_t  *buf;       /* rows x 2 len, mirrored */
+    uint16_t rows;
+    uint16_t len;
+    uint16_t head;      /* oldest value of every row */
+    scale_t  s;         /* header of the values in the ring */
+} tt_stream_ring_t;
+
+typedef struct {
+    tt_seq_model_t  *m;
+    size_t           n_conv;    /* leading layers computed column by column */
+    size_t           hop;       /* pushes per output once primed */
+    size_t           fill;      /* input samples so far, up to ring[0].len */
+    size_t           since;     /* pushes since the last output */
+    uint8_t          primed;
+
+    tt_stream_ring_t ring[TT_STREAM_MAX_CONV + 1];
+    tt_epilogue_t    e[TT_STREAM_MAX_CONV];    /* frozen shift and rescale */
+    tt_act_lut_t     lut[TT_STREAM_MAX_CONV];  /* sigmoid / tanh of the frozen header */
+    tensor_t         win;       /* view of a single row window */
+} tt_stream_t;
+
+/* ring bytes for m fed with channels samples per push, 0 if the model cannot be streamed */
+size_t tt_stream_mem_size(const tt_seq_model_t *m, size_t channels);
+
+/*
+ * binds a stream to m (weights and input header set). channels must be
+ * c_in of a leading Conv1D layer or divide layers[0].in; hop >= 1.
+ * Returns 0 on success, -1 on bad arguments or a too small mem.
+ */
+int  tt_stream_init(tt_stream_t *s, tt_seq_model_t *m, size_t channels, size_t hop,
+                    void *mem, size_t mem_size);
+
+/*
+ * one sample per channel; returns the model output when one is due (the
+ * priming push, then every hop pushes) and NULL otherwise
+ */
+const tensor_t *tt_stream_push(tt_stream_t *s, const int8_t *sample);
+
+/* full pass on the current window, refreezes the headers; NULL before the first full window */
+const tensor_t *tt_stream_prime(tt_stream_t *s);
+
+/* drops the window, the next full one primes again */
+void tt_stream_reset(tt_stream_t *s);
+
+#endif // TT_STREAM_H
@@ -0,0 +1,267 @@
+/**
+ * @file tt_profile.c
+ * @brief per-layer profiling wrapper around any TensorBackend_t
+ * @license MIT
+ */
+#include "tt_profile.h"
+#include <string.h>
+
+tt_prof_layer_t *tt_prof_cur = NULL;
+
+/* the wrapper slots have no context argument: one active profile */
+static tt_profile_t *s_prof = NULL;
+
+/* wrapped backends and their wrapper tables, s_wrap[i] around s_inner[i] */
+static const TensorBackend_t *s_inner[TT_PROF_MAX_BACKENDS];
+static TensorBackend_t        s_wrap[TT_PROF_MAX_BACKENDS];
+static size_t                 s_n_wrap = 0;
+
+static const char *const s_kind_name[TT_PROF_N_KINDS] = {
+    "forward", "forward_batch", "train", "grad", "grad_pack", "update",
+};
+
+void tt_profile_init(tt_profile_t *p, tt_prof_layer_t *layers, size_t max_layers,
+                     tt_prof_event_t *ring, size_t ring_len) {
+    if (!p || !layers || !max_layers) return;
+    p->layers     = layers;
+    p->n_layers   = 0;
+    p->max_layers = max_layers;
+    p->ring       = ring;
+    p->ring_len   = ring ? ring_len : 0;
+    p->n_events   = 0;
+    p->hint       = 0;
+    memset(layers, 0, max_layers * sizeof(*layers));
+    s_prof = p;
+}
+
+int tt_profile_add_layer(tt_profile_t *p, const tensor_t *W, const TensorBackend_t *inner) {
+    if (!p || !W || !W->data || !inner) return -1;
+    if (p->n_layers >= p->max_layers) return -1;
+    const TensorBackend_t *ops = tt_profile_wrap(inner);
+    if (!ops) return -1;
+    tt_prof_layer_t *L = &p->layers[p->n_layers];
+    memset(L, 0, sizeof(*L));
+    L->key   = W->data;
+    L->inner = s_inner[ops - s_wrap];   /* the backend under a wrapper passed in */
+    L->ops   = ops;
+    return (int)p->n_layers++;
+}
+
+void tt_profile_reset(tt_profile_t *p) {
+    if (!p) return;
+    for (size_t l = 0; l < p->n_layers; ++l) {
+        tt_prof_layer_t *L = &p->layers[l];
+        const int8_t *key = L->key;
+        const TensorBackend_t *inner = L->inner, *ops = L->ops;
+        memset(L, 0, sizeof(*L));
+        L->key   = key;
+        L->inner = inner;
+        L->ops   = ops;
+    }
+    p->n_events = 0;
+}
+
+/*----------------------------------------------------------------------*
+ * call accounting
+ *----------------------------------------------------------------------*/
+/* a model calls its layers in order, forward and back: the last layer found
+ * and its neighbours are tried before the scan */
+static tt_prof_layer_t *s_find(const tensor_t *W, size_t *idx) {
+    if (!s_prof || !W || !s_prof->n_layers) return NULL;
+    size_t n = s_prof->n_layers, h = s_prof->hint < n ? s_prof->hint : 0;
+    const size_t near[3] = { h, h + 1 < n ? h + 1 : 0, h ? h - 1 : n - 1 };
+    for (int k = 0; k < 3; ++k) {
+        if (s_prof->layers[near[k]].key == W->data) {
+            *idx = s_prof->hint = near[k];
+            return &s_prof->layers[near[k]];
+        }
+    }
+    for (size_t l = 0; l < n; ++l) {
+        if (s_prof->layers[l].key == W->data) {
+            *idx = s_prof->hint = l;
+            return &s_prof->layers[l];
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    tt_prof_layer_t *L;
+    size_t           idx;
+    tt_prof_layer_t  before;
+    uint64_t         t0;
+} s_call_t;
+
+static tt_prof_layer_t *s_enter(s_call_t *c, const tensor_t *W) {
+    c->L = s_find(W, &c->idx);
+    if (!c->L) return NULL;
+    c->before   = *c->L;
+    tt_prof_cur = c->L;
+    c->t0       = tt_prof_now();
+    return c->L;
+}
+
+static void s_leave(s_call_t *c, tt_prof_kind_t kind, uint64_t bytes) {
+    uint64_t dt = tt_prof_now() - c->t0;
+    tt_prof_layer_t *L = c->L, *b = &c->before;
+    tt_prof_cur = NULL;
+    L->calls[kind]  += 1;
+    L->cycles[kind] += dt;
+    L->bytes[kind]  += bytes;
+
+    if (!s_prof->ring_len) {
+        s_prof->n_events++;
+        return;
+    }
+    tt_prof_event_t *e = &s_prof->ring[s_prof->n_events++ % s_prof->ring_len];
+    e->t_start  = c->t0;
+    e->cycles   = (uint32_t)(dt > UINT32_MAX ? UINT32_MAX : dt);
+    e->gemv     = (uint32_t)(L->cyc_gemv - b->cyc_gemv);
+    e->epilogue = (uint32_t)(L->cyc_epilogue - b->cyc_epilogue);
+    e->layer    = (uint16_t)c->idx;
+    e->kind     = (uint8_t)kind;
+    e->flags    = (uint8_t)((L->n_up     != b->n_up     ? TT_PROF_EV_UP     : 0) |
+                            (L->n_down   != b->n_down   ? TT_PROF_EV_DOWN   : 0) |
+                            (L->n_w_up   != b->n_w_up   ? TT_PROF_EV_W_UP   : 0) |
+                            (L->n_w_down != b->n_w_down ? TT_PROF_EV_W_DOWN : 0) |
+                            (L->n_rollup != b->n_rollup ? TT_PROF_EV_ROLLUP : 0));
+    e->bytes    = bytes;
+}
+
+/*----------------------------------------------------------------------*
+ * wrapper slots; bytes are the tensors read + written once each, the
+ * int32 accumulators written and read back once. Slot set i calls
+ * s_inner[i] and is only installed where that backend has the slot; a
+ * tensor no layer was registered for still runs, just not accounted.
+ *----------------------------------------------------------------------*/
+static void s_forward(size_t i, const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc,
+                      size_t acc_size, tt_act_t act) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_forward(W, X, Y, acc, acc_size, act);
+    if (on) s_leave(&c, TT_PROF_FORWARD, W->len + X->len + Y->len + 2 * acc_size * sizeof(int32_t));
+}
+
+static void s_forward_batch(size_t i, const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t n,
+                            int32_t *acc, size_t acc_size, tt_act_t act) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_forward_batch(W, X, Y, n, acc, acc_size, act);
+    if (on) s_leave(&c, TT_PROF_FORWARD_BATCH, W->len + X->len + Y->len + 2 * acc_size * sizeof(int32_t));
+}
+
+static void s_train(size_t i, tensor_t *W, const tensor_t *x, const tensor_t *err_next, tensor_t *err_prev,
+                    tensor_t *G) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_train(W, x, err_next, err_prev, G);
+    /* G written + read, W read + written + read by the backprop */
+    if (on) s_leave(&c, TT_PROF_TRAIN, 2 * G->len + 3 * W->len + x->len + err_next->len + err_prev->len);
+}
+
+static void s_grad(size_t i, const tensor_t *W, const tensor_t *x, const tensor_t *err_next,
+                   tensor_t *err_prev, int32_t *acc) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_grad(W, x, err_next, err_prev, acc);
+    if (on) s_leave(&c, TT_PROF_GRAD,
+                    2 * W->len * sizeof(int32_t) + W->len + x->len + err_next->len + err_prev->len);
+}
+
+static void s_grad_pack(size_t i, const tensor_t *W, const int32_t *acc, tensor_t *G) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_grad_pack(W, acc, G);
+    if (on) s_leave(&c, TT_PROF_GRAD_PACK, 2 * W->len * sizeof(int32_t) + G->len);
+}
+
+static void s_update(size_t i, tensor_t *W, const tensor_t *G, size_t n_grad, size_t n_samples,
+                     int32_t *acc) {
+    s_call_t c;
+    int on = s_enter(&c, W) != NULL;
+    s_inner[i]->dense_update(W, G, n_grad, n_samples, acc);
+    if (on) s_leave(&c, TT_PROF_UPDATE, n_grad * W->len + 3 * W->len * sizeof(int32_t) + 3 * W->len);
+}
+
+/* the vtable has no context argument: one set of entry points per wrapped backend */
+#define S_SLOT_SET(i)                                                                                      static void s_forward_##i(const tensor_t *W, const tensor_t *X, tensor_t *Y, int32_t *acc,                                       size_t acc_size, tt_act_t act)                                               { s_forward(i, W, X, Y, acc, acc_size, act); }                                                         static void s_forward_batch_##i(const tensor_t *W, const tensor_t *X, tensor_t *Y, size_t n,                                           int32_t *acc, size_t acc_size, tt_act_t act)                           { s_forward_batch(i, W, X, Y, n, acc, acc_size, act); }                                                static void s_train_##i(tensor_t *W, const tensor_t *x, const tensor_t *err_next,                                              tensor_t *err_prev, tensor_t *G)                                               { s_train(i, W, x, err_next, err_prev, G); }                                                           static void s_grad_##i(const tensor_t *W, const tensor_t *x, const tensor_t *err_next,                                        tensor_t *err_prev, int32_t *acc)                                               { s_grad(i, W, x, err_next, err_prev, acc); }                                                          static void s_grad_pack_##i(const tensor_t *W, const int32_t *acc, tensor_t *G)                        { s_grad_pack(i, W, acc, G); }                                                                         static void s_update_##i(tensor_t *W, const tensor_t *G, size_t n_grad, size_t n_samples,                                       int32_t *acc)                                                                 { s_update(i, W, G, n_grad, n_samples, acc); }
+
+#define S_SLOTS(i)                                                                                         { .dense_forward = s_forward_##i, .dense_forward_batch = s_forward_batch_##i,                            .dense_train = s_train_##i, .dense_grad = s_grad_##i, .dense_grad_pack = s_grad_pack_##i,              .dense_update = s_update_##i }
+
+S_SLOT_SET(0)  S_SLOT_SET(1)  S_SLOT_SET(2)  S_SLOT_SET(3)
+S_SLOT_SET(4)  S_SLOT_SET(5)  S_SLOT_SET(6)  S_SLOT_SET(7)
+S_SLOT_SET(8)  S_SLOT_SET(9)  S_SLOT_SET(10) S_SLOT_SET(11)
+S_SLOT_SET(12) S_SLOT_SET(13) S_SLOT_SET(14) S_SLOT_SET(15)
+
+static const TensorBackend_t s_slots[TT_PROF_MAX_BACKENDS] = {
+    S_SLOTS(0),  S_SLOTS(1),  S_SLOTS(2),  S_SLOTS(3),  S_SLOTS(4),  S_SLOTS(5),  S_SLOTS(6),  S_SLOTS(7),
+    S_SLOTS(8),  S_SLOTS(9),  S_SLOTS(10), S_SLOTS(11), S_SLOTS(12), S_SLOTS(13), S_SLOTS(14), S_SLOTS(15),
+};
+
+const TensorBackend_t *tt_profile_wrap(const TensorBackend_t *inner) {
+    if (!inner) return NULL;
+    for (size_t i = 0; i < s_n_wrap; ++i) {
+        if (inner == &s_wrap[i]) return inner;      /* already a wrapper */
+        if (inner == s_inner[i]) return &s_wrap[i];
+    }
+    if (s_n_wrap >= TT_PROF_MAX_BACKENDS) return NULL;
+
+    size_t i = s_n_wrap;
+    const TensorBackend_t *k = &s_slots[i];
+    TensorBackend_t w = *inner;                     /* storage flags, epilogue as they are */
+    if (inner->dense_forward)       w.dense_forward       = k->dense_forward;
+    if (inner->dense_forward_batch) w.dense_forward_batch = k->dense_forward_batch;
+    if (inner->dense_train)         w.dense_train         = k->dense_train;
+    if (inner->dense_grad)          w.dense_grad          = k->dense_grad;
+    if (inner->dense_grad_pack)     w.dense_grad_pack     = k->dense_grad_pack;
+    if (inner->dense_update)        w.dense_update        = k->dense_update;
+    s_inner[i] = inner;
+    s_wrap[i]  = w;
+    s_n_wrap   = i + 1;
+    return &s_wrap[i];
+}
+
+/*----------------------------------------------------------------------*
+ * export
+ *----------------------------------------------------------------------*/
+int tt_profile_write_json(const tt_profile_t *p, FILE *f) {
+    if (!p || !f) return -1;
+    fprintf(f, "{\n  \"clock\": \"%s\",\n  \"hooks\": %d,\n  \"events\": %llu,\n  \"layers\": [\n",
+            TT_PROF_CLOCK, TT_PROFILE_ENABLE, (unsigned long long)p->n_events);
+    for (size_t l = 0; l < p->n_layers; ++l) {
+        const tt_prof_layer_t *L = &p->layers[l];
+        fprintf(f, "    {\"layer\": %zu", l);
+        for (int k = 0; k < TT_PROF_N_KINDS; ++k) {
+            if (!L->calls[k]) continue;
+            fprintf(f, ", \"%s\": {\"calls\": %llu, \"cycles\": %llu, \"bytes\": %llu}",
+                    s_kind_name[k], (unsigned long long)L->calls[k],
+                    (unsigned long long)L->cycles[k], (unsigned long long)L->bytes[k]);
+        }
+        fprintf(f, ", \"gemv_cycles\": %llu, \"epilogue_cycles\": %llu"
+                   ", \"upscales\": %llu, \"downscales\": %llu"
+                   ", \"w_upscales\": %llu, \"w_downscales\": %llu, \"rollups\": %llu}%s\n",
+                (unsigned long long)L->cyc_gemv, (unsigned long long)L->cyc_epilogue,
+                (unsigned long long)L->n_up, (unsigned long long)L->n_down,
+                (unsigned long long)L->n_w_up, (unsigned long long)L->n_w_down,
+                (unsigned long long)L->n_rollup, l + 1 < p->n_layers ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return ferror(f) ? -1 : 0;
+}
+
+int tt_profile_write_ring(const tt_profile_t *p, FILE *f) {
+    if (!p || !f) return -1;
+    uint64_t n     = p->n_events < p->ring_len ? p->n_events : p->ring_len;
+    uint64_t first = p->n_events - n;
+    uint16_t ver = 1, rec = (uint16_t)sizeof(tt_prof_event_t);
+    uint32_t cnt = (uint32_t)n;
+    if (fwrite("TTPR", 1, 4, f) != 4 ||
+        fwrite(&ver, sizeof(ver), 1, f) != 1 ||
+        fwrite(&rec, sizeof(rec), 1, f) != 1 ||
+        fwrite(&cnt, sizeof(cnt), 1, f) != 1) return -1;
+    for (uint64_t i = 0; i < n; ++i) {
+        const tt_prof_event_t *e = &p->ring[(first + i) % p->ring_len];
+        if (fwrite(e, sizeof(*e), 1, f) != 1) return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file tt_profile.h
+ * @brief per-layer profiling wrapper around any TensorBackend_t
+ * @details tt_profile_wrap gives the wrapper table of a backend: the same
+ * storage flags and slots, each slot the backend has forwarded to it and
+ * accounted to the registered layer (found by its weight pointer): calls,
+ * cycles and bytes per slot, plus one event in a ring buffer. Calls on
+ * weights that were never registered run unaccounted. With TT_PROFILE_ENABLE the dense kernels also split the
+ * forward cycles into GEMV and epilogue and count the 4/3 and 4/5
+ * rescales and the nested roll-ups, through the TT_PROF_* hooks below.
+ * Counters are plain integers: profile single-threaded runs.
+ * @license MIT
+ */
+#ifndef TT_PROFILE_H
+#define TT_PROFILE_H
+
+#include "tt_tensor_backend.h"
+#include "tt_debug.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TT_PROF_CLOCK "rdtsc"
+#elif defined(__aarch64__)
+#define TT_PROF_CLOCK "cntvct"
+#else
+#include <time.h>
+#define TT_PROF_CLOCK "ns"
+#endif
+
+/* profiled vtable slots */
+typedef enum {
+    TT_PROF_FORWARD = 0,
+    TT_PROF_FORWARD_BATCH,
+    TT_PROF_TRAIN,
+    TT_PROF_GRAD,
+    TT_PROF_GRAD_PACK,
+    TT_PROF_UPDATE,
+    TT_PROF_N_KINDS
+} tt_prof_kind_t;
+
+/* distinct backends tt_profile_wrap can wrap */
+#define TT_PROF_MAX_BACKENDS    (16)
+
+/* counters of one layer */
+typedef struct {
+    const int8_t          *key;         /* W data, identifies the layer */
+    const TensorBackend_t *inner;       /* profiled backend */
+    const TensorBackend_t *ops;         /* its wrapper, for the layer's descriptor */
+    uint64_t calls[TT_PROF_N_KINDS];
+    uint64_t cycles[TT_PROF_N_KINDS];   /* whole call */
+    uint64_t bytes[TT_PROF_N_KINDS];    /* estimated bytes touched */
+    /* filled by the kernel hooks (TT_PROFILE_ENABLE) */
+    uint64_t cyc_gemv;
+    uint64_t cyc_epilogue;
+    uint64_t n_up;                      /* activation 4/3 up-scales */
+    uint64_t n_down;                    /* activation 4/5 down-scales */
+    uint64_t n_w_up;                    /* weight renorm up-scales */
+    uint64_t n_w_down;                  /* weight renorm down-scales */
+    uint64_t n_rollup;                  /* nested roll-up steps */
+} tt_prof_layer_t;
+
+/* one ring buffer record, fixed 32 bytes */
+typedef struct {
+    uint64_t t_start;       /* clock at the call */
+    uint32_t cycles;        /* whole call */
+    uint32_t gemv;          /* GEMV part (hooks) */
+    uint32_t epilogue;      /* epilogue part (hooks) */
+    uint16_t layer;
+    uint8_t  kind;          /* tt_prof_kind_t */
+    uint8_t  flags;         /* TT_PROF_EV_* */
+    uint64_t bytes;
+} tt_prof_event_t;
+
+#define TT_PROF_EV_UP       (1u << 0)
+#define TT_PROF_EV_DOWN     (1u << 1)
+#define TT_PROF_EV_W_UP     (1u << 2)
+#define TT_PROF_EV_W_DOWN   (1u << 3)
+#define TT_PROF_EV_ROLLUP   (1u << 4)
+
+typedef struct {
+    tt_prof_layer_t *layers;
+    size_t           n_layers;
+    size_t           max_layers;
+    tt_prof_event_t *ring;          /* may be NULL */
+    size_t           ring_len;
+    uint64_t         n_events;      /* total recorded, the ring keeps the last ring_len */
+    size_t           hint;          /* last layer found, tried first */
+} tt_profile_t;
+
+/* wrapper table of inner (inner itself if it is one), NULL once TT_PROF_MAX_BACKENDS
+ * backends are wrapped; has exactly the slots inner has */
+const TensorBackend_t *tt_profile_wrap(const TensorBackend_t *inner);
+
+/* counters of the layer being run, NULL outside the wrapper */
+extern tt_prof_layer_t *tt_prof_cur;
+
+/* caller-provided storage; makes p the active profile */
+void tt_profile_init(tt_profile_t *p, tt_prof_layer_t *layers, size_t max_layers,
+                     tt_prof_event_t *ring, size_t ring_len);
+/* registers the layer of weights W on backend inner (or its wrapper), returns its index or -1;
+ * the layer's descriptor then takes layers[index].ops */
+int  tt_profile_add_layer(tt_profile_t *p, const tensor_t *W, const TensorBackend_t *inner);
+/* zeroes every counter and the ring, keeps the layers */
+void tt_profile_reset(tt_profile_t *p);
+
+/* JSON summary of every layer */
+int  tt_profile_write_json(const tt_profile_t *p, FILE *f);
+/* binary ring dump: "TTPR", u16 version, u16 record size, u32 count, records oldest first */
+int  tt_profile_write_ring(const tt_profile_t *p, FILE *f);
+
+static inline uint64_t tt_prof_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/*
+ * kernel hooks, compiled out unless TT_PROFILE_ENABLE:
+ *   TT_PROF_MARK(t)        start a lap clock t
+ *   TT_PROF_LAP(t, field)  add the lap to the current layer's field, restart t
+ *   TT_PROF_COUNT(field, n) add n to the current layer's field (n is always evaluated)
+ */
+#if TT_PROFILE_ENABLE
+#define TT_PROF_MARK(t)         uint64_t t = tt_prof_now()
+#define TT_PROF_LAP(t, field)                                        \
+    do {                                                             \
+        uint64_t now_ = tt_prof_now();                               \
+        if (tt_prof_cur) tt_prof_cur->field += now_ - (t);           \
+        (t) = now_;                                                  \
+    } while (0)
+#define TT_PROF_COUNT(field, n)                                      \
+    do {                                                             \
+        uint64_t n_ = (uint64_t)(n);                                 \
+        if (tt_prof_cur) tt_prof_cur->field += n_;                   \
+    } while (0)
+#else
+#define TT_PROF_MARK(t)         ((void)0)
+#define TT_PROF_LAP(t, field)   ((void)0)
+#define TT_PROF_COUNT(field, n) ((void)(n))
+#endif
+
+#endif // TT_PROFILE_H
@@ -0,0 +1,304 @@
+/**
+ * @file tt_quant.c
+ * @brief offline conversion of float weights to Tin-Tin int8 tensors
+ * @license MIT
+ */
+#include "tt_quant.h"
+#include "tt_model_file.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define S_N_UD  ((TT_QUANT_MAX_UD + 1) * (TT_QUANT_MAX_UD + 1))
+
+typedef struct {
+    int8_t S, U, D;
+    double sse;
+} s_cand_t;
+
+static double s_lsb(int S, int U, int D) {
+    return ldexp(pow(16.0 / 21.0, U) * pow(4.0 / 3.0, D), -S);
+}
+
+static void s_set(scale_t *s, int8_t S, int8_t U, int8_t D) {
+    memset(s, 0, sizeof(*s));
+#ifdef TENSOR_USE_NESTED
+    s->l.S = S; s->l.U = U; s->l.D = D;
+    while (scale_rollup(s)) ;
+#else
+    s->S = S;   s->U = U;   s->D = D;
+#endif
+}
+
+static int8_t s_quant1(float x, double inv) {
+    long q = lround(x * inv);
+    return (int8_t)(q > INT8_MAX ? INT8_MAX : q < INT8_MIN ? INT8_MIN : q);
+}
+
+static double s_sse(const float *x, size_t n, double lsb) {
+    const double inv = 1.0 / lsb;
+    double e = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double d = x[i] - s_quant1(x[i], inv) * lsb;
+        e += d * d;
+    }
+    return e;
+}
+
+/*
+ * best S of every (U, D), sorted by error (fewer U + D first on ties).
+ * returns the candidate count, 1 for an all-zero input
+ */
+static size_t s_search(const float *x, size_t n, s_cand_t *c) {
+    double maxa = 0.0;
+    for (size_t i = 0; i < n; ++i) maxa = fabs(x[i]) > maxa ? fabs(x[i]) : maxa;
+    if (maxa == 0.0) {
+        c[0].S = c[0].U = c[0].D = 0;
+        c[0].sse = 0.0;
+        return 1;
+    }
+
+    size_t k = 0;
+    for (int ud = 0; ud <= 2 * TT_QUANT_MAX_UD; ++ud) {
+        for (int U = 0; U <= TT_QUANT_MAX_UD; ++U) {
+            int D = ud - U;
+            if (D < 0 || D > TT_QUANT_MAX_UD) continue;
+            /* coarsest S with max-abs inside [-127, 127], then two finer ones */
+            double base = s_lsb(0, U, D);
+            int S0 = (int)floor(log2(INT8_MAX * base / maxa));
+            s_cand_t best = { 0, 0, 0, HUGE_VAL };
+            for (int S = S0; S <= S0 + 2; ++S) {
+                if (S < INT8_MIN || S > INT8_MAX) continue;
+                double e = s_sse(x, n, s_lsb(S, U, D));
+                if (e < best.sse) {
+                    best.S = (int8_t)S; best.U = (int8_t)U; best.D = (int8_t)D;
+                    best.sse = e;
+                }
+            }
+            if (best.sse == HUGE_VAL) continue;
+            /* insertion after every candidate that is not worse */
+            size_t j = k++;
+            while (j > 0 && c[j - 1].sse > best.sse) { c[j] = c[j - 1]; --j; }
+            c[j] = best;
+        }
+    }
+    return k;
+}
+
+double tt_scale_lsb(const scale_t *s) {
+    if (!s) return 0.0;
+#ifdef TENSOR_USE_NESTED
+    return s_lsb(s->g.S + s->l.S, s->g.U + s->l.U, s->g.D + s->l.D);
+#else
+    return s_lsb(s->S, s->U, s->D);
+#endif
+}
+
+void tt_quantize(const float *x, size_t n, const scale_t *s, int8_t *q) {
+    if (!x || !s || !q) return;
+    const double inv = 1.0 / tt_scale_lsb(s);
+    for (size_t i = 0; i < n; ++i) q[i] = s_quant1(x[i], inv);
+}
+
+void tt_dequantize(const tensor_t *t, float *x) {
+    if (!t || !t->data || !x) return;
+    const double lsb = tt_scale_lsb(&t->s);
+    for (size_t i = 0; i < t->len; ++i) x[i] = (float)(t->data[i] * lsb);
+}
+
+/**
+ * @brief searches the header with the smallest reconstruction error
+ * @param x pointer of the float values
+ * @param n number of values
+ * @param s receives the header
+ * @return double squared reconstruction error, -1 on bad arguments
+ */
+double tt_quant_search(const float *x, size_t n, scale_t *s) {
+    if (!x || !s) return -1.0;
+    s_cand_t c[S_N_UD];
+    s_search(x, n, c);
+    s_set(s, c[0].S, c[0].U, c[0].D);
+    return c[0].sse;
+}
+
+/*----------------------------------------------------------------------*
+ * Model conversion
+ *----------------------------------------------------------------------*/
+
+/* int8 weights the backend reads or derives its storage from */
+static int8_t *s_w_view(tt_layer_t *L) {
+    return L->w_bits == 4 ? L->i4.shadow : L->W.data;
+}
+
+static void s_store(tt_layer_t *L, const float *W, const s_cand_t *c) {
+    scale_t s;
+    s_set(&s, c->S, c->U, c->D);
+    if (L->w_tiled) {
+        /* a tile row holds MATRIX_TILE_C consecutive columns of one row */
+        const size_t in = L->desc.in;
+        for (size_t r = 0; r < L->desc.out; ++r)
+            for (size_t c0 = 0; c0 < in; c0 += MATRIX_TILE_C)
+                tt_quantize(W + r * in + c0, in - c0 < MATRIX_TILE_C ? in - c0 : MATRIX_TILE_C, &s,
+                            L->W.data + matrix_tile_idx(&L->tile, r, c0));
+    } else {
+        tt_quantize(W, (size_t)L->desc.in * L->desc.out, &s, s_w_view(L));
+    }
+    L->W.s = s;
+    if (L->w_bits == 4)   tt_i4_weights_sync(&L->W);
+    else if (L->w_sparse) tt_sparse_weights_sync(&L->W);
+    else if (L->W.ext == &L->acc16) tt_dense_weights_sync(&L->W);
+}
+
+/*
+ * runs layer L on the n int8 inputs x (headers xs), returns the squared
+ * error of the dequantized outputs against ref; keeps them in y / ys
+ */
+static double s_eval(tt_seq_model_t *m, tt_layer_t *L, const int8_t *x, const scale_t *xs,
+                     const float *ref, size_t n, int8_t *y, scale_t *ys) {
+    const size_t in = L->desc.in, out = L->desc.out;
+    double e = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        tensor_t X;
+        tt_tensor_init(&X, (int8_t *)x + i * in, in);
+        X.s = xs[i];
+        L->desc.ops->dense_forward(&L->W, &X, &L->A, m->acc, L->A.len, L->desc.act);
+        const double lsb = tt_scale_lsb(&L->A.s);
+        for (size_t r = 0; r < out; ++r) {
+            double d = L->A.data[r] * lsb - ref[i * out + r];
+            e += d * d;
+        }
+        if (y) {
+            memcpy(y + i * out, L->A.data, out);
+            ys[i] = L->A.s;
+        }
+    }
+    return e;
+}
+
+static float s_float_act(tt_act_t act, float a) {
+    switch (act) {
+    case TT_ACT_RELU:    return relu_f(a);
+    case TT_ACT_LEAKY:   return a < 0.0f ? 0.25f * a : a;
+    case TT_ACT_SIGMOID: return sigmoid_f(a);
+    case TT_ACT_TANH:    return tanh_f(a);
+    default:             return a;
+    }
+}
+
+/* y = act(W x) of the float layer over n rows */
+static void s_float_forward(const tt_float_layer_t *fl, const float *x, float *y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t r = 0; r < fl->out; ++r) {
+            const float *w = fl->W + r * fl->in;
+            float a = 0.0f;
+            for (size_t c = 0; c < fl->in; ++c) a += w[c] * x[i * fl->in + c];
+            y[i * fl->out + r] = s_float_act(fl->act, a);
+        }
+    }
+}
+
+/**
+ * @brief converts float layers into an initialized model
+ * @param m pointer of the model, layer sizes as in fl
+ * @param fl float layers [m->n_layers]
+ * @param calib calibration inputs [n_calib x fl[0].in], may be NULL
+ * @param n_calib number of calibration inputs
+ * @param mse optional per-layer mean squared output error [m->n_layers]
+ * @return int 0 on success, -1 on failure
+ */
+int tt_quant_model(tt_seq_model_t *m, const tt_float_layer_t *fl,
+                   const float *calib, size_t n_calib, double *mse) {
+    if (!m || !m->layers || !m->n_layers || !fl) return -1;
+    if (!calib) n_calib = 0;
+
+    size_t maxw = m->layers[0].desc.in;
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        /* float layers are dense: [out x in] */
+        if (L->desc.type != TT_LAYER_DENSE) return -1;
+        if (!fl[l].W || fl[l].in != L->desc.in || fl[l].out != L->desc.out || fl[l].act != L->desc.act ||
+            !s_w_view(L)) return -1;
+        maxw = L->desc.out > maxw ? L->desc.out : maxw;
+    }
+
+    /* float reference and int8 activations of the calibration set, ping-pong */
+    const size_t rows = n_calib ? n_calib : 1;
+    const size_t fb = rows * maxw * sizeof(float);
+    const size_t qb = rows * maxw;
+    const size_t sb = rows * sizeof(scale_t);
+    uint8_t *mem = malloc(2 * (fb + qb + sb));
+    if (!mem) return -1;
+    float   *ref[2] = { (float *)mem, (float *)(mem + fb) };
+    scale_t *qs[2]  = { (scale_t *)(mem + 2 * fb), (scale_t *)(mem + 2 * fb + sb) };
+    int8_t  *q[2]   = { (int8_t *)(mem + 2 * (fb + sb)), (int8_t *)(mem + 2 * (fb + sb) + qb) };
+
+    if (n_calib) {
+        const size_t in = m->layers[0].desc.in;
+        tt_quant_search(calib, n_calib * in, &m->input.s);
+        memcpy(ref[0], calib, n_calib * in * sizeof(float));
+        tt_quantize(calib, n_calib * in, &m->input.s, q[0]);
+        for (size_t i = 0; i < n_calib; ++i) qs[0][i] = m->input.s;
+    }
+
+    s_cand_t c[S_N_UD];
+    for (size_t l = 0; l < m->n_layers; ++l) {
+        tt_layer_t *L = &m->layers[l];
+        size_t nc = s_search(fl[l].W, (size_t)L->desc.in * L->desc.out, c);
+        size_t best = 0;
+        double best_e = 0.0;
+        if (n_calib) {
+            s_float_forward(&fl[l], ref[0], ref[1], n_calib);
+            if (nc > TT_QUANT_CANDIDATES) nc = TT_QUANT_CANDIDATES;
+            for (size_t k = 0; k < nc; ++k) {
+                s_store(L, fl[l].W, &c[k]);
+                double e = s_eval(m, L, q[0], qs[0], ref[1], n_calib, NULL, NULL);
+                if (k == 0 || e < best_e) { best = k; best_e = e; }
+            }
+        }
+        s_store(L, fl[l].W, &c[best]);
+        if (n_calib) {
+            s_eval(m, L, q[0], qs[0], ref[1], n_calib, q[1], qs[1]);
+            float *tf = ref[0]; ref[0] = ref[1]; ref[1] = tf;
+            int8_t *tq = q[0];  q[0] = q[1];     q[1] = tq;
+            scale_t *ts = qs[0]; qs[0] = qs[1];  qs[1] = ts;
+        }
+        if (mse) mse[l] = n_calib ? best_e / ((double)n_calib * L->desc.out) : 0.0;
+    }
+    free(mem);
+    return 0;
+}
+
+/**
+ * @brief converts float layers on the tt backend and saves them as a model file
+ * @param path output model file, see tt_model_file.h
+ * @param fl float layers [n_layers]
+ * @param n_layers number of layers
+ * @param calib calibration inputs [n_calib x fl[0].in], may be NULL
+ * @param n_calib number of calibration inputs
+ * @return int 0 on success, -1 on failure
+ */
+int tt_quant_convert(const char *path, const tt_float_layer_t *fl, size_t n_layers,
+                     const float *calib, size_t n_calib) {
+    if (!path || !fl || !n_layers || n_layers > TT_SEQ_MAX_LAYERS) return -1;
+    tt_layer_desc_t descs[TT_SEQ_MAX_LAYERS];
+    for (size_t l = 0; l < n_layers; ++l) {
+        descs[l].type = TT_LAYER_DENSE;
+        descs[l].in   = fl[l].in;
+        descs[l].out  = fl[l].out;
+        descs[l].act  = fl[l].act;
+        descs[l].ops  = &tt_backend;
+    }
+    size_t size = tt_seq_model_arena_size(descs, n_layers);
+    if (!size) return -1;
+    void *arena = malloc(size);
+    tt_layer_t *layers = malloc(n_layers * sizeof(tt_layer_t));
+    int rc = -1;
+    tt_seq_model_t m;
+    if (arena && layers &&
+        tt_seq_model_init(&m, layers, descs, n_layers, arena, size) == 0 &&
+        tt_quant_model(&m, fl, calib, n_calib, NULL) == 0)
+        rc = tt_model_file_save(path, &m);
+    free(layers);
+    free(arena);
+    return rc;
+}
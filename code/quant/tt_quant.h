@@ -0,0 +1,66 @@
+/**
+ * @file tt_quant.h
+ * @brief offline conversion of float weights to Tin-Tin int8 tensors
+ * @details a header (S, U, D) stands for one int8 step of
+ *
+ *   lsb = 2^-S * (16/21)^U * (4/3)^D
+ *
+ * i.e. the inverse of the upscale_4_3 (x * 21/16) and downscale_4_5
+ * (x * 3/4) steps a tensor went through, nested builds use S = g.S + l.S
+ * and so on. U and D refine the power-of-two grid inside an octave, so
+ * for every (U, D) up to TT_QUANT_MAX_UD the search takes the S that just
+ * covers the max-abs and the next two finer ones (clipping outliers),
+ * and keeps the header with the smallest squared reconstruction error.
+ *
+ * Model conversion is greedy, layer by layer: the TT_QUANT_CANDIDATES
+ * best weight headers of a layer are each run on the calibration set
+ * through the layer's backend (inputs are the int8 outputs of the layers
+ * already converted) and the one whose dequantized output is closest to
+ * the float model's output is kept.
+ * @license MIT
+ */
+#ifndef TT_QUANT_H
+#define TT_QUANT_H
+
+#include "tt_seq_model.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define TT_QUANT_MAX_UD      (8)   /* largest U and D tried */
+#define TT_QUANT_CANDIDATES  (4)   /* weight headers compared on the calibration set */
+
+/* one float dense layer, y = act(W x), no bias like the int8 layers */
+typedef struct {
+    uint16_t     in;
+    uint16_t     out;
+    tt_act_t     act;      /* leaky as in the int8 path (slope 1/4) */
+    const float *W;        /* [out x in], row major */
+} tt_float_layer_t;
+
+/* value of one int8 step of header s */
+double tt_scale_lsb(const scale_t *s);
+
+/* q = clip(round(x / lsb(s))) over n elements */
+void   tt_quantize(const float *x, size_t n, const scale_t *s, int8_t *q);
+/* x = q * lsb(t->s) over t->len elements */
+void   tt_dequantize(const tensor_t *t, float *x);
+
+/* best header of n floats, returns its squared reconstruction error */
+double tt_quant_search(const float *x, size_t n, scale_t *s);
+
+/*
+ * convert the float layers fl[0..m->n_layers-1] into m, whose layer sizes
+ * and activations must match: weights and W headers of every layer (int4
+ * layers through their shadow) and m->input.s from the n_calib calibration
+ * inputs (calib [n_calib x fl[0].in]). With no calibration set every layer takes
+ * its best weight header. mse (optional, [m->n_layers]) receives the mean
+ * squared output error of every layer on the calibration set. 0 or -1
+ */
+int    tt_quant_model(tt_seq_model_t *m, const tt_float_layer_t *fl,
+                      const float *calib, size_t n_calib, double *mse);
+
+/* tt_quant_model on the tt backend, then tt_model_file_save to path; 0 or -1 */
+int    tt_quant_convert(const char *path, const tt_float_layer_t *fl, size_t n_layers,
+                        const float *calib, size_t n_calib);
+
+#endif // TT_QUANT_H
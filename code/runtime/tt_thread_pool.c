@@ -0,0 +1,208 @@
+/**
+ * @file tt_thread_pool.c
+ * @brief fixed-size pthread pool running blocking parallel-for jobs
+ * @license MIT
+ */
+#define _GNU_SOURCE
+#include "tt_thread_pool.h"
+#include <sched.h>
+#include <stdlib.h>
+
+/* takes tasks of the current job until none is left, lock held on entry/exit */
+static void s_drain(tt_pool_t *p) {
+    while (p->next < p->n_tasks) {
+        size_t t = p->next++;
+        tt_pool_fn_t fn = p->fn;
+        void *ctx = p->ctx;
+        pthread_mutex_unlock(&p->lock);
+        fn(ctx, t);
+        pthread_mutex_lock(&p->lock);
+        if (--p->pending == 0) pthread_cond_broadcast(&p->done);
+    }
+}
+
+/* runs the lane's share of a per-lane job, lock held on entry/exit */
+static void s_lane(tt_pool_t *p, size_t lane) {
+    tt_pool_fn_t fn = p->fn;
+    void *ctx = p->ctx;
+    pthread_mutex_unlock(&p->lock);
+    fn(ctx, lane);
+    pthread_mutex_lock(&p->lock);
+    if (--p->pending == 0) pthread_cond_broadcast(&p->done);
+}
+
+static void *s_worker(void *arg) {
+    tt_pool_t *p = (tt_pool_t *)arg;
+    unsigned seen = 0;
+    pthread_mutex_lock(&p->lock);
+    const size_t lane = ++p->started;
+    for (;;) {
+        while (!p->stop && p->job == seen) pthread_cond_wait(&p->wake, &p->lock);
+        if (p->stop) break;
+        seen = p->job;
+        if (p->per_lane) s_lane(p, lane);
+        else             s_drain(p);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+/**
+ * @brief starts the worker threads
+ * @param p pointer of the pool
+ * @param n_threads number of threads besides the caller (0 = inline)
+ * @return int 0 on success, -1 on failure
+ */
+int tt_pool_init(tt_pool_t *p, size_t n_threads) {
+    if (!p) return -1;
+    p->threads   = NULL;
+    p->n_threads = 0;
+    p->fn        = NULL;
+    p->ctx       = NULL;
+    p->n_tasks   = 0;
+    p->next      = 0;
+    p->pending   = 0;
+    p->job       = 0;
+    p->per_lane  = 0;
+    p->started   = 0;
+    p->stop      = 0;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    pthread_cond_init(&p->done, NULL);
+    if (!n_threads) return 0;
+
+    p->threads = malloc(n_threads * sizeof(pthread_t));
+    if (!p->threads) {
+        tt_pool_destroy(p);
+        return -1;
+    }
+    for (size_t i = 0; i < n_threads; ++i) {
+        if (pthread_create(&p->threads[i], NULL, s_worker, p) != 0) {
+            tt_pool_destroy(p);
+            return -1;
+        }
+        p->n_threads++;
+    }
+    return 0;
+}
+
+/**
+ * @brief stops and joins the worker threads
+ * @param p pointer of the pool
+ * @return NULL
+ */
+void tt_pool_destroy(tt_pool_t *p) {
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for (size_t i = 0; i < p->n_threads; ++i) pthread_join(p->threads[i], NULL);
+    free(p->threads);
+    p->threads   = NULL;
+    p->n_threads = 0;
+    pthread_cond_destroy(&p->done);
+    pthread_cond_destroy(&p->wake);
+    pthread_mutex_destroy(&p->lock);
+}
+
+/**
+ * @brief runs a parallel-for job
+ * @param p pointer of the pool
+ * @param fn task body
+ * @param ctx context shared by all tasks
+ * @param n_tasks number of tasks
+ * @return NULL
+ */
+void tt_pool_run(tt_pool_t *p, tt_pool_fn_t fn, void *ctx, size_t n_tasks) {
+    if (!p || !fn || !n_tasks) return;
+    if (!p->n_threads) {
+        for (size_t t = 0; t < n_tasks; ++t) fn(ctx, t);
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->fn       = fn;
+    p->ctx      = ctx;
+    p->n_tasks  = n_tasks;
+    p->next     = 0;
+    p->pending  = n_tasks;
+    p->per_lane = 0;
+    p->job++;
+    pthread_cond_broadcast(&p->wake);
+    s_drain(p);
+    while (p->pending) pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+}
+
+/**
+ * @brief runs a per-lane job
+ * @details every worker runs fn(ctx, lane) with its own lane, the caller
+ * runs lane 0. A worker that has not started yet takes the job when it does.
+ * @param p pointer of the pool
+ * @param fn lane body
+ * @param ctx context shared by all lanes
+ * @return NULL
+ */
+void tt_pool_run_lanes(tt_pool_t *p, tt_pool_fn_t fn, void *ctx) {
+    if (!p || !fn) return;
+    if (!p->n_threads) {
+        fn(ctx, 0);
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->fn       = fn;
+    p->ctx      = ctx;
+    p->n_tasks  = 0;
+    p->next     = 0;
+    p->pending  = p->n_threads + 1;
+    p->per_lane = 1;
+    p->job++;
+    pthread_cond_broadcast(&p->wake);
+    s_lane(p, 0);
+    while (p->pending) pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+}
+
+typedef struct {
+    cpu_set_t allowed;
+    size_t    n_cpus;
+    int       err;
+} s_pin_t;
+
+/* pins the calling worker to the lane-th allowed CPU */
+static void s_pin_lane(void *ctx, size_t lane) {
+    s_pin_t *pin = (s_pin_t *)ctx;
+    if (!lane) return;
+    size_t want = lane % pin->n_cpus, seen = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &pin->allowed) || seen++ != want) continue;
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(one), &one) != 0) pin->err = 1;
+        return;
+    }
+}
+
+/**
+ * @brief pins every worker to one CPU
+ * @details worker lane l goes to the (l mod n)-th of the n CPUs in the
+ * affinity mask of the calling thread, so with as many lanes as CPUs the
+ * workers take the CPUs after the caller's first one.
+ * @param p pointer of the pool
+ * @return int 0 on success, -1 if the mask could not be read or set
+ */
+int tt_pool_pin(tt_pool_t *p) {
+    if (!p) return -1;
+    s_pin_t pin;
+    if (sched_getaffinity(0, sizeof(pin.allowed), &pin.allowed) != 0) return -1;
+    pin.n_cpus = (size_t)CPU_COUNT(&pin.allowed);
+    pin.err    = 0;
+    if (!pin.n_cpus) return -1;
+    tt_pool_run_lanes(p, s_pin_lane, &pin);
+    return pin.err ? -1 : 0;
+}
+
+size_t tt_pool_lanes(const tt_pool_t *p) {
+    return p ? p->n_threads + 1 : 1;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file tt_thread_pool.h
+ * @brief fixed-size pthread pool running blocking parallel-for jobs
+ * @details for the Linux gateway builds. The calling thread takes part in
+ * every job, so a pool of n threads gives n + 1 lanes and a pool of 0
+ * threads runs the tasks inline.
+ *
+ * Lane 0 is the caller, lanes 1..n are the workers in the order they
+ * started and a worker keeps its lane for the life of the pool. A per-lane
+ * job (tt_pool_run_lanes) runs its body once on every lane, so state
+ * indexed by lane stays with one thread and, once pinned, one core.
+ * @license MIT
+ */
+#ifndef TT_THREAD_POOL_H
+#define TT_THREAD_POOL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+/* task body: ctx is shared by the job, task in [0, n_tasks) */
+typedef void (*tt_pool_fn_t)(void *ctx, size_t task);
+
+typedef struct {
+    pthread_t      *threads;
+    size_t          n_threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;       /* a job was posted or the pool stops */
+    pthread_cond_t  done;       /* the last task of a job finished */
+
+    tt_pool_fn_t    fn;
+    void           *ctx;
+    size_t          n_tasks;
+    size_t          next;       /* next task to hand out */
+    size_t          pending;    /* tasks not finished yet */
+    unsigned        job;        /* job generation */
+    int             per_lane;   /* the job runs fn(ctx, lane) once per lane */
+    size_t          started;    /* lanes handed to the workers so far */
+    int             stop;
+} tt_pool_t;
+
+/* returns 0 on success, -1 if the threads could not be started */
+int    tt_pool_init(tt_pool_t *p, size_t n_threads);
+void   tt_pool_destroy(tt_pool_t *p);
+
+/* runs fn(ctx, 0..n_tasks-1) on the pool and the caller, returns when all are done */
+void   tt_pool_run(tt_pool_t *p, tt_pool_fn_t fn, void *ctx, size_t n_tasks);
+
+/* runs fn(ctx, lane) once on every lane, returns when all are done */
+void   tt_pool_run_lanes(tt_pool_t *p, tt_pool_fn_t fn, void *ctx);
+
+/* pins worker lane l to the l-th CPU the process may run on (wrapping), the caller is left as is; 0 or -1 */
+int    tt_pool_pin(tt_pool_t *p);
+
+/* number of lanes a job runs on (threads + caller) */
+size_t tt_pool_lanes(const tt_pool_t *p);
+
+#endif // TT_THREAD_POOL_H
@@ -1,3 +1,5 @@
+#ifndef SCALE_H
+#define SCALE_H
 #include<stdint.h>
 /**
  * @file scale.h
@@ -32,12 +34,94 @@ typedef _scale_t scale_t;
 #endif
 
 // scale operations
-static inline void scale_combine(scale_t *dst, const scale_t *a, const scale_t *b);
-static inline void scale_shift(scale_t *h, int8_t k);
-static inline void scale_up(scale_t *h);
-static inline void scale_down(scale_t *h);
+/**
+ * @brief combine scales
+ * @param dst pointer of destination
+ * @param a pointer of scale one to combine
+ * @param b pointer of scale two to combine
+ * @return NULL
+ */
+static inline void scale_combine(scale_t *dst, const scale_t *a, const scale_t *b) {
+    if(!a || !b || !dst) return;
+#ifdef TENSOR_USE_NESTED
+    dst->g.S = a->g.S + b->g.S;
+    dst->g.U = a->g.U + b->g.U;
+    dst->g.D = a->g.D + b->g.D;
+    dst->l.S = a->l.S + b->l.S;
+    dst->l.U = a->l.U + b->l.U;
+    dst->l.D = a->l.D + b->l.D;
+#else
+    dst->S = a->S + b->S;
+    dst->U = a->U + b->U;
+    dst->D = a->D + b->D;
+#endif
+    return;
+}
 
+/**
+ * @brief shifts scales
+ * @param h pointer of the scale to shift
+ * @param k shift by
+ * @return NULL
+ */
+static inline void scale_shift(scale_t *h, int8_t k) {
+    if(!h) return;
+#ifdef TENSOR_USE_NESTED
+    h->l.S += k;
+#else
+    h->S   += k;
+#endif
+    return;
+}
+
+/**
+ * @brief scales up
+ * increments by one
+ * @param h pointer of the scale to up
+ * @return NULL
+ */
+static inline void scale_up(scale_t *h) {
+    if(!h) return;
 #ifdef TENSOR_USE_NESTED
-static inline void scale_rollup(scale_t *h);
+    h->l.U += 1;
+#else
+    h->U   += 1;
+#endif
+    return;
+}
+
+/**
+ * @brief scales down
+ * decrements by one
+ * @param h pointer of the scale to down
+ * @return NULL
+ */
+static inline void scale_down(scale_t *h) {
+    if(!h) return;
+#ifdef TENSOR_USE_NESTED
+    h->l.D += 1;
+#else
+    h->D += 1;
+#endif
+    return;
+}
+
+#ifdef TENSOR_USE_NESTED
+/**
+ * @brief rolls up scale
+ * @param h pointer of the scale to roll upd
+ * @return int number of counters rolled up
+ */
+static inline int scale_rollup(scale_t *h) {
+    if(!h) return 0;
+    const int8_t LIM  = 16, STEP = 8;
+    int n = 0;
+    if      (h->l.S >  LIM) { h->g.S += STEP; h->l.S -= STEP; n++; }
+    else if (h->l.S < -LIM) { h->g.S -= STEP; h->l.S += STEP; n++; }
+    if      (h->l.U >  LIM) { h->g.U += STEP; h->l.U -= STEP; n++; }
+    if      (h->l.D >  LIM) { h->g.D += STEP; h->l.D -= STEP; n++; }
+    return n;
+}
 #endif
 
+#endif // SCALE_H
@@ -1,15 +1,92 @@
 #include "tt_tensor_backend.h"
 #include "tt_dense.h"
 #include "ntt_dense.h"
+#include "tt_dense_i4.h"
+#include "tt_dense_sparse.h"
+#include "tt_conv1d.h"
 
 const TensorBackend_t tt_backend = {
-    .dense_forward = tt_dense_forward,
-    .dense_train   = tt_dense_train
+    .dense_forward       = tt_dense_forward,
+    .dense_forward_batch = tt_dense_forward_batch,
+    .dense_train         = tt_dense_train,
+    .dense_grad          = tt_dense_grad,
+    .dense_grad_pack     = tt_dense_grad_pack,
+    .dense_update        = tt_dense_update,
+    .dense_epilogue      = tt_dense_epilogue,
+    .w_bits              = 8
+};
+
+const TensorBackend_t tt_i4_backend = {
+    .dense_forward       = tt_i4_dense_forward,
+    .dense_forward_batch = tt_i4_dense_forward_batch,
+    .dense_train         = tt_i4_dense_train,
+    .dense_grad          = tt_i4_dense_grad,
+    .dense_grad_pack     = tt_i4_dense_grad_pack,
+    .dense_update        = tt_i4_dense_update,
+    .w_bits              = 4
+};
+
+const TensorBackend_t tt_sparse_backend = {
+    .dense_forward       = tt_sparse_dense_forward,
+    .dense_forward_batch = tt_sparse_dense_forward_batch,
+    .dense_train         = tt_sparse_dense_train,
+    .dense_grad          = tt_dense_grad,
+    .dense_grad_pack     = tt_dense_grad_pack,
+    .dense_update        = tt_sparse_dense_update,
+    .w_bits              = 8,
+    .w_sparse            = 1
+};
+
+/* no minibatch split: the Conv1D gradient is not framed in W per sample */
+const TensorBackend_t tt_conv1d_backend = {
+    .dense_forward       = tt_conv1d_forward,
+    .dense_forward_batch = tt_conv1d_forward_batch,
+    .dense_train         = tt_conv1d_train,
+    .w_bits              = 8,
+    .w_conv              = 1
+};
+
+/* weights repacked once into VNNI / sdot tiles; no split epilogue, the
+   grouped forward reads row-major weights */
+const TensorBackend_t tt_tiled_backend = {
+    .dense_forward       = tt_tiled_dense_forward,
+    .dense_forward_batch = tt_tiled_dense_forward_batch,
+    .dense_train         = tt_tiled_dense_train,
+    .dense_grad          = tt_tiled_dense_grad,
+    .dense_grad_pack     = tt_dense_grad_pack,
+    .dense_update        = tt_dense_update,
+    .w_bits              = 8,
+    .w_tiled             = 1
 };
 
 #ifdef TENSOR_USE_NESTED
 const TensorBackend_t nested_backend = {
-    .dense_forward = ntt_dense_forward,
-    .dense_train   = ntt_dense_train
+    .dense_forward       = ntt_dense_forward,
+    .dense_forward_batch = ntt_dense_forward_batch,
+    .dense_train         = ntt_dense_train,
+    .dense_grad          = ntt_dense_grad,
+    .dense_grad_pack     = ntt_dense_grad_pack,
+    .dense_update        = ntt_dense_update,
+    .dense_epilogue      = ntt_dense_epilogue,
+    .w_bits              = 8
+};
+
+const TensorBackend_t nested_conv1d_backend = {
+    .dense_forward       = tt_conv1d_forward,
+    .dense_forward_batch = tt_conv1d_forward_batch,
+    .dense_train         = ntt_conv1d_train,
+    .w_bits              = 8,
+    .w_conv              = 1
+};
+
+const TensorBackend_t nested_tiled_backend = {
+    .dense_forward       = ntt_tiled_dense_forward,
+    .dense_forward_batch = ntt_tiled_dense_forward_batch,
+    .dense_train         = ntt_tiled_dense_train,
+    .dense_grad          = ntt_tiled_dense_grad,
+    .dense_grad_pack     = ntt_dense_grad_pack,
+    .dense_update        = ntt_dense_update,
+    .w_bits              = 8,
+    .w_tiled             = 1
 };
 #endif
\ No newline at end of file
@@ -2,18 +2,41 @@
 #define TT_TENSOR_BACKEND_H
 
 #include "tt_types.h"
+#include "activations.h"
 
 // Backend vtable:
 typedef struct {
-    void (*dense_forward)(const tensor_t*, const tensor_t*, tensor_t*, int32_t*, size_t);
+    /* the activation is a per-call argument, fused into the epilogue */
+    void (*dense_forward)(const tensor_t*, const tensor_t*, tensor_t*, int32_t*, size_t, tt_act_t);
+    void (*dense_forward_batch)(const tensor_t*, const tensor_t*, tensor_t*, size_t, int32_t*, size_t, tt_act_t);
     void (*dense_train)(tensor_t*, const tensor_t*, const tensor_t*, tensor_t*, tensor_t*);
+    /* minibatch / data-parallel training: grad sums, int8 pack, one update */
+    void (*dense_grad)(const tensor_t*, const tensor_t*, const tensor_t*, tensor_t*, int32_t*);
+    void (*dense_grad_pack)(const tensor_t*, const int32_t*, tensor_t*);
+    void (*dense_update)(tensor_t*, const tensor_t*, size_t, size_t, int32_t*);
+    /* requantization of accumulators computed elsewhere (grouped forward), NULL if fused only */
+    void (*dense_epilogue)(const tensor_t*, const tensor_t*, tensor_t*, int32_t*, tt_act_t);
+    /* weight storage: 8 = plain int8 W->data, 4 = packed int4 (tt_dense_i4.h) */
+    uint8_t w_bits;
+    /* 1 = block-CSR index of the kept blocks in W->ext (tt_dense_sparse.h) */
+    uint8_t w_sparse;
+    /* 1 = Conv1D weights [c_out x c_in x k], geometry in W->ext (tt_conv1d.h) */
+    uint8_t w_conv;
+    /* 1 = W->data in 16 x 4 tiles, padded, geometry in W->ext (matrix_tile.h) */
+    uint8_t w_tiled;
 } TensorBackend_t;
 
 // Extern instances:
 extern const TensorBackend_t tt_backend;
+extern const TensorBackend_t tt_i4_backend;
+extern const TensorBackend_t tt_sparse_backend;
+extern const TensorBackend_t tt_conv1d_backend;
+extern const TensorBackend_t tt_tiled_backend;
 
 #ifdef TENSOR_USE_NESTED
 extern const TensorBackend_t nested_backend;
+extern const TensorBackend_t nested_conv1d_backend;
+extern const TensorBackend_t nested_tiled_backend;
 #endif
 
 #endif // TENSOR_BACKEND_H
\ No newline at end of file
@@ -0,0 +1,153 @@
+/**
+ * @file test_dataset.c
+ * @brief the dataset reader returns every record once per epoch
+ * @details 37 records, written with tt_ds_writer_*, are read back in
+ * batches of 5 over windows of 2 batches for two epochs, in file order
+ * and shuffled: the last batch of an epoch holds the 2 records left over
+ * and the epoch ends with an empty batch. Every record must come back
+ * exactly once per epoch, byte for byte, inside the window it was read
+ * with, with the stored input and target headers. An autoencoder file
+ * (target_len 0) hands out the input as the target.
+ * @license MIT
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "tt_dataset.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define T_N         (37)
+#define T_IN        (6)
+#define T_TG        (3)
+#define T_BATCH     (5)
+#define T_WINDOW    (10)
+#define T_EPOCHS    (2)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static int8_t s_in[T_N][T_IN], s_tg[T_N][T_TG];
+
+static void s_set_hdr(scale_t *s, int8_t S, int8_t U, int8_t D) {
+#ifdef TENSOR_USE_NESTED
+    s->g.S = 1; s->g.U = 0; s->g.D = 1;
+    s->l.S = (int8_t)(S - 1); s->l.U = U; s->l.D = (int8_t)(D - 1);
+#else
+    s->S = S; s->U = U; s->D = D;
+#endif
+}
+
+/* record of an input row: its first two bytes are the index */
+static int s_index(const int8_t *in) {
+    int i = (uint8_t)in[0] | (uint8_t)in[1] << 8;
+    return i < T_N && !memcmp(in, s_in[i], T_IN) ? i : -1;
+}
+
+static int s_write(const char *path, uint32_t tg_len, const scale_t *sx, const scale_t *sy) {
+    tt_ds_writer_t w;
+    if (tt_ds_writer_open(&w, path, T_IN, tg_len, sx, sy) != 0) return -1;
+    /* appended in uneven pieces, the file must not show them */
+    int rc = 0;
+    for (size_t i = 0; i < T_N && rc == 0; i += 3) {
+        size_t n = T_N - i < 3 ? T_N - i : 3;
+        rc = tt_ds_writer_append(&w, s_in[i], tg_len ? s_tg[i] : NULL, n);
+    }
+    return tt_ds_writer_close(&w) == 0 ? rc : -1;
+}
+
+static void s_check(const char *path, int shuffle, const scale_t *sx, const scale_t *sy) {
+    tt_dataset_t ds;
+    tt_ds_batch_t b;
+    if (tt_dataset_open(&ds, path, T_BATCH, T_WINDOW, shuffle, 5) != 0) {
+        CHECK(0, "shuffle %d: open", shuffle);
+        return;
+    }
+    int moved = 0;
+    for (uint32_t e = 0; e < T_EPOCHS; ++e) {
+        int seen[T_N] = { 0 }, pos = 0, r;
+        while ((r = tt_dataset_next(&ds, &b)) > 0) {
+            CHECK(b.epoch == e, "shuffle %d: batch of epoch %u in epoch %u", shuffle, b.epoch, e);
+            CHECK(r == (T_N - pos < T_BATCH ? T_N - pos : T_BATCH) && b.n == (size_t)r,
+                  "shuffle %d epoch %u: batch at %d holds %d", shuffle, e, pos, r);
+            CHECK(!memcmp(&b.in.s, sx, sizeof(*sx)) && !memcmp(&b.target.s, sy, sizeof(*sy)),
+                  "shuffle %d: batch headers differ from the file", shuffle);
+            for (int k = 0; k < r; ++k, ++pos) {
+                int i = s_index(b.in.data + k * T_IN);
+                if (i < 0) { CHECK(0, "shuffle %d epoch %u: record %d damaged", shuffle, e, pos); continue; }
+                ++seen[i];
+                moved |= i != pos;
+                CHECK(shuffle ? i / T_WINDOW == pos / T_WINDOW : i == pos,
+                      "shuffle %d epoch %u: record %d at %d", shuffle, e, i, pos);
+                CHECK(!memcmp(b.target.data + k * T_TG, s_tg[i], T_TG), "shuffle %d: target of %d", shuffle, i);
+            }
+        }
+        CHECK(r == 0 && pos == T_N && b.epoch == e, "shuffle %d epoch %u: ended with %d after %d", shuffle, e, r, pos);
+        for (int i = 0; i < T_N; ++i)
+            CHECK(seen[i] == 1, "shuffle %d epoch %u: record %d read %d times", shuffle, e, i, seen[i]);
+    }
+    CHECK(moved == shuffle, "shuffle %d: records moved %d", shuffle, moved);
+    tt_dataset_close(&ds);
+}
+
+/* target_len 0: the target is the input */
+static void s_check_autoencoder(const char *path, const scale_t *sx) {
+    tt_dataset_t ds;
+    tt_ds_batch_t b;
+    if (s_write(path, 0, sx, NULL) != 0 || tt_dataset_open(&ds, path, T_BATCH, 0, 1, 9) != 0) {
+        CHECK(0, "autoencoder: write / open");
+        return;
+    }
+    int pos = 0, r;
+    while ((r = tt_dataset_next(&ds, &b)) > 0) {
+        CHECK(b.target.data == b.in.data && b.target.len == b.in.len, "autoencoder: target is not the input");
+        pos += r;
+    }
+    CHECK(r == 0 && pos == T_N, "autoencoder: epoch of %d records", pos);
+    tt_dataset_close(&ds);
+}
+
+int main(void) {
+    char path[] = "/tmp/test_dataset_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("test_dataset: no temporary file\n");
+        return 1;
+    }
+    close(fd);
+
+    uint32_t st;
+    prng_init(&st, 20250704u);
+    for (int i = 0; i < T_N; ++i) {
+        s_in[i][0] = (int8_t)(i & 0xff);
+        s_in[i][1] = (int8_t)(i >> 8);
+        for (size_t j = 2; j < T_IN; ++j) s_in[i][j] = prng_rand_int8(&st);
+        for (size_t j = 0; j < T_TG; ++j) s_tg[i][j] = prng_rand_int8(&st);
+    }
+    scale_t sx, sy;
+    memset(&sx, 0, sizeof(sx));
+    memset(&sy, 0, sizeof(sy));
+    s_set_hdr(&sx, 7, 1, 2);
+    s_set_hdr(&sy, 5, 0, 3);
+
+    if (s_write(path, T_TG, &sx, &sy) != 0) {
+        CHECK(0, "write");
+    } else {
+        s_check(path, 0, &sx, &sy);
+        s_check(path, 1, &sx, &sy);
+    }
+    s_check_autoencoder(path, &sx);
+
+    unlink(path);
+    printf("test_dataset: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file test_dense_hdr.c
+ * @brief tt_backend trains on the value of a nested header, not its split
+ * @details the same weights, input and error run through the train step
+ * and through grad / pack / update twice: once with the headers in the
+ * local counters only and once with part of them moved to the global
+ * counters. Both runs must leave the same weights and errors, with headers
+ * of the same g + l. In a flat build there is one header and nothing to
+ * check.
+ * @license MIT
+ */
+#include "tt_tensor_backend.h"
+#include "prng.h"
+#include <stdio.h>
+#include <string.h>
+
+#define T_OUT       (12)
+#define T_IN        (20)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+#ifdef TENSOR_USE_NESTED
+
+typedef struct {
+    int8_t  w[T_OUT * T_IN], x[T_IN], e[T_OUT], ep[T_IN], g[T_OUT * T_IN];
+    int32_t acc[T_OUT * T_IN];
+    tensor_t W, X, E, EP, G;
+} s_layer_t;
+
+/* header of value (S, U, D), k of every counter moved to the global part */
+static void s_hdr(scale_t *s, int8_t S, int8_t U, int8_t D, int8_t k) {
+    s->g.S = k; s->g.U = k; s->g.D = k;
+    s->l.S = (int8_t)(S - k); s->l.U = (int8_t)(U - k); s->l.D = (int8_t)(D - k);
+}
+
+static int s_same_value(const scale_t *a, const scale_t *b) {
+    return a->g.S + a->l.S == b->g.S + b->l.S && a->g.U + a->l.U == b->g.U + b->l.U &&
+           a->g.D + a->l.D == b->g.D + b->l.D;
+}
+
+static void s_init(s_layer_t *L, uint32_t seed, int8_t k) {
+    uint32_t st;
+    prng_init(&st, seed);
+    for (size_t i = 0; i < sizeof(L->w); ++i) L->w[i] = (int8_t)((int)(prng_next(&st) % 121) - 60);
+    for (size_t i = 0; i < sizeof(L->x); ++i) L->x[i] = (int8_t)(prng_next(&st) % 100);
+    for (size_t i = 0; i < sizeof(L->e); ++i) L->e[i] = prng_rand_int8(&st);
+    tt_tensor_init(&L->W,  L->w,  sizeof(L->w));
+    tt_tensor_init(&L->X,  L->x,  sizeof(L->x));
+    tt_tensor_init(&L->E,  L->e,  sizeof(L->e));
+    tt_tensor_init(&L->EP, L->ep, sizeof(L->ep));
+    tt_tensor_init(&L->G,  L->g,  sizeof(L->g));
+    s_hdr(&L->W.s, 7, 2, 1, k);
+    s_hdr(&L->X.s, 6, 0, 3, k);
+    s_hdr(&L->E.s, 9, 1, 0, k);
+}
+
+static void s_compare(const s_layer_t *a, const s_layer_t *b, const char *what) {
+    CHECK(!memcmp(a->w, b->w, sizeof(a->w)) && s_same_value(&a->W.s, &b->W.s),
+          "%s: weights depend on the g / l split", what);
+    CHECK(!memcmp(a->ep, b->ep, sizeof(a->ep)) && s_same_value(&a->EP.s, &b->EP.s),
+          "%s: input error depends on the g / l split", what);
+}
+
+static void s_check(void) {
+    static s_layer_t a, b;
+
+    s_init(&a, 1, 0);
+    s_init(&b, 1, 8);
+    tt_backend.dense_train(&a.W, &a.X, &a.E, &a.EP, &a.G);
+    tt_backend.dense_train(&b.W, &b.X, &b.E, &b.EP, &b.G);
+    s_compare(&a, &b, "dense_train");
+
+    s_init(&a, 2, 0);
+    s_init(&b, 2, -8);
+    memset(a.acc, 0, sizeof(a.acc));
+    memset(b.acc, 0, sizeof(b.acc));
+    tt_backend.dense_grad(&a.W, &a.X, &a.E, &a.EP, a.acc);
+    tt_backend.dense_grad(&b.W, &b.X, &b.E, &b.EP, b.acc);
+    CHECK(!memcmp(a.acc, b.acc, sizeof(a.acc)), "dense_grad: sums depend on the g / l split");
+    tt_backend.dense_grad_pack(&a.W, a.acc, &a.G);
+    tt_backend.dense_grad_pack(&b.W, b.acc, &b.G);
+    tt_backend.dense_update(&a.W, &a.G, 1, 1, a.acc);
+    tt_backend.dense_update(&b.W, &b.G, 1, 1, b.acc);
+    s_compare(&a, &b, "dense_grad / dense_update");
+}
+
+#else
+static void s_check(void) {}
+#endif
+
+int main(void) {
+    s_check();
+    printf("test_dense_hdr: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file test_dp_trainer.c
+ * @brief data-parallel training is the minibatch step, sharded
+ * @details on a one-lane pool the trainer runs the whole batch as a single
+ * shard and must keep the SSE and weights (data and header) of
+ * tt_seq_model_train_batch, batch after batch. On a four-lane pool, with
+ * batches that leave lanes idle, two runs of the same model and data must
+ * give the same SSE and weights: the result cannot depend on which lane
+ * finishes first.
+ * @license MIT
+ */
+#include "tt_dp_trainer.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_IN        (24)
+#define T_HID       (16)
+#define T_OUT       (24)
+#define T_BATCH     (9)
+#define T_STEPS     (30)
+#define T_THREADS   (3)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static int8_t s_in[T_STEPS][T_BATCH * T_IN], s_tg[T_STEPS][T_BATCH * T_OUT];
+
+static int s_init(tt_seq_model_t *m, tt_layer_t *layers, void **arena) {
+    const tt_layer_desc_t d[2] = {
+        { .type = TT_LAYER_DENSE, .in = T_IN,  .out = T_HID, .act = TT_ACT_RELU,   .ops = &tt_backend },
+        { .type = TT_LAYER_DENSE, .in = T_HID, .out = T_OUT, .act = TT_ACT_LINEAR, .ops = &tt_backend },
+    };
+    size_t sz = tt_seq_model_arena_size(d, 2);
+    *arena = malloc(sz);
+    if (!*arena || tt_seq_model_init(m, layers, d, 2, *arena, sz) != 0) return -1;
+    tt_seq_model_randomize(m, 13, -40, 40);
+    return 0;
+}
+
+static int s_same_weights(const tt_layer_t *a, const tt_layer_t *b) {
+    for (size_t l = 0; l < 2; ++l)
+        if (memcmp(a[l].W.data, b[l].W.data, a[l].W.len) || memcmp(&a[l].W.s, &b[l].W.s, sizeof(a[l].W.s)))
+            return 0;
+    return 1;
+}
+
+/* batch sizes of step s: full, short and smaller than the lane count */
+static size_t s_batch(int s) {
+    return s % 3 == 0 ? T_BATCH : s % 3 == 1 ? T_BATCH - 2 : 2;
+}
+
+/* one lane: the trainer is tt_seq_model_train_batch */
+static void s_check_one_lane(void) {
+    tt_seq_model_t a, b;
+    tt_layer_t la[2], lb[2];
+    void *ara = NULL, *arb = NULL, *buf = NULL;
+    tt_pool_t pool;
+    tt_dp_trainer_t t;
+
+    if (s_init(&a, la, &ara) || s_init(&b, lb, &arb) || tt_pool_init(&pool, 0) != 0) {
+        CHECK(0, "one lane: setup");
+        goto out;
+    }
+    size_t bytes = tt_seq_model_batch_bytes(&a);
+    buf = bytes ? malloc(bytes) : NULL;
+    if (!buf || tt_dp_trainer_init(&t, &b, &pool) != 0) {
+        CHECK(0, "one lane: trainer init");
+        tt_pool_destroy(&pool);
+        goto out;
+    }
+    CHECK(t.n_workers == 1, "one lane: %zu workers", t.n_workers);
+    for (int s = 0; s < T_STEPS; ++s) {
+        size_t n = s_batch(s);
+        uint32_t ea = tt_seq_model_train_batch(&a, s_in[s], s_tg[s], n, buf, bytes);
+        uint32_t eb = tt_dp_train_batch(&t, s_in[s], s_tg[s], n);
+        CHECK(ea == eb, "one lane step %d: sse %u, trainer %u", s, ea, eb);
+        CHECK(s_same_weights(la, lb), "one lane step %d: weights differ from train_batch", s);
+    }
+    tt_dp_trainer_free(&t);
+    tt_pool_destroy(&pool);
+out:
+    free(buf);
+    free(ara);
+    free(arb);
+}
+
+/* many lanes: two runs agree step for step */
+static void s_check_lanes(void) {
+    tt_seq_model_t a, b;
+    tt_layer_t la[2], lb[2];
+    void *ara = NULL, *arb = NULL;
+    tt_pool_t pool;
+    tt_dp_trainer_t ta, tb;
+
+    if (s_init(&a, la, &ara) || s_init(&b, lb, &arb) || tt_pool_init(&pool, T_THREADS) != 0) {
+        CHECK(0, "lanes: setup");
+        goto out;
+    }
+    if (tt_dp_trainer_init(&ta, &a, &pool) != 0 || tt_dp_trainer_init(&tb, &b, &pool) != 0) {
+        CHECK(0, "lanes: trainer init");
+        tt_pool_destroy(&pool);
+        goto out;
+    }
+    CHECK(ta.n_workers == T_THREADS + 1, "lanes: %zu workers", ta.n_workers);
+    uint32_t first = 0, last = 0;
+    for (int s = 0; s < T_STEPS; ++s) {
+        size_t n = s_batch(s);
+        uint32_t ea = tt_dp_train_batch(&ta, s_in[s], s_tg[s], n);
+        uint32_t eb = tt_dp_train_batch(&tb, s_in[s], s_tg[s], n);
+        CHECK(ea == eb, "lanes step %d: sse %u, second run %u", s, ea, eb);
+        CHECK(s_same_weights(la, lb), "lanes step %d: weights differ between runs", s);
+        if (s == 0) first = ea;
+        if (s == T_STEPS - 3) last = ea;
+    }
+    CHECK(last < first, "lanes: sse %u after training, %u before", last, first);
+    tt_dp_trainer_free(&ta);
+    tt_dp_trainer_free(&tb);
+    tt_pool_destroy(&pool);
+out:
+    free(ara);
+    free(arb);
+}
+
+int main(void) {
+    uint32_t st;
+    prng_init(&st, 20250706u);
+    /* autoencoder data: the target is the input */
+    for (int s = 0; s < T_STEPS; ++s) {
+        for (size_t i = 0; i < sizeof(s_in[s]); ++i) s_in[s][i] = (int8_t)(prng_next(&st) % 100);
+        memcpy(s_tg[s], s_in[s], sizeof(s_tg[s]));
+    }
+    s_check_one_lane();
+    s_check_lanes();
+    printf("test_dp_trainer: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file test_kernels.c
+ * @brief differential test of the tile, group, conv1d, sparse and int4 kernels
+ * @details every level matrix_set_isa can reach on the running cpu (the
+ * scalar one included) is compared against the plain loops of the formulas
+ * in matrix_tile.h, matrix_group.h, matrix_conv1d.h, matrix_sparse.h and
+ * matrix_i4.h over random shapes. Inputs mix uniform values with runs of
+ * -128 and 127, the operands where the unsigned bias of vpdpbusd, the int16
+ * pairs of pmaddwd or a saturating step would show.
+ * @license MIT
+ */
+#include "matrix.h"
+#include "matrix_tile.h"
+#include "matrix_group.h"
+#include "matrix_conv1d.h"
+#include "matrix_sparse.h"
+#include "matrix_i4.h"
+#include "tt_cpu.h"
+#include "tt_math.h"
+#include "tt_utils.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_ROUNDS        (60)
+/* tile / sparse / int4 */
+#define T_MAX_ROWS      (70)
+#define T_MAX_COLS      (150)
+/* group */
+#define T_MAX_K         (20)
+#define T_MAX_OUT       (24)
+#define T_MAX_IN        (40)
+/* conv1d */
+#define T_MAX_CH        (6)
+#define T_MAX_TAPS      (5)
+#define T_MAX_L         (100)
+/* longest output, stride 1 with k = 1 and the widest padding */
+#define T_MAX_L_OUT     (T_MAX_L + 2 * 3)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static void s_fill(uint32_t *st, int8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        p[i] = (prng_next(st) & 3) == 0 ? ((prng_next(st) & 1) ? 127 : -128) : prng_rand_int8(st);
+}
+
+static void s_check_tile(const char *name, uint32_t *st) {
+    static int8_t  W[T_MAX_ROWS * T_MAX_COLS], W2[T_MAX_ROWS * T_MAX_COLS], x[T_MAX_COLS], e[T_MAX_ROWS];
+    static int8_t  Wt[MATRIX_TILE_LEN(T_MAX_ROWS, T_MAX_COLS)] __attribute__((aligned(64)));
+    static int32_t ref[T_MAX_ROWS], out[T_MAX_ROWS];
+    static int8_t  yref[T_MAX_COLS], yout[T_MAX_COLS];
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        size_t rows = 1 + prng_next(st) % T_MAX_ROWS, cols = 1 + prng_next(st) % T_MAX_COLS;
+        matrix_tile_t t;
+        CHECK(!matrix_tile_init(&t, rows, cols), "matrix_tile_init %zux%zu", rows, cols);
+        s_fill(st, W, rows * cols);
+        s_fill(st, x, cols);
+        s_fill(st, e, rows);
+        matrix_tile_pack(&t, W, Wt);
+        matrix_tile_unpack(&t, Wt, W2);
+        CHECK(!memcmp(W, W2, rows * cols), "matrix_tile_unpack %zux%zu", rows, cols);
+
+        for (size_t r = 0; r < rows; ++r) {
+            ref[r] = 0;
+            for (size_t c = 0; c < cols; ++c) ref[r] += (int32_t)W[r * cols + c] * x[c];
+        }
+        matrix_mul_tile(&t, Wt, x, out);
+        CHECK(!memcmp(ref, out, rows * sizeof(int32_t)), "%s matrix_mul_tile %zux%zu", name, rows, cols);
+
+        uint8_t shift = (uint8_t)(prng_next(st) % 15);
+        for (size_t c = 0; c < cols; ++c) {
+            int32_t sum = 0;
+            for (size_t r = 0; r < rows; ++r) sum += (int32_t)W[r * cols + c] * e[r];
+            yref[c] = clip_int8(shift_and_round32(sum, shift));
+        }
+        matrix_tmul_tile(&t, Wt, e, shift, yout);
+        CHECK(!memcmp(yref, yout, cols), "%s matrix_tmul_tile %zux%zu shift %u", name, rows, cols, shift);
+    }
+}
+
+static void s_check_grp(const char *name, uint32_t *st) {
+    static int8_t  W[T_MAX_K][T_MAX_OUT * T_MAX_IN], x[T_MAX_K][T_MAX_IN];
+    static int8_t  mem[MATRIX_GRP_W_BYTES(T_MAX_K, T_MAX_OUT, T_MAX_IN)] __attribute__((aligned(64)));
+    static int8_t  xg[MATRIX_GRP_X_BYTES(T_MAX_K, T_MAX_IN)] __attribute__((aligned(64)));
+    static int32_t ref[T_MAX_K * T_MAX_OUT], out[T_MAX_K * T_MAX_OUT];
+    const int8_t *xs[T_MAX_K];
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        size_t K = 1 + prng_next(st) % T_MAX_K, O = 1 + prng_next(st) % T_MAX_OUT, I = 1 + prng_next(st) % T_MAX_IN;
+        matrix_grp_t g;
+        CHECK(!matrix_grp_init(&g, mem, K, O, I), "matrix_grp_init %zu x %zux%zu", K, O, I);
+        for (size_t k = 0; k < K; ++k) {
+            s_fill(st, W[k], O * I);
+            s_fill(st, x[k], I);
+            matrix_grp_pack(&g, k, W[k]);
+            xs[k] = x[k];
+            for (size_t o = 0; o < O; ++o) {
+                int32_t sum = 0;
+                for (size_t i = 0; i < I; ++i) sum += (int32_t)W[k][o * I + i] * x[k][i];
+                ref[k * O + o] = sum;
+            }
+        }
+        matrix_grp_pack_x(&g, xs, xg);
+        matrix_mul_grp(&g, xg, out);
+        CHECK(!memcmp(ref, out, K * O * sizeof(int32_t)), "%s matrix_mul_grp %zu x %zux%zu", name, K, O, I);
+    }
+}
+
+static void s_check_conv1d(const char *name, uint32_t *st) {
+    static int8_t  W[T_MAX_CH * T_MAX_CH * T_MAX_TAPS], x[T_MAX_CH * T_MAX_L], e[T_MAX_CH * T_MAX_L_OUT];
+    static int8_t  xr[T_MAX_CH * (T_MAX_L + 7)];
+    static int32_t ref[T_MAX_CH * T_MAX_L_OUT], out[T_MAX_CH * T_MAX_L_OUT];
+    static int32_t dref[T_MAX_CH * T_MAX_L], dout[T_MAX_CH * T_MAX_L];
+    static int32_t wref[T_MAX_CH * T_MAX_CH * T_MAX_TAPS], wout[T_MAX_CH * T_MAX_CH * T_MAX_TAPS];
+    int32_t col[T_MAX_CH];
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        /* half the rounds at stride 1, where the sliding-window kernels run */
+        size_t ci_n = 1 + prng_next(st) % T_MAX_CH, co_n = 1 + prng_next(st) % T_MAX_CH;
+        size_t k = 1 + prng_next(st) % T_MAX_TAPS, dil = 1 + prng_next(st) % 3, pad = prng_next(st) % 4;
+        size_t stride = (round & 1) ? 1 + prng_next(st) % 3 : 1;
+        size_t l_in = dil * (k - 1) + 1 + prng_next(st) % (T_MAX_L - dil * (k - 1));
+        matrix_conv1d_t g;
+        if (matrix_conv1d_init(&g, ci_n, co_n, k, stride, dil, pad, l_in)) {
+            CHECK(0, "matrix_conv1d_init %zu -> %zu k %zu l_in %zu", ci_n, co_n, k, l_in);
+            continue;
+        }
+        size_t l_out = g.l_out;
+        s_fill(st, W, MATRIX_CONV1D_W_LEN(&g));
+        s_fill(st, x, MATRIX_CONV1D_IN_LEN(&g));
+        s_fill(st, e, MATRIX_CONV1D_OUT_LEN(&g));
+
+        memset(dref, 0, sizeof(dref));
+        memset(wref, 0, sizeof(wref));
+        for (size_t co = 0; co < co_n; ++co)
+            for (size_t t = 0; t < l_out; ++t) {
+                int32_t sum = 0;
+                for (size_t ci = 0; ci < ci_n; ++ci)
+                    for (size_t j = 0; j < k; ++j) {
+                        long p = (long)(t * stride + j * dil) - (long)pad;
+                        if (p < 0 || p >= (long)l_in) continue;
+                        int32_t w = W[(co * ci_n + ci) * k + j];
+                        sum += w * x[ci * l_in + p];
+                        dref[ci * l_in + p] += w * e[co * l_out + t];
+                        wref[(co * ci_n + ci) * k + j] += (int32_t)e[co * l_out + t] * x[ci * l_in + p];
+                    }
+                ref[co * l_out + t] = sum;
+            }
+
+        matrix_conv1d_fwd(&g, W, x, out);
+        CHECK(!memcmp(ref, out, co_n * l_out * sizeof(int32_t)),
+              "%s matrix_conv1d_fwd %zu->%zu k %zu s %zu d %zu p %zu l %zu", name, ci_n, co_n, k, stride, dil, pad, l_in);
+        matrix_conv1d_bwd(&g, W, e, dout);
+        CHECK(!memcmp(dref, dout, ci_n * l_in * sizeof(int32_t)),
+              "%s matrix_conv1d_bwd %zu->%zu k %zu s %zu d %zu p %zu l %zu", name, ci_n, co_n, k, stride, dil, pad, l_in);
+        matrix_conv1d_wgrad(&g, e, x, wout);
+        CHECK(!memcmp(wref, wout, MATRIX_CONV1D_W_LEN(&g) * sizeof(int32_t)),
+              "%s matrix_conv1d_wgrad %zu->%zu k %zu s %zu d %zu p %zu l %zu", name, ci_n, co_n, k, stride, dil, pad, l_in);
+
+        /* one column from rows a few bytes further apart than l_in */
+        size_t xs = l_in + prng_next(st) % 8, t = prng_next(st) % l_out;
+        for (size_t ci = 0; ci < ci_n; ++ci) memcpy(xr + ci * xs, x + ci * l_in, l_in);
+        matrix_conv1d_col(&g, W, xr, xs, t, col);
+        int ok = 1;
+        for (size_t co = 0; co < co_n; ++co) ok &= col[co] == ref[co * l_out + t];
+        CHECK(ok, "%s matrix_conv1d_col %zu->%zu k %zu t %zu", name, ci_n, co_n, k, t);
+    }
+}
+
+static void s_check_sp(const char *name, uint32_t *st) {
+    static int8_t  W[T_MAX_ROWS * T_MAX_COLS], x[T_MAX_COLS];
+    static int8_t  mem[MATRIX_SP_BYTES(T_MAX_ROWS, T_MAX_COLS)] __attribute__((aligned(64)));
+    static int32_t ref[T_MAX_ROWS], out[T_MAX_ROWS];
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        size_t rows = 1 + prng_next(st) % T_MAX_ROWS, cols = 1 + prng_next(st) % T_MAX_COLS;
+        matrix_sp_t sp;
+        CHECK(!matrix_sp_init(&sp, mem, rows, cols), "matrix_sp_init %zux%zu", rows, cols);
+        s_fill(st, W, rows * cols);
+        s_fill(st, x, cols);
+        /* drop about half of the blocks */
+        for (size_t br = 0; br < MATRIX_SP_NBR(rows); ++br)
+            for (size_t bc = 0; bc < MATRIX_SP_NBC(cols); ++bc) {
+                if (prng_next(st) & 1) continue;
+                for (size_t r = br * MATRIX_SP_BR; r < rows && r < (br + 1) * MATRIX_SP_BR; ++r)
+                    for (size_t c = bc * MATRIX_SP_BC; c < cols && c < (bc + 1) * MATRIX_SP_BC; ++c)
+                        W[r * cols + c] = 0;
+            }
+        for (size_t r = 0; r < rows; ++r) {
+            ref[r] = 0;
+            for (size_t c = 0; c < cols; ++c) ref[r] += (int32_t)W[r * cols + c] * x[c];
+        }
+        matrix_sp_build(&sp, W);
+        matrix_mul_sp(&sp, x, out);
+        CHECK(!memcmp(ref, out, rows * sizeof(int32_t)), "%s matrix_mul_sp %zux%zu kept %zu",
+              name, rows, cols, matrix_sp_kept(&sp));
+    }
+}
+
+static void s_check_i4(const char *name, uint32_t *st) {
+    static int8_t  W[T_MAX_ROWS * T_MAX_COLS], Q[T_MAX_ROWS * T_MAX_COLS], x[T_MAX_COLS];
+    static uint8_t W4[T_MAX_ROWS * MATRIX_I4_ROW_BYTES(T_MAX_COLS)];
+    static int32_t ref[T_MAX_ROWS], out[T_MAX_ROWS];
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        size_t rows = 1 + prng_next(st) % T_MAX_ROWS, cols = 1 + prng_next(st) % T_MAX_COLS;
+        s_fill(st, W, rows * cols);
+        s_fill(st, x, cols);
+        /* k = 0 leaves nibbles clipped to -8 / 7 */
+        uint8_t k = (round & 1) ? matrix_i4_shift(W, rows * cols) : 0;
+        matrix_i4_pack(W4, W, rows, cols, k);
+        matrix_i4_unpack(Q, W4, rows, cols);
+        for (size_t r = 0; r < rows; ++r) {
+            ref[r] = 0;
+            for (size_t c = 0; c < cols; ++c) ref[r] += (int32_t)Q[r * cols + c] * x[c];
+        }
+        tensor_t tx = { .data = x, .len = cols };
+        matrix_mul_i4(W4, rows, &tx, out);
+        CHECK(!memcmp(ref, out, rows * sizeof(int32_t)), "%s matrix_mul_i4 %zux%zu k %u", name, rows, cols, k);
+    }
+}
+
+int main(void) {
+    uint32_t st;
+    prng_init(&st, 20250613u);
+    int levels = 0;
+    for (int isa = TT_ISA_SCALAR; isa <= TT_ISA_NEON_DOT; ++isa) {
+        if (matrix_set_isa((tt_isa_t)isa) != (tt_isa_t)isa) continue;
+        const char *name = tt_cpu_isa_name((tt_isa_t)isa);
+        s_check_tile(name, &st);
+        s_check_grp(name, &st);
+        s_check_conv1d(name, &st);
+        s_check_sp(name, &st);
+        s_check_i4(name, &st);
+        ++levels;
+    }
+    matrix_set_isa(tt_cpu_isa());
+    printf("test_kernels: %d levels, %d failures\n", levels, s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_math.c
+ * @brief exhaustive test of the closed-form alignment of tt_math.h
+ * @details every int8 input against every delta dS in [-12, 8] and dU, dD
+ * in [0, 40): clip_int8(tt_mult_apply(x, tt_align_mult(dS, dU, dD))) must
+ * be the exact rational x * 2^dS * (21/16)^dU * (3/4)^dD rounded half away
+ * from zero and clipped, the exact value held in a 256-bit integer. The
+ * same inputs then run through iterated upscale_4_3 / downscale_4_5 steps
+ * and the differences documented in tt_math.h are checked as maxima.
+ * @license MIT
+ */
+#include "tt_math.h"
+#include "tt_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define T_LIMBS     (8)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+/* v *= f, little-endian 32-bit limbs */
+static void s_big_mul(uint32_t *v, uint32_t f) {
+    uint64_t carry = 0;
+    for (int i = 0; i < T_LIMBS; ++i) {
+        uint64_t p = (uint64_t)v[i] * f + carry;
+        v[i]  = (uint32_t)p;
+        carry = p >> 32;
+    }
+    if (carry) { printf("256-bit overflow\n"); exit(2); }
+}
+
+static int s_big_bit(const uint32_t *v, int i) {
+    return i >= 0 && i < 32 * T_LIMBS ? (int)((v[i / 32] >> (i % 32)) & 1u) : 0;
+}
+
+/* min(255, round(v / 2^s)), round half up */
+static int s_big_round(const uint32_t *v, int s) {
+    for (int i = 32 * T_LIMBS - 1; i >= s + 8; --i)
+        if (s_big_bit(v, i)) return 255;
+    int q = 0;
+    for (int i = 7; i >= 0; --i) q = (q << 1) | s_big_bit(v, s + i);
+    return q + (s > 0 ? s_big_bit(v, s - 1) : 0);
+}
+
+/* clip_int8 of x * 2^dS * 21^dU / 16^dU * 3^dD / 4^dD, rounded half away from zero */
+static int8_t s_exact(int8_t x, int dS, int dU, int dD) {
+    uint32_t v[T_LIMBS] = { (uint32_t)abs(x) };
+    for (int i = 0; i < dU; ++i) s_big_mul(v, 21);
+    for (int i = 0; i < dD; ++i) s_big_mul(v, 3);
+    int q = s_big_round(v, 4 * dU + 2 * dD - dS);
+    return clip_int8(x < 0 ? -q : q);
+}
+
+static int8_t s_closed(int8_t x, int dS, int dU, int dD) {
+    return clip_int8(tt_mult_apply(x, tt_align_mult((int8_t)dS, (uint8_t)dU, (uint8_t)dD)));
+}
+
+static void s_check_exact(void) {
+    for (int dS = -12; dS <= 8; ++dS)
+        for (int dU = 0; dU < 40; ++dU)
+            for (int dD = 0; dD < 40; ++dD)
+                for (int x = -128; x <= 127; ++x) {
+                    int8_t ref = s_exact((int8_t)x, dS, dU, dD), out = s_closed((int8_t)x, dS, dU, dD);
+                    CHECK(ref == out, "x %d dS %d dU %d dD %d: closed form %d, exact %d", x, dS, dU, dD, out, ref);
+                }
+}
+
+static void s_check_iterated(void) {
+    /* max |closed - iterated| over all int8 inputs, k upscale steps */
+    static const int up_max[7] = { 0, 2, 4, 6, 8, 11, 16 };
+    for (int k = 1; k <= 6; ++k) {
+        int worst = 0;
+        for (int x = -128; x <= 127; ++x) {
+            int8_t it = (int8_t)x;
+            for (int i = 0; i < k; ++i) it = upscale_4_3(it);
+            int d = abs(s_closed((int8_t)x, 0, k, 0) - it);
+            worst = d > worst ? d : worst;
+        }
+        CHECK(worst == up_max[k], "upscale k %d: max difference %d, documented %d", k, worst, up_max[k]);
+    }
+    for (int k = 1; k < 40; ++k) {
+        int worst = 0;
+        for (int x = -128; x <= 127; ++x) {
+            int8_t it = (int8_t)x;
+            for (int i = 0; i < k; ++i) it = downscale_4_5(it);
+            int d = abs(s_closed((int8_t)x, 0, 0, k) - it);
+            worst = d > worst ? d : worst;
+        }
+        CHECK(worst == (k <= 2 ? 1 : k <= 6 ? 2 : 3), "downscale k %d: max difference %d", k, worst);
+    }
+
+    /* the corner cases named in the header */
+    int8_t up = 1, um = -1, dp = 1, dm = -1;
+    for (int k = 1; k <= 3; ++k) {
+        up = upscale_4_3(up);
+        um = upscale_4_3(um);
+    }
+    CHECK(up == 1 && um == -8, "iterated upscale of +1 / -1: %d %d", up, um);
+    for (int k = 1; k <= 39; ++k) {
+        dp = downscale_4_5(dp);
+        dm = downscale_4_5(dm);
+    }
+    CHECK(dp == 1 && dm == 0, "iterated downscale of +1 / -1: %d %d", dp, dm);
+    CHECK(s_closed(1, 0, 0, 3) == 0 && s_closed(-1, 0, 0, 3) == 0, "closed downscale of +1 / -1");
+    CHECK(shift_and_round32(-1, 2) == 0 && s_closed(-1, -2, 0, 0) == 0, "negative right shift");
+    for (int k = 1; k <= 8; ++k)
+        for (int x = -300; x <= 300; ++x)
+            CHECK(shift_and_round32(-x, (uint8_t)k) == -shift_and_round32(x, (uint8_t)k),
+                  "shift_and_round32 not symmetric at %d, k %d", x, k);
+    CHECK(s_closed(100, 1, 0, 0) == 127, "closed left shift saturates");
+
+    /* exactness holds after the clip only: int32 results past the int8
+     * range keep growing where every iterated step clips */
+    tt_mult_t m = tt_align_mult(0, 1, 0);
+    CHECK(tt_mult_apply(127, m) == 167 && upscale_4_3(127) == 127 && s_closed(127, 0, 1, 0) == 127,
+          "int32 closed form of 127 * 21/16: %d", tt_mult_apply(127, m));
+}
+
+int main(void) {
+    s_check_exact();
+    s_check_iterated();
+    printf("test_math: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
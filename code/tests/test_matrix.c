@@ -0,0 +1,171 @@
+/**
+ * @file test_matrix.c
+ * @brief differential test of the dispatched int8 kernels of matrix.h
+ * @details every level matrix_set_isa can reach on the running cpu is
+ * compared against matrix_mul_ref (and a column-loop reference of the
+ * transposed product) over random shapes, for matrix_dot, matrix_mul,
+ * matrix_mul_acc, matrix_mul_batch, matrix_mul_batch_acc and matrix_tmul.
+ * Inputs mix uniform values with runs of -128 and 127, and whole -128 /
+ * 127 matrices, the cases where a saturating or int16 path would differ.
+ * A last pass switches levels from a second thread while the first keeps
+ * multiplying, every result must still match.
+ * @license MIT
+ */
+#include "matrix.h"
+#include "tt_cpu.h"
+#include "tt_math.h"
+#include "tt_utils.h"
+#include "prng.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_MAX_ROWS  (70)
+#define T_MAX_COLS  (300)
+#define T_MAX_N     (5)
+#define T_ROUNDS    (60)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+/* mode 0 uniform, 1 uniform with -128 / 127 runs, 2 all -128, 3 all 127 */
+static void s_fill(uint32_t *st, int8_t *p, size_t n, int mode, int8_t lim) {
+    for (size_t i = 0; i < n; ++i) {
+        switch (mode) {
+        case 2:  p[i] = -128; break;
+        case 3:  p[i] = 127;  break;
+        case 1:  if ((prng_next(st) & 3) == 0) { p[i] = (prng_next(st) & 1) ? 127 : -128; break; }
+                 /* fall through */
+        default: p[i] = prng_rand_int8(st); break;
+        }
+        if (lim < 127) p[i] = p[i] > lim ? lim : (p[i] < -lim ? (int8_t)-lim : p[i]);
+    }
+}
+
+static void s_tmul_ref(const int8_t *W, const int8_t *e, int8_t *y, size_t rows, size_t cols, uint8_t shift) {
+    for (size_t c = 0; c < cols; ++c) {
+        int32_t sum = 0;
+        for (size_t r = 0; r < rows; ++r) sum += (int32_t)W[r * cols + c] * e[r];
+        y[c] = clip_int8(shift_and_round32(sum, shift));
+    }
+}
+
+static void s_check_level(tt_isa_t isa, uint32_t *st) {
+    static int8_t  W[T_MAX_ROWS * T_MAX_COLS], X[T_MAX_N * T_MAX_COLS], E[T_MAX_ROWS];
+    static int32_t ref[T_MAX_N * T_MAX_ROWS], out[T_MAX_N * T_MAX_ROWS];
+    static int8_t  yref[T_MAX_COLS], yout[T_MAX_COLS];
+    const char *name = tt_cpu_isa_name(isa);
+
+    for (int round = 0; round < T_ROUNDS; ++round) {
+        size_t rows = 1 + prng_next(st) % T_MAX_ROWS;
+        size_t cols = 1 + prng_next(st) % T_MAX_COLS;
+        size_t N    = 1 + prng_next(st) % T_MAX_N;
+        int    mode = round < 4 ? 2 + (round & 1) : (int)(prng_next(st) % 2);
+        /* weights bounded to bit-width 3, 5, 7 (int16 kernels) or full range */
+        static const int8_t lims[4] = { 7, 31, 127, 127 };
+        int8_t lim  = lims[prng_next(st) % 4];
+
+        s_fill(st, W, rows * cols, mode, lim);
+        s_fill(st, X, N * cols, mode, 127);
+        s_fill(st, E, rows, mode, 127);
+
+        tensor_t tw = { .data = W, .len = rows * cols };
+        tensor_t tx = { .data = X, .len = cols };
+        tensor_t tb = { .data = X, .len = N * cols };
+        tensor_t te = { .data = E, .len = rows };
+        tensor_t ty = { .data = yout, .len = cols };
+
+        int32_t maxw = 0;
+        for (size_t i = 0; i < rows * cols; ++i) maxw = abs(W[i]) > maxw ? abs(W[i]) : maxw;
+        matrix_acc_t plan;
+        matrix_acc_plan(&plan, cols, eff_bitwidth32(maxw));
+
+        /* single sample */
+        matrix_mul_ref(&tw, &tx, ref);
+        matrix_mul(&tw, &tx, out);
+        CHECK(!memcmp(ref, out, rows * sizeof(int32_t)), "%s matrix_mul %zux%zu", name, rows, cols);
+        memset(out, 0, sizeof(out));
+        matrix_mul_acc(&tw, &tx, &plan, out);
+        CHECK(!memcmp(ref, out, rows * sizeof(int32_t)), "%s matrix_mul_acc %zux%zu spill %u",
+              name, rows, cols, plan.spill);
+        CHECK(matrix_dot(W, X, cols) == ref[0], "%s matrix_dot %zu", name, cols);
+
+        /* batch, each row of X against the reference */
+        for (size_t n = 0; n < N; ++n) {
+            tensor_t xn = { .data = X + n * cols, .len = cols };
+            matrix_mul_ref(&tw, &xn, ref + n * rows);
+        }
+        memset(out, 0, sizeof(out));
+        matrix_mul_batch(&tw, &tb, N, out);
+        CHECK(!memcmp(ref, out, N * rows * sizeof(int32_t)), "%s matrix_mul_batch %zux%zu N %zu",
+              name, rows, cols, N);
+        memset(out, 0, sizeof(out));
+        matrix_mul_batch_acc(&tw, &tb, N, &plan, out);
+        CHECK(!memcmp(ref, out, N * rows * sizeof(int32_t)), "%s matrix_mul_batch_acc %zux%zu N %zu",
+              name, rows, cols, N);
+
+        /* transposed, backprop shift and a spread of others */
+        for (uint8_t shift = 0; shift <= 14; shift += 7) {
+            s_tmul_ref(W, E, yref, rows, cols, shift);
+            matrix_tmul(&tw, &te, shift, &ty);
+            CHECK(!memcmp(yref, yout, cols), "%s matrix_tmul %zux%zu shift %u", name, rows, cols, shift);
+        }
+    }
+}
+
+/* flips between every reachable level until told to stop */
+static volatile int s_stop = 0;
+
+static void *s_flip(void *arg) {
+    (void)arg;
+    for (unsigned i = 0; !s_stop; ++i) matrix_set_isa((tt_isa_t)(i % (TT_ISA_NEON_DOT + 1)));
+    return NULL;
+}
+
+static void s_check_concurrent(uint32_t *st) {
+    enum { R = 33, C = 100 };
+    static int8_t W[R * C], X[C];
+    int32_t ref[R], out[R];
+    s_fill(st, W, R * C, 0, 31);
+    s_fill(st, X, C, 1, 127);
+    tensor_t tw = { .data = W, .len = R * C }, tx = { .data = X, .len = C };
+    matrix_acc_t plan;
+    matrix_acc_plan(&plan, C, 5);
+    matrix_mul_ref(&tw, &tx, ref);
+
+    pthread_t th;
+    if (pthread_create(&th, NULL, s_flip, NULL)) return;
+    int bad = 0;
+    for (int i = 0; i < 20000; ++i) {
+        matrix_mul_acc(&tw, &tx, &plan, out);
+        bad += memcmp(ref, out, sizeof(ref)) != 0;
+    }
+    s_stop = 1;
+    pthread_join(th, NULL);
+    CHECK(!bad, "matrix_mul_acc while switching levels: %d wrong results", bad);
+}
+
+int main(void) {
+    uint32_t st;
+    prng_init(&st, 20250507u);
+    int levels = 0;
+    for (int isa = TT_ISA_SCALAR; isa <= TT_ISA_NEON_DOT; ++isa) {
+        if (matrix_set_isa((tt_isa_t)isa) != (tt_isa_t)isa) continue;
+        CHECK(matrix_isa() == (tt_isa_t)isa, "matrix_isa after forcing %s", tt_cpu_isa_name((tt_isa_t)isa));
+        s_check_level((tt_isa_t)isa, &st);
+        ++levels;
+    }
+    s_check_concurrent(&st);
+    matrix_set_isa(tt_cpu_isa());
+    printf("test_matrix: %d levels, %d failures\n", levels, s_fail);
+    return s_fail ? 1 : 0;
+}
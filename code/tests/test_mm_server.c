@@ -0,0 +1,121 @@
+/**
+ * @file test_mm_server.c
+ * @brief the stream front-end serves every whole request it was sent
+ * @details two models, inputs of 24 and 8, and a batch cap of 4: the
+ * buffer is sized for 4 requests of 24, so 9 requests of 8 fit in one
+ * read. All 9 must be answered in order, with the SSE that
+ * tt_seq_model_forward gives, before the end of file is seen; a partial
+ * request at the end of the file is reported after the whole ones ran.
+ * @license MIT
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "tt_mm_server.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define T_CAP       (4)
+#define T_REQS      (9)
+#define T_SHORT     (8)
+#define T_LONG      (24)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+/* one dense autoencoder layer of width n */
+static int s_model(tt_seq_model_t *m, tt_layer_t *layer, void **arena, uint16_t n, uint32_t seed) {
+    const tt_layer_desc_t d = { .type = TT_LAYER_DENSE, .in = n, .out = n, .act = TT_ACT_LINEAR, .ops = &tt_backend };
+    size_t sz = tt_seq_model_arena_size(&d, 1);
+    *arena = malloc(sz);
+    if (!*arena || tt_seq_model_init(m, layer, &d, 1, *arena, sz) != 0) return -1;
+    tt_seq_model_randomize(m, seed, -40, 40);
+    return 0;
+}
+
+/* sse of one input as tt_mm_server scores it */
+static uint32_t s_sse(tt_seq_model_t *m, const int8_t *in) {
+    const tensor_t *y = tt_seq_model_forward(m, in);
+    uint32_t s = 0;
+    for (size_t i = 0; i < y->len; ++i) {
+        int16_t d = (int16_t)m->input.data[i] - y->data[i];
+        s += (uint32_t)(d * d);
+    }
+    return s;
+}
+
+/* writes T_REQS requests of model 1 (+ trunc bytes of a tenth) to a pipe, serves it */
+static void s_check(tt_mm_server_t *srv, tt_seq_model_t *ref, size_t trunc, uint32_t *st) {
+    int in_p[2], out_p[2];
+    if (pipe(in_p) || pipe(out_p)) { CHECK(0, "pipe"); return; }
+
+    static int8_t x[T_REQS + 1][T_SHORT];
+    uint8_t rec[sizeof(tt_mm_wire_req_t) + T_SHORT];
+    for (uint32_t i = 0; i <= T_REQS; ++i) {
+        for (size_t j = 0; j < T_SHORT; ++j) x[i][j] = prng_rand_int8(st);
+        tt_mm_wire_req_t h = { .model = 1, .tag = 100 + i, .len = T_SHORT };
+        memcpy(rec, &h, sizeof(h));
+        memcpy(rec + sizeof(h), x[i], T_SHORT);
+        size_t len = i < T_REQS ? sizeof(rec) : trunc;
+        if (len && write(in_p[1], rec, len) != (ssize_t)len) CHECK(0, "write request %u", i);
+    }
+    close(in_p[1]);
+
+    int rc = tt_mm_server_serve_fd(srv, in_p[0], out_p[1]);
+    close(in_p[0]);
+    close(out_p[1]);
+    CHECK(rc == (trunc ? -1 : 0), "truncated tail %zu: rc %d", trunc, rc);
+
+    tt_mm_wire_resp_t resp[T_REQS + 1];
+    size_t got = 0;
+    ssize_t r;
+    while (got < sizeof(resp) && (r = read(out_p[0], (uint8_t *)resp + got, sizeof(resp) - got)) > 0)
+        got += (size_t)r;
+    close(out_p[0]);
+    CHECK(got == T_REQS * sizeof(resp[0]), "truncated tail %zu: %zu of %d responses",
+          trunc, got / sizeof(resp[0]), T_REQS);
+    for (size_t i = 0; i < got / sizeof(resp[0]); ++i)
+        CHECK(resp[i].model == 1 && resp[i].tag == 100 + i && resp[i].status == 0 &&
+              resp[i].sse == s_sse(ref, x[i]), "response %zu: tag %u status %d", i, resp[i].tag, resp[i].status);
+}
+
+int main(void) {
+    tt_seq_model_t m[2];
+    tt_layer_t l[2];
+    void *arena[2] = { NULL, NULL };
+    tt_pool_t pool;
+    tt_mm_server_t srv;
+    uint32_t st;
+    prng_init(&st, 20250702u);
+
+    if (s_model(&m[0], &l[0], &arena[0], T_LONG, 1) || s_model(&m[1], &l[1], &arena[1], T_SHORT, 2) ||
+        tt_pool_init(&pool, 2) != 0) {
+        printf("test_mm_server: setup failed\n");
+        return 1;
+    }
+    tt_seq_model_t *const models[2] = { &m[0], &m[1] };
+    if (tt_mm_server_init(&srv, models, 2, &pool, T_CAP) != 0) {
+        printf("test_mm_server: server init failed\n");
+        return 1;
+    }
+
+    s_check(&srv, &m[1], 0, &st);
+    s_check(&srv, &m[1], 5, &st);
+    s_check(&srv, &m[1], sizeof(tt_mm_wire_req_t) + 3, &st);
+
+    tt_mm_server_free(&srv);
+    tt_pool_destroy(&pool);
+    free(arena[0]);
+    free(arena[1]);
+    printf("test_mm_server: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
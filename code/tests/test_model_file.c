@@ -0,0 +1,184 @@
+/**
+ * @file test_model_file.c
+ * @brief model files round-trip without copies and reject damaged layouts
+ * @details an int8 and an int4 model with nonzero W and input headers are
+ * saved, opened and bound: every bound W must point into the mapping at
+ * its payload offset, carry the saved header and give the forward output
+ * of the model it was saved from. Copies of the int8 file with one field
+ * broken (length, magic, alignment of the table or a payload, w_bytes,
+ * in / out of a layer, a broken layer chain) must fail to open, and an
+ * int8 file must not bind on a 4-bit backend.
+ * @license MIT
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "tt_model_file.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define T_IN        (24)
+#define T_HID       (20)
+#define T_OUT       (12)
+#define T_RUNS      (16)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+/* header of value (S, U, D), one count of each in the global part when nested */
+static void s_set_hdr(scale_t *s, int8_t S, int8_t U, int8_t D) {
+#ifdef TENSOR_USE_NESTED
+    s->g.S = 1; s->g.U = 1; s->g.D = 1;
+    s->l.S = (int8_t)(S - 1); s->l.U = (int8_t)(U - 1); s->l.D = (int8_t)(D - 1);
+#else
+    s->S = S; s->U = U; s->D = D;
+#endif
+}
+
+static int s_model(tt_seq_model_t *m, tt_layer_t *layers, void **arena, const TensorBackend_t *ops) {
+    const tt_layer_desc_t d[2] = {
+        { .type = TT_LAYER_DENSE, .in = T_IN,  .out = T_HID, .act = TT_ACT_RELU,   .ops = ops },
+        { .type = TT_LAYER_DENSE, .in = T_HID, .out = T_OUT, .act = TT_ACT_LINEAR, .ops = ops },
+    };
+    size_t sz = tt_seq_model_arena_size(d, 2);
+    *arena = malloc(sz);
+    if (!*arena || tt_seq_model_init(m, layers, d, 2, *arena, sz) != 0) return -1;
+    tt_seq_model_randomize(m, 7, -50, 50);
+    s_set_hdr(&layers[0].W.s, 6, 1, 2);
+    s_set_hdr(&layers[1].W.s, 5, 2, 1);
+    s_set_hdr(&m->input.s, 7, 1, 1);
+    return 0;
+}
+
+/* save, open, bind; the bound model must be the saved one, in place */
+static void s_check_round_trip(const char *path, const TensorBackend_t *ops, const char *name, uint32_t *st) {
+    tt_seq_model_t a, b;
+    tt_layer_t la[2], lb[2];
+    void *ara = NULL, *arb = NULL;
+    tt_model_file_t f;
+
+    if (s_model(&a, la, &ara, ops) != 0) { CHECK(0, "%s: model init", name); free(ara); return; }
+    CHECK(tt_model_file_save(path, &a) == 0, "%s: save", name);
+    if (tt_model_file_open(&f, path) != 0) { CHECK(0, "%s: open", name); free(ara); return; }
+
+    size_t sz = tt_model_file_arena_size(&f, ops);
+    arb = sz ? malloc(sz) : NULL;
+    if (!arb || tt_model_file_bind(&f, &b, lb, ops, arb, sz) != 0) {
+        CHECK(0, "%s: bind", name);
+        goto out;
+    }
+    CHECK(sz < a.arena_size, "%s: bind arena %zu holds the weights (%zu)", name, sz, a.arena_size);
+    for (size_t l = 0; l < 2; ++l) {
+        const tt_mf_layer_t *e = &f.table[l];
+        CHECK(lb[l].W.data == (int8_t *)(f.map + e->w_off), "%s: layer %zu weights copied", name, l);
+        CHECK(!memcmp(la[l].W.data, lb[l].W.data, (size_t)e->w_bytes), "%s: layer %zu payload differs", name, l);
+        CHECK(!memcmp(&la[l].W.s, &lb[l].W.s, sizeof(la[l].W.s)), "%s: layer %zu W header differs", name, l);
+    }
+    CHECK(!memcmp(&a.input.s, &b.input.s, sizeof(a.input.s)), "%s: input header differs", name);
+
+    static int8_t in[T_IN];
+    for (int r = 0; r < T_RUNS; ++r) {
+        for (size_t i = 0; i < T_IN; ++i) in[i] = prng_rand_int8(st);
+        const tensor_t *ya = tt_seq_model_forward(&a, in), *yb = tt_seq_model_forward(&b, in);
+        CHECK(ya->len == yb->len && !memcmp(ya->data, yb->data, ya->len) && !memcmp(&ya->s, &yb->s, sizeof(ya->s)),
+              "%s: run %d: bound model output differs", name, r);
+    }
+out:
+    tt_model_file_close(&f);
+    free(ara);
+    free(arb);
+}
+
+static int s_write(const char *path, const uint8_t *buf, size_t n) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return -1;
+    int rc = fwrite(buf, 1, n, fp) == n ? 0 : -1;
+    return fclose(fp) == 0 ? rc : -1;
+}
+
+/* a copy of the file with one field broken must not open */
+static void s_check_rejects(const char *path, const char *bad) {
+    tt_seq_model_t a;
+    tt_layer_t la[2];
+    void *ara = NULL;
+    tt_model_file_t f;
+
+    if (s_model(&a, la, &ara, &tt_backend) != 0 || tt_model_file_save(path, &a) != 0) {
+        CHECK(0, "reject: model init / save");
+        free(ara);
+        return;
+    }
+    free(ara);
+
+    FILE *fp = fopen(path, "rb");
+    static uint8_t good[16384], buf[16384];
+    size_t n = fp ? fread(good, 1, sizeof(good), fp) : 0;
+    if (fp) fclose(fp);
+    if (n < 256 || n == sizeof(good)) { CHECK(0, "reject: read back %zu bytes", n); return; }
+
+    const tt_mf_header_t *h0 = (const tt_mf_header_t *)good;
+    tt_mf_header_t *h = (tt_mf_header_t *)buf;
+    tt_mf_layer_t  *t = (tt_mf_layer_t *)(buf + h0->table_off);
+    CHECK(tt_model_file_open(&f, path) == 0, "reject: the good file does not open");
+    tt_model_file_close(&f);
+
+    for (int c = 0; c < 11; ++c) {
+        size_t len = n;
+        memcpy(buf, good, n);
+        switch (c) {
+        case 0:  len = n - 1;                                       break;   /* truncated payload */
+        case 1:  len = sizeof(tt_mf_header_t) + 8;                  break;   /* truncated table */
+        case 2:  len = sizeof(tt_mf_header_t) - 1;                  break;   /* truncated header */
+        case 3:  h->magic[0] = 'X';                                 break;
+        case 4:  h->version = TT_MF_VERSION + 1;                    break;
+        case 5:  h->table_off += 8;                                 break;   /* misaligned table */
+        case 6:  t[1].w_off += 1;                                   break;   /* misaligned payload */
+        case 7:  t[0].w_bytes -= 1;                                 break;
+        case 8:  t[1].in += 1;                                      break;   /* in / w_bytes mismatch */
+        case 9:  t[1].out -= 1;                                     break;   /* out / w_bytes mismatch */
+        default: t[0].out += 1; t[0].w_bytes += t[0].in;            break;   /* chain broken, bytes agree */
+        }
+        if (s_write(bad, buf, len) != 0) { CHECK(0, "reject %d: write", c); continue; }
+        int rc = tt_model_file_open(&f, bad);
+        CHECK(rc != 0, "damaged file %d opened", c);
+        if (rc == 0) tt_model_file_close(&f);
+    }
+
+    /* an int8 payload is not what the 4-bit backend keeps in W */
+    if (tt_model_file_open(&f, path) != 0) { CHECK(0, "reject: reopen"); return; }
+    tt_layer_desc_t d[2];
+    CHECK(tt_model_file_descs(&f, &tt_i4_backend, d, 2) == 0 && tt_model_file_arena_size(&f, &tt_i4_backend) == 0,
+          "int8 file fits the 4-bit backend");
+    tt_model_file_close(&f);
+}
+
+int main(void) {
+    char path[] = "/tmp/test_model_file_XXXXXX", bad[] = "/tmp/test_model_file_XXXXXX";
+    int fd = mkstemp(path), fb = mkstemp(bad);
+    if (fd < 0 || fb < 0) {
+        printf("test_model_file: no temporary file\n");
+        return 1;
+    }
+    close(fd);
+    close(fb);
+
+    uint32_t st;
+    prng_init(&st, 20250703u);
+    s_check_round_trip(path, &tt_backend, "int8", &st);
+    s_check_round_trip(path, &tt_i4_backend, "int4", &st);
+    s_check_rejects(path, bad);
+
+    unlink(path);
+    unlink(bad);
+    printf("test_model_file: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file test_profile.c
+ * @brief the profiling wrapper changes the counters and nothing else
+ * @details a profiled and a plain copy of the same model train side by
+ * side (single steps and minibatches) and must keep identical outputs and
+ * weights while the profile counts the calls. The wrapper table of every
+ * backend must carry exactly the slots and storage flags of the backend,
+ * so a profiled Conv1D model still reports that it cannot train in
+ * minibatches, and a call on weights that were never registered must run
+ * unaccounted instead of being dropped.
+ * @license MIT
+ */
+#include "tt_seq_model.h"
+#include "tt_profile.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_IN        (24)
+#define T_HID       (20)
+#define T_OUT       (24)
+#define T_BATCH     (8)
+#define T_STEPS     (40)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static void s_check_tables(void) {
+    const struct { const char *name; const TensorBackend_t *ops; } be[] = {
+        { "tt",        &tt_backend },
+        { "i4",        &tt_i4_backend },
+        { "sparse",    &tt_sparse_backend },
+        { "conv1d",    &tt_conv1d_backend },
+        { "tiled",     &tt_tiled_backend },
+#ifdef TENSOR_USE_NESTED
+        { "nested",        &nested_backend },
+        { "nested_conv1d", &nested_conv1d_backend },
+        { "nested_tiled",  &nested_tiled_backend },
+#endif
+    };
+    for (size_t b = 0; b < sizeof(be) / sizeof(be[0]); ++b) {
+        const TensorBackend_t *in = be[b].ops, *w = tt_profile_wrap(in);
+        CHECK(w && w != in, "%s: no wrapper", be[b].name);
+        if (!w) continue;
+        CHECK(tt_profile_wrap(in) == w && tt_profile_wrap(w) == w, "%s: wrapper not reused", be[b].name);
+        CHECK(!w->dense_forward       == !in->dense_forward &&
+              !w->dense_forward_batch == !in->dense_forward_batch &&
+              !w->dense_train         == !in->dense_train &&
+              !w->dense_grad          == !in->dense_grad &&
+              !w->dense_grad_pack     == !in->dense_grad_pack &&
+              !w->dense_update        == !in->dense_update,
+              "%s: wrapper slots differ from the backend's", be[b].name);
+        CHECK(w->dense_epilogue == in->dense_epilogue && w->w_bits == in->w_bits &&
+              w->w_sparse == in->w_sparse && w->w_conv == in->w_conv && w->w_tiled == in->w_tiled,
+              "%s: wrapper flags differ from the backend's", be[b].name);
+    }
+}
+
+/* a profiled Conv1D layer has no dense_grad, minibatch training must see that */
+static void s_check_conv(void) {
+    tt_layer_desc_t d[2] = {
+        { .type = TT_LAYER_CONV1D, .act = TT_ACT_RELU, .ops = &tt_conv1d_backend },
+        { .type = TT_LAYER_DENSE,  .act = TT_ACT_LINEAR, .ops = &tt_backend },
+    };
+    if (matrix_conv1d_init(&d[0].conv, 2, 3, 3, 1, 1, 1, 16) < 0) { CHECK(0, "conv geometry"); return; }
+    d[0].in  = (uint16_t)MATRIX_CONV1D_IN_LEN(&d[0].conv);
+    d[0].out = (uint16_t)MATRIX_CONV1D_OUT_LEN(&d[0].conv);
+    d[1].in  = d[0].out;
+    d[1].out = 4;
+
+    size_t sz = tt_seq_model_arena_size(d, 2);
+    void *arena = malloc(sz);
+    tt_layer_t layers[2];
+    tt_seq_model_t m;
+    static tt_prof_layer_t pl[2];
+    tt_profile_t p;
+    if (!arena || tt_seq_model_init(&m, layers, d, 2, arena, sz) != 0) {
+        CHECK(0, "conv model init");
+        free(arena);
+        return;
+    }
+    tt_profile_init(&p, pl, 2, NULL, 0);
+    CHECK(tt_seq_model_profile(&m, &p) == 0, "profile conv model");
+    CHECK(tt_seq_model_batch_bytes(&m) == 0, "profiled Conv1D model claims minibatch training");
+    free(arena);
+}
+
+/* the unregistered call computes what the backend computes */
+static void s_check_unregistered(uint32_t *st) {
+    static int8_t wd[T_HID * T_IN], xd[T_IN], y0[T_HID], y1[T_HID];
+    int32_t acc[T_HID];
+    for (size_t i = 0; i < sizeof(wd); ++i) wd[i] = (int8_t)((int)(prng_next(st) % 31) - 15);
+    for (size_t i = 0; i < sizeof(xd); ++i) xd[i] = prng_rand_int8(st);
+    tensor_t W = { .data = wd, .len = sizeof(wd) }, X = { .data = xd, .len = T_IN };
+    tensor_t Y0 = { .data = y0, .len = T_HID }, Y1 = { .data = y1, .len = T_HID };
+
+    static tt_prof_layer_t pl[1];
+    tt_profile_t p;
+    tt_profile_init(&p, pl, 1, NULL, 0);
+    tt_backend.dense_forward(&W, &X, &Y0, acc, T_HID, TT_ACT_RELU);
+    tt_profile_wrap(&tt_backend)->dense_forward(&W, &X, &Y1, acc, T_HID, TT_ACT_RELU);
+    CHECK(!memcmp(y0, y1, T_HID) && !memcmp(&Y0.s, &Y1.s, sizeof(Y0.s)),
+          "unregistered forward through the wrapper differs");
+    CHECK(p.n_events == 0, "unregistered forward was accounted");
+}
+
+static int s_init(tt_seq_model_t *m, tt_layer_t *layers, void **arena) {
+    const tt_layer_desc_t d[2] = {
+        { .type = TT_LAYER_DENSE, .in = T_IN,  .out = T_HID, .act = TT_ACT_RELU,   .ops = &tt_backend },
+        { .type = TT_LAYER_DENSE, .in = T_HID, .out = T_OUT, .act = TT_ACT_LINEAR, .ops = &tt_backend },
+    };
+    size_t sz = tt_seq_model_arena_size(d, 2);
+    *arena = malloc(sz);
+    if (!*arena || tt_seq_model_init(m, layers, d, 2, *arena, sz) != 0) return -1;
+    tt_seq_model_randomize(m, 11, -40, 40);
+    return 0;
+}
+
+/* profiled and plain models step for step */
+static void s_check_same(uint32_t *st) {
+    tt_seq_model_t a, b;
+    tt_layer_t la[2], lb[2];
+    void *ara = NULL, *arb = NULL;
+    static tt_prof_layer_t pl[2];
+    static tt_prof_event_t ring[16];
+    static int8_t in[T_BATCH * T_IN], tg[T_BATCH * T_OUT];
+    tt_profile_t p;
+
+    if (s_init(&a, la, &ara) || s_init(&b, lb, &arb)) {
+        CHECK(0, "dense model init");
+        goto out;
+    }
+    tt_profile_init(&p, pl, 2, ring, 16);
+    CHECK(tt_seq_model_profile(&b, &p) == 0, "profile dense model");
+
+    size_t bytes = tt_seq_model_batch_bytes(&a);
+    CHECK(bytes && bytes == tt_seq_model_batch_bytes(&b), "batch bytes %zu", bytes);
+    void *buf = malloc(bytes);
+    if (!buf) goto out;
+    for (int s = 0; s < T_STEPS; ++s) {
+        for (size_t i = 0; i < sizeof(in); ++i) in[i] = (int8_t)(prng_next(st) % 100);
+        for (size_t i = 0; i < sizeof(tg); ++i) tg[i] = (int8_t)(prng_next(st) % 100);
+        uint32_t ea, eb;
+        if (s & 1) {
+            ea = tt_seq_model_train_batch(&a, in, tg, T_BATCH, buf, bytes);
+            eb = tt_seq_model_train_batch(&b, in, tg, T_BATCH, buf, bytes);
+        } else {
+            ea = tt_seq_model_train_step(&a, in, tg);
+            eb = tt_seq_model_train_step(&b, in, tg);
+        }
+        CHECK(ea == eb, "step %d: sse %u profiled %u", s, ea, eb);
+    }
+    for (size_t l = 0; l < 2; ++l)
+        CHECK(!memcmp(la[l].W.data, lb[l].W.data, la[l].W.len) && !memcmp(&la[l].W.s, &lb[l].W.s, sizeof(la[l].W.s)),
+              "layer %zu weights differ after training", l);
+
+    uint64_t steps = T_STEPS / 2, batches = T_STEPS / 2;
+    for (size_t l = 0; l < 2; ++l) {
+        CHECK(pl[l].calls[TT_PROF_FORWARD] == steps + batches * T_BATCH, "layer %zu forward calls %llu",
+              l, (unsigned long long)pl[l].calls[TT_PROF_FORWARD]);
+        CHECK(pl[l].calls[TT_PROF_TRAIN] == steps, "layer %zu train calls", l);
+        CHECK(pl[l].calls[TT_PROF_GRAD] == batches * T_BATCH && pl[l].calls[TT_PROF_GRAD_PACK] == batches &&
+              pl[l].calls[TT_PROF_UPDATE] == batches, "layer %zu minibatch calls", l);
+    }
+    free(buf);
+out:
+    free(ara);
+    free(arb);
+}
+
+int main(void) {
+    uint32_t st;
+    prng_init(&st, 20250620u);
+    s_check_tables();
+    s_check_conv();
+    s_check_unregistered(&st);
+    s_check_same(&st);
+    printf("test_profile: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_stream.c
+ * @brief streamed outputs match the full forward pass they stand for
+ * @details a conv (ReLU) - conv (dilated, tanh) - dense model is fed two
+ * channels one sample at a time. The priming push must return the output
+ * of tt_seq_model_forward on the same window, bit for bit and with the
+ * same header. Every later push must return what the full window gives
+ * when each streamed layer is recomputed over all of its columns with the
+ * frozen shift, rescale and header, and the dense tail runs on the
+ * result. With a hop of 3 only every third push returns an output. A
+ * dense model without streamed layers reads its single-channel window
+ * straight from the ring and must match tt_seq_model_forward on every
+ * push.
+ * @license MIT
+ */
+#include "tt_stream.h"
+#include "matrix_conv1d.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_CH        (2)
+#define T_LIN       (16)
+#define T_OUT       (6)
+#define T_PUSHES    (24)
+#define T_MAX       (64)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static int s_same(const tensor_t *a, const tensor_t *b) {
+    return a && b && a->len == b->len && !memcmp(a->data, b->data, a->len) && !memcmp(&a->s, &b->s, sizeof(a->s));
+}
+
+static int s_conv_model(tt_seq_model_t *m, tt_layer_t *layers, void **arena) {
+    tt_layer_desc_t d[3] = {
+        { .type = TT_LAYER_CONV1D, .act = TT_ACT_RELU,   .ops = &tt_conv1d_backend },
+        { .type = TT_LAYER_CONV1D, .act = TT_ACT_TANH,   .ops = &tt_conv1d_backend },
+        { .type = TT_LAYER_DENSE,  .act = TT_ACT_LINEAR, .ops = &tt_backend },
+    };
+    if (matrix_conv1d_init(&d[0].conv, T_CH, 3, 3, 1, 1, 0, T_LIN) < 0 ||
+        matrix_conv1d_init(&d[1].conv, 3, 4, 2, 1, 2, 0, d[0].conv.l_out) < 0) return -1;
+    for (size_t l = 0; l < 2; ++l) {
+        d[l].in  = (uint16_t)MATRIX_CONV1D_IN_LEN(&d[l].conv);
+        d[l].out = (uint16_t)MATRIX_CONV1D_OUT_LEN(&d[l].conv);
+    }
+    d[2].in  = d[1].out;
+    d[2].out = T_OUT;
+    size_t sz = tt_seq_model_arena_size(d, 3);
+    *arena = malloc(sz);
+    if (!*arena || tt_seq_model_init(m, layers, d, 3, *arena, sz) != 0) return -1;
+    tt_seq_model_randomize(m, 3, -30, 30);
+    return 0;
+}
+
+/* channel-major window of the last T_LIN samples ending at push p (0-based) */
+static void s_window(int8_t *win, const int8_t (*x)[T_CH], size_t p) {
+    for (size_t c = 0; c < T_CH; ++c)
+        for (size_t t = 0; t < T_LIN; ++t) win[c * T_LIN + t] = x[p + 1 - T_LIN + t][c];
+}
+
+/* the full window through the streamed layers with the frozen epilogues, then the tail */
+static void s_frozen(const tt_stream_t *s, const int8_t *win, tensor_t *y, int8_t *buf) {
+    const tt_seq_model_t *m = s->m;
+    static int8_t cur[T_MAX], nxt[T_MAX];
+    int32_t acc[T_MAX];
+    memcpy(cur, win, T_CH * T_LIN);
+    for (size_t l = 0; l < s->n_conv; ++l) {
+        const tt_layer_t *L = &m->layers[l];
+        matrix_conv1d_fwd(&L->cv.g, L->W.data, cur, acc);
+        tt_epilogue_fixed(L->desc.act, acc, nxt, L->A.len, s->e[l]);
+        if (L->desc.act == TT_ACT_TANH || L->desc.act == TT_ACT_SIGMOID)
+            for (size_t i = 0; i < L->A.len; ++i) nxt[i] = s->lut[l].map[(uint8_t)nxt[i]];
+        memcpy(cur, nxt, L->A.len);
+    }
+    const tt_layer_t *T = &m->layers[s->n_conv];
+    tensor_t x = { .data = cur, .len = T->desc.in, .s = s->ring[s->n_conv].s };
+    y->data = buf;
+    y->len  = T->A.len;
+    T->desc.ops->dense_forward(&T->W, &x, y, acc, y->len, T->desc.act);
+}
+
+static void s_check_conv(size_t hop, uint32_t *st) {
+    tt_seq_model_t m;
+    tt_layer_t layers[3];
+    void *arena = NULL, *mem = NULL;
+    tt_stream_t s;
+    static int8_t x[T_PUSHES][T_CH], win[T_CH * T_LIN], got[T_OUT], ref[T_OUT];
+
+    if (s_conv_model(&m, layers, &arena) != 0) { CHECK(0, "conv model init"); goto out; }
+    size_t sz = tt_stream_mem_size(&m, T_CH);
+    mem = sz ? malloc(sz) : NULL;
+    if (!mem || tt_stream_init(&s, &m, T_CH, hop, mem, sz) != 0) { CHECK(0, "stream init"); goto out; }
+    CHECK(s.n_conv == 2, "streamed layers %zu", s.n_conv);
+
+    for (size_t p = 0; p < T_PUSHES; ++p) {
+        for (size_t c = 0; c < T_CH; ++c) x[p][c] = prng_rand_int8(st);
+        const tensor_t *y = tt_stream_push(&s, x[p]);
+        int due = p + 1 >= T_LIN && (p + 1 - T_LIN) % hop == 0;
+        CHECK(!y == !due, "hop %zu push %zu: output %s", hop, p, y ? "early" : "missing");
+        if (!y) continue;
+        tensor_t out = { .data = got, .len = y->len, .s = y->s };
+        memcpy(got, y->data, y->len);
+
+        s_window(win, (const int8_t (*)[T_CH])x, p);
+        if (p + 1 == T_LIN) {
+            CHECK(s_same(&out, tt_seq_model_forward(&m, win)), "priming output differs from the forward pass");
+        } else {
+            tensor_t r;
+            s_frozen(&s, win, &r, ref);
+            CHECK(s_same(&out, &r), "hop %zu push %zu: differs from the frozen-header recompute", hop, p);
+        }
+    }
+out:
+    free(mem);
+    free(arena);
+}
+
+/* dense only: the ring is the window, every output is the forward pass */
+static void s_check_dense(uint32_t *st) {
+    const tt_layer_desc_t d = { .type = TT_LAYER_DENSE, .in = T_LIN, .out = T_OUT, .act = TT_ACT_RELU, .ops = &tt_backend };
+    tt_seq_model_t m;
+    tt_layer_t layer;
+    tt_stream_t s;
+    static int8_t x[T_PUSHES][1], win[T_LIN], got[T_OUT];
+    size_t sz = tt_seq_model_arena_size(&d, 1);
+    void *arena = malloc(sz), *mem = NULL;
+
+    if (!arena || tt_seq_model_init(&m, &layer, &d, 1, arena, sz) != 0) { CHECK(0, "dense model init"); goto out; }
+    tt_seq_model_randomize(&m, 4, -30, 30);
+    sz  = tt_stream_mem_size(&m, 1);
+    mem = sz ? malloc(sz) : NULL;
+    if (!mem || tt_stream_init(&s, &m, 1, 1, mem, sz) != 0) { CHECK(0, "dense stream init"); goto out; }
+
+    for (size_t p = 0; p < T_PUSHES; ++p) {
+        x[p][0] = prng_rand_int8(st);
+        const tensor_t *y = tt_stream_push(&s, x[p]);
+        if (p + 1 < T_LIN) { CHECK(!y, "dense push %zu: early output", p); continue; }
+        if (!y) { CHECK(0, "dense push %zu: no output", p); continue; }
+        tensor_t out = { .data = got, .len = y->len, .s = y->s };
+        memcpy(got, y->data, y->len);
+        for (size_t t = 0; t < T_LIN; ++t) win[t] = x[p + 1 - T_LIN + t][0];
+        CHECK(s_same(&out, tt_seq_model_forward(&m, win)), "dense push %zu: differs from the forward pass", p);
+    }
+out:
+    free(mem);
+    free(arena);
+}
+
+int main(void) {
+    uint32_t st;
+    prng_init(&st, 20250705u);
+    s_check_conv(1, &st);
+    s_check_conv(3, &st);
+    s_check_dense(&st);
+    printf("test_stream: %d failures\n", s_fail);
+    return s_fail ? 1 : 0;
+}
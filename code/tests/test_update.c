@@ -0,0 +1,157 @@
+/**
+ * @file test_update.c
+ * @brief differential test of the fused update kernels of tt_update.h
+ * @details the scalar kernels (matrix_set_isa(TT_ISA_SCALAR)) are the
+ * reference; every other level the cpu reaches must produce the same
+ * gradients, weights, sums and max-abs scans over random shapes and random
+ * composed maps. Values include -128 / 127 runs, so every map entry and
+ * the saturating corners are hit.
+ * @license MIT
+ */
+#include "tt_update.h"
+#include "matrix.h"
+#include "matrix_tile.h"
+#include "tt_cpu.h"
+#include "prng.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define T_MAX_OUT   (40)
+#define T_MAX_IN    (150)
+#define T_MAX_LEN   (MATRIX_TILE_LEN(T_MAX_OUT, T_MAX_IN))
+#define T_ROUNDS    (80)
+
+static int s_fail = 0;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            if (s_fail < 20) { printf("FAIL %s:%d: ", __FILE__, __LINE__);      \
+                               printf(__VA_ARGS__); printf("\n"); }             \
+            ++s_fail;                                                           \
+        }                                                                       \
+    } while (0)
+
+static void s_fill(uint32_t *st, int8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        p[i] = (prng_next(st) & 7) == 0 ? ((prng_next(st) & 1) ? 127 : -128) : prng_rand_int8(st);
+}
+
+/* outputs of every kernel at one level */
+typedef struct {
+    int8_t  G[T_MAX_LEN], Gt[T_MAX_LEN], W[T_MAX_LEN], W32[T_MAX_LEN], R[T_MAX_LEN], P[T_MAX_LEN];
+    int32_t acc[T_MAX_LEN], acct[T_MAX_LEN];
+    int     mg, mw, mgt, mwt, sgd, sgd32, mi8;
+    int32_t mi32;
+    uint8_t k;
+} s_out_t;
+
+static void s_run(tt_isa_t isa, const tt_grad_map_t *m, tt_mult_t am, const int8_t *e, size_t OUT, const int8_t *x, size_t IN,
+                  const int8_t *W0, const int32_t *acc0, uint8_t shift, int8_t shift32, int dir, s_out_t *o) {
+    size_t n = OUT * IN, nt = MATRIX_TILE_LEN(OUT, IN);
+    matrix_set_isa(isa);
+
+    tt_grad_outer(o->G, e, OUT, x, IN, m, W0, &o->mg, &o->mw);
+    tt_grad_outer_tile(o->Gt, e, OUT, x, IN, m, W0, &o->mgt, &o->mwt);
+
+    memcpy(o->W, W0, n);
+    o->sgd = tt_sgd_apply(o->W, o->G, n, shift);
+
+    memcpy(o->R, W0, n);
+    tt_rescale_i8(o->R, n, dir);
+
+    memcpy(o->acc, acc0, n * sizeof(int32_t));
+    tt_grad_outer_acc(o->acc, e, OUT, x, IN, am);
+    memcpy(o->acct, acc0, nt * sizeof(int32_t));
+    tt_grad_outer_acc_tile(o->acct, e, OUT, x, IN, am);
+
+    o->k = tt_grad_pack_i8(o->P, o->acc, n);
+    memcpy(o->W32, W0, n);
+    o->sgd32 = tt_sgd_apply32(o->W32, o->acc, n, shift32);
+    o->mi8   = tt_max_abs_i8(W0, n);
+    o->mi32  = tt_max_abs_i32(o->acc, n);
+}
+
+/* with no alignment the sums gain e[r] * x[c] exactly, whatever their size */
+static void s_check_raw(uint32_t *st, tt_isa_t isa, const char *name) {
+    static int8_t  e[T_MAX_OUT], x[T_MAX_IN];
+    static int32_t acc[T_MAX_LEN], acct[T_MAX_LEN];
+    const tt_mult_t one = tt_align_mult(0, 0, 0);
+    size_t OUT = 1 + prng_next(st) % T_MAX_OUT, IN = 1 + prng_next(st) % T_MAX_IN;
+    matrix_tile_t t;
+    if (matrix_tile_init(&t, OUT, IN) < 0) return;
+    s_fill(st, e, OUT);
+    s_fill(st, x, IN);
+    matrix_set_isa(isa);
+    memset(acc, 0, sizeof(acc));
+    memset(acct, 0, sizeof(acct));
+    for (int s = 0; s < 3; ++s) {
+        tt_grad_outer_acc(acc, e, OUT, x, IN, one);
+        tt_grad_outer_acc_tile(acct, e, OUT, x, IN, one);
+    }
+    int bad = 0;
+    for (size_t r = 0; r < OUT; ++r)
+        for (size_t c = 0; c < IN; ++c) {
+            int32_t p = 3 * (int32_t)e[r] * x[c];
+            bad += acc[r * IN + c] != p || acct[matrix_tile_idx(&t, r, c)] != p;
+        }
+    CHECK(!bad, "%s tt_grad_outer_acc %zux%zu: %d sums differ from the raw products", name, OUT, IN, bad);
+}
+
+int main(void) {
+    static int8_t  e[T_MAX_OUT], x[T_MAX_IN], W0[T_MAX_LEN];
+    static int32_t acc0[T_MAX_LEN];
+    static s_out_t ref, out;
+    uint32_t st;
+    prng_init(&st, 20250611u);
+    int levels = 0;
+    s_check_raw(&st, TT_ISA_SCALAR, "scalar");
+
+    for (int isa = TT_ISA_SSE41; isa <= TT_ISA_NEON_DOT; ++isa) {
+        if (matrix_set_isa((tt_isa_t)isa) != (tt_isa_t)isa) continue;
+        const char *name = tt_cpu_isa_name((tt_isa_t)isa);
+        ++levels;
+        s_check_raw(&st, (tt_isa_t)isa, name);
+        for (int round = 0; round < T_ROUNDS; ++round) {
+            size_t OUT = 1 + prng_next(&st) % T_MAX_OUT;
+            size_t IN  = 1 + prng_next(&st) % T_MAX_IN;
+            size_t nt  = MATRIX_TILE_LEN(OUT, IN);
+            tt_grad_map_t m;
+            tt_grad_map_init(&m, (uint8_t)(prng_next(&st) % 4), (int8_t)(prng_next(&st) % 9) - 4,
+                             (int8_t)(prng_next(&st) % 3), (int8_t)(prng_next(&st) % 3));
+            /* alignments down to zero, and up to the saturation of the errors */
+            tt_mult_t am = tt_align_mult((int8_t)(prng_next(&st) % 40) - 20,
+                                         (uint8_t)(prng_next(&st) % 3), (uint8_t)(prng_next(&st) % 3));
+            s_fill(&st, e, OUT);
+            s_fill(&st, x, IN);
+            s_fill(&st, W0, nt);
+            /* sums of a few samples, kept clear of int32 overflow */
+            for (size_t i = 0; i < nt; ++i) acc0[i] = (int32_t)(prng_next(&st) % 4096) - 2048;
+            uint8_t shift   = (uint8_t)(prng_next(&st) % 4);
+            int8_t  shift32 = (int8_t)(prng_next(&st) % 12) - 2;
+            int     dir     = (int)(prng_next(&st) % 3) - 1;
+            size_t  n = OUT * IN;
+
+            s_run(TT_ISA_SCALAR, &m, am, e, OUT, x, IN, W0, acc0, shift, shift32, dir, &ref);
+            s_run((tt_isa_t)isa, &m, am, e, OUT, x, IN, W0, acc0, shift, shift32, dir, &out);
+
+            CHECK(!memcmp(ref.G, out.G, n) && ref.mg == out.mg && ref.mw == out.mw,
+                  "%s tt_grad_outer %zux%zu", name, OUT, IN);
+            CHECK(!memcmp(ref.Gt, out.Gt, nt) && ref.mgt == out.mgt && ref.mwt == out.mwt,
+                  "%s tt_grad_outer_tile %zux%zu", name, OUT, IN);
+            CHECK(!memcmp(ref.W, out.W, n) && ref.sgd == out.sgd, "%s tt_sgd_apply %zu shift %u", name, n, shift);
+            CHECK(!memcmp(ref.R, out.R, n), "%s tt_rescale_i8 %zu dir %d", name, n, dir);
+            CHECK(!memcmp(ref.acc, out.acc, n * sizeof(int32_t)), "%s tt_grad_outer_acc %zux%zu", name, OUT, IN);
+            CHECK(!memcmp(ref.acct, out.acct, nt * sizeof(int32_t)), "%s tt_grad_outer_acc_tile %zux%zu",
+                  name, OUT, IN);
+            CHECK(!memcmp(ref.P, out.P, n) && ref.k == out.k, "%s tt_grad_pack_i8 %zu", name, n);
+            CHECK(!memcmp(ref.W32, out.W32, n) && ref.sgd32 == out.sgd32, "%s tt_sgd_apply32 %zu shift %d",
+                  name, n, shift32);
+            CHECK(ref.mi8 == out.mi8 && ref.mi32 == out.mi32, "%s tt_max_abs %zu", name, n);
+        }
+    }
+    matrix_set_isa(tt_cpu_isa());
+    printf("test_update: %d levels against scalar, %d failures\n", levels, s_fail);
+    return s_fail ? 1 : 0;
+}
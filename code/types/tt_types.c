@@ -13,9 +13,8 @@ void tt_tensor_init(tensor_t *t, int8_t *data, size_t len) {
     if(!len) return;
     t->data = data;
     t->len = len;
-    t->s.S = 0;
-    t->s.U = 0;
-    t->s.D = 0;
+    memset(&t->s, 0, sizeof(t->s));   /* flat or nested header */
+    t->ext = NULL;
     return;
 }
 
@@ -26,9 +25,8 @@ void tt_tensor_clear(tensor_t *t) {
     if(!t) return;
     t->data = NULL;
     t->len = 0;
-    t->s.S = 0;
-    t->s.U = 0;
-    t->s.D = 0;
+    memset(&t->s, 0, sizeof(t->s));   /* flat or nested header */
+    t->ext = NULL;
     return;
 }
 
@@ -1,12 +1,14 @@
 #ifndef TT_TYPES_H
 #define TT_TYPES_H
-#include"scale.h"
+#include <stddef.h>
+#include "scale.h"
 
 /* -------- 1‑D tensor ------------------- */
 typedef struct {
     int8_t  *data;     /* int‑8 payload */
     size_t   len;
     scale_t  s;        /* scale header */
+    void    *ext;      /* backend extension (e.g. int4 shadow), NULL for plain int8 */
 } tensor_t;
 
 /* init */
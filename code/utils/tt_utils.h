@@ -20,4 +20,24 @@ static inline uint8_t bitwidth32(int32_t v)
     return 32u - __builtin_clz(a);
 }
 
+/* divide by 2^k, round half away from zero */
+static inline int32_t shift_round32_inline(int32_t x, uint8_t k)
+{
+    if (k == 0) return x;
+    /* the shift floors, so a negative x takes 2^(k-1) - 1: -2 >> 1 gives -1 */
+    return (x + (1 << (k - 1)) - (x < 0)) >> k;
+}
+
+/* x *= 4/3 (as x + x/4 + x/16), clip */
+static inline int8_t upscale_4_3_inline(int8_t x)
+{
+    return clip_int8(x + (x >> 2) + (x >> 4));
+}
+
+/* x *= 4/5 (as x - x/4), clip */
+static inline int8_t downscale_4_5_inline(int8_t x)
+{
+    return clip_int8(x - (x >> 2));
+}
+
 #endif